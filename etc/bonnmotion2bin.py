@@ -0,0 +1,87 @@
+#!/usr/bin/env python
+#
+# Converts a BonnMotion text trace or an ANSim XML trace into the binary
+# trace format read by BonnMotionMobility (see BonnMotionFileCache.h).
+# The binary file can be given to BonnMotionMobility's traceFile parameter
+# in place of the text file; it is memory-mapped instead of being parsed.
+#
+# usage: bonnmotion2bin.py [-f bonnmotion|ansim] <input> <output>
+#
+# The format is guessed from the input file if -f is not given. For ANSim
+# traces, each <position_change> element becomes an (end_time, xpos, ypos)
+# triplet of its node; node ids are used as line numbers.
+#
+
+import struct
+import sys
+import xml.etree.ElementTree as ET
+
+MAGIC = b"INETBMT\0"
+VERSION = 1
+
+
+def read_bonnmotion(filename):
+    lines = []
+    f = open(filename)
+    for line in f:
+        lines.append([float(x) for x in line.split()])
+    f.close()
+    return lines
+
+
+def read_ansim(filename):
+    nodes = {}
+    root = ET.parse(filename).getroot()
+    mobility = root.find("mobility")
+    if mobility is None:
+        raise ValueError("%s: no <mobility> element" % filename)
+    for change in mobility.findall("position_change"):
+        node = int(change.findtext("node_id"))
+        dest = change.find("destination")
+        triplet = [float(change.findtext("end_time")),
+                   float(dest.findtext("xpos")),
+                   float(dest.findtext("ypos"))]
+        nodes.setdefault(node, []).extend(triplet)
+    numNodes = max(nodes.keys()) + 1 if nodes else 0
+    return [nodes.get(i, []) for i in range(numNodes)]
+
+
+def guess_format(filename):
+    f = open(filename)
+    head = f.read(256).lstrip()
+    f.close()
+    return "ansim" if head.startswith("<") else "bonnmotion"
+
+
+def write_binary(lines, filename):
+    index = [0]
+    for line in lines:
+        index.append(index[-1] + len(line))
+    f = open(filename, "wb")
+    f.write(MAGIC)
+    f.write(struct.pack("<II", VERSION, len(lines)))
+    f.write(struct.pack("<%dQ" % len(index), *index))
+    for line in lines:
+        f.write(struct.pack("<%dd" % len(line), *line))
+    f.close()
+
+
+def main(args):
+    fmt = None
+    if len(args) >= 2 and args[0] == "-f":
+        fmt = args[1]
+        args = args[2:]
+    if len(args) != 2 or fmt not in (None, "bonnmotion", "ansim"):
+        sys.stderr.write("usage: bonnmotion2bin.py [-f bonnmotion|ansim] <input> <output>\n")
+        return 1
+    input, output = args
+    if fmt is None:
+        fmt = guess_format(input)
+    lines = read_ansim(input) if fmt == "ansim" else read_bonnmotion(input)
+    write_binary(lines, output)
+    print("%s: %d nodes, %d values" % (output, len(lines), sum([len(l) for l in lines])))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,44 @@
+#!/usr/bin/env python
+#
+# Sends UDP datagrams as fast as possible (or at a given rate) to the
+# simulated host of the LoopbackPerf example, and prints the offered load.
+#
+# usage: udpflood.py [-d 127.0.0.2] [-p 9999] [-s 64] [-r pps] [-t seconds]
+#
+
+import optparse
+import socket
+import time
+
+def main():
+    parser = optparse.OptionParser()
+    parser.add_option("-d", "--dest", default="127.0.0.2", help="destination address")
+    parser.add_option("-p", "--port", type="int", default=9999, help="destination port")
+    parser.add_option("-s", "--size", type="int", default=64, help="UDP payload size in bytes")
+    parser.add_option("-r", "--rate", type="float", default=0, help="packets/s, 0: unlimited")
+    parser.add_option("-t", "--time", type="float", default=10, help="duration in seconds")
+    opts, args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    payload = b"x" * opts.size
+    dest = (opts.dest, opts.port)
+
+    sent = 0
+    start = time.time()
+    end = start + opts.time
+    now = start
+    while now < end:
+        sock.sendto(payload, dest)
+        sent += 1
+        if opts.rate > 0:
+            due = start + sent / opts.rate
+            if due > now:
+                time.sleep(due - now)
+        if sent % 256 == 0 or opts.rate > 0:
+            now = time.time()
+
+    elapsed = time.time() - start
+    print("sent %d packets in %.2f s: %.0f packets/s" % (sent, elapsed, sent / elapsed))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,59 @@
+#!/usr/bin/env python
+#
+# Generates traffic.pcap for the PcapReplay example: a UDP stream of
+# 1000 packets/s towards 10.1.1.1:9999 and an ICMP echo request every
+# 100ms, from 10.1.1.2, on an Ethernet link.
+#
+# usage: mktrace.py [-d seconds] [-o traffic.pcap]
+#
+
+import optparse
+import struct
+
+def checksum(data):
+    if len(data) % 2:
+        data += b"\0"
+    s = sum(struct.unpack("!%dH" % (len(data) // 2), data))
+    while s >> 16:
+        s = (s & 0xffff) + (s >> 16)
+    return ~s & 0xffff
+
+def ipv4(proto, payload, ident):
+    src = bytes(bytearray([10, 1, 1, 2]))
+    dst = bytes(bytearray([10, 1, 1, 1]))
+    hdr = struct.pack("!BBHHHBBH4s4s", 0x45, 0, 20 + len(payload), ident, 0, 64, proto, 0, src, dst)
+    hdr = hdr[:10] + struct.pack("!H", checksum(hdr)) + hdr[12:]
+    return hdr + payload
+
+def ethernet(ippacket):
+    return b"\x0a\xaa\x00\x00\x00\x01" + b"\x0a\xaa\x00\x00\x00\x02" + b"\x08\x00" + ippacket
+
+def main():
+    parser = optparse.OptionParser()
+    parser.add_option("-d", "--duration", type="float", default=1.0, help="trace length in seconds")
+    parser.add_option("-o", "--output", default="traffic.pcap", help="output file")
+    opts, args = parser.parse_args()
+
+    start = 1287360000   # arbitrary epoch second
+    packets = []
+    numUdp = int(opts.duration * 1000)
+    for i in range(numUdp):
+        payload = b"u" * 64
+        udp = struct.pack("!HHHH", 5000, 9999, 8 + len(payload), 0) + payload
+        packets.append((i * 1000, ethernet(ipv4(17, udp, i & 0xffff))))
+    for i in range(int(opts.duration * 10)):
+        data = b"p" * 56
+        icmp = struct.pack("!BBHHH", 8, 0, 0, 1, i) + data
+        icmp = icmp[:2] + struct.pack("!H", checksum(icmp)) + icmp[4:]
+        packets.append((i * 100000 + 500, ethernet(ipv4(1, icmp, (numUdp + i) & 0xffff))))
+    packets.sort(key=lambda p: p[0])
+
+    f = open(opts.output, "wb")
+    f.write(struct.pack("<IHHiIII", 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+    for usec, frame in packets:
+        f.write(struct.pack("<IIII", start + usec // 1000000, usec % 1000000, len(frame), len(frame)))
+        f.write(frame)
+    f.close()
+
+if __name__ == "__main__":
+    main()
@@ -35,7 +35,7 @@ void UDPAppBase::bindToPort(int port)
     send(msg, "udpOut");
 }
 
-void UDPAppBase::sendToUDP(cPacket *msg, int srcPort, const IPvXAddress& destAddr, int destPort)
+void UDPAppBase::sendToUDP(cPacket *msg, int srcPort, const IPvXAddress& destAddr, int destPort, int diffServCodePoint)
 {
     // send message to UDP, with the appropriate control info attached
     msg->setKind(UDP_C_DATA);
@@ -44,6 +44,7 @@ void UDPAppBase::sendToUDP(cPacket *msg, int srcPort, const IPvXAddress& destAdd
     ctrl->setSrcPort(srcPort);
     ctrl->setDestAddr(destAddr);
     ctrl->setDestPort(destPort);
+    ctrl->setDiffServCodePoint(diffServCodePoint);
     msg->setControlInfo(ctrl);
 
     EV << "Sending packet: ";
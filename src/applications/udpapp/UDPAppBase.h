@@ -36,9 +36,9 @@ class INET_API UDPAppBase : public cSimpleModule
     virtual void bindToPort(int port);
 
     /**
-     * Sends a packet over UDP
+     * Sends a packet over UDP, optionally with the given DiffServ code point
      */
-    virtual void sendToUDP(cPacket *msg, int srcPort, const IPvXAddress& destAddr, int destPort);
+    virtual void sendToUDP(cPacket *msg, int srcPort, const IPvXAddress& destAddr, int destPort, int diffServCodePoint=0);
 
     /**
      * Prints a brief about packets having an attached UDPControlInfo
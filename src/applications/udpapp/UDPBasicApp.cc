@@ -42,6 +42,7 @@ void UDPBasicApp::initialize(int stage)
 
     localPort = par("localPort");
     destPort = par("destPort");
+    diffServCodePoint = par("diffServCodePoint");
 
     const char *destAddrs = par("destAddresses");
     cStringTokenizer tokenizer(destAddrs);
@@ -126,7 +127,7 @@ void UDPBasicApp::sendPacket()
 {
     cPacket *payload = createPacket();
     IPvXAddress destAddr = chooseDestAddr();
-    sendToUDP(payload, localPort, destAddr, destPort);
+    sendToUDP(payload, localPort, destAddr, destPort, diffServCodePoint);
 
     numSent++;
 }
@@ -33,6 +33,7 @@ class INET_API UDPBasicApp : public UDPAppBase
   protected:
     std::string nodeName;
     int localPort, destPort;
+    int diffServCodePoint;
     std::vector<IPvXAddress> destAddresses;
     double curFreq; // current frequency set from data given in NED/.ini
     std::vector<std::string> freqArrayVals;
@@ -29,6 +29,7 @@ void UDPSink::initialize()
 {
     numReceived = 0;
     WATCH(numReceived);
+    endToEndDelayVec.setName("endToEndDelay");
 
     int port = par("localPort");
     if (port!=-1)
@@ -52,8 +53,14 @@ void UDPSink::processPacket(cPacket *msg)
 {
     EV << "Received packet: ";
     printPacket(msg);
+    endToEndDelayVec.record(simTime() - msg->getCreationTime());
     delete msg;
 
     numReceived++;
 }
 
+void UDPSink::finish()
+{
+    recordScalar("packets received", numReceived);
+}
+
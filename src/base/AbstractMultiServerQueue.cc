@@ -0,0 +1,135 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <omnetpp.h>
+#include "AbstractMultiServerQueue.h"
+
+
+AbstractMultiServerQueue::AbstractMultiServerQueue()
+{
+    numServersPerQueue = 0;
+    numBusyServers = 0;
+    numBypassed = 0;
+}
+
+AbstractMultiServerQueue::~AbstractMultiServerQueue()
+{
+    for (unsigned int i=0; i<servers.size(); i++)
+    {
+        delete servers[i].msgServiced;
+        cancelAndDelete(servers[i].endServiceMsg);
+    }
+    for (unsigned int i=0; i<queues.size(); i++)
+        delete queues[i];
+}
+
+void AbstractMultiServerQueue::initQueues(int numQueues, int numServers)
+{
+    if (numQueues<1 || numServers<1)
+        error("number of queues and servers must be at least 1");
+
+    numServersPerQueue = numServers;
+    numBusyServers = 0;
+    numBypassed = 0;
+
+    for (int i=0; i<numQueues; i++)
+    {
+        char name[32];
+        sprintf(name, "queue-%d", i);
+        queues.push_back(new cPacketQueue(name));
+    }
+
+    servers.resize(numQueues*numServers);
+    for (unsigned int i=0; i<servers.size(); i++)
+    {
+        servers[i].msgServiced = NULL;
+        servers[i].endServiceMsg = new cMessage("end-service", i);
+    }
+
+    WATCH(numBusyServers);
+    WATCH(numBypassed);
+}
+
+void AbstractMultiServerQueue::handleMessage(cMessage *msg)
+{
+    if (msg->isSelfMessage())
+    {
+        doEndService(msg->getKind());
+        return;
+    }
+
+    cPacket *pk = PK(msg);
+    int queueId = selectQueue(pk);
+    if (queueId<0 || queueId>=(int)queues.size())
+        error("selectQueue() returned invalid queue index %d", queueId);
+
+    // look for an idle server of this queue
+    int first = queueId*numServersPerQueue;
+    for (int i=first; i<first+numServersPerQueue; i++)
+    {
+        if (!servers[i].msgServiced)
+        {
+            doStartService(i, pk);
+            return;
+        }
+    }
+    queues[queueId]->insert(pk);
+}
+
+void AbstractMultiServerQueue::doStartService(int serverId, cPacket *msg)
+{
+    Server& server = servers[serverId];
+    for (;;)
+    {
+        simtime_t serviceTime = startService(msg);
+        if (serviceTime != 0)
+        {
+            server.msgServiced = msg;
+            numBusyServers++;
+            scheduleAt(simTime()+serviceTime, server.endServiceMsg);
+            return;
+        }
+
+        // zero service time: no timer, no queueing
+        numBypassed++;
+        endService(msg);
+
+        // continue with the queue this server serves
+        cPacketQueue *queue = queues[serverId/numServersPerQueue];
+        if (queue->empty())
+            return;
+        msg = queue->pop();
+    }
+}
+
+void AbstractMultiServerQueue::doEndService(int serverId)
+{
+    Server& server = servers[serverId];
+    cPacket *msg = server.msgServiced;
+    server.msgServiced = NULL;
+    numBusyServers--;
+    endService(msg);
+
+    cPacketQueue *queue = queues[serverId/numServersPerQueue];
+    if (!queue->empty())
+        doStartService(serverId, queue->pop());
+}
+
+void AbstractMultiServerQueue::finish()
+{
+    recordScalar("packets processed without scheduling", numBypassed);
+}
+
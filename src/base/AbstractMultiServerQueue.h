@@ -0,0 +1,98 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_ABSTRACTMULTISERVERQUEUE_H
+#define __INET_ABSTRACTMULTISERVERQUEUE_H
+
+#include <vector>
+#include <omnetpp.h>
+#include "INETDefs.h"
+
+
+/**
+ * Abstract base class for queueing stations with several FIFO queues, each
+ * served by one or more parallel servers. A single queue with N servers
+ * models a multi-core forwarding engine; one queue per input with one
+ * server each models per-line-card forwarding.
+ *
+ * As in AbstractQueue, a message that finds an idle server and has zero
+ * service time is processed right away: it is neither queued nor is an
+ * end-of-service timer scheduled for it.
+ */
+class INET_API AbstractMultiServerQueue : public cSimpleModule
+{
+  private:
+    struct Server
+    {
+        cPacket *msgServiced;
+        cMessage *endServiceMsg;
+    };
+
+    // servers of queue i are servers[i*numServersPerQueue ...]
+    std::vector<Server> servers;
+    int numServersPerQueue;
+    int numBusyServers;
+    long numBypassed;
+
+  private:
+    void doStartService(int serverId, cPacket *msg);
+    void doEndService(int serverId);
+
+  protected:
+    /**
+     * The queues.
+     */
+    std::vector<cPacketQueue *> queues;
+
+  public:
+    AbstractMultiServerQueue();
+    virtual ~AbstractMultiServerQueue();
+
+  protected:
+    /**
+     * Creates numQueues queues with numServersPerQueue servers each.
+     * Must be called from initialize() of the subclass.
+     */
+    virtual void initQueues(int numQueues, int numServersPerQueue);
+    virtual void handleMessage(cMessage *msg);
+    virtual void finish();
+
+    /** Number of servers currently busy */
+    int getNumBusyServers() const {return numBusyServers;}
+
+    /** Functions to (re)define behaviour */
+
+    //@{
+    /**
+     * Returns the index of the queue the message should join (0..numQueues-1).
+     * The default implementation returns 0.
+     */
+    virtual int selectQueue(cPacket *msg) {return 0;}
+
+    /**
+     * Called when a message starts service, and should return the service time.
+     */
+    virtual simtime_t startService(cPacket *msg) = 0;
+
+    /**
+     * Called when a message completes service. The function may send it
+     * to another module, discard it, or in general do anything with it.
+     */
+    virtual void endService(cPacket *msg) = 0;
+    //@}
+};
+
+#endif
+
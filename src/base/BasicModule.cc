@@ -22,7 +22,7 @@
 #include <iostream>
 #include "BasicModule.h"
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? (std::ostream&)ev : EV << loggingName << "::BasicModule: "
+#define coreEV INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.isDisabled() && coreDebug) << loggingName << "::BasicModule: "
 
 /**
  * Subscription to NotificationBoard should be in stage==0, and firing
@@ -26,9 +26,9 @@
 #include "NotificationBoard.h"
 #include "NotifierConsts.h"
 
-#ifndef EV
-#define EV (ev.isDisabled()||!debug) ? (std::ostream&)ev : ev << logName() << "::" << getClassName() << ": "
-#endif
+// replaces the EV of INETDefs.h: honours the debug parameter, and prefixes the module
+#undef EV
+#define EV INET_LOG_IF(INET_LOGLEVEL_INFO, ev, !ev.isDisabled() && debug) << logName() << "::" << getClassName() << ": "
 
 
 /**
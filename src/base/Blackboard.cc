@@ -23,7 +23,7 @@
 Define_Module(Blackboard);
 
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? ev : ev <<getParentModule()->getName()<<"["<<getParentModule()->getIndex()<<"]::Blackboard: "
+#define coreEV INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.isDisabled() && coreDebug) <<getParentModule()->getName()<<"["<<getParentModule()->getIndex()<<"]::Blackboard: "
 
 
 std::ostream& operator<<(std::ostream& os, const Blackboard::BBItem& bbi)
@@ -42,11 +42,35 @@ typedef unsigned int uint;
 typedef unsigned long ulong;
 
 
+//
+// Compile-time log levels. Log statements above INET_LOGLEVEL are compiled
+// out completely, including the evaluation of their arguments; build with
+// -DINET_LOGLEVEL=0 for runs where no log output is needed at all.
+//
+#define INET_LOGLEVEL_OFF    0
+#define INET_LOGLEVEL_INFO   1   // EV, tcpEV
+#define INET_LOGLEVEL_DEBUG  2   // tcpEV2, sctpEV3
+
+#ifndef INET_LOGLEVEL
+#define INET_LOGLEVEL INET_LOGLEVEL_DEBUG
+#endif
+
+//
+// INET_LOG_IF(level, stream, enabled) << ...;
+// The << arguments are only evaluated if the level is compiled in and
+// the run-time condition is true. The if/else form keeps the macro safe
+// inside unbraced if/else statements (Note: deliberately no parens).
+//
+#define INET_LOG_IF(level, stream, enabled) \
+    if (INET_LOGLEVEL < (level) || !(enabled)) ; else stream
+
 //
 // Macro to prevent executing ev<< statements in Express mode.
-// Compare ev/sec values with code compiled with #define EV ev.
+// Compare ev/sec values with code compiled with -DINET_LOGLEVEL=0.
+// Replaces the EV of <cenvir.h>.
 //
-#define EV ev.isDisabled()?ev:ev
+#undef EV
+#define EV INET_LOG_IF(INET_LOGLEVEL_INFO, ev, !ev.isDisabled())
 
 
 //
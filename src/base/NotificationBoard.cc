@@ -49,7 +49,7 @@ std::ostream& operator<<(std::ostream& os, const NotificationBoard::NotifiableVe
 
 void NotificationBoard::initialize()
 {
-    WATCH_MAP(clientMap);
+    WATCH_VECTOR(clientMap);
 }
 
 void NotificationBoard::handleMessage(cMessage *msg)
@@ -63,6 +63,10 @@ void NotificationBoard::subscribe(INotifiable *client, int category)
     Enter_Method("subscribe(%s)", notificationCategoryName(category));
 
     // find or create entry for this category
+    if (category<0)
+        error("subscribe(): invalid category %d", category);
+    if (category >= (int)clientMap.size())
+        clientMap.resize(category+1);
     NotifiableVector& clients = clientMap[category];
 
     // add client if not already there
@@ -76,7 +80,9 @@ void NotificationBoard::unsubscribe(INotifiable *client, int category)
 {
     Enter_Method("unsubscribe(%s)", notificationCategoryName(category));
 
-    // find (or create) entry for this category
+    // find entry for this category
+    if (category<0 || category >= (int)clientMap.size())
+        return;
     NotifiableVector& clients = clientMap[category];
 
     // remove client if there
@@ -89,21 +95,33 @@ void NotificationBoard::unsubscribe(INotifiable *client, int category)
 
 bool NotificationBoard::hasSubscribers(int category)
 {
-    ClientMap::iterator it = clientMap.find(category);
-    return it!=clientMap.end() && !it->second.empty();
+    return category>=0 && category<(int)clientMap.size() && !clientMap[category].empty();
 }
 
 void NotificationBoard::fireChangeNotification(int category, const cPolymorphic *details)
 {
-    Enter_Method("fireChangeNotification(%s, %s)", notificationCategoryName(category),
-                 details?details->info().c_str() : "n/a");
-
-    ClientMap::iterator it = clientMap.find(category);
-    if (it==clientMap.end())
+    // no subscribers: return before any context switching or formatting
+    if (!hasSubscribers(category))
         return;
-    NotifiableVector& clients = it->second;
-    for (NotifiableVector::iterator j=clients.begin(); j!=clients.end(); j++)
-        (*j)->receiveChangeNotification(category, details);
+
+    if (ev.isGUI() || (INET_LOGLEVEL>=INET_LOGLEVEL_INFO && !ev.isDisabled()))
+    {
+        Enter_Method("fireChangeNotification(%s, %s)", notificationCategoryName(category),
+                     details?details->info().c_str() : "n/a");
+        notifyClients(category, details);
+    }
+    else
+    {
+        Enter_Method_Silent();
+        notifyClients(category, details);
+    }
+}
+
+void NotificationBoard::notifyClients(int category, const cPolymorphic *details)
+{
+    // index-based loop: clientMap may be modified by the clients
+    for (unsigned int i=0; i<clientMap[category].size(); i++)
+        clientMap[category][i]->receiveChangeNotification(category, details);
 }
 
 
@@ -20,7 +20,6 @@
 #define __INET_NOTIFICATIONBOARD_H
 
 #include <omnetpp.h>
-#include <map>
 #include <vector>
 #include "ModuleAccess.h"
 #include "INotifiable.h"
@@ -86,13 +85,19 @@ class INET_API NotificationBoard : public cSimpleModule
 {
   public: // should be protected
     typedef std::vector<INotifiable *> NotifiableVector;
-    typedef std::map<int, NotifiableVector> ClientMap;
+    typedef std::vector<NotifiableVector> ClientMap;  // indexed by category
     friend std::ostream& operator<<(std::ostream&, const NotifiableVector&); // doesn't work in MSVC 6.0
 
   protected:
     ClientMap clientMap;
 
   protected:
+    /**
+     * Delivers the notification to the clients of the category. Clients
+     * may subscribe or unsubscribe during delivery.
+     */
+    void notifyClients(int category, const cPolymorphic *details);
+
     /**
      * Initialize.
      */
@@ -134,6 +139,10 @@ class INET_API NotificationBoard : public cSimpleModule
      * taken place. The optional details object may carry more specific
      * information about the change (e.g. exact location, specific attribute
      * that changed, old value, new value, etc).
+     *
+     * This is called very frequently (e.g. on every mobility update), so
+     * the method call is only annotated with the details when running
+     * under a GUI or with logging enabled.
      */
     virtual void fireChangeNotification(int category, const cPolymorphic *details=NULL);
     //@}
@@ -0,0 +1,295 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <fstream>
+#include <math.h>
+#include <string.h>
+#include "PcapFileReader.h"
+
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32) && !defined(__CYGWIN__) && !defined(_WIN64)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define HAVE_MMAP
+#endif
+
+#define PCAP_MAGIC          0xa1b2c3d4
+#define PCAP_MAGIC_NSEC     0xa1b23c4d
+#define PCAPNG_SHB          0x0a0d0d0a  // Section Header Block
+#define PCAPNG_IDB          0x00000001  // Interface Description Block
+#define PCAPNG_SPB          0x00000003  // Simple Packet Block
+#define PCAPNG_EPB          0x00000006  // Enhanced Packet Block
+#define PCAPNG_BYTE_ORDER   0x1a2b3c4d
+#define PCAPNG_OPT_TSRESOL  9
+
+
+PcapFileReader::PcapFileReader()
+{
+    file = NULL;
+    size = pos = 0;
+    mappedData = NULL;
+    ng = swapped = nanoRes = false;
+    pcapLinkType = -1;
+    lastTimestamp = 0;
+}
+
+PcapFileReader::~PcapFileReader()
+{
+    close();
+}
+
+void PcapFileReader::close()
+{
+#ifdef HAVE_MMAP
+    if (mappedData)
+        munmap(mappedData, size);
+#endif
+    mappedData = NULL;
+    buffer.clear();
+    file = NULL;
+    size = pos = 0;
+    interfaces.clear();
+}
+
+uint16 PcapFileReader::get16(const unsigned char *p) const
+{
+    uint16 v;
+    memcpy(&v, p, 2);
+    return swapped ? (uint16)((v>>8) | (v<<8)) : v;
+}
+
+uint32 PcapFileReader::get32(const unsigned char *p) const
+{
+    uint32 v;
+    memcpy(&v, p, 4);
+    return swapped ? ((v>>24) | ((v>>8) & 0xff00) | ((v<<8) & 0xff0000) | (v<<24)) : v;
+}
+
+void PcapFileReader::open(const char *fname)
+{
+    close();
+    filename = fname;
+
+#ifdef HAVE_MMAP
+    int fd = ::open(fname, O_RDONLY);
+    struct stat st;
+    if (fd<0 || fstat(fd, &st)<0)
+        opp_error("Cannot open file '%s'", fname);
+    size = st.st_size;
+    if (size > 0)
+    {
+        void *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p==MAP_FAILED)
+        {
+            ::close(fd);
+            opp_error("Cannot map file '%s' into memory", fname);
+        }
+        madvise(p, size, MADV_SEQUENTIAL);
+        mappedData = p;
+        file = (const unsigned char *)p;
+    }
+    ::close(fd);
+#else
+    std::ifstream in(fname, std::ios::in|std::ios::binary);
+    if (in.fail())
+        opp_error("Cannot open file '%s'", fname);
+    in.seekg(0, std::ios::end);
+    size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    buffer.resize(size);
+    if (size>0 && !in.read((char *)&buffer[0], size))
+        opp_error("Cannot read file '%s'", fname);
+    file = size>0 ? &buffer[0] : NULL;
+#endif
+
+    if (size < 4)
+        opp_error("'%s' is not a pcap or pcapng file", fname);
+
+    uint32 magic;
+    memcpy(&magic, file, 4);
+    if (magic==PCAPNG_SHB)
+    {
+        ng = true;
+        readSectionHeader();
+        return;
+    }
+
+    ng = false;
+    if (magic==PCAP_MAGIC || magic==PCAP_MAGIC_NSEC)
+        swapped = false;
+    else
+    {
+        swapped = true;
+        magic = get32(file);
+        if (magic!=PCAP_MAGIC && magic!=PCAP_MAGIC_NSEC)
+            opp_error("'%s' is not a pcap or pcapng file", fname);
+    }
+    if (size < 24)
+        opp_error("pcap file '%s' is truncated", fname);
+    nanoRes = (magic==PCAP_MAGIC_NSEC);
+    pcapLinkType = get32(file+20) & 0xffff;  // upper bits carry FCS information
+    pos = 24;
+}
+
+void PcapFileReader::readSectionHeader()
+{
+    // byte order magic follows block type and length
+    if (pos+28 > size)
+        opp_error("pcapng file '%s' is truncated", filename.c_str());
+    uint32 bom;
+    memcpy(&bom, file+pos+8, 4);
+    if (bom==PCAPNG_BYTE_ORDER)
+        swapped = false;
+    else
+    {
+        swapped = true;
+        if (get32(file+pos+8)!=PCAPNG_BYTE_ORDER)
+            opp_error("'%s': invalid pcapng section header", filename.c_str());
+    }
+    uint32 blockLength = get32(file+pos+4);
+    if (blockLength < 28 || pos+blockLength > size)
+        opp_error("pcapng file '%s' is truncated", filename.c_str());
+    interfaces.clear();  // interface ids are per section
+    pos += blockLength;
+}
+
+void PcapFileReader::readInterfaceDescription(const unsigned char *body, uint32 bodyLength)
+{
+    if (bodyLength < 8)
+        opp_error("'%s': invalid pcapng interface description", filename.c_str());
+    Interface iface;
+    iface.linkType = get16(body);
+    iface.resolution = 6;
+
+    // options: code, length, value padded to 32 bits
+    uint32 off = 8;
+    while (off+4 <= bodyLength)
+    {
+        uint16 code = get16(body+off);
+        uint16 len = get16(body+off+2);
+        if (code==0)
+            break;
+        if (code==PCAPNG_OPT_TSRESOL && len>=1 && off+5 <= bodyLength)
+            iface.resolution = body[off+4];
+        off += 4 + ((len+3) & ~3);
+    }
+    interfaces.push_back(iface);
+}
+
+int64 PcapFileReader::toNanoseconds(uint64 ts, int resolution)
+{
+    int exp = resolution & 0x7f;
+    if (resolution & 0x80)
+    {
+        // 2^-exp seconds
+        uint64 secs = exp < 64 ? ts >> exp : 0;
+        uint64 frac = exp < 64 ? ts - (secs << exp) : ts;
+        return (int64)(secs * 1000000000) + (int64)(frac * 1e9 / pow(2.0, exp));
+    }
+    int64 ns = ts;
+    for (; exp < 9; exp++)
+        ns *= 10;
+    for (; exp > 9; exp--)
+        ns /= 10;
+    return ns;
+}
+
+bool PcapFileReader::next(Packet& packet)
+{
+    if (!ng)
+    {
+        if (pos >= size)
+            return false;
+        if (pos+16 > size)
+            opp_error("pcap file '%s' is truncated", filename.c_str());
+        const unsigned char *hdr = file+pos;
+        packet.capLength = get32(hdr+8);
+        packet.origLength = get32(hdr+12);
+        if (pos+16+packet.capLength > size)
+            opp_error("pcap file '%s' is truncated", filename.c_str());
+        packet.timestamp = (int64)get32(hdr) * 1000000000 + (int64)get32(hdr+4) * (nanoRes ? 1 : 1000);
+        packet.data = hdr+16;
+        packet.linkType = pcapLinkType;
+        packet.interfaceId = 0;
+        pos += 16 + packet.capLength;
+        return true;
+    }
+
+    while (pos < size)
+    {
+        if (pos+12 > size)
+            opp_error("pcapng file '%s' is truncated", filename.c_str());
+        uint32 blockType = get32(file+pos);
+        if (blockType==PCAPNG_SHB)
+        {
+            // a new section may change the byte order
+            readSectionHeader();
+            continue;
+        }
+        uint32 blockLength = get32(file+pos+4);
+        if (blockLength < 12 || (blockLength & 3) || pos+blockLength > size)
+            opp_error("pcapng file '%s' is truncated or corrupt", filename.c_str());
+        const unsigned char *body = file+pos+8;
+        uint32 bodyLength = blockLength-12;
+        pos += blockLength;
+
+        switch (blockType)
+        {
+            case PCAPNG_IDB:
+                readInterfaceDescription(body, bodyLength);
+                break;
+
+            case PCAPNG_EPB:
+            {
+                if (bodyLength < 20)
+                    opp_error("'%s': invalid pcapng packet block", filename.c_str());
+                uint32 ifId = get32(body);
+                if (ifId >= interfaces.size())
+                    opp_error("'%s': packet refers to undefined interface %u", filename.c_str(), ifId);
+                const Interface& iface = interfaces[ifId];
+                uint64 ts = ((uint64)get32(body+4) << 32) | get32(body+8);
+                packet.capLength = get32(body+12);
+                packet.origLength = get32(body+16);
+                if (20+packet.capLength > bodyLength)
+                    opp_error("'%s': invalid pcapng packet block", filename.c_str());
+                packet.data = body+20;
+                packet.timestamp = lastTimestamp = toNanoseconds(ts, iface.resolution);
+                packet.linkType = iface.linkType;
+                packet.interfaceId = ifId;
+                return true;
+            }
+
+            case PCAPNG_SPB:
+            {
+                if (bodyLength < 4 || interfaces.empty())
+                    opp_error("'%s': invalid pcapng simple packet block", filename.c_str());
+                packet.origLength = get32(body);
+                packet.capLength = std::min(packet.origLength, bodyLength-4);
+                packet.data = body+4;
+                packet.timestamp = lastTimestamp;
+                packet.linkType = interfaces[0].linkType;
+                packet.interfaceId = 0;
+                return true;
+            }
+
+            default:
+                // name resolution, statistics, custom blocks etc.
+                break;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,97 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __PCAPFILEREADER_H
+#define __PCAPFILEREADER_H
+
+#include <vector>
+#include <string>
+#include <omnetpp.h>
+#include "INETDefs.h"
+
+
+/**
+ * Sequential reader for libpcap (.pcap, microsecond or nanosecond
+ * timestamps, either byte order) and pcapng files. It does not depend on
+ * libpcap: the file is memory-mapped where possible (read into memory
+ * otherwise), and packet data is returned as pointers into it, so
+ * reading a packet copies nothing.
+ *
+ * From pcapng files, Enhanced and Simple Packet Blocks are returned;
+ * the link type and timestamp resolution come from the Interface
+ * Description Block of the packet's interface.
+ */
+class INET_API PcapFileReader
+{
+  public:
+    struct Packet
+    {
+        const unsigned char *data;  // captured bytes, points into the file
+        uint32 capLength;           // number of captured bytes
+        uint32 origLength;          // length of the packet on the wire
+        int64 timestamp;            // nanoseconds since the epoch
+        int linkType;               // DLT_ / LINKTYPE_ value
+        int interfaceId;            // pcapng interface index, 0 for pcap
+    };
+
+  protected:
+    struct Interface
+    {
+        int linkType;
+        int resolution;             // if_tsresol option: 10^-n s, or 2^-n s if bit 7 is set
+    };
+
+    std::string filename;
+    const unsigned char *file;
+    size_t size;
+    size_t pos;
+    void *mappedData;
+    std::vector<unsigned char> buffer;  // file contents when not mapped
+
+    bool ng;                        // pcapng format
+    bool swapped;                   // byte order differs from this machine
+    bool nanoRes;                   // pcap: nanosecond timestamps
+    int pcapLinkType;               // pcap: link type of all packets
+    std::vector<Interface> interfaces;  // pcapng: interfaces of the current section
+    int64 lastTimestamp;            // pcapng SPBs carry no timestamp
+
+  protected:
+    uint16 get16(const unsigned char *p) const;
+    uint32 get32(const unsigned char *p) const;
+    void readSectionHeader();
+    void readInterfaceDescription(const unsigned char *body, uint32 bodyLength);
+    static int64 toNanoseconds(uint64 ts, int resolution);
+
+  public:
+    PcapFileReader();
+    ~PcapFileReader();
+
+    /** Opens the file and checks its header; throws an error on failure. */
+    void open(const char *filename);
+
+    /** Unmaps the file; returned Packet data becomes invalid. */
+    void close();
+
+    /** True if the file is in pcapng format */
+    bool isPcapNG() const {return ng;}
+
+    /**
+     * Returns the next packet, or false at the end of the file. Throws an
+     * error if the file is malformed or truncated.
+     */
+    bool next(Packet& packet);
+};
+
+#endif
@@ -0,0 +1,259 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "cPcapReplayScheduler.h"
+
+// link types, as defined at http://www.tcpdump.org/linktypes.html
+#define LINKTYPE_NULL       0
+#define LINKTYPE_ETHERNET   1
+#define LINKTYPE_RAW_OLD1   12
+#define LINKTYPE_RAW_OLD2   14
+#define LINKTYPE_RAW        101
+#define LINKTYPE_LOOP       108
+#define LINKTYPE_LINUX_SLL  113
+#define LINKTYPE_IPV4       228
+
+#define ETHERTYPE_IPV4      0x0800
+#define ETHERTYPE_VLAN      0x8100
+
+Register_GlobalConfigOption(CFGID_PCAPREPLAY_TIME_SCALE, "pcapreplay-time-scale", CFG_DOUBLE, "1", "cPcapReplayScheduler: factor applied to the recorded packet timestamps; 0 injects all packets at t=0");
+
+Register_Class(cPcapReplayScheduler);
+
+
+cPcapReplayScheduler::cPcapReplayScheduler() : cSocketRTScheduler()
+{
+    timeScale = 1;
+    firstTimestamp = 0;
+    firstTimestampValid = false;
+    numDiscarded = 0;
+}
+
+cPcapReplayScheduler::~cPcapReplayScheduler()
+{
+    for (unsigned int i=0; i<sources.size(); i++)
+        delete sources[i];
+}
+
+void cPcapReplayScheduler::startRun()
+{
+    // no raw socket and no capture devices: nothing of the base class is needed
+    timeScale = ev.getConfig()->getAsDouble(CFGID_PCAPREPLAY_TIME_SCALE);
+    if (timeScale < 0)
+        throw cRuntimeError("cPcapReplayScheduler: pcapreplay-time-scale must not be negative");
+    firstTimestampValid = false;
+    numDiscarded = 0;
+}
+
+void cPcapReplayScheduler::endRun()
+{
+    for (unsigned int i=0; i<sources.size(); i++)
+    {
+        Source *src = sources[i];
+        std::cout << src->module->getFullPath() << ": " << src->numInjected << " packets replayed, "
+                  << src->numSkipped << " packets skipped.\n";
+#ifdef HAVE_PCAP
+        for (std::map<int, bpf_program>::iterator it=src->programs.begin(); it!=src->programs.end(); ++it)
+            pcap_freecode(&it->second);
+#endif
+        delete src;
+    }
+    sources.clear();
+    if (numDiscarded > 0)
+        std::cout << "cPcapReplayScheduler: " << numDiscarded << " packets sent by the simulation were discarded.\n";
+}
+
+void cPcapReplayScheduler::setInterfaceModule(cModule *mod, const char *dev, const char *filter)
+{
+    if (!mod || !dev || !filter)
+        throw cRuntimeError("cPcapReplayScheduler::setInterfaceModule(): arguments must be non-NULL");
+#ifndef HAVE_PCAP
+    if (filter[0])
+        throw cRuntimeError("cPcapReplayScheduler::setInterfaceModule(): filterString \"%s\" cannot be applied without pcap support; set it to \"\"", filter);
+#endif
+
+    Source *src = new Source();
+    src->module = mod;
+    src->filter = filter;
+    src->numInjected = src->numSkipped = 0;
+    src->reader.open(dev);
+    sources.push_back(src);
+    readNext(src);
+
+    EV << "Replaying " << (src->reader.isPcapNG() ? "pcapng" : "pcap") << " file " << dev
+       << " to " << mod->getFullPath() << ".\n";
+}
+
+int cPcapReplayScheduler::getIPOffset(const PcapFileReader::Packet& packet)
+{
+    const unsigned char *p = packet.data;
+    uint32 len = packet.capLength;
+    uint32 off;
+    switch (packet.linkType)
+    {
+        case LINKTYPE_ETHERNET:
+        {
+            off = 12;
+            uint16 type = len >= off+2 ? (p[off]<<8) | p[off+1] : 0;
+            if (type == ETHERTYPE_VLAN)
+            {
+                off += 4;
+                type = len >= off+2 ? (p[off]<<8) | p[off+1] : 0;
+            }
+            if (type != ETHERTYPE_IPV4)
+                return -1;
+            off += 2;
+            break;
+        }
+        case LINKTYPE_RAW:
+        case LINKTYPE_RAW_OLD1:
+        case LINKTYPE_RAW_OLD2:
+        case LINKTYPE_IPV4:
+            off = 0;
+            break;
+        case LINKTYPE_NULL:
+        case LINKTYPE_LOOP:
+            // address family in host (NULL) or network (LOOP) byte order;
+            // AF_INET is 2 everywhere
+            if (len < 4 || !((p[0]==2 && p[3]==0) || (p[0]==0 && p[3]==2)))
+                return -1;
+            off = 4;
+            break;
+        case LINKTYPE_LINUX_SLL:
+            if (len < 16 || ((p[14]<<8) | p[15]) != ETHERTYPE_IPV4)
+                return -1;
+            off = 16;
+            break;
+        default:
+            return -1;
+    }
+    // IP version 4 with at least a minimal header
+    if (len < off+20 || (p[off]>>4) != 4)
+        return -1;
+    return off;
+}
+
+bool cPcapReplayScheduler::matchesFilter(Source *src, const PcapFileReader::Packet& packet)
+{
+#ifdef HAVE_PCAP
+    if (src->filter.empty())
+        return true;
+    std::map<int, bpf_program>::iterator it = src->programs.find(packet.linkType);
+    if (it == src->programs.end())
+    {
+        // compile the filter for this link type on first use
+        pcap_t *pd = pcap_open_dead(packet.linkType, 65535);
+        if (!pd)
+            throw cRuntimeError("cPcapReplayScheduler: pcap_open_dead() failed");
+        bpf_program prog;
+        if (pcap_compile(pd, &prog, (char *)src->filter.c_str(), 1, 0) < 0)
+        {
+            std::string err = pcap_geterr(pd);
+            pcap_close(pd);
+            throw cRuntimeError("cPcapReplayScheduler: Can not compile filter \"%s\" for link type %d: %s",
+                                src->filter.c_str(), packet.linkType, err.c_str());
+        }
+        pcap_close(pd);
+        it = src->programs.insert(std::make_pair(packet.linkType, prog)).first;
+    }
+    struct pcap_pkthdr hdr;
+    hdr.ts.tv_sec = packet.timestamp / 1000000000;
+    hdr.ts.tv_usec = (packet.timestamp % 1000000000) / 1000;
+    hdr.caplen = packet.capLength;
+    hdr.len = packet.origLength;
+    return pcap_offline_filter(&it->second, &hdr, packet.data) != 0;
+#else
+    return true;
+#endif
+}
+
+void cPcapReplayScheduler::readNext(Source *src)
+{
+    // skip packets which would not reach the interface anyway
+    while ((src->hasPacket = src->reader.next(src->packet)))
+    {
+        if (getIPOffset(src->packet) >= 0 && matchesFilter(src, src->packet))
+            return;
+        src->numSkipped++;
+    }
+}
+
+simtime_t cPcapReplayScheduler::getInjectionTime(const PcapFileReader::Packet& packet)
+{
+    // offsets are computed in integer nanoseconds, so absolute (epoch)
+    // timestamps lose no precision
+    simtime_t t = timeScale * ((packet.timestamp - firstTimestamp) * 1e-9);
+    // keep causality for files which are not in timestamp order
+    if (t < sim->getSimTime())
+        t = sim->getSimTime();
+    return t;
+}
+
+cPcapReplayScheduler::Source *cPcapReplayScheduler::getEarliestSource()
+{
+    Source *earliest = NULL;
+    for (unsigned int i=0; i<sources.size(); i++)
+        if (sources[i]->hasPacket && (!earliest || sources[i]->packet.timestamp < earliest->packet.timestamp))
+            earliest = sources[i];
+    return earliest;
+}
+
+void cPcapReplayScheduler::inject(Source *src)
+{
+    const PcapFileReader::Packet& packet = src->packet;
+    int off = getIPOffset(packet);
+    uint32 length = packet.capLength - off;
+
+    ExtFrame *notificationMsg = new ExtFrame("rtEvent");
+    notificationMsg->setDataArraySize(length);
+    for (uint32 j=0; j<length; j++)
+        notificationMsg->setData(j, packet.data[off + j]);
+    notificationMsg->setArrival(src->module, -1, getInjectionTime(packet));
+    sim->msgQueue.insert(notificationMsg);
+    src->numInjected++;
+
+    readNext(src);
+}
+
+cMessage *cPcapReplayScheduler::getNextEvent()
+{
+    if (!firstTimestampValid)
+    {
+        // all files have been opened during initialization
+        Source *first = getEarliestSource();
+        firstTimestamp = first ? first->packet.timestamp : 0;
+        firstTimestampValid = true;
+    }
+
+    while (true)
+    {
+        cMessage *msg = sim->msgQueue.peekFirst();
+        Source *src = getEarliestSource();
+        if (!src)
+        {
+            if (!msg)
+                throw cTerminationException(eENDEDOK);
+            return msg;
+        }
+        if (msg && msg->getArrivalTime() < getInjectionTime(src->packet))
+            return msg;
+        inject(src);
+    }
+}
+
+void cPcapReplayScheduler::sendBytes(unsigned char *buf, size_t numBytes, struct sockaddr *to, socklen_t addrlen)
+{
+    numDiscarded++;
+}
@@ -0,0 +1,112 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __CPCAPREPLAYSCHEDULER_H__
+#define __CPCAPREPLAYSCHEDULER_H__
+
+#include <map>
+#include "cSocketRTScheduler.h"
+#include "PcapFileReader.h"
+
+/**
+ * Replays pcap or pcapng files through ExtInterface instead of capturing
+ * live traffic. The "device" parameter of each ExtInterface names the
+ * file to replay; IPv4 packets (on Ethernet, raw IP, BSD loopback or
+ * Linux cooked links) are delivered to the interface in ExtFrames, like
+ * captured packets are, at simulation time
+ * pcapreplay-time-scale * (timestamp - first timestamp of all files).
+ * A time scale of 0 injects every packet at t=0, one after the other.
+ *
+ * This is an ordinary discrete-event scheduler: it never waits for the
+ * wall clock, so runs are reproducible and as fast as the model allows.
+ * Packets are read lazily, one per file ahead of the event queue.
+ * Packets the simulation sends to the wire are counted and discarded.
+ *
+ * If INET is built with pcap, the filterString of the ExtInterface is
+ * applied to the replayed packets; otherwise it must be empty.
+ */
+class cPcapReplayScheduler : public cSocketRTScheduler
+{
+    protected:
+        struct Source
+        {
+            cModule *module;
+            std::string filter;
+            PcapFileReader reader;
+            PcapFileReader::Packet packet;  // next packet to inject
+            bool hasPacket;
+#ifdef HAVE_PCAP
+            std::map<int, bpf_program> programs;  // filter compiled per link type
+#endif
+            unsigned long numInjected;
+            unsigned long numSkipped;   // filtered out or not IPv4
+        };
+
+        std::vector<Source *> sources;
+        double timeScale;
+        int64 firstTimestamp;
+        bool firstTimestampValid;
+        unsigned long numDiscarded;   // packets sent by the simulation
+
+        virtual void readNext(Source *src);
+        virtual bool matchesFilter(Source *src, const PcapFileReader::Packet& packet);
+        virtual void inject(Source *src);
+        virtual Source *getEarliestSource();
+        static int getIPOffset(const PcapFileReader::Packet& packet);
+        simtime_t getInjectionTime(const PcapFileReader::Packet& packet);
+
+    public:
+        /**
+         * Constructor.
+         */
+        cPcapReplayScheduler();
+
+        /**
+         * Destructor.
+         */
+        virtual ~cPcapReplayScheduler();
+
+        /**
+         * Called at the beginning of a simulation run.
+         */
+        virtual void startRun();
+
+        /**
+         * Called at the end of a simulation run.
+         */
+        virtual void endRun();
+
+        /**
+         * Nothing to do: replay does not depend on the wall clock.
+         */
+        virtual void executionResumed() {}
+
+        /**
+         * Opens the pcap/pcapng file named by dev for the given ExtInterface.
+         */
+        virtual void setInterfaceModule(cModule *mod, const char *dev, const char *filter);
+
+        /**
+         * Returns the next event, injecting file packets that are due before it.
+         */
+        virtual cMessage *getNextEvent();
+
+        /**
+         * Discards the packet (there is no wire to send it to).
+         */
+        virtual void sendBytes(unsigned char *buf, size_t numBytes, struct sockaddr *from, socklen_t addrlen);
+};
+
+#endif
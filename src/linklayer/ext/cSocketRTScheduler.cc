@@ -33,8 +33,18 @@
 #include <ws2tcpip.h>
 #endif
 
+#ifdef LINUX
+#include <errno.h>
+#include <sys/epoll.h>
+#endif
+
 #define PCAP_SNAPLEN 65536 /* capture all data packets with up to pcap_snaplen bytes */
-#define PCAP_TIMEOUT 10    /* Timeout in ms */
+#define PCAP_TIMEOUT 10    /* Timeout in ms; upper bound of a single wait, so ev.idle() gets called */
+#define PCAP_READ_TIMEOUT 1 /* Timeout in ms after which the kernel hands over a partially filled buffer */
+#define MAX_EPOLL_EVENTS 16
+
+Register_GlobalConfigOption(CFGID_SOCKETRT_BATCH_SIZE, "socketrt-batch-size", CFG_INT, "64", "cSocketRTScheduler: maximum number of packets taken from a capture device at once; -1 means drain everything that is buffered");
+Register_GlobalConfigOption(CFGID_SOCKETRT_BUFFER_SIZE, "socketrt-buffer-size", CFG_INT, "4194304", "cSocketRTScheduler: size of the kernel capture buffer (memory-mapped ring on Linux) per device in bytes; 0 means the pcap default");
 
 #ifdef HAVE_PCAP
 std::vector<cModule *>cSocketRTScheduler::modules;
@@ -55,6 +65,12 @@ inline std::ostream& operator<<(std::ostream& out, const timeval& tv)
 cSocketRTScheduler::cSocketRTScheduler() : cScheduler()
 {
     fd = INVALID_SOCKET;
+#ifdef LINUX
+    epollFd = -1;
+#endif
+    batchSize = 1;
+    bufferSize = 0;
+    numCaptured = numDispatches = 0;
 }
 
 cSocketRTScheduler::~cSocketRTScheduler()
@@ -68,6 +84,16 @@ void cSocketRTScheduler::startRun()
 
 #endif
     gettimeofday(&baseTime, NULL);
+    runStartTime = baseTime;
+    numCaptured = numDispatches = 0;
+
+    batchSize = ev.getConfig()->getAsInt(CFGID_SOCKETRT_BATCH_SIZE);
+    if (batchSize == 0 || batchSize < -1)
+        throw cRuntimeError("cSocketRTScheduler: socketrt-batch-size must be positive or -1");
+    bufferSize = ev.getConfig()->getAsInt(CFGID_SOCKETRT_BUFFER_SIZE);
+    if (bufferSize < 0)
+        throw cRuntimeError("cSocketRTScheduler: socketrt-buffer-size must not be negative");
+
 #ifdef HAVE_PCAP
     // Enabling sending makes no sense when we can't receive...
     fd = socket(AF_INET, SOCK_RAW, IPPROTO_RAW);
@@ -75,6 +101,10 @@ void cSocketRTScheduler::startRun()
         throw cRuntimeError("cSocketRTScheduler: Root priviledges needed");
     if (setsockopt(fd, IPPROTO_IP, IP_HDRINCL, (char *)&on, sizeof(on)) < 0)
         throw cRuntimeError("cSocketRTScheduler: couldn't set sockopt for raw socket");
+#ifdef LINUX
+    if ((epollFd = epoll_create(MAX_EPOLL_EVENTS)) < 0)
+        throw cRuntimeError("cSocketRTScheduler: epoll_create() failed: %s", strerror(errno));
+#endif
 #endif
 }
 
@@ -87,6 +117,11 @@ void cSocketRTScheduler::endRun()
 #endif
     close(fd);
     fd = INVALID_SOCKET;
+#ifdef LINUX
+    if (epollFd >= 0)
+        close(epollFd);
+    epollFd = -1;
+#endif
 #ifdef HAVE_PCAP
 
     for (uint16 i=0; i<pds.size(); i++)
@@ -98,9 +133,19 @@ void cSocketRTScheduler::endRun()
         pcap_close(pds.at(i));
     }
 
+    if (!pds.empty())
+    {
+        timeval curTime;
+        gettimeofday(&curTime, NULL);
+        timeval elapsed = timeval_substract(curTime, runStartTime);
+        double secs = elapsed.tv_sec + elapsed.tv_usec * 1e-6;
+        std::cout << "cSocketRTScheduler: " << numCaptured << " packets captured in "
+                  << numDispatches << " batches (" << (numDispatches ? (double)numCaptured / numDispatches : 0.0)
+                  << " packets/batch), " << (secs > 0 ? numCaptured / secs : 0.0) << " packets/s.\n";
+    }
+
     pds.clear();
     modules.clear();
-    pds.clear();
     datalinks.clear();
     headerLengths.clear();
 #endif
@@ -126,10 +171,26 @@ void cSocketRTScheduler::setInterfaceModule(cModule *mod, const char *dev, const
 
     /* get pcap handle */
     memset(&errbuf, 0, sizeof(errbuf));
-    if ((pd = pcap_open_live(dev, PCAP_SNAPLEN, 0, PCAP_TIMEOUT, errbuf)) == NULL)
+#ifdef PCAP_ERROR
+    // libpcap >= 1.0: pcap_create() allows setting the buffer size before
+    // activation; on Linux this selects the size of the TPACKET_V3 ring
+    if ((pd = pcap_create(dev, errbuf)) == NULL)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Can not open pcap device, error = %s", errbuf);
+    if (pcap_set_snaplen(pd, PCAP_SNAPLEN) != 0 || pcap_set_promisc(pd, 0) != 0 || pcap_set_timeout(pd, PCAP_READ_TIMEOUT) != 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Can not configure pcap device %s", dev);
+    if (bufferSize > 0 && pcap_set_buffer_size(pd, bufferSize) != 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Can not set pcap buffer size of device %s", dev);
+    int32 status = pcap_activate(pd);
+    if (status < 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Can not activate pcap device %s, error = %s", dev, pcap_geterr(pd));
+    else if (status > 0)
+        EV << "cSocketRTScheduler::setInterfaceModule: pcap_activate returned warning: " << pcap_geterr(pd) << "\n";
+#else
+    if ((pd = pcap_open_live(dev, PCAP_SNAPLEN, 0, PCAP_READ_TIMEOUT, errbuf)) == NULL)
         throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Can not open pcap device, error = %s", errbuf);
     else if(strlen(errbuf) > 0)
         EV << "cSocketRTScheduler::setInterfaceModule: pcap_open_live returned waring: " << errbuf << "\n";
+#endif
 
     /* compile this command into a filter program */
     if (pcap_compile(pd, &fcode, (char *)filter, 0, 0) < 0)
@@ -138,14 +199,14 @@ void cSocketRTScheduler::setInterfaceModule(cModule *mod, const char *dev, const
     /* apply the compiled filter to the packet capture device */
     if (pcap_setfilter(pd, &fcode) < 0)
         throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Can not apply compiled filter: %s", pcap_geterr(pd));
+    pcap_freecode(&fcode);
 
     if ((datalink = pcap_datalink(pd)) < 0)
         throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Can not get datalink: %s", pcap_geterr(pd));
 
-#ifndef LINUX
+    // non-blocking on all platforms: a device is drained until pcap_dispatch() returns 0
     if (pcap_setnonblock(pd, 1, errbuf) < 0)
         throw cRuntimeError("cSocketRTScheduler::pcap_setnonblock(): Can not put pcap device into non-blocking mode, error = %s", errbuf);
-#endif
 
     switch (datalink) {
     case DLT_NULL:
@@ -163,6 +224,19 @@ void cSocketRTScheduler::setInterfaceModule(cModule *mod, const char *dev, const
     default:
         throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): Unsupported datalink: %d", datalink);
     }
+
+#ifdef LINUX
+    int32 selectableFd = pcap_get_selectable_fd(pd);
+    if (selectableFd < 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): pcap device %s has no selectable descriptor", dev);
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = pds.size();
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, selectableFd, &event) < 0)
+        throw cRuntimeError("cSocketRTScheduler::setInterfaceModule(): epoll_ctl() failed: %s", strerror(errno));
+#endif
+
     modules.push_back(mod);
     pds.push_back(pd);
     datalinks.push_back(datalink);
@@ -204,78 +278,96 @@ static void packet_handler(u_char *user, const struct pcap_pkthdr *hdr, const u_
 
     // signalize new incoming packet to the interface via cMessage
     EV << "Captured " << hdr->caplen - headerLength << " bytes for an IP packet.\n";
-    timeval curTime;
-    gettimeofday(&curTime, NULL);
-    curTime = timeval_substract(curTime, cSocketRTScheduler::baseTime);
-    simtime_t t = curTime.tv_sec + curTime.tv_usec*1e-6;
-    // TBD assert that it's somehow not smaller than previous event's time
+
+    // use the kernel's capture timestamp: packets of a batch keep their
+    // spacing, and no gettimeofday() call is needed per packet. Packets
+    // which were buffered while the simulation was busy are delivered now.
+    timeval capTime = timeval_substract(hdr->ts, cSocketRTScheduler::baseTime);
+    simtime_t t = capTime.tv_sec + capTime.tv_usec*1e-6;
+    if (t < simulation.getSimTime())
+        t = simulation.getSimTime();
     notificationMsg->setArrival(module, -1, t);
 
     simulation.msgQueue.insert(notificationMsg);
 }
 #endif
 
-bool cSocketRTScheduler::receiveWithTimeout()
+bool cSocketRTScheduler::dispatchDevice(uint16 i)
 {
-    bool found;
-    struct timeval timeout;
 #ifdef HAVE_PCAP
-    int32 n;
-#ifdef LINUX
-    int32 fd[FD_SETSIZE], maxfd;
-    fd_set rdfds;
-#endif
+    bool found = false;
+    int32 budget = batchSize;
+    while (true)
+    {
+        int32 n = pcap_dispatch(pds.at(i), budget, packet_handler, (uint8 *)&i);
+        if (n < 0)
+            throw cRuntimeError("cSocketRTScheduler::pcap_dispatch(): An error occired: %s", pcap_geterr(pds.at(i)));
+        if (n == 0)
+            break;
+        found = true;
+        numCaptured += n;
+        numDispatches++;
+        // batchSize == -1: keep going until the buffer is empty
+        if (batchSize > 0 && (budget -= n) <= 0)
+            break;
+    }
+    return found;
+#else
+    return false;
 #endif
+}
+
+bool cSocketRTScheduler::receiveWithTimeout(long usec)
+{
+    bool found;
+    struct timeval timeout;
 
     found = false;
     timeout.tv_sec  = 0;
-    timeout.tv_usec = PCAP_TIMEOUT * 1000;
+    timeout.tv_usec = usec;
 #ifdef HAVE_PCAP
 #ifdef LINUX
-    FD_ZERO(&rdfds);
-    maxfd = -1;
-    for (uint16 i = 0; i < pds.size(); i++)
-    {
-        fd[i] = pcap_get_selectable_fd(pds.at(i));
-        if (fd[i] > maxfd)
-            maxfd = fd[i];
-        FD_SET(fd[i], &rdfds);
-    }
-    if (select(maxfd + 1, &rdfds, NULL, NULL, &timeout) < 0)
+    if (!pds.empty())
     {
+        // round up, so we never wake up before the target time
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        int32 n = epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, (usec + 999) / 1000);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                return found;
+            throw cRuntimeError("cSocketRTScheduler: epoll_wait() failed: %s", strerror(errno));
+        }
+        for (int32 k = 0; k < n; k++)
+            if (dispatchDevice(events[k].data.u32))
+                found = true;
         return found;
     }
-#endif
+#else
     for (uint16 i = 0; i < pds.size(); i++)
-    {
-#ifdef LINUX
-        if (!(FD_ISSET(fd[i], &rdfds)))
-            continue;
-#endif
-        if ((n = pcap_dispatch(pds.at(i), 1, packet_handler, (uint8 *)&i)) < 0)
-            throw cRuntimeError("cSocketRTScheduler::pcap_dispatch(): An error occired: %s", pcap_geterr(pds.at(i)));
-        if (n > 0)
+        if (dispatchDevice(i))
             found = true;
-    }
-#ifndef LINUX
-    if (!found)
-        select(0, NULL, NULL, NULL, &timeout);
+    if (found)
+        return found;
 #endif
-#else
-    select(0, NULL, NULL, NULL, &timeout);
 #endif
+    select(0, NULL, NULL, NULL, &timeout);
     return found;
 }
 
 int32 cSocketRTScheduler::receiveUntil(const timeval& targetTime)
 {
-    // wait until targetTime or a bit longer, wait in PCAP_TIMEOUT chunks
+    // wait until targetTime, but at most PCAP_TIMEOUT at a time
     // in order to keep UI responsiveness by invoking ev.idle()
     timeval curTime;
     gettimeofday(&curTime, NULL);
     while (timeval_greater(targetTime, curTime))
     {
-        if (receiveWithTimeout())
+        timeval remaining = timeval_substract(targetTime, curTime);
+        long usec = PCAP_TIMEOUT * 1000;
+        if (remaining.tv_sec == 0 && remaining.tv_usec < usec)
+            usec = remaining.tv_usec;
+        if (receiveWithTimeout(usec))
             return 1;
         if (ev.idle())
             return -1;
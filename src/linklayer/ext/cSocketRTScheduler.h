@@ -37,13 +37,34 @@
 #endif
 #include "ExtFrame_m.h"
 
+/**
+ * Real-time scheduler that injects packets captured with pcap into the
+ * simulation (see ExtInterface). On Linux the capture descriptors are
+ * registered in an epoll set once, and every readable device is drained
+ * in batches of up to "socketrt-batch-size" packets per pcap_dispatch()
+ * call; elsewhere the devices are polled between short sleeps. When
+ * libpcap supports pcap_create() the devices are opened with a
+ * "socketrt-buffer-size" kernel buffer, which lets libpcap >= 1.5 use
+ * a TPACKET_V3 memory-mapped ring on Linux.
+ */
 class cSocketRTScheduler : public cScheduler
 {
     protected:
         int fd;
+#ifdef LINUX
+        int epollFd;
+#endif
+        int batchSize;      // max packets per pcap_dispatch(); -1: whole buffer
+        int bufferSize;     // kernel capture buffer in bytes, 0: pcap default
+
+        // statistics
+        unsigned long numCaptured;
+        unsigned long numDispatches;
+        timeval runStartTime;
 
-        virtual bool receiveWithTimeout();
+        virtual bool receiveWithTimeout(long usec);
         virtual int receiveUntil(const timeval& targetTime);
+        virtual bool dispatchDevice(uint16 i);
     public:
         /**
          * Constructor.
@@ -82,7 +103,7 @@ class cSocketRTScheduler : public cScheduler
          * socket. The method must be called from the module's initialize()
          * function.
          */
-        void setInterfaceModule(cModule *mod, const char *dev, const char *filter);
+        virtual void setInterfaceModule(cModule *mod, const char *dev, const char *filter);
 
         /**
          * Scheduler function -- it comes from cScheduler interface.
@@ -92,7 +113,7 @@ class cSocketRTScheduler : public cScheduler
         /**
          * Send on the currently open connection
          */
-        void sendBytes(unsigned char *buf, size_t numBytes, struct sockaddr *from, socklen_t addrlen);
+        virtual void sendBytes(unsigned char *buf, size_t numBytes, struct sockaddr *from, socklen_t addrlen);
 };
 
 #endif
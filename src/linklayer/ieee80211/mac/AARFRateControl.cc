@@ -0,0 +1,37 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include "AARFRateControl.h"
+
+Register_Class(AARFRateControl);
+
+
+void AARFRateControl::initializeFrom(cModule *macModule)
+{
+    ARFRateControl::initializeFrom(macModule);
+    maxSuccessThreshold = macModule->par("aarfMaxSuccessThreshold");
+    if (maxSuccessThreshold < successThreshold)
+        throw cRuntimeError("AARFRateControl: aarfMaxSuccessThreshold must not be less than arfSuccessThreshold");
+}
+
+void AARFRateControl::decreaseRate(StationInfo& station, bool probeFailed)
+{
+    if (probeFailed)
+        station.successThreshold = std::min(2 * station.successThreshold, maxSuccessThreshold);
+    else
+        station.successThreshold = successThreshold;
+    ARFRateControl::decreaseRate(station, probeFailed);
+}
@@ -0,0 +1,45 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IEEE80211_AARFRATECONTROL_H
+#define IEEE80211_AARFRATECONTROL_H
+
+#include "ARFRateControl.h"
+
+
+/**
+ * Adaptive ARF (Lacage, Manshaei and Turletti, 2004): like ARF, but each
+ * failed probe of a higher bitrate doubles the number of successes needed
+ * before the next probe (up to maxSuccessThreshold), so a stable channel
+ * is not disturbed by probing every successThreshold frames. A regular
+ * rate decrease resets it.
+ */
+class INET_API AARFRateControl : public ARFRateControl
+{
+  protected:
+    int maxSuccessThreshold;
+
+  public:
+    /**
+     * Parameters read from the MAC module: those of ARFRateControl, plus
+     * aarfMaxSuccessThreshold.
+     */
+    virtual void initializeFrom(cModule *macModule);
+
+  protected:
+    virtual void decreaseRate(StationInfo& station, bool probeFailed);
+};
+
+#endif
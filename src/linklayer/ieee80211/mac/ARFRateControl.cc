@@ -0,0 +1,95 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "ARFRateControl.h"
+
+Register_Class(ARFRateControl);
+
+
+void ARFRateControl::initializeFrom(cModule *macModule)
+{
+    RateControlBase::initializeFrom(macModule);
+    successThreshold = macModule->par("arfSuccessThreshold");
+    failureThreshold = macModule->par("arfFailureThreshold");
+    timerThreshold = macModule->par("arfTimerThreshold");
+    if (successThreshold < 1 || failureThreshold < 1 || timerThreshold < 1)
+        throw cRuntimeError("ARFRateControl: arfSuccessThreshold, arfFailureThreshold and arfTimerThreshold must be at least 1");
+}
+
+ARFRateControl::StationInfo& ARFRateControl::getStationInfo(const MACAddress& receiver)
+{
+    StationTable::iterator it = stations.find(receiver);
+    if (it != stations.end())
+        return it->second;
+
+    StationInfo& station = stations[receiver];
+    station.rateIndex = getMaxRateIndex();
+    station.successThreshold = successThreshold;
+    resetCounters(station);
+    return station;
+}
+
+double ARFRateControl::getBitrate(const MACAddress& receiver, int retryCount)
+{
+    return bitrates[getStationInfo(receiver).rateIndex];
+}
+
+void ARFRateControl::reportAttempt(const MACAddress& receiver, double bitrate, int numFrames, int numAcked)
+{
+    StationInfo& station = getStationInfo(receiver);
+    station.attemptCount++;
+    if (numAcked > 0)
+    {
+        station.successCount++;
+        station.failureCount = 0;
+        station.isProbing = false;
+        if (station.successCount >= station.successThreshold || station.attemptCount >= timerThreshold)
+            increaseRate(station);
+    }
+    else
+    {
+        station.successCount = 0;
+        station.failureCount++;
+        if (station.isProbing)
+            decreaseRate(station, true);
+        else if (station.failureCount >= failureThreshold)
+            decreaseRate(station, false);
+    }
+}
+
+void ARFRateControl::increaseRate(StationInfo& station)
+{
+    resetCounters(station);
+    if (station.rateIndex < getMaxRateIndex())
+    {
+        station.rateIndex++;
+        station.isProbing = true;
+    }
+}
+
+void ARFRateControl::decreaseRate(StationInfo& station, bool probeFailed)
+{
+    resetCounters(station);
+    if (station.rateIndex > 0)
+        station.rateIndex--;
+}
+
+void ARFRateControl::resetCounters(StationInfo& station)
+{
+    station.successCount = 0;
+    station.failureCount = 0;
+    station.attemptCount = 0;
+    station.isProbing = false;
+}
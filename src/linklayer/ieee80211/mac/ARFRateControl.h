@@ -0,0 +1,72 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IEEE80211_ARFRATECONTROL_H
+#define IEEE80211_ARFRATECONTROL_H
+
+#include <map>
+#include "RateControlBase.h"
+
+
+/**
+ * Auto Rate Fallback (Kamerman and Monteban, 1997). The bitrate to a
+ * receiver is raised after successThreshold consecutive acknowledged
+ * attempts, or after timerThreshold attempts at the same bitrate (the
+ * "timer"); it is lowered after failureThreshold consecutive failures,
+ * or at once if the first attempt at a raised bitrate fails.
+ * Transmission starts at the highest bitrate.
+ */
+class INET_API ARFRateControl : public RateControlBase
+{
+  protected:
+    struct StationInfo {
+        int rateIndex;
+        int successCount;      // consecutive acknowledged attempts
+        int failureCount;      // consecutive failed attempts
+        int attemptCount;      // attempts since the last rate change
+        bool isProbing;        // no attempt since the rate was raised
+        int successThreshold;  // successes needed to raise the rate
+    };
+    typedef std::map<MACAddress, StationInfo, MAC_compare> StationTable;
+    StationTable stations;
+
+    int successThreshold;
+    int failureThreshold;
+    int timerThreshold;
+
+  public:
+    /**
+     * Parameters read from the MAC module: those of RateControlBase, plus
+     * arfSuccessThreshold, arfFailureThreshold and arfTimerThreshold.
+     */
+    virtual void initializeFrom(cModule *macModule);
+
+    virtual double getBitrate(const MACAddress& receiver, int retryCount);
+
+    virtual void reportAttempt(const MACAddress& receiver, double bitrate, int numFrames, int numAcked);
+
+  protected:
+    /** Returns the state kept for the receiver, creating it if needed */
+    virtual StationInfo& getStationInfo(const MACAddress& receiver);
+
+    virtual void increaseRate(StationInfo& station);
+
+    /** probeFailed: the first attempt after increasing the rate failed */
+    virtual void decreaseRate(StationInfo& station, bool probeFailed);
+
+    virtual void resetCounters(StationInfo& station);
+};
+
+#endif
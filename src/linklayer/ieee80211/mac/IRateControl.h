@@ -0,0 +1,62 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IEEE80211_IRATECONTROL_H
+#define IEEE80211_IRATECONTROL_H
+
+#include "INETDefs.h"
+#include "MACAddress.h"
+
+
+/**
+ * Bitrate adaptation for Ieee80211Mac. The MAC asks for the bitrate of
+ * each unicast transmission attempt, and reports whether it was
+ * acknowledged; implementations keep their state per receiver.
+ * The class is chosen with the rateControl parameter of the MAC.
+ */
+class INET_API IRateControl : public cPolymorphic
+{
+  public:
+    /**
+     * Allows parameters to be read from the module parameters of the MAC.
+     */
+    virtual void initializeFrom(cModule *macModule) = 0;
+
+    /**
+     * Returns the bitrate for the next transmission attempt to the receiver.
+     * retryCount is the number of failed attempts of the current frame.
+     */
+    virtual double getBitrate(const MACAddress& receiver, int retryCount) = 0;
+
+    /**
+     * Reports the outcome of a transmission attempt at the given bitrate:
+     * numAcked of the numFrames frames sent (more than one for an A-MPDU)
+     * have been acknowledged.
+     */
+    virtual void reportAttempt(const MACAddress& receiver, double bitrate, int numFrames, int numAcked) = 0;
+
+    /**
+     * Reports the SNIR (as a fraction) of a frame received from the
+     * station. The default implementation ignores it.
+     */
+    virtual void reportSnir(const MACAddress& station, double snir) {}
+
+    /**
+     * Virtual destructor.
+     */
+    virtual ~IRateControl() {}
+};
+
+#endif
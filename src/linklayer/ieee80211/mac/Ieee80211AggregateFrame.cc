@@ -0,0 +1,88 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Ieee80211AggregateFrame.h"
+
+Register_Class(Ieee80211AggregateFrame);
+
+// byteLength of Ieee80211DataFrame, i.e. the MAC header
+static const int64 DATA_FRAME_HEADER_LENGTH = 34;
+
+
+Ieee80211AggregateFrame& Ieee80211AggregateFrame::operator=(const Ieee80211AggregateFrame& other)
+{
+    if (this == &other)
+        return *this;
+
+    for (unsigned int i = 0; i < subframes.size(); i++)
+        dropAndDelete(subframes[i]);
+    subframes.clear();
+
+    Ieee80211AggregateFrame_Base::operator=(other);
+
+    for (unsigned int i = 0; i < other.subframes.size(); i++)
+    {
+        Ieee80211DataFrame *frame = other.subframes[i]->dup();
+        take(frame);
+        subframes.push_back(frame);
+    }
+    subframeBitErrors = other.subframeBitErrors;
+
+    return *this;
+}
+
+Ieee80211AggregateFrame::~Ieee80211AggregateFrame()
+{
+    for (unsigned int i = 0; i < subframes.size(); i++)
+        dropAndDelete(subframes[i]);
+}
+
+void Ieee80211AggregateFrame::setAmpdu(bool ampdu)
+{
+    Ieee80211AggregateFrame_Base::setAmpdu(ampdu);
+    updateByteLength();
+}
+
+void Ieee80211AggregateFrame::addSubframe(Ieee80211DataFrame *frame)
+{
+    take(frame);
+    subframes.push_back(frame);
+    subframeBitErrors.push_back(false);
+    updateByteLength();
+}
+
+Ieee80211DataFrame *Ieee80211AggregateFrame::removeSubframe(unsigned int i)
+{
+    Ieee80211DataFrame *frame = subframes.at(i);
+    subframes.erase(subframes.begin() + i);
+    subframeBitErrors.erase(subframeBitErrors.begin() + i);
+    drop(frame);
+    updateByteLength();
+    return frame;
+}
+
+void Ieee80211AggregateFrame::updateByteLength()
+{
+    // subframes are padded to a multiple of 4 bytes
+    int64 length = getAmpdu() ? 0 : DATA_FRAME_HEADER_LENGTH;
+    for (unsigned int i = 0; i < subframes.size(); i++)
+    {
+        int64 subframeLength = getAmpdu() ?
+            AMPDU_DELIMITER_LENGTH + subframes[i]->getByteLength() :
+            AMSDU_SUBFRAME_HEADER_LENGTH + subframes[i]->getByteLength() - DATA_FRAME_HEADER_LENGTH;
+        length += (subframeLength + 3) & ~(int64)3;
+    }
+    setByteLength(length);
+}
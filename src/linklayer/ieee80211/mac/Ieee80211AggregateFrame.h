@@ -0,0 +1,69 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IEEE80211_AGGREGATEFRAME_H
+#define IEEE80211_AGGREGATEFRAME_H
+
+#include <vector>
+#include "Ieee80211Frame_m.h"
+
+/** Length of the MPDU delimiter preceding each subframe of an A-MPDU */
+#define AMPDU_DELIMITER_LENGTH          4
+
+/** Length of the subframe header preceding each MSDU of an A-MSDU */
+#define AMSDU_SUBFRAME_HEADER_LENGTH    14
+
+/**
+ * A-MSDU or A-MPDU (see the msg file). The subframes are complete data
+ * frames owned by the aggregate; for an A-MSDU only their payload counts
+ * in the length. Each subframe carries a bit error flag, which the radio
+ * sets for the A-MPDU subframes it did not receive correctly.
+ */
+class INET_API Ieee80211AggregateFrame : public Ieee80211AggregateFrame_Base
+{
+  protected:
+    std::vector<Ieee80211DataFrame*> subframes;
+    std::vector<bool> subframeBitErrors;
+
+    void updateByteLength();
+
+  public:
+    Ieee80211AggregateFrame(const char *name=NULL, int kind=0) : Ieee80211AggregateFrame_Base(name,kind) {}
+    Ieee80211AggregateFrame(const Ieee80211AggregateFrame& other) : Ieee80211AggregateFrame_Base(other.getName()) {operator=(other);}
+    virtual ~Ieee80211AggregateFrame();
+    Ieee80211AggregateFrame& operator=(const Ieee80211AggregateFrame& other);
+    virtual Ieee80211AggregateFrame *dup() const {return new Ieee80211AggregateFrame(*this);}
+
+    /** Redefined to recompute the length, which depends on the aggregation type */
+    virtual void setAmpdu(bool ampdu);
+
+    /** Returns the number of subframes */
+    virtual unsigned int getNumSubframes() const {return subframes.size();}
+
+    /** Returns the ith subframe; the aggregate keeps the ownership */
+    virtual Ieee80211DataFrame *getSubframe(unsigned int i) const {return subframes.at(i);}
+
+    /** Appends a subframe and takes ownership of it */
+    virtual void addSubframe(Ieee80211DataFrame *frame);
+
+    /** Removes and returns the ith subframe. Ownership passes to the caller. */
+    virtual Ieee80211DataFrame *removeSubframe(unsigned int i);
+
+    /** Bit error flag of the ith subframe */
+    virtual bool getSubframeBitError(unsigned int i) const {return subframeBitErrors.at(i);}
+    virtual void setSubframeBitError(unsigned int i, bool bitError) {subframeBitErrors.at(i) = bitError;}
+};
+
+#endif
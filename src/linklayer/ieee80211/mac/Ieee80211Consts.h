@@ -29,6 +29,7 @@
 const unsigned int LENGTH_RTS = 160;
 const unsigned int LENGTH_CTS = 112;
 const unsigned int LENGTH_ACK = 112;
+const unsigned int LENGTH_BLOCKACK = 256;
 
 // time slot ST, short interframe space SIFS, distributed interframe
 // space DIFS, and extended interframe space EIFS
@@ -46,6 +47,15 @@ const int CW_MIN = 31;
 /** Maximum size of contention window */
 const int CW_MAX = 1023;
 
+/** EDCA access categories (802.11e), as queue indices in decreasing priority */
+enum AccessCategory {
+    AC_VO = 0,  // voice
+    AC_VI = 1,  // video
+    AC_BE = 2,  // best effort
+    AC_BK = 3,  // background
+};
+const int NUM_ACCESS_CATEGORIES = 4;
+
 const int PHY_HEADER_LENGTH = 192;
 const int HEADER_WITHOUT_PREAMBLE = 48;
 const double BITRATE_HEADER = 1E+6;
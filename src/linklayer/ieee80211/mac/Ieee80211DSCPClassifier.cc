@@ -0,0 +1,43 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Ieee80211DSCPClassifier.h"
+#include "Ieee80211Consts.h"
+
+Register_Class(Ieee80211DSCPClassifier);
+
+Ieee80211DSCPClassifier::Ieee80211DSCPClassifier()
+{
+    for (int dscp=0; dscp<64; dscp++)
+        dscpToQueue[dscp] = AC_BE;
+
+    dscpToQueue[1<<3] = AC_BK;  // CS1
+    for (int afClass=3; afClass<=4; afClass++)
+    {
+        dscpToQueue[afClass<<3] = AC_VI;
+        for (int dropPrec=1; dropPrec<=3; dropPrec++)
+            dscpToQueue[(afClass<<3) | (dropPrec<<1)] = AC_VI;
+    }
+    dscpToQueue[5<<3] = AC_VI;  // CS5
+    dscpToQueue[44] = AC_VO;    // VOICE-ADMIT
+    dscpToQueue[46] = AC_VO;    // EF
+    dscpToQueue[6<<3] = AC_VO;
+    dscpToQueue[7<<3] = AC_VO;
+}
+
+int Ieee80211DSCPClassifier::getNumQueues()
+{
+    return NUM_ACCESS_CATEGORIES;
+}
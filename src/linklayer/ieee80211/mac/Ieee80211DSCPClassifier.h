@@ -0,0 +1,43 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IEEE80211DSCPCLASSIFIER_H
+#define __INET_IEEE80211DSCPCLASSIFIER_H
+
+#include "DSCPClassifier.h"
+
+/**
+ * Maps DiffServ code points to the EDCA access categories of Ieee80211Mac,
+ * following RFC 8325 (the queue indices are those in Ieee80211Consts.h):
+ *
+ *  - AC_VO: EF, VOICE-ADMIT, CS6, CS7
+ *  - AC_VI: AF3x, AF4x, CS3, CS4, CS5
+ *  - AC_BE: default PHB, AF1x, AF2x, CS2 and all other code points
+ *  - AC_BK: CS1
+ *
+ * Packets other than IPv4/IPv6 datagrams are sent as best effort.
+ */
+class INET_API Ieee80211DSCPClassifier : public DSCPClassifier
+{
+  public:
+    Ieee80211DSCPClassifier();
+
+    /**
+     * Returns the number of access categories.
+     */
+    virtual int getNumQueues();
+};
+
+#endif
@@ -55,6 +55,8 @@ Ieee80211Mac::Ieee80211Mac()
     endReserve = NULL;
     mediumStateChange = NULL;
     pendingRadioConfigMsg = NULL;
+    rateControl = NULL;
+    classifier = NULL;
 }
 
 Ieee80211Mac::~Ieee80211Mac()
@@ -68,6 +70,9 @@ Ieee80211Mac::~Ieee80211Mac()
 
     if (pendingRadioConfigMsg)
         delete pendingRadioConfigMsg;
+
+    delete rateControl;
+    delete classifier;
 }
 
 /****************************************************************
@@ -101,6 +106,58 @@ void Ieee80211Mac::initialize(int stage)
         if (cwMinBroadcast == -1) cwMinBroadcast = 31;
         ASSERT(cwMinBroadcast >= 0);
 
+        const char *aggregationString = par("aggregation");
+        if (!strcmp(aggregationString, "none"))
+            aggregation = NO_AGGREGATION;
+        else if (!strcmp(aggregationString, "amsdu"))
+            aggregation = AMSDU;
+        else if (!strcmp(aggregationString, "ampdu"))
+            aggregation = AMPDU;
+        else
+            error("invalid aggregation \"%s\", must be \"none\", \"amsdu\" or \"ampdu\"", aggregationString);
+        maxAggregateSize = par("maxAggregateSize");
+        maxAggregateCount = par("maxAggregateCount");
+        if (aggregation == AMPDU && maxAggregateCount > 64)
+            error("maxAggregateCount cannot be larger than the Block Ack window (64)");
+
+        const char *rateControlClass = par("rateControl");
+        if (rateControlClass[0])
+        {
+            rateControl = check_and_cast<IRateControl *>(createOne(rateControlClass));
+            rateControl->initializeFrom(this);
+        }
+
+        edca = par("edca");
+        if (edca)
+        {
+            const char *classifierClass = par("classifierClass");
+            classifier = check_and_cast<IQoSClassifier *>(createOne(classifierClass));
+            if (classifier->getNumQueues() != NUM_ACCESS_CATEGORIES)
+                error("classifier %s must map frames to %d access categories", classifierClass, NUM_ACCESS_CATEGORIES);
+
+            // parameter name suffixes in the order of the queue indices
+            static const char *acNames[NUM_ACCESS_CATEGORIES] = {"VO", "VI", "BE", "BK"};
+            edcafs.resize(NUM_ACCESS_CATEGORIES);
+            for (int ac = 0; ac < NUM_ACCESS_CATEGORIES; ac++)
+            {
+                edcafs[ac].aifsn = par((std::string("aifsn") + acNames[ac]).c_str());
+                edcafs[ac].cwMin = par((std::string("cwMin") + acNames[ac]).c_str());
+                edcafs[ac].cwMax = par((std::string("cwMax") + acNames[ac]).c_str());
+                edcafs[ac].txopLimit = par((std::string("txopLimit") + acNames[ac]).c_str());
+                if (edcafs[ac].aifsn < 2 || edcafs[ac].cwMin < 0 || edcafs[ac].cwMax < edcafs[ac].cwMin)
+                    error("invalid EDCA parameters for AC_%s", acNames[ac]);
+            }
+        }
+        else
+        {
+            // DCF: DIFS is an AIFS with AIFSN 2
+            edcafs.resize(1);
+            edcafs[0].aifsn = 2;
+            edcafs[0].cwMin = cwMinData;
+            edcafs[0].cwMax = CW_MAX;
+            edcafs[0].txopLimit = 0;
+        }
+
         const char *addressString = par("address");
         if (!strcmp(addressString, "auto")) {
             // assign automatic address
@@ -133,9 +190,16 @@ void Ieee80211Mac::initialize(int stage)
         mode = DCF;
         sequenceNumber = 0;
         radioState = RadioState::IDLE;
-        retryCounter = 0;
-        backoffPeriod = -1;
-        backoff = false;
+        for (currentAC = 0; currentAC < (int)edcafs.size(); currentAC++)
+        {
+            retryCounter() = 0;
+            backoffPeriod() = -1;
+            backoff() = false;
+        }
+        currentAC = 0;
+        minAIFS = getDIFS();
+        txopStart = 0;
+        dataBitrate = -1;
         lastReceiveFailed = false;
         nav = false;
 
@@ -148,6 +212,8 @@ void Ieee80211Mac::initialize(int stage)
         numReceived = 0;
         numSentBroadcast = 0;
         numReceivedBroadcast = 0;
+        numSentAggregate = 0;
+        numInternalCollision = 0;
         stateVector.setName("State");
         stateVector.setEnum("Ieee80211Mac");
         radioStateVector.setName("RadioState");
@@ -156,8 +222,8 @@ void Ieee80211Mac::initialize(int stage)
         // initialize watches
         WATCH(fsm);
         WATCH(radioState);
-        WATCH(retryCounter);
-        WATCH(backoff);
+        WATCH(currentAC);
+        WATCH_VECTOR(edcafs);
         WATCH(nav);
 
         WATCH(numRetry);
@@ -168,6 +234,8 @@ void Ieee80211Mac::initialize(int stage)
         WATCH(numReceived);
         WATCH(numSentBroadcast);
         WATCH(numReceivedBroadcast);
+        WATCH(numSentAggregate);
+        WATCH(numInternalCollision);
     }
 }
 
@@ -214,10 +282,24 @@ void Ieee80211Mac::initializeQueueModule()
         cModule *module = getParentModule()->getSubmodule(par("queueModule").stringValue());
         queueModule = check_and_cast<IPassiveQueue *>(module);
 
+        if (edca)
+        {
+            // with EDCA, every frame is pulled from the queue module as soon as it
+            // arrives there, and waits in the queue of its access category here
+            EV << "Requesting first frame from queue module\n";
+            queueModule->requestPacket();
+            return;
+        }
+
         EV << "Requesting first two frames from queue module\n";
         queueModule->requestPacket();
         // needed for backoff: mandatory if next message is already present
         queueModule->requestPacket();
+
+        // frames to be aggregated with the first one
+        if (aggregation != NO_AGGREGATION)
+            for (int i = 1; i < maxAggregateCount; i++)
+                queueModule->requestPacket();
     }
 }
 
@@ -236,16 +318,24 @@ void Ieee80211Mac::handleSelfMsg(cMessage *msg)
 
 void Ieee80211Mac::handleUpperMsg(cPacket *msg)
 {
-    // check for queue overflow
-    if (maxQueueSize && (int)transmissionQueue.size() == maxQueueSize)
+    // must be a Ieee80211DataOrMgmtFrame, within the max size because we don't support fragmentation
+    Ieee80211DataOrMgmtFrame *frame = check_and_cast<Ieee80211DataOrMgmtFrame *>(msg);
+    int ac = classifyFrame(frame);
+
+    // with EDCA, keep pulling frames from the queue module, otherwise voice
+    // frames would wait there behind the bulk traffic (see initializeQueueModule())
+    if (queueModule && edca)
+        queueModule->requestPacket();
+
+    // check for queue overflow; with an external queue module and DCF, the number
+    // of outstanding requestPacket() calls limits our queue instead
+    if ((!queueModule || edca) && maxQueueSize && (int)transmissionQueue(ac).size() == maxQueueSize)
     {
         EV << "message " << msg << " received from higher layer but MAC queue is full, dropping message\n";
         delete msg;
         return;
     }
 
-    // must be a Ieee80211DataOrMgmtFrame, within the max size because we don't support fragmentation
-    Ieee80211DataOrMgmtFrame *frame = check_and_cast<Ieee80211DataOrMgmtFrame *>(msg);
     if (frame->getByteLength() > fragmentationThreshold)
         error("message from higher layer (%s)%s is too long for 802.11b, %d bytes (fragmentation is not supported yet)",
               msg->getClassName(), msg->getName(), (int)(msg->getByteLength()));
@@ -258,7 +348,15 @@ void Ieee80211Mac::handleUpperMsg(cPacket *msg)
     frame->setSequenceNumber(sequenceNumber);
     sequenceNumber = (sequenceNumber+1) % 4096;  //XXX seqNum must be checked upon reception of frames!
 
-    transmissionQueue.push_back(frame);
+    // an access category that gets a frame while the MAC is busy has to back off
+    if (transmissionQueue(ac).empty() && fsm.getState() != IDLE)
+    {
+        backoff(ac) = true;
+        backoffPeriod(ac) = -1;
+    }
+    transmissionQueue(ac).push_back(frame);
+    if (fsm.getState() == IDLE)
+        currentAC = ac;
 
     handleWithFSM(frame);
 }
@@ -314,6 +412,8 @@ void Ieee80211Mac::handleLowerMsg(cPacket *msg)
     Ieee80211TwoAddressFrame *twoAddressFrame = dynamic_cast<Ieee80211TwoAddressFrame *>(msg);
     ASSERT(!twoAddressFrame || twoAddressFrame->getTransmitterAddress() != address);
 
+    processPhyIndication(frame);
+
     handleWithFSM(msg);
 
     // if we are the owner then we did not send this message up
@@ -364,6 +464,12 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
         scheduleReservePeriod(frame);
     }
 
+    // with EDCA, decide which access category gets the transmit opportunity
+    if (edca && msg == endDIFS)
+        selectAccessCategoryAfterAIFS();
+    else if (edca && msg == endBackoff)
+        selectAccessCategoryAfterBackoff();
+
     // TODO: fix bug according to the message: [omnetpp] A possible bug in the Ieee80211's FSM.
     FSMA_Switch(fsm)
     {
@@ -373,13 +479,19 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
             FSMA_Event_Transition(Data-Ready,
                                   isUpperMsg(msg),
                                   DEFER,
-                ASSERT(isInvalidBackoffPeriod() || backoffPeriod == 0);
+                ASSERT(isInvalidBackoffPeriod() || backoffPeriod() == 0);
                 invalidateBackoffPeriod();
+                aggregateCurrentTransmission();
             );
             FSMA_No_Event_Transition(Immediate-Data-Ready,
-                                     !transmissionQueue.empty(),
+                                     getPendingAccessCategory() != -1,
                                      DEFER,
-                invalidateBackoffPeriod();
+                // other access categories keep their backoff periods
+                if (transmissionQueue().empty())
+                    currentAC = getPendingAccessCategory();
+                else
+                    invalidateBackoffPeriod();
+                aggregateCurrentTransmission();
             );
             FSMA_Event_Transition(Receive,
                                   isLowerMsg(msg),
@@ -394,7 +506,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   WAITDIFS,
             ;);
             FSMA_No_Event_Transition(Immediate-Wait-DIFS,
-                                     isMediumFree() || !backoff,
+                                     isMediumFree() || !backoff(),
                                      WAITDIFS,
             ;);
             FSMA_Event_Transition(Receive,
@@ -407,19 +519,19 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
             FSMA_Enter(scheduleDIFSPeriod());
             FSMA_Event_Transition(Immediate-Transmit-RTS,
                                   msg == endDIFS && !isBroadcast(getCurrentTransmission())
-                                  && getCurrentTransmission()->getByteLength() >= rtsThreshold && !backoff,
+                                  && getCurrentTransmission()->getByteLength() >= rtsThreshold && !backoff(),
                                   WAITCTS,
                 sendRTSFrame(getCurrentTransmission());
                 cancelDIFSPeriod();
             );
             FSMA_Event_Transition(Immediate-Transmit-Broadcast,
-                                  msg == endDIFS && isBroadcast(getCurrentTransmission()) && !backoff,
+                                  msg == endDIFS && isBroadcast(getCurrentTransmission()) && !backoff(),
                                   WAITBROADCAST,
                 sendBroadcastFrame(getCurrentTransmission());
                 cancelDIFSPeriod();
             );
             FSMA_Event_Transition(Immediate-Transmit-Data,
-                                  msg == endDIFS && !isBroadcast(getCurrentTransmission()) && !backoff,
+                                  msg == endDIFS && !isBroadcast(getCurrentTransmission()) && !backoff(),
                                   WAITACK,
                 sendDataFrame(getCurrentTransmission());
                 cancelDIFSPeriod();
@@ -427,20 +539,20 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
             FSMA_Event_Transition(DIFS-Over,
                                   msg == endDIFS,
                                   BACKOFF,
-                ASSERT(backoff);
+                ASSERT(backoff());
                 if (isInvalidBackoffPeriod())
                     generateBackoffPeriod();
             );
             FSMA_Event_Transition(Busy,
                                   isMediumStateChange(msg) && !isMediumFree(),
                                   DEFER,
-                backoff = true;
+                backoff() = true;
                 cancelDIFSPeriod();
             );
             FSMA_No_Event_Transition(Immediate-Busy,
                                      !isMediumFree(),
                                      DEFER,
-                backoff = true;
+                backoff() = true;
                 cancelDIFSPeriod();
             );
             // radio state changes before we actually get the message, so this must be here
@@ -479,22 +591,70 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
         FSMA_State(WAITACK)
         {
             FSMA_Enter(scheduleDataTimeoutPeriod(getCurrentTransmission()));
+            // with EDCA, the rest of the transmit opportunity is used for the next frame
+            FSMA_Event_Transition(Receive-ACK-TXOP,
+                                  isLowerMsg(msg) && isForUs(frame) && frameType == ST_ACK && canContinueTXOP(),
+                                  WAITSIFS,
+                if (retryCounter() == 0) numSentWithoutRetry++;
+                numSent++;
+                reportTransmissionAttempt(true);
+                if (dynamic_cast<Ieee80211AggregateFrame *>(getCurrentTransmission()))
+                    numSentAggregate += ((Ieee80211AggregateFrame *)getCurrentTransmission())->getNumSubframes();
+                cancelTimeoutPeriod();
+                finishCurrentTransmission();
+            );
             FSMA_Event_Transition(Receive-ACK,
                                   isLowerMsg(msg) && isForUs(frame) && frameType == ST_ACK,
                                   IDLE,
-                if (retryCounter == 0) numSentWithoutRetry++;
+                if (retryCounter() == 0) numSentWithoutRetry++;
+                numSent++;
+                reportTransmissionAttempt(true);
+                if (dynamic_cast<Ieee80211AggregateFrame *>(getCurrentTransmission()))
+                    numSentAggregate += ((Ieee80211AggregateFrame *)getCurrentTransmission())->getNumSubframes();
+                cancelTimeoutPeriod();
+                finishCurrentTransmission();
+            );
+            // an A-MPDU is done if all subframes have been acknowledged, otherwise
+            // the rest is retransmitted as long as the retry limit allows
+            FSMA_Event_Transition(Receive-BlockAck,
+                                  isLowerMsg(msg) && isForUs(frame) && frameType == ST_BLOCKACK
+                                  && isAmpdu(getCurrentTransmission()) && getNumUnackedSubframes(frame) == 0,
+                                  IDLE,
+                if (retryCounter() == 0) numSentWithoutRetry++;
                 numSent++;
                 cancelTimeoutPeriod();
+                reportBlockAck(frame);
+                removeAckedSubframes(frame);
                 finishCurrentTransmission();
             );
+            FSMA_Event_Transition(Receive-BlockAck-Failed,
+                                  isLowerMsg(msg) && isForUs(frame) && frameType == ST_BLOCKACK
+                                  && isAmpdu(getCurrentTransmission()) && retryCounter() == transmissionLimit - 1,
+                                  IDLE,
+                cancelTimeoutPeriod();
+                reportBlockAck(frame);
+                removeAckedSubframes(frame);
+                giveUpCurrentTransmission();
+            );
+            FSMA_Event_Transition(Receive-BlockAck-Partial,
+                                  isLowerMsg(msg) && isForUs(frame) && frameType == ST_BLOCKACK
+                                  && isAmpdu(getCurrentTransmission()),
+                                  DEFER,
+                cancelTimeoutPeriod();
+                reportBlockAck(frame);
+                removeAckedSubframes(frame);
+                retryCurrentTransmission();
+            );
             FSMA_Event_Transition(Transmit-Data-Failed,
-                                  msg == endTimeout && retryCounter == transmissionLimit - 1,
+                                  msg == endTimeout && retryCounter() == transmissionLimit - 1,
                                   IDLE,
+                reportTransmissionAttempt(false);
                 giveUpCurrentTransmission();
             );
             FSMA_Event_Transition(Receive-ACK-Timeout,
                                   msg == endTimeout,
                                   DEFER,
+                reportTransmissionAttempt(false);
                 retryCurrentTransmission();
             );
         }
@@ -519,7 +679,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                 cancelTimeoutPeriod();
             );
             FSMA_Event_Transition(Transmit-RTS-Failed,
-                                  msg == endTimeout && retryCounter == transmissionLimit - 1,
+                                  msg == endTimeout && retryCounter() == transmissionLimit - 1,
                                   IDLE,
                 giveUpCurrentTransmission();
             );
@@ -543,6 +703,11 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   WAITACK,
                 sendDataFrameOnEndSIFS(getCurrentTransmission());
             );
+            FSMA_Event_Transition(Transmit-Data-TXOP,
+                                  msg == endSIFS && getFrameReceivedBeforeSIFS()->getType() == ST_ACK,
+                                  WAITACK,
+                sendDataFrameOnEndSIFS(getCurrentTransmission());
+            );
             FSMA_Event_Transition(Transmit-ACK,
                                   msg == endSIFS && isDataOrMgmtFrame(getFrameReceivedBeforeSIFS()),
                                   IDLE,
@@ -570,8 +735,13 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
             FSMA_No_Event_Transition(Immediate-Receive-Data,
                                      isLowerMsg(msg) && isForUs(frame) && isDataOrMgmtFrame(frame),
                                      WAITSIFS,
-                sendUp(frame);
-                numReceived++;
+                if (dynamic_cast<Ieee80211AggregateFrame *>(frame))
+                    sendUpAggregate((Ieee80211AggregateFrame *)frame);
+                else
+                {
+                    sendUp(frame);
+                    numReceived++;
+                }
             );
             FSMA_No_Event_Transition(Immediate-Receive-RTS,
                                      isLowerMsg(msg) && isForUs(frame) && frameType == ST_RTS,
@@ -614,6 +784,11 @@ simtime_t Ieee80211Mac::getDIFS()
     return getSIFS() + 2 * getSlotTime();
 }
 
+simtime_t Ieee80211Mac::getAIFS(int ac)
+{
+    return getSIFS() + edcafs[ac].aifsn * getSlotTime();
+}
+
 simtime_t Ieee80211Mac::getEIFS()
 {
 // FIXME:   return getSIFS() + getDIFS() + (8 * ACKSize + aPreambleLength + aPLCPHeaderLength) / lowestDatarate;
@@ -626,16 +801,16 @@ simtime_t Ieee80211Mac::computeBackoffPeriod(Ieee80211Frame *msg, int r)
 
     EV << "generating backoff slot number for retry: " << r << endl;
 
-    if (isBroadcast(msg))
+    if (isBroadcast(msg) && !edca)
         cw = cwMinBroadcast;
     else
     {
         ASSERT(0 <= r && r < transmissionLimit);
 
-        cw = (cwMinData + 1) * (1 << r) - 1;
+        cw = (edcafs[currentAC].cwMin + 1) * (1 << r) - 1;
 
-        if (cw > CW_MAX)
-            cw = CW_MAX;
+        if (cw > edcafs[currentAC].cwMax)
+            cw = edcafs[currentAC].cwMax;
     }
 
     int c = intrand(cw + 1);
@@ -645,6 +820,13 @@ simtime_t Ieee80211Mac::computeBackoffPeriod(Ieee80211Frame *msg, int r)
     return ((double)c) * getSlotTime();
 }
 
+simtime_t Ieee80211Mac::getContentionPeriod(int ac)
+{
+    // an access category that got its frame during the AIFS period may have a shorter AIFS than minAIFS
+    simtime_t extraAIFS = getAIFS(ac) - minAIFS;
+    return (extraAIFS > 0 ? extraAIFS : SIMTIME_ZERO) + backoffPeriod(ac);
+}
+
 /****************************************************************
  * Timer functions.
  */
@@ -657,15 +839,22 @@ void Ieee80211Mac::scheduleSIFSPeriod(Ieee80211Frame *frame)
 
 void Ieee80211Mac::scheduleDIFSPeriod()
 {
+    // with EDCA, the period ends with the shortest AIFS of the access categories having frames
+    minAIFS = -1;
+    for (int ac = 0; ac < (int)edcafs.size(); ac++)
+        if (!transmissionQueue(ac).empty() && (minAIFS == -1 || getAIFS(ac) < minAIFS))
+            minAIFS = getAIFS(ac);
+    ASSERT(minAIFS != -1);
+
     if (lastReceiveFailed)
     {
         EV << "receiption of last frame failed, scheduling EIFS period\n";
-        scheduleAt(simTime() + getEIFS(), endDIFS);
+        scheduleAt(simTime() + getEIFS() - getDIFS() + minAIFS, endDIFS);
     }
     else
     {
         EV << "scheduling DIFS period\n";
-        scheduleAt(simTime() + getDIFS(), endDIFS);
+        scheduleAt(simTime() + minAIFS, endDIFS);
     }
 }
 
@@ -678,7 +867,7 @@ void Ieee80211Mac::cancelDIFSPeriod()
 void Ieee80211Mac::scheduleDataTimeoutPeriod(Ieee80211DataOrMgmtFrame *frameToSend)
 {
     EV << "scheduling data timeout period\n";
-    scheduleAt(simTime() + computeFrameDuration(frameToSend) + getSIFS() + computeFrameDuration(LENGTH_ACK, basicBitrate) + MAX_PROPAGATION_DELAY * 2, endTimeout);
+    scheduleAt(simTime() + computeFrameDuration(frameToSend) + getSIFS() + computeAckDuration(frameToSend) + MAX_PROPAGATION_DELAY * 2, endTimeout);
 }
 
 void Ieee80211Mac::scheduleBroadcastTimeoutPeriod(Ieee80211DataOrMgmtFrame *frameToSend)
@@ -731,34 +920,57 @@ void Ieee80211Mac::scheduleReservePeriod(Ieee80211Frame *frame)
 
 void Ieee80211Mac::invalidateBackoffPeriod()
 {
-    backoffPeriod = -1;
+    backoffPeriod() = -1;
 }
 
 bool Ieee80211Mac::isInvalidBackoffPeriod()
 {
-    return backoffPeriod == -1;
+    return backoffPeriod() == -1;
 }
 
 void Ieee80211Mac::generateBackoffPeriod()
 {
-    backoffPeriod = computeBackoffPeriod(getCurrentTransmission(), retryCounter);
-    ASSERT(backoffPeriod >= 0);
-    EV << "backoff period set to " << backoffPeriod << endl;
+    backoffPeriod() = computeBackoffPeriod(getCurrentTransmission(), retryCounter());
+    ASSERT(backoffPeriod() >= 0);
+    EV << "backoff period set to " << backoffPeriod() << endl;
 }
 
 void Ieee80211Mac::decreaseBackoffPeriod()
 {
     // see spec 9.2.5.2
     simtime_t elapsedBackoffTime = simTime() - endBackoff->getSendingTime();
-    backoffPeriod -= ((int)(elapsedBackoffTime / getSlotTime())) * getSlotTime();
-    ASSERT(backoffPeriod >= 0);
-    EV << "backoff period decreased to " << backoffPeriod << endl;
+    for (int ac = 0; ac < (int)edcafs.size(); ac++)
+        if (isContending(ac))
+            decreaseBackoffPeriod(ac, elapsedBackoffTime);
+}
+
+void Ieee80211Mac::decreaseBackoffPeriod(int ac, simtime_t elapsedBackoffTime)
+{
+    // the slots are counted after the access category's own AIFS
+    simtime_t countdownTime = elapsedBackoffTime - (getContentionPeriod(ac) - backoffPeriod(ac));
+    if (countdownTime > 0)
+        backoffPeriod(ac) -= ((int)(countdownTime / getSlotTime())) * getSlotTime();
+    ASSERT(backoffPeriod(ac) >= 0);
+    EV << "backoff period decreased to " << backoffPeriod(ac) << endl;
 }
 
 void Ieee80211Mac::scheduleBackoffPeriod()
 {
+    // access categories that got their frames during contention draw their backoff now
+    int oldAC = currentAC;
+    for (currentAC = 0; currentAC < (int)edcafs.size(); currentAC++)
+        if (!transmissionQueue().empty() && backoff() && isInvalidBackoffPeriod())
+            generateBackoffPeriod();
+    currentAC = oldAC;
+
+    // the first access category to finish its backoff gets the transmit opportunity
+    simtime_t period = -1;
+    for (int ac = 0; ac < (int)edcafs.size(); ac++)
+        if (isContending(ac) && (period == -1 || getContentionPeriod(ac) < period))
+            period = getContentionPeriod(ac);
+
     EV << "scheduling backoff period\n";
-    scheduleAt(simTime() + backoffPeriod, endBackoff);
+    scheduleAt(simTime() + period, endBackoff);
 }
 
 void Ieee80211Mac::cancelBackoffPeriod()
@@ -774,7 +986,10 @@ void Ieee80211Mac::sendACKFrameOnEndSIFS()
 {
     Ieee80211Frame *frameToACK = (Ieee80211Frame *)endSIFS->getContextPointer();
     endSIFS->setContextPointer(NULL);
-    sendACKFrame(check_and_cast<Ieee80211DataOrMgmtFrame*>(frameToACK));
+    if (isAmpdu(frameToACK))
+        sendBlockAckFrame((Ieee80211AggregateFrame *)frameToACK);
+    else
+        sendACKFrame(check_and_cast<Ieee80211DataOrMgmtFrame*>(frameToACK));
     delete frameToACK;
 }
 
@@ -784,6 +999,12 @@ void Ieee80211Mac::sendACKFrame(Ieee80211DataOrMgmtFrame *frameToACK)
     sendDown(setBasicBitrate(buildACKFrame(frameToACK)));
 }
 
+void Ieee80211Mac::sendBlockAckFrame(Ieee80211AggregateFrame *aggregate)
+{
+    EV << "sending Block Ack frame\n";
+    sendDown(setBasicBitrate(buildBlockAckFrame(aggregate)));
+}
+
 void Ieee80211Mac::sendDataFrameOnEndSIFS(Ieee80211DataOrMgmtFrame *frameToSend)
 {
     Ieee80211Frame *ctsFrame = (Ieee80211Frame *)endSIFS->getContextPointer();
@@ -831,10 +1052,17 @@ Ieee80211DataOrMgmtFrame *Ieee80211Mac::buildDataFrame(Ieee80211DataOrMgmtFrame
 {
     Ieee80211DataOrMgmtFrame *frame = (Ieee80211DataOrMgmtFrame *)frameToSend->dup();
 
+    if (rateControl && !isBroadcast(frameToSend))
+    {
+        PhyControlInfo *ctrl = new PhyControlInfo();
+        ctrl->setBitrate(getDataBitrate(frameToSend));
+        frame->setControlInfo(ctrl);
+    }
+
     if (isBroadcast(frameToSend))
         frame->setDuration(0);
     else if (!frameToSend->getMoreFragments())
-        frame->setDuration(getSIFS() + computeFrameDuration(LENGTH_ACK, basicBitrate));
+        frame->setDuration(getSIFS() + computeAckDuration(frameToSend));
     else
         // FIXME: shouldn't we use the next frame to be sent?
         frame->setDuration(3 * getSIFS() + 2 * computeFrameDuration(LENGTH_ACK, basicBitrate) + computeFrameDuration(frameToSend));
@@ -862,7 +1090,7 @@ Ieee80211RTSFrame *Ieee80211Mac::buildRTSFrame(Ieee80211DataOrMgmtFrame *frameTo
     frame->setReceiverAddress(frameToSend->getReceiverAddress());
     frame->setDuration(3 * getSIFS() + computeFrameDuration(LENGTH_CTS, basicBitrate) +
                        computeFrameDuration(frameToSend) +
-                       computeFrameDuration(LENGTH_ACK, basicBitrate));
+                       computeAckDuration(frameToSend));
 
     return frame;
 }
@@ -883,6 +1111,26 @@ Ieee80211DataOrMgmtFrame *Ieee80211Mac::buildBroadcastFrame(Ieee80211DataOrMgmtF
     return frame;
 }
 
+Ieee80211BlockAckFrame *Ieee80211Mac::buildBlockAckFrame(Ieee80211AggregateFrame *aggregate)
+{
+    Ieee80211BlockAckFrame *frame = new Ieee80211BlockAckFrame("wlan-blockack");
+    frame->setReceiverAddress(aggregate->getTransmitterAddress());
+    frame->setTransmitterAddress(address);
+    frame->setDuration(0);
+
+    // the sender keeps the subframes within the Block Ack window of the first one
+    int startingSequenceNumber = aggregate->getSubframe(0)->getSequenceNumber();
+    frame->setStartingSequenceNumber(startingSequenceNumber);
+    for (unsigned int i = 0; i < aggregate->getNumSubframes(); i++)
+    {
+        int offset = (aggregate->getSubframe(i)->getSequenceNumber() - startingSequenceNumber + 4096) % 4096;
+        if (!aggregate->getSubframeBitError(i) && offset < (int)frame->getAckedArraySize())
+            frame->setAcked(offset, true);
+    }
+
+    return frame;
+}
+
 Ieee80211Frame *Ieee80211Mac::setBasicBitrate(Ieee80211Frame *frame)
 {
     ASSERT(frame->getControlInfo()==NULL);
@@ -910,17 +1158,298 @@ void Ieee80211Mac::giveUpCurrentTransmission()
 
 void Ieee80211Mac::retryCurrentTransmission()
 {
-    ASSERT(retryCounter < transmissionLimit - 1);
+    ASSERT(retryCounter() < transmissionLimit - 1);
     getCurrentTransmission()->setRetry(true);
-    retryCounter++;
+    retryCounter()++;
+    dataBitrate = -1;
     numRetry++;
-    backoff = true;
+    backoff() = true;
     generateBackoffPeriod();
 }
 
+void Ieee80211Mac::aggregateCurrentTransmission()
+{
+    if (aggregation == NO_AGGREGATION || transmissionQueue().size() < 2)
+        return;
+
+    // only unicast data frames are aggregated, and only once
+    Ieee80211DataFrame *first = dynamic_cast<Ieee80211DataFrame *>(getCurrentTransmission());
+    if (!first || isBroadcast(first) || dynamic_cast<Ieee80211AggregateFrame *>(first))
+        return;
+
+    // the A-MSDU header is the MAC header of the first frame
+    Ieee80211AggregateFrame *aggregate = new Ieee80211AggregateFrame(aggregation == AMPDU ? "wlan-ampdu" : "wlan-amsdu");
+    aggregate->setAmpdu(aggregation == AMPDU);
+    aggregate->setReceiverAddress(first->getReceiverAddress());
+    aggregate->setTransmitterAddress(address);
+    aggregate->setAddress3(first->getAddress3());
+    aggregate->setAddress4(first->getAddress4());
+    aggregate->setToDS(first->getToDS());
+    aggregate->setFromDS(first->getFromDS());
+    aggregate->setSequenceNumber(first->getSequenceNumber());
+
+    std::vector<Ieee80211DataOrMgmtFrameList::iterator> aggregated;
+    for (Ieee80211DataOrMgmtFrameList::iterator it = transmissionQueue().begin();
+         it != transmissionQueue().end() && (int)aggregated.size() < maxAggregateCount; ++it)
+    {
+        Ieee80211DataFrame *frame = dynamic_cast<Ieee80211DataFrame *>(*it);
+        if (!frame || dynamic_cast<Ieee80211AggregateFrame *>(frame) || frame->getReceiverAddress() != first->getReceiverAddress())
+            continue;
+        if (aggregation == AMSDU && (frame->getToDS() != first->getToDS() || frame->getFromDS() != first->getFromDS()))
+            continue;
+        if (aggregation == AMPDU && (frame->getSequenceNumber() - first->getSequenceNumber() + 4096) % 4096 >= 64)
+            continue;
+
+        aggregate->addSubframe(frame);
+        if (aggregate->getByteLength() > maxAggregateSize)
+        {
+            take(aggregate->removeSubframe(aggregate->getNumSubframes() - 1));
+            break;
+        }
+        aggregated.push_back(it);
+    }
+
+    if (aggregated.size() < 2)
+    {
+        // nothing to aggregate with: the frame stays in the queue as it was
+        while (aggregate->getNumSubframes() > 0)
+            take(aggregate->removeSubframe(0));
+        delete aggregate;
+        return;
+    }
+
+    EV << "aggregating " << aggregated.size() << " frames into " << aggregate->getName() << endl;
+    for (unsigned int i = 0; i < aggregated.size(); i++)
+        transmissionQueue().erase(aggregated[i]);
+    transmissionQueue().push_front(aggregate);
+
+    if (queueModule && !edca)
+    {
+        // keep the same number of frames requested from the queue module
+        for (unsigned int i = 1; i < aggregated.size(); i++)
+            queueModule->requestPacket();
+    }
+}
+
+static bool isAckedBy(Ieee80211BlockAckFrame *blockAck, Ieee80211DataFrame *frame)
+{
+    int offset = (frame->getSequenceNumber() - blockAck->getStartingSequenceNumber() + 4096) % 4096;
+    return offset < (int)blockAck->getAckedArraySize() && blockAck->getAcked(offset);
+}
+
+int Ieee80211Mac::getNumUnackedSubframes(Ieee80211Frame *frame)
+{
+    Ieee80211BlockAckFrame *blockAck = check_and_cast<Ieee80211BlockAckFrame *>(frame);
+    Ieee80211AggregateFrame *aggregate = check_and_cast<Ieee80211AggregateFrame *>(getCurrentTransmission());
+    int numUnacked = 0;
+    for (unsigned int i = 0; i < aggregate->getNumSubframes(); i++)
+        if (!isAckedBy(blockAck, aggregate->getSubframe(i)))
+            numUnacked++;
+    return numUnacked;
+}
+
+void Ieee80211Mac::removeAckedSubframes(Ieee80211Frame *frame)
+{
+    Ieee80211BlockAckFrame *blockAck = check_and_cast<Ieee80211BlockAckFrame *>(frame);
+    Ieee80211AggregateFrame *aggregate = check_and_cast<Ieee80211AggregateFrame *>(getCurrentTransmission());
+    for (int i = aggregate->getNumSubframes() - 1; i >= 0; i--)
+    {
+        if (isAckedBy(blockAck, aggregate->getSubframe(i)))
+        {
+            delete aggregate->removeSubframe(i);
+            numSentAggregate++;
+        }
+    }
+}
+
+void Ieee80211Mac::sendUpAggregate(Ieee80211AggregateFrame *aggregate)
+{
+    for (unsigned int i = 0; i < aggregate->getNumSubframes(); i++)
+    {
+        if (aggregate->getSubframeBitError(i))
+        {
+            EV << "subframe " << aggregate->getSubframe(i) << " has bit errors, dropping it\n";
+            continue;
+        }
+        sendUp(aggregate->getSubframe(i)->dup());
+        numReceived++;
+    }
+}
+
+double Ieee80211Mac::getDataBitrate(Ieee80211DataOrMgmtFrame *frame)
+{
+    if (!rateControl || isBroadcast(frame))
+        return bitrate;
+
+    // chosen once per transmission attempt, so that the RTS, the NAV durations
+    // and the timeouts all agree with the bitrate of the data frame
+    if (dataBitrate == -1)
+        dataBitrate = rateControl->getBitrate(frame->getReceiverAddress(), retryCounter());
+    return dataBitrate;
+}
+
+void Ieee80211Mac::reportTransmissionAttempt(bool acked)
+{
+    if (!rateControl || dataBitrate == -1)
+        return;
+    Ieee80211DataOrMgmtFrame *frame = getCurrentTransmission();
+    int numFrames = isAmpdu(frame) ? ((Ieee80211AggregateFrame *)frame)->getNumSubframes() : 1;
+    rateControl->reportAttempt(frame->getReceiverAddress(), dataBitrate, numFrames, acked ? numFrames : 0);
+}
+
+void Ieee80211Mac::reportBlockAck(Ieee80211Frame *blockAck)
+{
+    if (!rateControl || dataBitrate == -1)
+        return;
+    Ieee80211AggregateFrame *aggregate = check_and_cast<Ieee80211AggregateFrame *>(getCurrentTransmission());
+    int numFrames = aggregate->getNumSubframes();
+    rateControl->reportAttempt(aggregate->getReceiverAddress(), dataBitrate, numFrames, numFrames - getNumUnackedSubframes(blockAck));
+}
+
+void Ieee80211Mac::processPhyIndication(Ieee80211Frame *frame)
+{
+    PhyIndication *indication = dynamic_cast<PhyIndication *>(frame->getControlInfo());
+    if (!indication)
+        return;
+
+    if (rateControl)
+    {
+        // ACK and CTS frames carry no transmitter address, but come from the station we are waiting for
+        Ieee80211TwoAddressFrame *twoAddressFrame = dynamic_cast<Ieee80211TwoAddressFrame *>(frame);
+        if (twoAddressFrame)
+            rateControl->reportSnir(twoAddressFrame->getTransmitterAddress(), indication->getSnirMin());
+        else if ((fsm.getState() == WAITACK || fsm.getState() == WAITCTS) && isForUs(frame))
+            rateControl->reportSnir(getCurrentTransmission()->getReceiverAddress(), indication->getSnirMin());
+    }
+    delete frame->removeControlInfo();
+}
+
+int Ieee80211Mac::classifyFrame(Ieee80211DataOrMgmtFrame *frame)
+{
+    if (!edca)
+        return 0;
+
+    // management frames are sent with the parameters of AC_VO
+    if (!dynamic_cast<Ieee80211DataFrame *>(frame))
+        return AC_VO;
+    return frame->getEncapsulatedMsg() ? classifier->classifyPacket(frame->getEncapsulatedMsg()) : AC_BE;
+}
+
+void Ieee80211Mac::selectAccessCategoryAfterAIFS()
+{
+    // access categories with a longer AIFS have to wait for the difference as if it were backoff
+    for (int ac = 0; ac < (int)edcafs.size(); ac++)
+    {
+        if (!transmissionQueue(ac).empty() && !backoff(ac) && getAIFS(ac) > minAIFS)
+        {
+            backoff(ac) = true;
+            backoffPeriod(ac) = 0;
+        }
+    }
+
+    // the highest priority access category without backoff transmits now
+    int winnerAC = -1;
+    for (int ac = 0; ac < (int)edcafs.size(); ac++)
+    {
+        if (transmissionQueue(ac).empty() || backoff(ac))
+            continue;
+        if (winnerAC == -1)
+            winnerAC = ac;
+        else
+            handleInternalCollision(ac);
+    }
+
+    if (winnerAC != -1)
+    {
+        currentAC = winnerAC;
+        txopStart = simTime();
+        aggregateCurrentTransmission();
+    }
+    else
+    {
+        // all of them go on with backoff
+        currentAC = getPendingAccessCategory();
+    }
+}
+
+void Ieee80211Mac::selectAccessCategoryAfterBackoff()
+{
+    simtime_t elapsedBackoffTime = simTime() - endBackoff->getSendingTime();
+    int winnerAC = -1;
+    for (int ac = 0; ac < (int)edcafs.size(); ac++)
+    {
+        if (!isContending(ac))
+            continue;
+        if (getContentionPeriod(ac) > elapsedBackoffTime)
+            decreaseBackoffPeriod(ac, elapsedBackoffTime);
+        else if (winnerAC == -1)
+            winnerAC = ac;
+        else
+            handleInternalCollision(ac);
+    }
+    ASSERT(winnerAC != -1);
+
+    currentAC = winnerAC;
+    txopStart = simTime();
+    aggregateCurrentTransmission();
+}
+
+void Ieee80211Mac::handleInternalCollision(int ac)
+{
+    // see 9.9.1.5: the lower priority access category behaves as if its frame had collided
+    EV << "internal collision, access category " << ac << " backs off\n";
+    numInternalCollision++;
+
+    int oldAC = currentAC;
+    currentAC = ac;
+    if (isBroadcast(getCurrentTransmission()))
+    {
+        backoff() = true;
+        generateBackoffPeriod();
+    }
+    else if (retryCounter() == transmissionLimit - 1)
+    {
+        giveUpCurrentTransmission();
+        invalidateBackoffPeriod();
+    }
+    else
+        retryCurrentTransmission();
+    currentAC = oldAC;
+}
+
+bool Ieee80211Mac::canContinueTXOP()
+{
+    if (!edca || edcafs[currentAC].txopLimit == 0 || transmissionQueue().size() < 2)
+        return false;
+
+    // only frames to the same receiver and without RTS/CTS; the next frame is
+    // assumed to be sent at the bitrate of the current one
+    Ieee80211DataOrMgmtFrame *frameToSend = getCurrentTransmission();
+    Ieee80211DataOrMgmtFrame *nextFrame = *(++transmissionQueue().begin());
+    if (nextFrame->getReceiverAddress() != frameToSend->getReceiverAddress() || nextFrame->getByteLength() >= rtsThreshold)
+        return false;
+
+    simtime_t end = simTime() + getSIFS() + computeFrameDuration(nextFrame->getBitLength(), getDataBitrate(frameToSend)) +
+                    getSIFS() + computeAckDuration(nextFrame);
+    return end <= txopStart + edcafs[currentAC].txopLimit;
+}
+
+int Ieee80211Mac::getPendingAccessCategory()
+{
+    for (int ac = 0; ac < (int)edcafs.size(); ac++)
+        if (!transmissionQueue(ac).empty())
+            return ac;
+    return -1;
+}
+
+bool Ieee80211Mac::isContending(int ac)
+{
+    return !transmissionQueue(ac).empty() && backoff(ac) && backoffPeriod(ac) != -1;
+}
+
 Ieee80211DataOrMgmtFrame *Ieee80211Mac::getCurrentTransmission()
 {
-    return (Ieee80211DataOrMgmtFrame *)transmissionQueue.front();
+    return (Ieee80211DataOrMgmtFrame *)transmissionQueue().front();
 }
 
 void Ieee80211Mac::sendDownPendingRadioConfigMsg()
@@ -942,15 +1471,16 @@ void Ieee80211Mac::setMode(Mode mode)
 
 void Ieee80211Mac::resetStateVariables()
 {
-    backoffPeriod = 0;
-    retryCounter = 0;
+    backoffPeriod() = 0;
+    retryCounter() = 0;
+    dataBitrate = -1;
 
-    if (!transmissionQueue.empty()) {
-        backoff = true;
+    if (!transmissionQueue().empty()) {
+        backoff() = true;
         getCurrentTransmission()->setRetry(false);
     }
     else {
-        backoff = false;
+        backoff() = false;
     }
 }
 
@@ -979,6 +1509,12 @@ bool Ieee80211Mac::isDataOrMgmtFrame(Ieee80211Frame *frame)
     return dynamic_cast<Ieee80211DataOrMgmtFrame*>(frame);
 }
 
+bool Ieee80211Mac::isAmpdu(Ieee80211Frame *frame)
+{
+    Ieee80211AggregateFrame *aggregate = dynamic_cast<Ieee80211AggregateFrame*>(frame);
+    return aggregate && aggregate->getAmpdu();
+}
+
 Ieee80211Frame *Ieee80211Mac::getFrameReceivedBeforeSIFS()
 {
     return (Ieee80211Frame *)endSIFS->getContextPointer();
@@ -987,11 +1523,11 @@ Ieee80211Frame *Ieee80211Mac::getFrameReceivedBeforeSIFS()
 void Ieee80211Mac::popTransmissionQueue()
 {
     EV << "dropping frame from transmission queue\n";
-    Ieee80211Frame *temp = transmissionQueue.front();
-    transmissionQueue.pop_front();
+    Ieee80211Frame *temp = transmissionQueue().front();
+    transmissionQueue().pop_front();
     delete temp;
 
-    if (queueModule)
+    if (queueModule && !edca)
     {
         // tell queue module that we've become idle
         EV << "requesting another frame from queue module\n";
@@ -1001,7 +1537,8 @@ void Ieee80211Mac::popTransmissionQueue()
 
 double Ieee80211Mac::computeFrameDuration(Ieee80211Frame *msg)
 {
-    return computeFrameDuration(msg->getBitLength(), bitrate);
+    Ieee80211DataOrMgmtFrame *frame = dynamic_cast<Ieee80211DataOrMgmtFrame *>(msg);
+    return computeFrameDuration(msg->getBitLength(), frame ? getDataBitrate(frame) : bitrate);
 }
 
 double Ieee80211Mac::computeFrameDuration(int bits, double bitrate)
@@ -1009,11 +1546,17 @@ double Ieee80211Mac::computeFrameDuration(int bits, double bitrate)
     return bits / bitrate + PHY_HEADER_LENGTH / BITRATE_HEADER;
 }
 
+double Ieee80211Mac::computeAckDuration(Ieee80211DataOrMgmtFrame *frame)
+{
+    return computeFrameDuration(isAmpdu(frame) ? LENGTH_BLOCKACK : LENGTH_ACK, basicBitrate);
+}
+
 void Ieee80211Mac::logState()
 {
     EV  << "state information: mode = " << modeName(mode) << ", state = " << fsm.getStateName()
-        << ", backoff = " << backoff << ", backoffPeriod = " << backoffPeriod
-        << ", retryCounter = " << retryCounter << ", radioState = " << radioState
+        << ", backoff = " << backoff() << ", backoffPeriod = " << backoffPeriod()
+        << ", retryCounter = " << retryCounter() << ", radioState = " << radioState
+        << ", currentAC = " << currentAC
         << ", nav = " << nav << endl;
 }
 
@@ -22,9 +22,13 @@
 #define FSM_DEBUG
 
 #include <list>
+#include <vector>
 #include "WirelessMacBase.h"
 #include "IPassiveQueue.h"
+#include "IQoSClassifier.h"
 #include "Ieee80211Frame_m.h"
+#include "Ieee80211AggregateFrame.h"
+#include "IRateControl.h"
 #include "Ieee80211Consts.h"
 #include "NotificationBoard.h"
 #include "RadioState.h"
@@ -67,6 +71,34 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
 
   typedef std::list<Ieee80211ASFTuple*> Ieee80211ASFTupleList;
 
+  public:
+    /**
+     * Parameters, queue and contention state of an access category (EDCAF, see
+     * 802.11e 9.9.1). With DCF there is a single one, which uses DIFS and cwMinData.
+     */
+    struct Edcaf
+    {
+        int aifsn;
+        int cwMin;
+        int cwMax;
+        simtime_t txopLimit;
+
+        /** Messages received from upper layer and to be transmitted later */
+        Ieee80211DataOrMgmtFrameList transmissionQueue;
+
+        /** True if backoff is enabled */
+        bool backoff;
+
+        /** Remaining backoff period in seconds, counted from the end of the AIFS period */
+        simtime_t backoffPeriod;
+
+        /**
+         * Number of frame retransmission attempts, this is a simpification of
+         * SLRC and SSRC, see 9.2.4 in the spec
+         */
+        int retryCounter;
+    };
+
   protected:
     /**
      * @name Configuration parameters
@@ -112,6 +144,31 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
 
     /** Messages longer than this threshold will be sent in multiple fragments. see spec 361 */
     static const int fragmentationThreshold = 2346;
+
+    /** Frame aggregation types */
+    enum Aggregation {
+        NO_AGGREGATION,
+        AMSDU,
+        AMPDU,
+    };
+
+    /** Aggregation of queued data frames to the same receiver */
+    Aggregation aggregation;
+
+    /** Maximum length of an aggregate in bytes */
+    int maxAggregateSize;
+
+    /** Maximum number of subframes in an aggregate */
+    int maxAggregateCount;
+
+    /** Bitrate adaptation for unicast data and mgmt frames, or NULL to always use bitrate */
+    IRateControl *rateControl;
+
+    /** True if EDCA (802.11e) is used with one queue per access category, instead of DCF */
+    bool edca;
+
+    /** Maps frames to access categories (queue indices in decreasing priority), used with EDCA */
+    IQoSClassifier *classifier;
     //@}
 
   public:
@@ -155,27 +212,27 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
      */
     bool lastReceiveFailed;
 
-    /** True if backoff is enabled */
-    bool backoff;
-
     /** True during network allocation period. This flag is present to be able to watch this state. */
     bool nav;
 
-    /** Remaining backoff period in seconds */
-    simtime_t backoffPeriod;
+    /** One per access category with EDCA, a single one with DCF */
+    std::vector<Edcaf> edcafs;
 
-    /**
-     * Number of frame retransmission attempts, this is a simpification of
-     * SLRC and SSRC, see 9.2.4 in the spec
-     */
-    int retryCounter;
+    /** The access category whose frame is being transmitted or contending */
+    int currentAC;
+
+    /** Shortest AIFS of the contending access categories, backoff periods are counted from its end */
+    simtime_t minAIFS;
+
+    /** Start of the current transmit opportunity */
+    simtime_t txopStart;
+
+    /** Bitrate of the current transmission attempt when rateControl is used, -1 if not chosen yet */
+    double dataBitrate;
 
     /** Physical radio (medium) state copied from physical layer */
     RadioState::State radioState;
 
-    /** Messages received from upper layer and to be transmitted later */
-    Ieee80211DataOrMgmtFrameList transmissionQueue;
-
     /**
      * A list of last sender, sequence and fragment number tuples to identify
      * duplicates, see spec 9.2.9.
@@ -226,6 +283,8 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     long numReceived;
     long numSentBroadcast;
     long numReceivedBroadcast;
+    long numSentAggregate;
+    long numInternalCollision;
     cOutVector stateVector;
     cOutVector radioStateVector;
     //@}
@@ -287,7 +346,11 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual simtime_t getDIFS();
     virtual simtime_t getEIFS();
     virtual simtime_t getPIFS();
+    virtual simtime_t getAIFS(int ac);
     virtual simtime_t computeBackoffPeriod(Ieee80211Frame *msg, int r);
+
+    /** @brief Time from the end of the shortest AIFS period until the access category may transmit */
+    virtual simtime_t getContentionPeriod(int ac);
     //@}
 
   protected:
@@ -315,6 +378,7 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual bool isInvalidBackoffPeriod();
     virtual void generateBackoffPeriod();
     virtual void decreaseBackoffPeriod();
+    virtual void decreaseBackoffPeriod(int ac, simtime_t elapsedBackoffTime);
     virtual void scheduleBackoffPeriod();
     virtual void cancelBackoffPeriod();
     //@}
@@ -332,6 +396,7 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual void sendDataFrameOnEndSIFS(Ieee80211DataOrMgmtFrame *frameToSend);
     virtual void sendDataFrame(Ieee80211DataOrMgmtFrame *frameToSend);
     virtual void sendBroadcastFrame(Ieee80211DataOrMgmtFrame *frameToSend);
+    virtual void sendBlockAckFrame(Ieee80211AggregateFrame *aggregate);
     //@}
 
   protected:
@@ -344,6 +409,7 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual Ieee80211RTSFrame *buildRTSFrame(Ieee80211DataOrMgmtFrame *frameToSend);
     virtual Ieee80211CTSFrame *buildCTSFrame(Ieee80211RTSFrame *rtsFrame);
     virtual Ieee80211DataOrMgmtFrame *buildBroadcastFrame(Ieee80211DataOrMgmtFrame *frameToSend);
+    virtual Ieee80211BlockAckFrame *buildBlockAckFrame(Ieee80211AggregateFrame *aggregate);
     //@}
 
     /**
@@ -361,6 +427,54 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual void giveUpCurrentTransmission();
     virtual void retryCurrentTransmission();
 
+    /**
+     * @brief Replaces the frame at the front of the queue with an aggregate
+     * if there are other data frames to the same receiver in the queue.
+     */
+    virtual void aggregateCurrentTransmission();
+
+    /** @brief Returns the number of subframes of the current A-MPDU not acknowledged by the Block Ack */
+    virtual int getNumUnackedSubframes(Ieee80211Frame *blockAck);
+
+    /** @brief Deletes the subframes of the current A-MPDU acknowledged by the Block Ack */
+    virtual void removeAckedSubframes(Ieee80211Frame *blockAck);
+
+    /** @brief Sends up the correctly received subframes of an aggregate */
+    virtual void sendUpAggregate(Ieee80211AggregateFrame *aggregate);
+
+    /** @brief Returns the bitrate for the current transmission attempt of the frame */
+    virtual double getDataBitrate(Ieee80211DataOrMgmtFrame *frame);
+
+    /** @brief Tells rateControl whether the current transmission attempt was acknowledged */
+    virtual void reportTransmissionAttempt(bool acked);
+
+    /** @brief Tells rateControl how many subframes of the current A-MPDU the Block Ack acknowledged */
+    virtual void reportBlockAck(Ieee80211Frame *blockAck);
+
+    /** @brief Passes the reception quality indicated by the radio to rateControl */
+    virtual void processPhyIndication(Ieee80211Frame *frame);
+
+    /** @brief Returns the access category of a frame received from the upper layer */
+    virtual int classifyFrame(Ieee80211DataOrMgmtFrame *frame);
+
+    /** @brief Chooses the access category that may transmit when the AIFS period is over */
+    virtual void selectAccessCategoryAfterAIFS();
+
+    /** @brief Chooses the access category that may transmit when the backoff period is over */
+    virtual void selectAccessCategoryAfterBackoff();
+
+    /** @brief Makes the access category back off as if its frame had collided */
+    virtual void handleInternalCollision(int ac);
+
+    /** @brief Tells if the next frame can be sent after SIFS within the current transmit opportunity */
+    virtual bool canContinueTXOP();
+
+    /** @brief Returns the highest priority access category with frames to send, or -1 */
+    virtual int getPendingAccessCategory();
+
+    /** @brief Tells if the access category takes part in the backoff procedure */
+    virtual bool isContending(int ac);
+
    /** @brief Send down the change channel message to the physical layer if there is any. */
     virtual void sendDownPendingRadioConfigMsg();
 
@@ -389,6 +503,9 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     /** @brief Checks if the frame is a data or management frame */
     virtual bool isDataOrMgmtFrame(Ieee80211Frame *frame);
 
+    /** @brief Returns true if the frame is an A-MPDU, which is acknowledged with a Block Ack */
+    virtual bool isAmpdu(Ieee80211Frame *frame);
+
     /** @brief Returns the last frame received before the SIFS period. */
     virtual Ieee80211Frame *getFrameReceivedBeforeSIFS();
 
@@ -403,13 +520,36 @@ class INET_API Ieee80211Mac : public WirelessMacBase, public INotifiable
     virtual double computeFrameDuration(Ieee80211Frame *msg);
     virtual double computeFrameDuration(int bits, double bitrate);
 
+    /** @brief Duration of the ACK or Block Ack expected for the frame */
+    virtual double computeAckDuration(Ieee80211DataOrMgmtFrame *frame);
+
     /** @brief Logs all state information */
     virtual void logState();
 
     /** @brief Produce a readable name of the given MAC operation mode */
     const char *modeName(int mode);
     //@}
+
+  protected:
+    /**
+     * @name State of the current access category
+     */
+    //@{
+    Ieee80211DataOrMgmtFrameList& transmissionQueue(int ac) {return edcafs[ac].transmissionQueue;}
+    Ieee80211DataOrMgmtFrameList& transmissionQueue() {return edcafs[currentAC].transmissionQueue;}
+    bool& backoff(int ac) {return edcafs[ac].backoff;}
+    bool& backoff() {return edcafs[currentAC].backoff;}
+    simtime_t& backoffPeriod(int ac) {return edcafs[ac].backoffPeriod;}
+    simtime_t& backoffPeriod() {return edcafs[currentAC].backoffPeriod;}
+    int& retryCounter() {return edcafs[currentAC].retryCounter;}
+    //@}
 };
 
+inline std::ostream& operator<<(std::ostream& os, const Ieee80211Mac::Edcaf& edcaf)
+{
+    return os << "queue=" << edcaf.transmissionQueue.size() << " backoff=" << edcaf.backoff
+              << " backoffPeriod=" << edcaf.backoffPeriod << " retryCounter=" << edcaf.retryCounter;
+}
+
 #endif
 
@@ -0,0 +1,149 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include "MinstrelRateControl.h"
+#include "Ieee80211Consts.h"
+
+Register_Class(MinstrelRateControl);
+
+
+void MinstrelRateControl::initializeFrom(cModule *macModule)
+{
+    RateControlBase::initializeFrom(macModule);
+    updateInterval = macModule->par("minstrelUpdateInterval");
+    ewmaWeight = macModule->par("minstrelEwmaWeight");
+    lookAroundRatio = macModule->par("minstrelLookAroundRatio");
+    minProbability = macModule->par("minstrelMinProbability");
+    if (updateInterval <= 0)
+        throw cRuntimeError("MinstrelRateControl: minstrelUpdateInterval must be positive");
+    if (ewmaWeight < 0 || ewmaWeight >= 1 || lookAroundRatio < 0 || lookAroundRatio > 1)
+        throw cRuntimeError("MinstrelRateControl: minstrelEwmaWeight must be in [0,1), minstrelLookAroundRatio in [0,1]");
+}
+
+MinstrelRateControl::StationInfo& MinstrelRateControl::getStationInfo(const MACAddress& receiver)
+{
+    StationTable::iterator it = stations.find(receiver);
+    if (it == stations.end())
+    {
+        StationInfo& station = stations[receiver];
+        RateStats stats;
+        stats.attempts = stats.successes = 0;
+        stats.hasProbability = false;
+        stats.probability = stats.throughput = 0;
+        station.rates.assign(bitrates.size(), stats);
+        station.nextUpdate = simTime() + updateInterval;
+        // start from the top, like a fixed bitrate MAC would
+        station.maxThroughputIndex = getMaxRateIndex();
+        station.secondThroughputIndex = std::max(getMaxRateIndex() - 1, 0);
+        station.maxProbabilityIndex = 0;
+        station.isSampling = false;
+        return station;
+    }
+
+    StationInfo& station = it->second;
+    if (simTime() >= station.nextUpdate)
+        updateStats(station);
+    return station;
+}
+
+double MinstrelRateControl::getBitrate(const MACAddress& receiver, int retryCount)
+{
+    StationInfo& station = getStationInfo(receiver);
+    int rateIndex;
+    if (retryCount == 0)
+    {
+        int sampleIndex = dblrand() < lookAroundRatio ? chooseSampleRate(station) : -1;
+        station.isSampling = sampleIndex != -1;
+        rateIndex = station.isSampling ? sampleIndex : station.maxThroughputIndex;
+    }
+    else if (retryCount == 1)
+        rateIndex = station.isSampling ? station.maxThroughputIndex : station.secondThroughputIndex;
+    else if (retryCount == 2)
+        rateIndex = station.maxProbabilityIndex;
+    else
+        rateIndex = 0;
+    return bitrates[rateIndex];
+}
+
+void MinstrelRateControl::reportAttempt(const MACAddress& receiver, double bitrate, int numFrames, int numAcked)
+{
+    RateStats& stats = getStationInfo(receiver).rates[getRateIndex(bitrate)];
+    stats.attempts += numFrames;
+    stats.successes += numAcked;
+}
+
+void MinstrelRateControl::updateStats(StationInfo& station)
+{
+    int n = station.rates.size();
+    for (int i = 0; i < n; i++)
+    {
+        RateStats& stats = station.rates[i];
+        if (stats.attempts > 0)
+        {
+            double p = (double)stats.successes / stats.attempts;
+            stats.probability = stats.hasProbability ? ewmaWeight * stats.probability + (1 - ewmaWeight) * p : p;
+            stats.hasProbability = true;
+            stats.attempts = stats.successes = 0;
+        }
+        stats.throughput = stats.probability < minProbability ? 0 : stats.probability * getIdealThroughput(i);
+    }
+
+    // keep the current choice until some bitrate has proven to work
+    int best = -1, second = -1, mostReliable = -1;
+    for (int i = 0; i < n; i++)
+    {
+        const RateStats& stats = station.rates[i];
+        if (!stats.hasProbability)
+            continue;
+        if (best == -1 || stats.throughput > station.rates[best].throughput)
+        {
+            second = best;
+            best = i;
+        }
+        else if (second == -1 || stats.throughput > station.rates[second].throughput)
+            second = i;
+        if (mostReliable == -1 || stats.probability >= station.rates[mostReliable].probability)
+            mostReliable = i;
+    }
+    if (best != -1 && station.rates[best].throughput > 0)
+    {
+        station.maxThroughputIndex = best;
+        station.secondThroughputIndex = second != -1 ? second : best;
+        station.maxProbabilityIndex = mostReliable;
+    }
+
+    simtime_t now = simTime();
+    station.nextUpdate += updateInterval;
+    if (station.nextUpdate <= now)
+        station.nextUpdate = now + updateInterval;
+}
+
+double MinstrelRateControl::getIdealThroughput(int rateIndex)
+{
+    const double frameBits = 1200 * 8;
+    return frameBits / (frameBits / bitrates[rateIndex] + PHY_HEADER_LENGTH / BITRATE_HEADER);
+}
+
+int MinstrelRateControl::chooseSampleRate(StationInfo& station)
+{
+    // only bitrates which could beat the current best are worth a sample
+    double bestThroughput = station.rates[station.maxThroughputIndex].throughput;
+    std::vector<int> candidates;
+    for (int i = 0; i < (int)station.rates.size(); i++)
+        if (i != station.maxThroughputIndex && getIdealThroughput(i) > bestThroughput)
+            candidates.push_back(i);
+    return candidates.empty() ? -1 : candidates[intrand(candidates.size())];
+}
@@ -0,0 +1,89 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IEEE80211_MINSTRELRATECONTROL_H
+#define IEEE80211_MINSTRELRATECONTROL_H
+
+#include <map>
+#include "RateControlBase.h"
+
+
+/**
+ * Sampling based rate control after Linux's Minstrel. For each receiver
+ * and bitrate, the success probability of attempts is averaged over
+ * updateInterval periods with an exponentially weighted moving average,
+ * and the expected throughput is derived from it. Frames go out at the
+ * bitrate with the best expected throughput; retries fall back to the
+ * second best, then to the most reliable bitrate, then to the lowest one.
+ * A lookAroundRatio fraction of the first attempts samples another
+ * bitrate which could do better than the current best.
+ *
+ * Statistics are updated lazily when the receiver is next used, so there
+ * are no timers and an idle receiver costs nothing.
+ */
+class INET_API MinstrelRateControl : public RateControlBase
+{
+  protected:
+    struct RateStats {
+        int attempts;           // in the current interval
+        int successes;          // in the current interval
+        bool hasProbability;    // false until the first attempt
+        double probability;     // EWMA of the success probability
+        double throughput;      // expected throughput at that probability
+    };
+
+    struct StationInfo {
+        std::vector<RateStats> rates;
+        simtime_t nextUpdate;
+        int maxThroughputIndex;
+        int secondThroughputIndex;
+        int maxProbabilityIndex;
+        bool isSampling;        // the current frame's first attempt is a sample
+    };
+    typedef std::map<MACAddress, StationInfo, MAC_compare> StationTable;
+    StationTable stations;
+
+    simtime_t updateInterval;
+    double ewmaWeight;          // weight of the old average
+    double lookAroundRatio;
+    double minProbability;      // below this, a bitrate's throughput is taken as 0
+
+  public:
+    /**
+     * Parameters read from the MAC module: those of RateControlBase, plus
+     * minstrelUpdateInterval, minstrelEwmaWeight, minstrelLookAroundRatio
+     * and minstrelMinProbability.
+     */
+    virtual void initializeFrom(cModule *macModule);
+
+    virtual double getBitrate(const MACAddress& receiver, int retryCount);
+
+    virtual void reportAttempt(const MACAddress& receiver, double bitrate, int numFrames, int numAcked);
+
+  protected:
+    /** Returns the state kept for the receiver, creating it if needed, with up-to-date statistics */
+    virtual StationInfo& getStationInfo(const MACAddress& receiver);
+
+    /** Folds the attempts of the last interval into the averages and reselects the retry chain */
+    virtual void updateStats(StationInfo& station);
+
+    /** Throughput at the bitrate if every attempt succeeded, for a typical 1200 byte frame */
+    virtual double getIdealThroughput(int rateIndex);
+
+    /** Chooses a bitrate to sample, or returns -1 */
+    virtual int chooseSampleRate(StationInfo& station);
+};
+
+#endif
@@ -0,0 +1,38 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "RateControlBase.h"
+
+
+static const double ieee80211bBitrates[] = {1E+6, 2E+6, 5.5E+6, 11E+6};
+
+
+void RateControlBase::initializeFrom(cModule *macModule)
+{
+    double maxBitrate = macModule->par("bitrate");
+    bitrates.clear();
+    for (unsigned int i = 0; i < sizeof(ieee80211bBitrates) / sizeof(ieee80211bBitrates[0]); i++)
+        if (ieee80211bBitrates[i] < maxBitrate)
+            bitrates.push_back(ieee80211bBitrates[i]);
+    bitrates.push_back(maxBitrate);
+}
+
+int RateControlBase::getRateIndex(double bitrate) const
+{
+    int i = getMaxRateIndex();
+    while (i > 0 && bitrates[i] > bitrate)
+        i--;
+    return i;
+}
@@ -0,0 +1,51 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IEEE80211_RATECONTROLBASE_H
+#define IEEE80211_RATECONTROLBASE_H
+
+#include <vector>
+#include "IRateControl.h"
+
+
+/**
+ * Base class for rate control algorithms: keeps the bitrates to choose
+ * from, the 802.11b bitrates up to the bitrate parameter of the MAC.
+ */
+class INET_API RateControlBase : public IRateControl
+{
+  protected:
+    struct MAC_compare {
+        bool operator()(const MACAddress& u1, const MACAddress& u2) const {return u1.compareTo(u2) < 0;}
+    };
+
+    /** Usable bitrates in ascending order */
+    std::vector<double> bitrates;
+
+  public:
+    /**
+     * Parameters read from the MAC module: bitrate (the highest one used).
+     */
+    virtual void initializeFrom(cModule *macModule);
+
+  protected:
+    /** Index of the highest bitrate */
+    int getMaxRateIndex() const {return bitrates.size() - 1;}
+
+    /** Index of the given bitrate, or of the highest one not above it */
+    int getRateIndex(double bitrate) const;
+};
+
+#endif
@@ -0,0 +1,194 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include "Ieee80211BeaconScheduler.h"
+
+
+Define_Module(Ieee80211BeaconScheduler);
+
+static bool compareReceptionTime(const Ieee80211BeaconScheduler::ReceivedBeacon& a, const Ieee80211BeaconScheduler::ReceivedBeacon& b)
+{
+    return a.time < b.time;
+}
+
+Ieee80211BeaconScheduler::Ieee80211BeaconScheduler()
+{
+    cc = NULL;
+}
+
+Ieee80211BeaconScheduler *Ieee80211BeaconScheduler::get()
+{
+    Ieee80211BeaconScheduler *scheduler = dynamic_cast<Ieee80211BeaconScheduler *>(simulation.getModuleByPath("beaconScheduler"));
+    if (!scheduler)
+        throw cRuntimeError("Could not find Ieee80211BeaconScheduler module (it should be called beaconScheduler)");
+    return scheduler;
+}
+
+void Ieee80211BeaconScheduler::initialize()
+{
+    cc = ChannelControl::get();
+    beaconRange = par("beaconRange");
+    pMax = cc->par("pMax");
+    alpha = cc->par("alpha");
+    waveLength = 300000000.0 / (double) cc->par("carrierFrequency");
+
+    numBeaconsDelivered = 0;
+    WATCH(numBeaconsDelivered);
+}
+
+void Ieee80211BeaconScheduler::handleMessage(cMessage *msg)
+{
+    error("This module does not process messages");
+}
+
+void Ieee80211BeaconScheduler::finish()
+{
+    recordScalar("beacons delivered", numBeaconsDelivered);
+}
+
+void Ieee80211BeaconScheduler::registerAP(const MACAddress& address, cModule *host, const Ieee80211BeaconFrameBody& body, simtime_t firstBeaconTime)
+{
+    Enter_Method("registerAP(%s)", address.str().c_str());
+
+    if (aps.find(address) != aps.end())
+        error("registerAP(): AP with address %s already registered", address.str().c_str());
+    ChannelControl::HostRef hostRef = cc->lookupHost(host);
+    if (!hostRef)
+        error("registerAP(): host %s of AP %s not registered with ChannelControl", host->getFullPath().c_str(), address.str().c_str());
+
+    APEntry& ap = aps[address];
+    ap.address = address;
+    ap.hostRef = hostRef;
+    ap.channel = body.getChannelNumber();
+    ap.firstBeaconTime = firstBeaconTime;
+    ap.body = body;
+    addToChannelIndex(&ap);
+}
+
+void Ieee80211BeaconScheduler::updateAPChannel(const MACAddress& address, int channel)
+{
+    Enter_Method("updateAPChannel(%s, %d)", address.str().c_str(), channel);
+
+    APMap::iterator it = aps.find(address);
+    if (it == aps.end())
+        error("updateAPChannel(): AP with address %s not registered", address.str().c_str());
+
+    APEntry *ap = &it->second;
+    if (ap->channel == channel)
+        return;
+    removeFromChannelIndex(ap);
+    ap->channel = channel;
+    ap->body.setChannelNumber(channel);
+    addToChannelIndex(ap);
+}
+
+void Ieee80211BeaconScheduler::addToChannelIndex(APEntry *ap)
+{
+    if (ap->channel < 0)
+        return;  // channel not yet known
+    if (ap->channel >= (int)apsByChannel.size())
+        apsByChannel.resize(ap->channel + 1);
+    apsByChannel[ap->channel].push_back(ap);
+}
+
+void Ieee80211BeaconScheduler::removeFromChannelIndex(APEntry *ap)
+{
+    if (ap->channel < 0 || ap->channel >= (int)apsByChannel.size())
+        return;
+    APVector& v = apsByChannel[ap->channel];
+    APVector::iterator it = std::find(v.begin(), v.end(), ap);
+    if (it != v.end())
+        v.erase(it);
+}
+
+ChannelControl::HostRef Ieee80211BeaconScheduler::lookupStation(cModule *staHost)
+{
+    HostRefMap::iterator it = stationHostRefs.find(staHost);
+    if (it != stationHostRefs.end())
+        return it->second;
+
+    ChannelControl::HostRef hostRef = cc->lookupHost(staHost);
+    if (!hostRef)
+        error("host %s not registered with ChannelControl", staHost->getFullPath().c_str());
+    stationHostRefs[staHost] = hostRef;
+    return hostRef;
+}
+
+simtime_t Ieee80211BeaconScheduler::getNextBeaconTime(const APEntry *ap, simtime_t t)
+{
+    if (t <= ap->firstBeaconTime)
+        return ap->firstBeaconTime;
+    simtime_t beaconInterval = ap->body.getBeaconInterval();
+    double n = ceil((t - ap->firstBeaconTime) / beaconInterval);
+    return ap->firstBeaconTime + n * beaconInterval;
+}
+
+double Ieee80211BeaconScheduler::computeRxPower(double distance)
+{
+    if (distance < 1.0)
+        distance = 1.0;  // keep the estimate finite for co-located hosts
+    return pMax * waveLength * waveLength / (16.0 * M_PI * M_PI * pow(distance, alpha));
+}
+
+void Ieee80211BeaconScheduler::collectBeacons(cModule *staHost, int channel, simtime_t from, simtime_t to, ReceivedBeaconList& beacons)
+{
+    Enter_Method_Silent();
+
+    if (channel < 0 || channel >= (int)apsByChannel.size() || from >= to)
+        return;
+
+    ChannelControl::HostRef staRef = lookupStation(staHost);
+    const Coord& staPos = cc->getHostPosition(staRef);
+    double range = beaconRange >= 0 ? beaconRange : cc->getCommunicationRange(staRef);
+    double sqrRange = range * range;
+
+    size_t first = beacons.size();
+    const APVector& v = apsByChannel[channel];
+    for (APVector::const_iterator it = v.begin(); it != v.end(); ++it)
+    {
+        const APEntry *ap = *it;
+        double sqrDistance = staPos.sqrdist(cc->getHostPosition(ap->hostRef));
+        if (sqrDistance > sqrRange)
+            continue;
+        simtime_t t = getNextBeaconTime(ap, from);
+        if (t >= to)
+            continue;
+
+        ReceivedBeacon beacon;
+        beacon.time = t;
+        beacon.rxPower = computeRxPower(sqrt(sqrDistance));
+        beacon.ap = ap;
+        beacons.push_back(beacon);
+    }
+    std::stable_sort(beacons.begin() + first, beacons.end(), compareReceptionTime);
+    numBeaconsDelivered += beacons.size() - first;
+}
+
+bool Ieee80211BeaconScheduler::isBeaconReceived(cModule *staHost, const MACAddress& apAddress)
+{
+    Enter_Method_Silent();
+
+    APMap::iterator it = aps.find(apAddress);
+    if (it == aps.end())
+        return false;
+    const APEntry *ap = &it->second;
+
+    ChannelControl::HostRef staRef = lookupStation(staHost);
+    if (cc->getHostChannel(staRef) != ap->channel)
+        return false;
+    double range = beaconRange >= 0 ? beaconRange : cc->getCommunicationRange(staRef);
+    return cc->getHostPosition(staRef).sqrdist(cc->getHostPosition(ap->hostRef)) <= range * range;
+}
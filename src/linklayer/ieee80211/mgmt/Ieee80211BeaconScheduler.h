@@ -0,0 +1,120 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IEEE80211_BEACON_SCHEDULER_H
+#define IEEE80211_BEACON_SCHEDULER_H
+
+#include <omnetpp.h>
+#include <map>
+#include <vector>
+#include "INETDefs.h"
+#include "MACAddress.h"
+#include "ChannelControl.h"
+#include "Ieee80211MgmtFrames_m.h"
+
+
+/**
+ * Shared beacon schedule of the access points in the network.
+ * See the NED file for a detailed description.
+ */
+class INET_API Ieee80211BeaconScheduler : public cSimpleModule
+{
+  public:
+    /** An access point as STAs would learn it from its beacons */
+    struct APEntry
+    {
+        MACAddress address;
+        ChannelControl::HostRef hostRef;
+        int channel;
+        simtime_t firstBeaconTime;   // beacons follow every beaconInterval
+        Ieee80211BeaconFrameBody body;
+    };
+
+    /** A beacon a STA would have received */
+    struct ReceivedBeacon
+    {
+        simtime_t time;
+        double rxPower;
+        const APEntry *ap;
+    };
+    typedef std::vector<ReceivedBeacon> ReceivedBeaconList;
+
+  protected:
+    struct MAC_compare {
+        bool operator()(const MACAddress& u1, const MACAddress& u2) const {return u1.compareTo(u2) < 0;}
+    };
+    typedef std::map<MACAddress, APEntry, MAC_compare> APMap;
+    typedef std::vector<APEntry *> APVector;
+    typedef std::map<cModule *, ChannelControl::HostRef> HostRefMap;
+
+    ChannelControl *cc;
+    double beaconRange;
+    double pMax;        // free-space received power estimate: pMax * waveLength^2 / (16 * pi^2 * d^alpha)
+    double alpha;
+    double waveLength;
+
+    APMap aps;
+    std::vector<APVector> apsByChannel;  // index: channel number
+    HostRefMap stationHostRefs;          // lookup cache, ChannelControl::lookupHost() is linear
+
+    long numBeaconsDelivered;
+
+  public:
+    Ieee80211BeaconScheduler();
+
+    /** Finds the beaconScheduler module in the network */
+    static Ieee80211BeaconScheduler *get();
+
+    /**
+     * Registers an AP that sends a beacon with the given contents at
+     * firstBeaconTime and then every body.getBeaconInterval(). The AP's
+     * host must be registered with ChannelControl (i.e. have a mobility module).
+     */
+    virtual void registerAP(const MACAddress& address, cModule *host, const Ieee80211BeaconFrameBody& body, simtime_t firstBeaconTime);
+
+    /** To be called when a registered AP switches channel */
+    virtual void updateAPChannel(const MACAddress& address, int channel);
+
+    /**
+     * Appends the beacons the STA in staHost would have received on the given
+     * channel in the [from,to) interval to the list, in order of reception.
+     */
+    virtual void collectBeacons(cModule *staHost, int channel, simtime_t from, simtime_t to, ReceivedBeaconList& beacons);
+
+    /**
+     * Returns true if the STA in staHost currently receives the beacons of
+     * the given AP, that is, they are on the same channel and within range.
+     */
+    virtual bool isBeaconReceived(cModule *staHost, const MACAddress& apAddress);
+
+  protected:
+    virtual void initialize();
+    virtual void handleMessage(cMessage *msg);
+    virtual void finish();
+
+    /** Returns the STA's handle in ChannelControl */
+    virtual ChannelControl::HostRef lookupStation(cModule *staHost);
+
+    /** Returns the first beacon time of the AP at or after t */
+    virtual simtime_t getNextBeaconTime(const APEntry *ap, simtime_t t);
+
+    /** Returns the estimated received power at the given distance (mW) */
+    virtual double computeRxPower(double distance);
+
+    virtual void removeFromChannelIndex(APEntry *ap);
+    virtual void addToChannelIndex(APEntry *ap);
+};
+
+#endif
@@ -56,9 +56,26 @@ void Ieee80211MgmtAP::initialize(int stage)
         NotificationBoard *nb = NotificationBoardAccess().get();
         nb->subscribe(this, NF_RADIO_CHANNEL_CHANGED);
 
-        // start beacon timer (randomize startup time)
-        beaconTimer = new cMessage("beaconTimer");
-        scheduleAt(simTime()+uniform(0,beaconInterval), beaconTimer);
+        // start beacon timer (randomize startup time), unless beacons are shared
+        beaconTimer = NULL;
+        beaconScheduler = NULL;
+        if (!par("sharedBeacons").boolValue())
+        {
+            beaconTimer = new cMessage("beaconTimer");
+            scheduleAt(simTime()+uniform(0,beaconInterval), beaconTimer);
+        }
+    }
+    else if (stage==1)
+    {
+        if (par("sharedBeacons").boolValue())
+        {
+            // register in stage 1, when our host is already known to ChannelControl
+            Ieee80211BeaconFrameBody body;
+            fillBeaconFrameBody(body);
+            cModule *host = NotificationBoardAccess().get()->getParentModule();
+            beaconScheduler = Ieee80211BeaconScheduler::get();
+            beaconScheduler->registerAP(myAddress, host, body, simTime()+uniform(0,beaconInterval));
+        }
     }
 }
 
@@ -109,6 +126,8 @@ void Ieee80211MgmtAP::receiveChangeNotification(int category, const cPolymorphic
     {
         EV << "updating channel number\n";
         channelNumber = check_and_cast<RadioState *>(details)->getChannelNumber();
+        if (beaconScheduler)
+            beaconScheduler->updateAPChannel(myAddress, channelNumber);
     }
 }
 
@@ -126,15 +145,19 @@ void Ieee80211MgmtAP::sendManagementFrame(Ieee80211ManagementFrame *frame, const
     sendOrEnqueue(frame);
 }
 
-void Ieee80211MgmtAP::sendBeacon()
+void Ieee80211MgmtAP::fillBeaconFrameBody(Ieee80211BeaconFrameBody& body)
 {
-    EV << "Sending beacon\n";
-    Ieee80211BeaconFrame *frame = new Ieee80211BeaconFrame("Beacon");
-    Ieee80211BeaconFrameBody& body = frame->getBody();
     body.setSSID(ssid.c_str());
     body.setSupportedRates(supportedRates);
     body.setBeaconInterval(beaconInterval);
     body.setChannelNumber(channelNumber);
+}
+
+void Ieee80211MgmtAP::sendBeacon()
+{
+    EV << "Sending beacon\n";
+    Ieee80211BeaconFrame *frame = new Ieee80211BeaconFrame("Beacon");
+    fillBeaconFrameBody(frame->getBody());
 
     frame->setReceiverAddress(MACAddress::BROADCAST_ADDRESS);
     frame->setFromDS(true);
@@ -22,6 +22,7 @@
 #include <map>
 #include "Ieee80211MgmtAPBase.h"
 #include "NotificationBoard.h"
+#include "Ieee80211BeaconScheduler.h"
 
 
 /**
@@ -61,6 +62,7 @@ class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
     // state
     STAList staList; ///< list of STAs
     cMessage *beaconTimer;
+    Ieee80211BeaconScheduler *beaconScheduler; // if non-NULL, beacons are delivered through it instead of frames
 
   protected:
     virtual int numInitStages() const {return 2;}
@@ -84,6 +86,9 @@ class INET_API Ieee80211MgmtAP : public Ieee80211MgmtAPBase
     /** Utility function: set fields in the given frame and send it out to the address */
     virtual void sendManagementFrame(Ieee80211ManagementFrame *frame, const MACAddress& destAddr);
 
+    /** Utility function: fills in the contents of a beacon */
+    virtual void fillBeaconFrameBody(Ieee80211BeaconFrameBody& body);
+
     /** Utility function: creates and sends a beacon frame */
     virtual void sendBeacon();
 
@@ -101,6 +101,14 @@ void Ieee80211MgmtSTA::initialize(int stage)
         cModule *cc = ChannelControl::get();
         numChannels = cc->par("numChannels");
 
+        beaconScheduler = NULL;
+        host = NULL;
+        if (par("sharedBeacons").boolValue())
+        {
+            beaconScheduler = Ieee80211BeaconScheduler::get();
+            host = nb->getParentModule();
+        }
+
         WATCH(isScanning);
         WATCH(isAssociated);
 
@@ -166,6 +174,13 @@ void Ieee80211MgmtSTA::handleTimer(cMessage *msg)
     }
     else if (msg->getKind()==MK_BEACON_TIMEOUT)
     {
+        if (beaconScheduler && beaconScheduler->isBeaconReceived(host, assocAP.address))
+        {
+            // shared beacons: AP still in range, as if its beacons had restarted the timer
+            scheduleAt(simTime()+MAX_BEACONS_MISSED*assocAP.beaconInterval, assocAP.beaconTimeoutMsg);
+            return;
+        }
+
         // missed a few consecutive beacons
         beaconLost();
     }
@@ -223,10 +238,8 @@ Ieee80211DataFrame *Ieee80211MgmtSTA::encapsulate(cPacket *msg)
 
 Ieee80211MgmtSTA::APInfo *Ieee80211MgmtSTA::lookupAP(const MACAddress& address)
 {
-    for (AccessPointList::iterator it=apList.begin(); it!=apList.end(); ++it)
-        if (it->address == address)
-            return &(*it);
-    return NULL;
+    AccessPointIndex::iterator it = apIndex.find(address);
+    return it==apIndex.end() ? NULL : it->second;
 }
 
 void Ieee80211MgmtSTA::clearAPList()
@@ -235,6 +248,7 @@ void Ieee80211MgmtSTA::clearAPList()
         if (it->authTimeoutMsg)
             delete cancelEvent(it->authTimeoutMsg);
     apList.clear();
+    apIndex.clear();
 }
 
 void Ieee80211MgmtSTA::changeChannel(int channelNum)
@@ -382,6 +396,10 @@ void Ieee80211MgmtSTA::processScanCommand(Ieee80211Prim_ScanRequest *ctrl)
 
 bool Ieee80211MgmtSTA::scanNextChannel()
 {
+    // pick up the shared beacons of the channel we're leaving
+    if (beaconScheduler && scanning.currentChannelIndex>=0)
+        collectSharedBeacons();
+
     // if we're already at the last channel, we're through
     if (scanning.currentChannelIndex==(int)scanning.channelList.size()-1)
     {
@@ -396,6 +414,7 @@ bool Ieee80211MgmtSTA::scanNextChannel()
     int newChannel = scanning.channelList[++scanning.currentChannelIndex];
     changeChannel(newChannel);
     scanning.busyChannelDetected = false;
+    scanning.channelStartTime = simTime();
 
     if (scanning.activeScan)
     {
@@ -413,6 +432,20 @@ bool Ieee80211MgmtSTA::scanNextChannel()
     return false;
 }
 
+void Ieee80211MgmtSTA::collectSharedBeacons()
+{
+    int channel = scanning.channelList[scanning.currentChannelIndex];
+    Ieee80211BeaconScheduler::ReceivedBeaconList beacons;
+    beaconScheduler->collectBeacons(host, channel, scanning.channelStartTime, simTime(), beacons);
+
+    EV << "Received " << beacons.size() << " shared beacons on channel #" << channel << "\n";
+    for (int i=0; i<(int)beacons.size(); i++)
+    {
+        APInfo *ap = storeAPInfo(beacons[i].ap->address, beacons[i].ap->body);
+        ap->rxPower = beacons[i].rxPower;
+    }
+}
+
 void Ieee80211MgmtSTA::sendProbeRequest()
 {
     EV << "Sending Probe Request, BSSID=" << scanning.bssid << ", SSID=\"" << scanning.ssid << "\"\n";
@@ -760,6 +793,14 @@ void Ieee80211MgmtSTA::handleDisassociationFrame(Ieee80211DisassociationFrame *f
 void Ieee80211MgmtSTA::handleBeaconFrame(Ieee80211BeaconFrame *frame)
 {
     EV << "Received Beacon frame\n";
+
+    // outside scanning, only beacons of our AP are of interest
+    if (!isScanning && !(isAssociated && frame->getTransmitterAddress()==assocAP.address))
+    {
+        delete frame;
+        return;
+    }
+
     storeAPInfo(frame->getTransmitterAddress(), frame->getBody());
 
     // if it is out associate AP, restart beacon timeout
@@ -789,7 +830,7 @@ void Ieee80211MgmtSTA::handleProbeResponseFrame(Ieee80211ProbeResponseFrame *fra
     delete frame;
 }
 
-void Ieee80211MgmtSTA::storeAPInfo(const MACAddress& address, const Ieee80211BeaconFrameBody& body)
+Ieee80211MgmtSTA::APInfo *Ieee80211MgmtSTA::storeAPInfo(const MACAddress& address, const Ieee80211BeaconFrameBody& body)
 {
     APInfo *ap = lookupAP(address);
     if (ap)
@@ -801,6 +842,7 @@ void Ieee80211MgmtSTA::storeAPInfo(const MACAddress& address, const Ieee80211Bea
         EV << "Inserting AP address=" << address << ", SSID=" << body.getSSID() << " into our AP list\n";
         apList.push_back(APInfo());
         ap = &apList.back();
+        apIndex[address] = ap;
     }
 
     ap->channel = body.getChannelNumber();
@@ -811,5 +853,7 @@ void Ieee80211MgmtSTA::storeAPInfo(const MACAddress& address, const Ieee80211Bea
 
     //XXX where to get this from?
     //ap->rxPower = ...
+
+    return ap;
 }
 
@@ -19,9 +19,11 @@
 #define IEEE80211_MGMT_STA_H
 
 #include <omnetpp.h>
+#include <map>
 #include "Ieee80211MgmtBase.h"
 #include "NotificationBoard.h"
 #include "Ieee80211Primitives_m.h"
+#include "Ieee80211BeaconScheduler.h"
 
 
 /**
@@ -47,6 +49,7 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
         bool busyChannelDetected; // during minChannelTime, we have to listen for busy channel
         simtime_t minChannelTime; // minimum time to spend on each channel when scanning
         simtime_t maxChannelTime; // maximum time to spend on each channel when scanning
+        simtime_t channelStartTime; // when we tuned to the current channel
     };
 
     //
@@ -82,6 +85,10 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
         AssociatedAPInfo() : APInfo() {receiveSequence=0; beaconTimeoutMsg=NULL;}
     };
 
+    struct MAC_compare {
+        bool operator()(const MACAddress& u1, const MACAddress& u2) const {return u1.compareTo(u2) < 0;}
+    };
+
   protected:
     NotificationBoard *nb;
 
@@ -95,7 +102,13 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
     // APInfo list: we collect scanning results and keep track of ongoing authentications here
     // Note: there can be several ongoing authentications simultaneously
     typedef std::list<APInfo> AccessPointList;
-    AccessPointList apList;
+    AccessPointList apList;  // in order of discovery; elements are referenced from timers
+    typedef std::map<MACAddress, APInfo *, MAC_compare> AccessPointIndex;
+    AccessPointIndex apIndex; // apList by address
+
+    // if non-NULL: beacons are obtained from the shared beacon scheduler, not from frames
+    Ieee80211BeaconScheduler *beaconScheduler;
+    cModule *host;
 
     // associated Access Point
     bool isAssociated;
@@ -133,8 +146,11 @@ class INET_API Ieee80211MgmtSTA : public Ieee80211MgmtBase
     /** Utility function: switches to the given radio channel. */
     virtual void changeChannel(int channelNum);
 
-    /** Stores AP info received in a beacon or probe response */
-    virtual void storeAPInfo(const MACAddress& address, const Ieee80211BeaconFrameBody& body);
+    /** Stores AP info received in a beacon or probe response, and returns the AP list entry */
+    virtual APInfo *storeAPInfo(const MACAddress& address, const Ieee80211BeaconFrameBody& body);
+
+    /** Stores the APs whose shared beacons we would have received on the current channel while scanning it */
+    virtual void collectSharedBeacons();
 
     /** Switches to the next channel to scan; returns true if done (there wasn't any more channel to scan). */
     virtual bool scanNextChannel();
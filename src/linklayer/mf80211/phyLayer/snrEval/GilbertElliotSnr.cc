@@ -136,13 +136,15 @@ void GilbertElliotSnr::handleLowerMsgStart(AirFrame * frame)
 {
     // Calculate the receive power of the message
 
-    // calculate distance
-    const Coord& myPos = getMyPosition();
-    const Coord& framePos = frame->getSenderPos();
-    double distance = myPos.distance(framePos);
-
-    // receive power
-    double rcvdPower = calcRcvdPower(frame->getPSend(), distance);
+    // receive power: precomputed by ChannelControl, or calculated from the distance
+    double rcvdPower = frame->getRcvdPower();
+    if (rcvdPower < 0)
+    {
+        const Coord& myPos = getMyPosition();
+        const Coord& framePos = frame->getSenderPos();
+        double distance = myPos.distance(framePos);
+        rcvdPower = calcRcvdPower(frame->getPSend(), distance);
+    }
 
     if (state == BAD)
         frame->setBitError(true);
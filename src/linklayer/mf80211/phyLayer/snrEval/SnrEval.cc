@@ -82,6 +82,9 @@ void SnrEval::initialize(int stage)
         // tell initial channel number to ChannelControl; should be done in
         // stage==2 or later, because base class initializes myHostRef in that stage
         cc->updateHostChannel(myHostRef, rs.getChannelNumber());
+
+        // calcRcvdPower() is the formula ChannelControl can precompute
+        cc->setHostPathLoss(myHostRef, pathLossAlpha);
     }
 }
 
@@ -270,13 +273,15 @@ void SnrEval::handleLowerMsgStart(AirFrame * frame)
 {
     // Calculate the receive power of the message
 
-    // calculate distance
-    const Coord& myPos = getMyPosition();
-    const Coord& framePos = frame->getSenderPos();
-    double distance = myPos.distance(framePos);
-
-    // calculate receive power
-    double rcvdPower = calcRcvdPower(frame->getPSend(), distance);
+    // receive power: precomputed by ChannelControl, or calculated from the distance
+    double rcvdPower = frame->getRcvdPower();
+    if (rcvdPower < 0)
+    {
+        const Coord& myPos = getMyPosition();
+        const Coord& framePos = frame->getSenderPos();
+        double distance = myPos.distance(framePos);
+        rcvdPower = calcRcvdPower(frame->getPSend(), distance);
+    }
 
     // store the receive power in the recvBuff
     recvBuff[frame] = rcvdPower;
@@ -467,7 +472,7 @@ void SnrEval::changeChannel(int channel)
     {
         AirFrame *frame = *it;
         // time for the message to reach us
-        double distance = myHostRef->pos.distance(frame->getSenderPos());
+        double distance = getMyPosition().distance(frame->getSenderPos());
         simtime_t propagationDelay = distance / LIGHT_SPEED;
 
         // if this transmission is on our new channel and it would reach us in the future, then schedule it
@@ -92,7 +92,11 @@ class INET_API SnrEval : public BasicSnrEval
     /** @brief Unbuffer the frame and update noise levels and snr information*/
     virtual void handleLowerMsgEnd(AirFrame*);
 
-    /** @brief Calculates the power with which a packet is received.*/
+    /**
+     * @brief Calculates the power with which a packet is received.
+     * ChannelControl precomputes the same value (see initialize()), so
+     * subclasses redefining this should not register with setHostPathLoss().
+     */
     virtual double calcRcvdPower(double pSend, double distance);
 
     /** Redefined from BasicSnrEval */
@@ -21,7 +21,7 @@
 #include "BasicDecider.h"
 
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? ev : ev << logName() << "::BasicDecider: "
+#define coreEV INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.isDisabled() && coreDebug) << logName() << "::BasicDecider: "
 
 Define_Module(BasicDecider);
 
@@ -23,7 +23,7 @@
 #include "TransmComplete_m.h"
 
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? ev : ev << logName() << "::BasicSnrEval: "
+#define coreEV INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.isDisabled() && coreDebug) << logName() << "::BasicSnrEval: "
 
 Define_Module(BasicSnrEval);
 
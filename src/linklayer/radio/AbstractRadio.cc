@@ -96,6 +96,11 @@ void AbstractRadio::initialize(int stage)
         // tell initial channel number to ChannelControl; should be done in
         // stage==2 or later, because base class initializes myHostRef in that stage
         cc->updateHostChannel(myHostRef, rs.getChannelNumber());
+
+        // let ChannelControl precompute the received power if it can
+        double pathLossAlpha = receptionModel->getPathLossAlpha();
+        if (pathLossAlpha >= 0)
+            cc->setHostPathLoss(myHostRef, pathLossAlpha);
     }
 }
 
@@ -392,13 +397,22 @@ void AbstractRadio::handleLowerMsgStart(AirFrame * airframe)
 {
     // Calculate the receive power of the message
 
-    // calculate distance
-    const Coord& myPos = getMyPosition();
-    const Coord& framePos = airframe->getSenderPos();
-    double distance = myPos.distance(framePos);
+    double rcvdPower;
+    if (airframe->getRcvdPower() >= 0)
+    {
+        // precomputed by ChannelControl
+        rcvdPower = receptionModel->applyRandomEffects(airframe->getRcvdPower());
+    }
+    else
+    {
+        // calculate distance
+        const Coord& myPos = getMyPosition();
+        const Coord& framePos = airframe->getSenderPos();
+        double distance = myPos.distance(framePos);
 
-    // calculate receive power
-    double rcvdPower = receptionModel->calculateReceivedPower(airframe->getPSend(), carrierFrequency, distance);
+        // calculate receive power
+        rcvdPower = receptionModel->calculateReceivedPower(airframe->getPSend(), carrierFrequency, distance);
+    }
 
     // store the receive power in the recvBuff
     recvBuff[airframe] = rcvdPower;
@@ -492,6 +506,17 @@ void AbstractRadio::handleLowerMsgEnd(AirFrame * airframe)
             airframe->getEncapsulatedMsg()->setKind(list.size()>1 ? COLLISION : BITERROR);
             airframe->setName(list.size()>1 ? "COLLISION" : "BITERROR");
         }
+
+        // tell the MAC the reception quality
+        double snirMin = list.begin()->snr;
+        for (SnrList::const_iterator iter = list.begin(); iter != list.end(); iter++)
+            if (iter->snr < snirMin)
+                snirMin = iter->snr;
+        PhyIndication *indication = new PhyIndication();
+        indication->setSnirMin(snirMin);
+        indication->setBitrate(airframe->getBitrate());
+        airframe->getEncapsulatedMsg()->setControlInfo(indication);
+
         sendUp(airframe);
     }
     // all other messages are noise
@@ -578,7 +603,7 @@ void AbstractRadio::changeChannel(int channel)
     {
         AirFrame *airframe = *it;
         // time for the message to reach us
-        double distance = myHostRef->pos.distance(airframe->getSenderPos());
+        double distance = getMyPosition().distance(airframe->getSenderPos());
         simtime_t propagationDelay = distance / LIGHT_SPEED;
 
         // if this transmission is on our new channel and it would reach us in the future, then schedule it
@@ -40,6 +40,21 @@ class INET_API IReceptionModel : public cPolymorphic
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance) = 0;
 
+    /**
+     * Models whose received power is pSend * waveLength^2 / (16 * pi^2 * distance^alpha),
+     * apart from random effects, may return alpha here; ChannelControl then
+     * precomputes that power for all receivers of a transmission, and the radio
+     * calls applyRandomEffects() on it instead of calculateReceivedPower().
+     * The default returns -1.
+     */
+    virtual double getPathLossAlpha() {return -1;}
+
+    /**
+     * Applies the random part of the model to a received power precomputed
+     * by ChannelControl (see getPathLossAlpha()). The default returns it unchanged.
+     */
+    virtual double applyRandomEffects(double rcvdPower) {return rcvdPower;}
+
     /**
      * Virtual destructor.
      */
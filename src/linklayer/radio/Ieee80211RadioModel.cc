@@ -19,6 +19,7 @@
 
 #include "Ieee80211RadioModel.h"
 #include "Ieee80211Consts.h"
+#include "Ieee80211AggregateFrame.h"
 #include "FWMath.h"
 
 
@@ -54,6 +55,17 @@ bool Ieee80211RadioModel::isReceivedCorrectly(AirFrame *airframe, const SnrList&
         EV << "COLLISION! Packet got lost\n";
         return false;
     }
+    else if (dynamic_cast<Ieee80211AggregateFrame *>(frame) && ((Ieee80211AggregateFrame *)frame)->getAmpdu())
+    {
+        // subframes of an A-MPDU are checked one by one, the MAC acknowledges the good ones
+        if (isAggregateOK(snirMin, (Ieee80211AggregateFrame *)frame, airframe->getBitrate()))
+        {
+            EV << "A-MPDU was received, correct subframes are handed to upper layer...\n";
+            return true;
+        }
+        EV << "All subframes of the A-MPDU have BIT ERRORS! It is lost!\n";
+        return false;
+    }
     else if (isPacketOK(snirMin, airframe->getEncapsulatedMsg()->getBitLength(), airframe->getBitrate()))
     {
         EV << "packet was received correctly, it is now handed to upper layer...\n";
@@ -67,10 +79,8 @@ bool Ieee80211RadioModel::isReceivedCorrectly(AirFrame *airframe, const SnrList&
 }
 
 
-bool Ieee80211RadioModel::isPacketOK(double snirMin, int lengthMPDU, double bitrate)
+void Ieee80211RadioModel::computeBitErrorRates(double snirMin, double bitrate, double& berHeader, double& berMPDU)
 {
-    double berHeader, berMPDU;
-
     berHeader = 0.5 * exp(-snirMin * BANDWIDTH / BITRATE_HEADER);
 
     // if PSK modulation
@@ -81,6 +91,12 @@ bool Ieee80211RadioModel::isPacketOK(double snirMin, int lengthMPDU, double bitr
         berMPDU = 0.5 * (1 - 1 / sqrt(pow(2.0, 4))) * erfc(snirMin * BANDWIDTH / bitrate);
     else                        // CCK, modelled with 256-QAM
         berMPDU = 0.25 * (1 - 1 / sqrt(pow(2.0, 8))) * erfc(snirMin * BANDWIDTH / bitrate);
+}
+
+bool Ieee80211RadioModel::isPacketOK(double snirMin, int lengthMPDU, double bitrate)
+{
+    double berHeader, berMPDU;
+    computeBitErrorRates(snirMin, bitrate, berHeader, berMPDU);
 
     // probability of no bit error in the PLCP header
     double headerNoError = pow(1.0 - berHeader, HEADER_WITHOUT_PREAMBLE);
@@ -98,6 +114,27 @@ bool Ieee80211RadioModel::isPacketOK(double snirMin, int lengthMPDU, double bitr
         return true; // no error
 }
 
+bool Ieee80211RadioModel::isAggregateOK(double snirMin, Ieee80211AggregateFrame *aggregate, double bitrate)
+{
+    double berHeader, berMPDU;
+    computeBitErrorRates(snirMin, bitrate, berHeader, berMPDU);
+    EV << "berHeader: " << berHeader << " berMPDU: " << berMPDU << endl;
+
+    // the PLCP header is shared by all subframes
+    if (dblrand() > pow(1.0 - berHeader, HEADER_WITHOUT_PREAMBLE))
+        return false;
+
+    bool anyOK = false;
+    for (unsigned int i = 0; i < aggregate->getNumSubframes(); i++)
+    {
+        double mpduNoError = pow(1.0 - berMPDU, (double)aggregate->getSubframe(i)->getBitLength());
+        bool bitError = dblrand() > mpduNoError;
+        aggregate->setSubframeBitError(i, bitError);
+        anyOK = anyOK || !bitError;
+    }
+    return anyOK;
+}
+
 double Ieee80211RadioModel::dB2fraction(double dB)
 {
     return pow(10.0, (dB / 10));
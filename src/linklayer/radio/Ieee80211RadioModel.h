@@ -21,6 +21,8 @@
 
 #include "IRadioModel.h"
 
+class Ieee80211AggregateFrame;
+
 /**
  * Radio model for IEEE 802.11. The implementation is largely based on the
  * Mobility Framework's SnrEval80211 and Decider80211 modules.
@@ -41,6 +43,10 @@ class INET_API Ieee80211RadioModel : public IRadioModel
   protected:
     // utility
     virtual bool isPacketOK(double snirMin, int lengthMPDU, double bitrate);
+    // utility: sets the bit error flags of the A-MPDU subframes, returns false if all are lost
+    virtual bool isAggregateOK(double snirMin, Ieee80211AggregateFrame *aggregate, double bitrate);
+    // utility
+    virtual void computeBitErrorRates(double snirMin, double bitrate, double& berHeader, double& berMPDU);
     // utility
     virtual double dB2fraction(double dB);
 };
@@ -35,8 +35,13 @@ double PathLossReceptionModel::calculateReceivedPower(double pSend, double carri
 {
     const double speedOfLight = 300000000.0;
     double waveLength = speedOfLight / carrierFrequency;
+    return applyRandomEffects(pSend * waveLength * waveLength / (16 * M_PI * M_PI * pow(distance, pathLossAlpha)));
+}
+
+double PathLossReceptionModel::applyRandomEffects(double mWValue)
+{
     if (shadowingDeviation == 0.0)
-        return pSend * waveLength * waveLength / (16 * M_PI * M_PI * pow(distance, pathLossAlpha));
+        return mWValue;
     else
     {
         // This code implements a shadowing component for the path loss reception model. The random
@@ -44,7 +49,6 @@ double PathLossReceptionModel::calculateReceivedPower(double pSend, double carri
         // This is a widespread and common model used for reproducing shadowing effects
         // (Rappaport, T. S. (2002), Wireless Communications - Principles and Practice, Prentice Hall PTR).
         double xs = normal(0.0, shadowingDeviation);
-        double mWValue = pSend * waveLength * waveLength / (16 * M_PI * M_PI * pow(distance, pathLossAlpha));
         double dBmValue = mW2dBm(mWValue);
         dBmValue += xs;
         double mWValueWithShadowing = pow(10.0, dBmValue/10.0);
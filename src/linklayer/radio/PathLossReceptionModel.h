@@ -41,6 +41,16 @@ class INET_API PathLossReceptionModel : public IReceptionModel
      */
     virtual double calculateReceivedPower(double pSend, double carrierFrequency, double distance);
 
+    /**
+     * Returns pathLossAlpha.
+     */
+    virtual double getPathLossAlpha() {return pathLossAlpha;}
+
+    /**
+     * Adds the shadowing component.
+     */
+    virtual double applyRandomEffects(double rcvdPower);
+
     /**
      * Convert mW to dBm.
     */
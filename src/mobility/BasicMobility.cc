@@ -24,7 +24,7 @@
 #include "FWMath.h"
 
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? (std::ostream&)ev : EV << logName() << "::BasicMobility: "
+#define coreEV INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.isDisabled() && coreDebug) << logName() << "::BasicMobility: "
 
 static int parseInt(const char *s, int defaultValue)
 {
@@ -96,7 +96,11 @@ void BasicMobility::handleMessage(cMessage * msg)
 void BasicMobility::updatePosition()
 {
     cc->updateHostPosition(myHostRef, pos);
+    positionUpdated();
+}
 
+void BasicMobility::positionUpdated()
+{
     if (ev.isGUI())
     {
         double r = cc->getCommunicationRange(myHostRef);
@@ -97,6 +97,12 @@ class INET_API BasicMobility : public BasicModule
      */
     virtual void updatePosition();
 
+    /** @brief Updates the display and fires NF_HOSTPOSITION_UPDATED; called
+     * from updatePosition(), and by models that report their movement to
+     * ChannelControl as a trajectory instead of a position.
+     */
+    virtual void positionUpdated();
+
     /** @brief Returns the width of the playground */
     virtual double getPlaygroundSizeX() const  {return cc->getPgs()->x;}
 
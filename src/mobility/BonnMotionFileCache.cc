@@ -17,14 +17,27 @@
 
 #include <fstream>
 #include <sstream>
+#include <string.h>
 #include "BonnMotionFileCache.h"
 
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32) && !defined(__CYGWIN__) && !defined(_WIN64)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define HAVE_MMAP
+#endif
 
-const BonnMotionFile::Line *BonnMotionFile::getLine(int nodeId) const
+#define BM_BINARY_MAGIC    "INETBMT"   // plus terminating zero: 8 bytes
+#define BM_BINARY_VERSION  1
+
+
+BonnMotionFile::~BonnMotionFile()
 {
-    LineList::const_iterator it = lines.begin();
-    for (int i=0; i<nodeId && it!=lines.end(); i++) it++;
-    return (it==lines.end()) ? NULL : &(*it);
+#ifdef HAVE_MMAP
+    if (mappedData)
+        munmap(mappedData, mappedSize);
+#endif
 }
 
 
@@ -46,17 +59,36 @@ void BonnMotionFileCache::deleteInstance()
     }
 }
 
+BonnMotionFileCache::~BonnMotionFileCache()
+{
+    for (BMFileMap::iterator it=cache.begin(); it!=cache.end(); ++it)
+        delete it->second;
+}
+
 const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename)
 {
     // if found, return it from cache
     BMFileMap::iterator it = cache.find(std::string(filename));
     if (it!=cache.end())
-        return &(it->second);
+        return it->second;
 
     // load and store in cache
-    BonnMotionFile& bmFile = cache[filename];
-    parseFile(filename, bmFile);
-    return &bmFile;
+    BonnMotionFile *bmFile = new BonnMotionFile();
+    if (isBinaryFile(filename))
+        loadBinaryFile(filename, *bmFile);
+    else
+        parseFile(filename, *bmFile);
+    cache[filename] = bmFile;
+    return bmFile;
+}
+
+bool BonnMotionFileCache::isBinaryFile(const char *filename)
+{
+    char magic[8];
+    std::ifstream in(filename, std::ios::in|std::ios::binary);
+    if (in.fail())
+        opp_error("Cannot open file '%s'",filename);
+    return in.read(magic, sizeof(magic)) && memcmp(magic, BM_BINARY_MAGIC, sizeof(magic))==0;
 }
 
 void BonnMotionFileCache::parseFile(const char *filename, BonnMotionFile& bmFile)
@@ -65,19 +97,96 @@ void BonnMotionFileCache::parseFile(const char *filename, BonnMotionFile& bmFile
     if (in.fail())
         opp_error("Cannot open file '%s'",filename);
 
+    // all numbers go into one array; lines are set up afterwards,
+    // because the array may be reallocated while growing
+    std::vector<size_t> lineStarts;
     std::string line;
     while (std::getline(in, line))
     {
-        bmFile.lines.push_back(BonnMotionFile::Line());
-        BonnMotionFile::Line& vec = bmFile.lines.back();
-
+        lineStarts.push_back(bmFile.values.size());
         std::stringstream linestream(line);
         double d;
         while (linestream >> d)
-            vec.push_back(d);
+            bmFile.values.push_back(d);
     }
     in.close();
+
+    lineStarts.push_back(bmFile.values.size());
+    const double *base = bmFile.values.empty() ? NULL : &bmFile.values[0];
+    bmFile.lines.reserve(lineStarts.size()-1);
+    for (unsigned int i=0; i+1<lineStarts.size(); i++)
+        bmFile.lines.push_back(BonnMotionFile::Line(base+lineStarts[i], lineStarts[i+1]-lineStarts[i]));
+}
+
+static uint32 readLE32(const unsigned char *p)
+{
+    return p[0] | (p[1]<<8) | (p[2]<<16) | ((uint32)p[3]<<24);
+}
+
+static uint64 readLE64(const unsigned char *p)
+{
+    return readLE32(p) | ((uint64)readLE32(p+4)<<32);
 }
 
+void BonnMotionFileCache::loadBinaryFile(const char *filename, BonnMotionFile& bmFile)
+{
+    // the data is used in place, so it must be in the byte order of this machine
+    const uint32 one = 1;
+    if (*(const unsigned char *)&one != 1)
+        opp_error("Cannot load binary trace '%s': only supported on little-endian machines", filename);
+
+    const unsigned char *file;
+    size_t size;
+#ifdef HAVE_MMAP
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd<0 || fstat(fd, &st)<0)
+        opp_error("Cannot open file '%s'",filename);
+    size = st.st_size;
+    void *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p==MAP_FAILED)
+        opp_error("Cannot map file '%s' into memory",filename);
+    bmFile.mappedData = p;
+    bmFile.mappedSize = size;
+    file = (const unsigned char *)p;
+#else
+    // no mmap: read the file into a double array, which keeps the data aligned
+    std::ifstream in(filename, std::ios::in|std::ios::binary);
+    if (in.fail())
+        opp_error("Cannot open file '%s'",filename);
+    in.seekg(0, std::ios::end);
+    size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    bmFile.values.resize((size+sizeof(double)-1)/sizeof(double));
+    if (size>0 && !in.read((char *)&bmFile.values[0], size))
+        opp_error("Cannot read file '%s'",filename);
+    file = (const unsigned char *)&bmFile.values[0];
+#endif
+
+    if (size<16 || memcmp(file, BM_BINARY_MAGIC, 8)!=0)
+        opp_error("'%s' is not a binary BonnMotion trace",filename);
+    if (readLE32(file+8)!=BM_BINARY_VERSION)
+        opp_error("Unsupported binary BonnMotion trace version %u in '%s'", readLE32(file+8), filename);
+
+    uint32 numNodes = readLE32(file+12);
+    uint64 dataStart = 16 + 8*((uint64)numNodes+1);
+    if (dataStart > size)
+        opp_error("Binary BonnMotion trace '%s' is truncated", filename);
+    const unsigned char *index = file+16;
+    uint64 numValues = readLE64(index+8*numNodes);
+    if (dataStart + 8*numValues > size)
+        opp_error("Binary BonnMotion trace '%s' is truncated", filename);
 
+    const double *data = (const double *)(file+dataStart);
+    bmFile.lines.reserve(numNodes);
+    for (uint32 i=0; i<numNodes; i++)
+    {
+        uint64 start = readLE64(index+8*i);
+        uint64 end = readLE64(index+8*(i+1));
+        if (start>end || end>numValues)
+            opp_error("Invalid index entry for node %u in binary BonnMotion trace '%s'", i, filename);
+        bmFile.lines.push_back(BonnMotionFile::Line(data+start, end-start));
+    }
+}
 
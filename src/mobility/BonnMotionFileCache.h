@@ -18,7 +18,8 @@
 #ifndef BONNMOTIONFILECACHE_H
 #define BONNMOTIONFILECACHE_H
 
-#include <list>
+#include <map>
+#include <string>
 #include <vector>
 #include <omnetpp.h>
 #include "BasicMobility.h"
@@ -26,19 +27,63 @@
 class BonnMotionFileCache;
 
 /**
- * Represents a BonnMotion file's contents.
+ * Represents a BonnMotion file's contents. Each line (node) is a sequence
+ * of numbers: (t, x, y) triplets in the BonnMotion format.
+ *
+ * The contents may come from a BonnMotion text file, or from the binary
+ * format below, which is memory-mapped and whose lines are used in place,
+ * without parsing or copying. All integers and doubles are little-endian:
+ *
+ * <pre>
+ *   char   magic[8]            "INETBMT" followed by a zero byte
+ *   uint32 version             1
+ *   uint32 numNodes
+ *   uint64 index[numNodes+1]   start of each node's numbers within data[],
+ *                              in doubles; index[numNodes] is the total
+ *   double data[]
+ * </pre>
+ *
+ * Binary files can be created from BonnMotion or ANSim traces with the
+ * etc/bonnmotion2bin.py script.
+ *
  * @see BonnMotionFileCache, BonnMotionMobility
  */
 class INET_API BonnMotionFile
 {
   public:
-    typedef std::vector<double> Line;
+    /**
+     * A line of the file; refers to the numbers stored in BonnMotionFile,
+     * so it is only valid while the file is in the cache.
+     */
+    class Line
+    {
+      protected:
+        const double *values;
+        int numValues;
+      public:
+        Line(const double *values=NULL, int numValues=0) : values(values), numValues(numValues) {}
+        int size() const {return numValues;}
+        double operator[](int i) const {return values[i];}
+    };
+
   protected:
     friend class BonnMotionFileCache;
-    typedef std::list<Line> LineList;
-    LineList lines;
+    std::vector<double> values;  // numbers of a text file, or a binary file read into memory
+    std::vector<Line> lines;
+    void *mappedData;            // binary file mapped into memory, or NULL
+    size_t mappedSize;
+
   public:
-    const Line *getLine(int nodeId) const;
+    BonnMotionFile() {mappedData = NULL; mappedSize = 0;}
+    ~BonnMotionFile();
+
+    /** Returns the line for the given node, or NULL if there is no such line */
+    const Line *getLine(int nodeId) const {
+        return (nodeId>=0 && nodeId<(int)lines.size()) ? &lines[nodeId] : NULL;
+    }
+
+    /** Returns the number of lines (nodes) */
+    int getNumLines() const {return lines.size();}
 };
 
 
@@ -53,12 +98,14 @@ class INET_API BonnMotionFile
 class INET_API BonnMotionFileCache
 {
   protected:
-    typedef std::map<std::string,BonnMotionFile> BMFileMap;
+    typedef std::map<std::string,BonnMotionFile*> BMFileMap;
     BMFileMap cache;
     static BonnMotionFileCache *inst;
     void parseFile(const char *filename, BonnMotionFile& bmFile);
+    void loadBinaryFile(const char *filename, BonnMotionFile& bmFile);
+    static bool isBinaryFile(const char *filename);
     BonnMotionFileCache() {}
-    virtual ~BonnMotionFileCache() {}
+    virtual ~BonnMotionFileCache();
 
   public:
     /**
@@ -72,7 +119,8 @@ class INET_API BonnMotionFileCache
     static void deleteInstance();
 
     /**
-     * Returns the given document.
+     * Returns the given document. Binary files are recognized by their
+     * contents, not by their names.
      */
     virtual const BonnMotionFile *getFile(const char *filename);
 };
@@ -27,6 +27,7 @@ void LineSegmentsMobilityBase::initialize(int stage)
     if (stage == 1)
     {
         updateInterval = par("updateInterval");
+        lazyPositionUpdates = par("lazyPositionUpdates");
         stationary = false;
         targetPos = pos;
         targetTime = simTime();
@@ -76,6 +77,39 @@ void LineSegmentsMobilityBase::beginNextMove(cMessage *msg)
     }
 }
 
+void LineSegmentsMobilityBase::beginNextLazyMove(cMessage *msg)
+{
+    // the previous segment has ended, at its exact target position
+    pos = targetPos;
+    simtime_t now = targetTime;
+    fixIfHostGetsOutside();
+
+    setTargetPosition();
+
+    if (targetTime<now)
+        error("LineSegmentsMobilityBase: targetTime<now was set in %s's beginNextMove()", getClassName());
+
+    step.x = step.y = 0;
+    if (stationary)
+    {
+        delete msg;
+        updatePosition();
+    }
+    else if (targetPos==pos || targetTime==now)
+    {
+        // waiting, or jumping to the target position
+        updatePosition();
+        scheduleAt(std::max(targetTime,simTime()), msg);
+    }
+    else
+    {
+        Coord speed = (targetPos - pos) / SIMTIME_DBL(targetTime-now);
+        cc->updateHostTrajectory(myHostRef, pos, now, speed, targetTime);
+        positionUpdated();
+        scheduleAt(std::max(targetTime,simTime()), msg);
+    }
+}
+
 void LineSegmentsMobilityBase::handleSelfMsg(cMessage *msg)
 {
     if (stationary)
@@ -83,6 +117,11 @@ void LineSegmentsMobilityBase::handleSelfMsg(cMessage *msg)
         delete msg;
         return;
     }
+    else if (lazyPositionUpdates)
+    {
+        beginNextLazyMove(msg);
+        return;
+    }
     else if (simTime()+updateInterval >= targetTime)
     {
         beginNextMove(msg);
@@ -29,6 +29,12 @@
  * Subclasses must redefine setTargetPosition() which is suppsed to set
  * a new target position and target time once the previous one is reached.
  *
+ * With the lazyPositionUpdates parameter, the position is not updated
+ * every updateInterval. Instead, each line segment is passed to
+ * ChannelControl as a trajectory, which evaluates the position when it
+ * is needed, and events only occur at the ends of the segments. Border
+ * policies are then applied at segment ends only.
+ *
  * @ingroup mobility
  * @author Andras Varga
  */
@@ -37,6 +43,7 @@ class INET_API LineSegmentsMobilityBase : public BasicMobility
   protected:
     // config
     double updateInterval; ///< time interval to update the host's position
+    bool lazyPositionUpdates; ///< publish line segments instead of stepping
 
     // state
     simtime_t targetTime;  ///< end time of current linear movement
@@ -54,6 +61,9 @@ class INET_API LineSegmentsMobilityBase : public BasicMobility
     /** @brief Begin new line segment after previous one finished */
     virtual void beginNextMove(cMessage *msg);
 
+    /** @brief Like beginNextMove(), but publishes the segment as a trajectory */
+    virtual void beginNextLazyMove(cMessage *msg);
+
     /**
      * @brief Should be redefined in subclasses. This method gets called
      * when targetPos and targetTime has been reached, and its task is
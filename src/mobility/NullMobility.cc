@@ -19,7 +19,7 @@
 #include "NullMobility.h"
 
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? (std::ostream&)ev : EV << logName() << "::BasicMobility: "
+#define coreEV INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.isDisabled() && coreDebug) << logName() << "::BasicMobility: "
 
 Define_Module(NullMobility);
 
@@ -19,6 +19,7 @@
 #include "ARP.h"
 #include "IPv4InterfaceData.h"
 #include "Ieee802Ctrl_m.h"
+#include "NotificationBoard.h"
 
 
 static std::ostream& operator<< (std::ostream& out, cMessage *msg)
@@ -39,6 +40,10 @@ static std::ostream& operator<< (std::ostream& out, const ARP::ARPCacheEntry& e)
 
 Define_Module (ARP);
 
+GlobalARPCache ARP::globalArpCache;
+bool ARP::globalArpCacheValid = false;
+int ARP::globalArpCacheRefCnt = 0;
+
 void ARP::initialize()
 {
     ift = InterfaceTableAccess().get();
@@ -50,6 +55,19 @@ void ARP::initialize()
     retryCount = par("retryCount");
     cacheTimeout = par("cacheTimeout");
     doProxyARP = par("proxyARP");
+    globalARP = par("globalARP");
+
+    if (globalARP)
+    {
+        globalArpCacheRefCnt++;
+        globalArpCacheValid = false;
+
+        NotificationBoard *nb = NotificationBoardAccess().get();
+        nb->subscribe(this, NF_INTERFACE_CREATED);
+        nb->subscribe(this, NF_INTERFACE_DELETED);
+        nb->subscribe(this, NF_INTERFACE_CONFIG_CHANGED);
+        nb->subscribe(this, NF_INTERFACE_IPv4CONFIG_CHANGED);
+    }
 
     pendingQueue.setName("pendingQueue");
 
@@ -74,6 +92,12 @@ void ARP::finish()
 
 ARP::~ARP()
 {
+    if (globalARP && --globalArpCacheRefCnt==0)
+    {
+        globalArpCache.clear();
+        globalArpCacheValid = false;
+    }
+
     while (!arpCache.empty())
     {
         ARPCache::iterator i = arpCache.begin();
@@ -101,6 +125,15 @@ void ARP::handleMessage(cMessage *msg)
         updateDisplayString();
 }
 
+void ARP::receiveChangeNotification(int category, const cPolymorphic *details)
+{
+    Enter_Method_Silent();
+    printNotificationBanner(category, details);
+
+    // interface addresses changed somewhere: rebuild the global table on next use
+    globalArpCacheValid = false;
+}
+
 void ARP::updateDisplayString()
 {
     std::stringstream os;
@@ -174,6 +207,12 @@ void ARP::processOutboundPacket(cMessage *msg)
 #endif
     }
 
+    if (globalARP)
+    {
+        resolveGlobally(msg, ie, nextHopAddr);
+        return;
+    }
+
     // try look up
     ARPCache::iterator it = arpCache.find(nextHopAddr);
     //ASSERT(it==arpCache.end() || ie==(*it).second->ie); // verify: if arpCache gets keyed on InterfaceEntry* too, this becomes unnecessary
@@ -220,6 +259,28 @@ void ARP::processOutboundPacket(cMessage *msg)
     }
 }
 
+void ARP::resolveGlobally(cMessage *msg, InterfaceEntry *ie, IPAddress nextHopAddr)
+{
+    if (!globalArpCacheValid)
+    {
+        globalArpCache.rebuild();
+        globalArpCacheValid = true;
+    }
+
+    numResolutions++;
+    const GlobalARPCache::Entry *entry = globalArpCache.lookup(nextHopAddr);
+    if (!entry)
+    {
+        EV << "global ARP: no interface has address " << nextHopAddr << ", dropping packet\n";
+        numFailedResolutions++;
+        delete msg;
+        return;
+    }
+
+    EV << "global ARP: MAC address for " << nextHopAddr << " is " << entry->macAddress << ", sending packet down\n";
+    sendPacketToNIC(msg, ie, entry->macAddress);
+}
+
 void ARP::initiateARPResolution(ARPCacheEntry *entry)
 {
     IPAddress nextHopAddr = entry->myIter->first;
@@ -31,13 +31,15 @@
 #include "InterfaceTableAccess.h"
 #include "IRoutingTable.h"
 #include "RoutingTableAccess.h"
+#include "INotifiable.h"
+#include "GlobalARPCache.h"
 
 
 
 /**
  * ARP implementation.
  */
-class INET_API ARP : public cSimpleModule
+class INET_API ARP : public cSimpleModule, public INotifiable
 {
   public:
     struct ARPCacheEntry;
@@ -64,6 +66,7 @@ class INET_API ARP : public cSimpleModule
     int retryCount;
     simtime_t cacheTimeout;
     bool doProxyARP;
+    bool globalARP;
 
     long numResolutions;
     long numFailedResolutions;
@@ -78,16 +81,24 @@ class INET_API ARP : public cSimpleModule
     IInterfaceTable *ift;
     IRoutingTable *rt;  // for Proxy ARP
 
+    // shared by all ARP modules in global mode; rebuilt on first use
+    // after an address change anywhere in the network
+    static GlobalARPCache globalArpCache;
+    static bool globalArpCacheValid;
+    static int globalArpCacheRefCnt;
+
   public:
-    ARP() {}
+    ARP() {globalARP = false;}
     virtual ~ARP();
 
   protected:
     virtual void initialize();
     virtual void handleMessage(cMessage *msg);
     virtual void finish();
+    virtual void receiveChangeNotification(int category, const cPolymorphic *details);
 
     virtual void processOutboundPacket(cMessage *msg);
+    virtual void resolveGlobally(cMessage *msg, InterfaceEntry *ie, IPAddress nextHopAddr);
     virtual void sendPacketToNIC(cMessage *msg, InterfaceEntry *ie, const MACAddress& macAddress);
 
     virtual void initiateARPResolution(ARPCacheEntry *entry);
@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "GlobalARPCache.h"
+#include "IInterfaceTable.h"
+#include "IPv4InterfaceData.h"
+
+
+void GlobalARPCache::clear()
+{
+    table.clear();
+    numEntries = 0;
+}
+
+void GlobalARPCache::grow()
+{
+    std::vector<Entry> oldTable;
+    oldTable.swap(table);
+    table.resize(oldTable.empty() ? 64 : 2*oldTable.size());
+    numEntries = 0;
+    for (unsigned int i=0; i<oldTable.size(); i++)
+        if (!oldTable[i].ipAddress.isUnspecified())
+            insert(oldTable[i].ipAddress, oldTable[i].macAddress, oldTable[i].ie);
+}
+
+void GlobalARPCache::insert(const IPAddress& addr, const MACAddress& macAddress, InterfaceEntry *ie)
+{
+    ASSERT(!addr.isUnspecified());
+
+    // keep the load factor below 1/2
+    if (2*(numEntries+1) > (int)table.size())
+        grow();
+
+    unsigned int mask = table.size()-1;
+    unsigned int i = slotOf(addr);
+    while (!table[i].ipAddress.isUnspecified() && table[i].ipAddress!=addr)
+        i = (i+1) & mask;
+
+    if (table[i].ipAddress.isUnspecified())
+        numEntries++;
+    table[i].ipAddress = addr;
+    table[i].macAddress = macAddress;
+    table[i].ie = ie;
+}
+
+const GlobalARPCache::Entry *GlobalARPCache::lookup(const IPAddress& addr) const
+{
+    if (table.empty() || addr.isUnspecified())
+        return NULL;
+
+    unsigned int mask = table.size()-1;
+    for (unsigned int i = slotOf(addr); !table[i].ipAddress.isUnspecified(); i = (i+1) & mask)
+        if (table[i].ipAddress==addr)
+            return &table[i];
+    return NULL;
+}
+
+void GlobalARPCache::rebuild()
+{
+    clear();
+    for (int id=0; id<=simulation.getLastModuleId(); id++)
+    {
+        IInterfaceTable *ift = dynamic_cast<IInterfaceTable *>(simulation.getModule(id));
+        if (!ift)
+            continue;
+        for (int i=0; i<ift->getNumInterfaces(); i++)
+        {
+            InterfaceEntry *ie = ift->getInterface(i);
+            if (ie->isLoopback() || !ie->ipv4Data() || ie->getMacAddress().isUnspecified())
+                continue;
+            IPAddress addr = ie->ipv4Data()->getIPAddress();
+            if (!addr.isUnspecified())
+                insert(addr, ie->getMacAddress(), ie);
+        }
+    }
+}
+
@@ -0,0 +1,76 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __INET_GLOBALARPCACHE_H
+#define __INET_GLOBALARPCACHE_H
+
+#include <vector>
+#include <omnetpp.h>
+#include "INETDefs.h"
+#include "IPAddress.h"
+#include "MACAddress.h"
+
+class InterfaceEntry;
+
+
+/**
+ * Network-wide IPAddress -> MACAddress table, used by ARP in global mode.
+ * It is filled from the interface tables of all nodes, so addresses can
+ * be resolved without exchanging ARP packets. Open addressing with linear
+ * probing keeps a lookup to a few cache lines even with many thousand
+ * hosts.
+ */
+class INET_API GlobalARPCache
+{
+  public:
+    struct Entry
+    {
+        IPAddress ipAddress;
+        MACAddress macAddress;
+        InterfaceEntry *ie;
+    };
+
+  protected:
+    std::vector<Entry> table;  // size is a power of two; unspecified ipAddress marks free slots
+    int numEntries;
+
+  protected:
+    unsigned int slotOf(const IPAddress& addr) const {
+        return (addr.getInt() * 2654435761u) & (table.size()-1);
+    }
+    void grow();
+
+  public:
+    GlobalARPCache() {numEntries = 0;}
+
+    int size() const {return numEntries;}
+    bool empty() const {return numEntries==0;}
+    void clear();
+
+    /** Adds or replaces the entry for the given address */
+    void insert(const IPAddress& addr, const MACAddress& macAddress, InterfaceEntry *ie);
+
+    /** Returns NULL if the address is not known */
+    const Entry *lookup(const IPAddress& addr) const;
+
+    /**
+     * Clears the table, and fills it with the IPv4 addresses of all
+     * non-loopback interfaces found in the interface tables of the network.
+     */
+    void rebuild();
+};
+
+#endif
+
@@ -17,6 +17,7 @@
 
 
 #include <omnetpp.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -32,13 +33,27 @@ Define_Module(IP);
 
 void IP::initialize()
 {
-    QueueBase::initialize();
-
     ift = InterfaceTableAccess().get();
     rt = RoutingTableAccess().get();
 
     queueOutGate = gate("queueOut");
 
+    procDelay = par("procDelay");
+    lookupDelay = par("lookupDelay");
+    const char *costModel = par("lookupCostModel");
+    if (!strcmp(costModel, "constant"))
+        lookupCostModel = LOOKUP_COST_CONSTANT;
+    else if (!strcmp(costModel, "linear"))
+        lookupCostModel = LOOKUP_COST_LINEAR;
+    else if (!strcmp(costModel, "logarithmic"))
+        lookupCostModel = LOOKUP_COST_LOGARITHMIC;
+    else
+        error("invalid lookupCostModel '%s': must be constant, linear or logarithmic", costModel);
+
+    perInterfaceEngines = par("perInterfaceEngines");
+    int numWorkers = par("numWorkers");
+    initQueues(perInterfaceEngines ? gateSize("queueIn")+1 : 1, numWorkers);
+
     defaultTimeToLive = par("timeToLive");
     defaultMCTimeToLive = par("multicastTimeToLive");
     fragmentTimeoutTime = par("fragmentTimeout");
@@ -68,6 +83,29 @@ void IP::updateDisplayString()
     getDisplayString().setTagArg("t",0,buf);
 }
 
+int IP::selectQueue(cPacket *msg)
+{
+    if (!perInterfaceEngines)
+        return 0;
+    cGate *g = msg->getArrivalGate();
+    return g->isName("queueIn") ? g->getIndex()+1 : 0;
+}
+
+simtime_t IP::startService(cPacket *msg)
+{
+    if (lookupDelay == 0 || dynamic_cast<ARPPacket *>(msg))
+        return procDelay;
+
+    int numRoutes = rt->getNumRoutes();
+    switch (lookupCostModel)
+    {
+        case LOOKUP_COST_CONSTANT: return procDelay + lookupDelay;
+        case LOOKUP_COST_LINEAR: return procDelay + lookupDelay * numRoutes;
+        case LOOKUP_COST_LOGARITHMIC: return procDelay + lookupDelay * ceil(log(numRoutes+1.0)/log(2.0));
+    }
+    return procDelay;
+}
+
 void IP::endService(cPacket *msg)
 {
     if (msg->getArrivalGate()->isName("transportIn"))
@@ -18,7 +18,7 @@
 #ifndef __INET_IP_H
 #define __INET_IP_H
 
-#include "QueueBase.h"
+#include "AbstractMultiServerQueue.h"
 #include "InterfaceTableAccess.h"
 #include "RoutingTableAccess.h"
 #include "IRoutingTable.h"
@@ -39,15 +39,25 @@ const int ICMP_FRAGMENTATION_ERROR_CODE = 4;
 /**
  * Implements the IP protocol.
  */
-class INET_API IP : public QueueBase
+class INET_API IP : public AbstractMultiServerQueue
 {
   protected:
+    enum LookupCostModel {
+        LOOKUP_COST_CONSTANT,
+        LOOKUP_COST_LINEAR,       // proportional to the number of routes
+        LOOKUP_COST_LOGARITHMIC   // proportional to log2 of the number of routes
+    };
+
     IRoutingTable *rt;
     IInterfaceTable *ift;
     ICMPAccess icmpAccess;
     cGate *queueOutGate; // the most frequently used output gate
 
     // config
+    simtime_t procDelay;
+    simtime_t lookupDelay;
+    LookupCostModel lookupCostModel;
+    bool perInterfaceEngines;
     int defaultTimeToLive;
     int defaultMCTimeToLive;
     simtime_t fragmentTimeoutTime;
@@ -156,6 +166,17 @@ class INET_API IP : public QueueBase
      */
     virtual void initialize();
 
+    /**
+     * With perInterfaceEngines, datagrams from queueIn[k] go to queue k+1,
+     * and packets from the higher layers to queue 0.
+     */
+    virtual int selectQueue(cPacket *msg);
+
+    /**
+     * Returns procDelay plus the routing table lookup cost.
+     */
+    virtual simtime_t startService(cPacket *msg);
+
     /**
      * Processing of IP datagrams. Called when a datagram reaches the front
      * of the queue.
@@ -67,6 +67,8 @@ void OSPFRouting::initialize(int stage)
 
         // Get routerId
         ospfRouter = new OSPF::Router(rt->getRouterId().getInt(), this);
+        ospfRouter->SetFloodPacingInterval(par("floodPacingInterval").doubleValue());
+        ospfRouter->SetSPFThrottle(par("spfInitialDelay").doubleValue(), par("spfHoldTime").doubleValue(), par("spfMaxHoldTime").doubleValue());
 
         // read the OSPF AS configuration
         const char *fileName = par("ospfConfigFile");
@@ -59,6 +59,10 @@ OSPF::Interface::Interface(OSPF::Interface::OSPFInterfaceType ifType) :
     acknowledgementTimer->setTimerKind(InterfaceAcknowledgementTimer);
     acknowledgementTimer->setContextPointer(this);
     acknowledgementTimer->setName("OSPF::Interface::InterfaceAcknowledgementTimer");
+    floodTimer = new OSPFTimer;
+    floodTimer->setTimerKind(InterfaceFloodTimer);
+    floodTimer->setContextPointer(this);
+    floodTimer->setName("OSPF::Interface::InterfaceFloodTimer");
     memset(authenticationKey.bytes, 0, 8 * sizeof(char));
 }
 
@@ -71,6 +75,8 @@ OSPF::Interface::~Interface(void)
     delete waitTimer;
     messageHandler->ClearTimer(acknowledgementTimer);
     delete acknowledgementTimer;
+    ClearPendingUpdates();
+    delete floodTimer;
     if (previousState != NULL) {
         delete previousState;
     }
@@ -112,6 +118,7 @@ void OSPF::Interface::Reset(void)
     messageHandler->ClearTimer(helloTimer);
     messageHandler->ClearTimer(waitTimer);
     messageHandler->ClearTimer(acknowledgementTimer);
+    ClearPendingUpdates();
     designatedRouter = NullDesignatedRouterID;
     backupDesignatedRouter = NullDesignatedRouterID;
     long neighborCount = neighboringRouters.size();
@@ -336,66 +343,59 @@ bool OSPF::Interface::FloodLSA(OSPFLSA* lsa, OSPF::Interface* intf, OSPF::Neighb
                  (neighbor->GetNeighborID() != backupDesignatedRouter.routerID)))  // (3)
             {
                 if ((intf != this) || (GetState() != OSPF::Interface::BackupState)) {  // (4)
-                    OSPFLinkStateUpdatePacket* updatePacket = CreateUpdatePacket(lsa);    // (5)
-
-                    if (updatePacket != NULL) {
-                        int                   ttl            = (interfaceType == OSPF::Interface::Virtual) ? VIRTUAL_LINK_TTL : 1;
-                        OSPF::MessageHandler* messageHandler = parentArea->GetRouter()->GetMessageHandler();
-
-                        if (interfaceType == OSPF::Interface::Broadcast) {
-                            if ((GetState() == OSPF::Interface::DesignatedRouterState) ||
-                                (GetState() == OSPF::Interface::BackupState) ||
-                                (designatedRouter == OSPF::NullDesignatedRouterID))
-                            {
-                                messageHandler->SendPacket(updatePacket, OSPF::AllSPFRouters, ifIndex, ttl);
-                                for (long k = 0; k < neighborCount; k++) {
-                                    neighboringRouters[k]->AddToTransmittedLSAList(lsaKey);
-                                    if (!neighboringRouters[k]->IsUpdateRetransmissionTimerActive()) {
-                                        neighboringRouters[k]->StartUpdateRetransmissionTimer();
-                                    }
+                    if (interfaceType == OSPF::Interface::Broadcast) {    // (5)
+                        if ((GetState() == OSPF::Interface::DesignatedRouterState) ||
+                            (GetState() == OSPF::Interface::BackupState) ||
+                            (designatedRouter == OSPF::NullDesignatedRouterID))
+                        {
+                            SendUpdate(lsa, OSPF::AllSPFRouters);
+                            for (long k = 0; k < neighborCount; k++) {
+                                neighboringRouters[k]->AddToTransmittedLSAList(lsaKey);
+                                if (!neighboringRouters[k]->IsUpdateRetransmissionTimerActive()) {
+                                    neighboringRouters[k]->StartUpdateRetransmissionTimer();
                                 }
-                            } else {
-                                messageHandler->SendPacket(updatePacket, OSPF::AllDRouters, ifIndex, ttl);
-                                OSPF::Neighbor* dRouter = GetNeighborByID(designatedRouter.routerID);
-                                OSPF::Neighbor* backupDRouter = GetNeighborByID(backupDesignatedRouter.routerID);
-                                if (dRouter != NULL) {
-                                    dRouter->AddToTransmittedLSAList(lsaKey);
-                                    if (!dRouter->IsUpdateRetransmissionTimerActive()) {
-                                        dRouter->StartUpdateRetransmissionTimer();
-                                    }
+                            }
+                        } else {
+                            SendUpdate(lsa, OSPF::AllDRouters);
+                            OSPF::Neighbor* dRouter = GetNeighborByID(designatedRouter.routerID);
+                            OSPF::Neighbor* backupDRouter = GetNeighborByID(backupDesignatedRouter.routerID);
+                            if (dRouter != NULL) {
+                                dRouter->AddToTransmittedLSAList(lsaKey);
+                                if (!dRouter->IsUpdateRetransmissionTimerActive()) {
+                                    dRouter->StartUpdateRetransmissionTimer();
                                 }
-                                if (backupDRouter != NULL) {
-                                    backupDRouter->AddToTransmittedLSAList(lsaKey);
-                                    if (!backupDRouter->IsUpdateRetransmissionTimerActive()) {
-                                        backupDRouter->StartUpdateRetransmissionTimer();
-                                    }
+                            }
+                            if (backupDRouter != NULL) {
+                                backupDRouter->AddToTransmittedLSAList(lsaKey);
+                                if (!backupDRouter->IsUpdateRetransmissionTimerActive()) {
+                                    backupDRouter->StartUpdateRetransmissionTimer();
                                 }
                             }
-                        } else {
-                            if (interfaceType == OSPF::Interface::PointToPoint) {
-                                messageHandler->SendPacket(updatePacket, OSPF::AllSPFRouters, ifIndex, ttl);
-                                if (neighborCount > 0) {
-                                    neighboringRouters[0]->AddToTransmittedLSAList(lsaKey);
-                                    if (!neighboringRouters[0]->IsUpdateRetransmissionTimerActive()) {
-                                        neighboringRouters[0]->StartUpdateRetransmissionTimer();
-                                    }
+                        }
+                    } else {
+                        if (interfaceType == OSPF::Interface::PointToPoint) {
+                            SendUpdate(lsa, OSPF::AllSPFRouters);
+                            if (neighborCount > 0) {
+                                neighboringRouters[0]->AddToTransmittedLSAList(lsaKey);
+                                if (!neighboringRouters[0]->IsUpdateRetransmissionTimerActive()) {
+                                    neighboringRouters[0]->StartUpdateRetransmissionTimer();
                                 }
-                            } else {
-                                for (long m = 0; m < neighborCount; m++) {
-                                    if (neighboringRouters[m]->GetState() >= OSPF::Neighbor::ExchangeState) {
-                                        messageHandler->SendPacket(updatePacket, neighboringRouters[m]->GetAddress(), ifIndex, ttl);
-                                        neighboringRouters[m]->AddToTransmittedLSAList(lsaKey);
-                                        if (!neighboringRouters[m]->IsUpdateRetransmissionTimerActive()) {
-                                            neighboringRouters[m]->StartUpdateRetransmissionTimer();
-                                        }
+                            }
+                        } else {
+                            for (long m = 0; m < neighborCount; m++) {
+                                if (neighboringRouters[m]->GetState() >= OSPF::Neighbor::ExchangeState) {
+                                    SendUpdate(lsa, neighboringRouters[m]->GetAddress());
+                                    neighboringRouters[m]->AddToTransmittedLSAList(lsaKey);
+                                    if (!neighboringRouters[m]->IsUpdateRetransmissionTimerActive()) {
+                                        neighboringRouters[m]->StartUpdateRetransmissionTimer();
                                     }
                                 }
                             }
                         }
+                    }
 
-                        if (intf == this) {
-                            floodedBackOut = true;
-                        }
+                    if (intf == this) {
+                        floodedBackOut = true;
                     }
                 }
             }
@@ -405,91 +405,214 @@ bool OSPF::Interface::FloodLSA(OSPFLSA* lsa, OSPF::Interface* intf, OSPF::Neighb
     return floodedBackOut;
 }
 
-OSPFLinkStateUpdatePacket* OSPF::Interface::CreateUpdatePacket(OSPFLSA* lsa)
+/**
+ * Creates an empty Link State Update packet to be sent out on this interface.
+ * If lsa is not NULL, it is added to the packet as its first LSA.
+ * @return The new packet, or NULL if lsa has an unknown type.
+ */
+OSPFLinkStateUpdatePacket* OSPF::Interface::CreateUpdatePacket(OSPFLSA* lsa /*= NULL*/)
 {
-    LSAType lsaType                  = static_cast<LSAType> (lsa->getHeader().getLsType());
-    OSPFRouterLSA* routerLSA         = (lsaType == RouterLSAType) ? dynamic_cast<OSPFRouterLSA*> (lsa) : NULL;
-    OSPFNetworkLSA* networkLSA       = (lsaType == NetworkLSAType) ? dynamic_cast<OSPFNetworkLSA*> (lsa) : NULL;
-    OSPFSummaryLSA* summaryLSA       = ((lsaType == SummaryLSA_NetworksType) ||
-                                        (lsaType == SummaryLSA_ASBoundaryRoutersType)) ? dynamic_cast<OSPFSummaryLSA*> (lsa) : NULL;
-    OSPFASExternalLSA* asExternalLSA = (lsaType == ASExternalLSAType) ? dynamic_cast<OSPFASExternalLSA*> (lsa) : NULL;
-
-    if (((lsaType == RouterLSAType) && (routerLSA != NULL)) ||
-        ((lsaType == NetworkLSAType) && (networkLSA != NULL)) ||
-        (((lsaType == SummaryLSA_NetworksType) || (lsaType == SummaryLSA_ASBoundaryRoutersType)) && (summaryLSA != NULL)) ||
-        ((lsaType == ASExternalLSAType) && (asExternalLSA != NULL)))
-    {
-        OSPFLinkStateUpdatePacket* updatePacket = new OSPFLinkStateUpdatePacket;
-
-        updatePacket->setType(LinkStateUpdatePacket);
-        updatePacket->setRouterID(parentArea->GetRouter()->GetRouterID());
-        updatePacket->setAreaID(areaID);
-        updatePacket->setAuthenticationType(authenticationType);
-        for (int j = 0; j < 8; j++) {
-            updatePacket->setAuthentication(j, authenticationKey.bytes[j]);
+    OSPFLinkStateUpdatePacket* updatePacket = new OSPFLinkStateUpdatePacket;
+
+    updatePacket->setType(LinkStateUpdatePacket);
+    updatePacket->setRouterID(parentArea->GetRouter()->GetRouterID());
+    updatePacket->setAreaID(areaID);
+    updatePacket->setAuthenticationType(authenticationType);
+    for (int j = 0; j < 8; j++) {
+        updatePacket->setAuthentication(j, authenticationKey.bytes[j]);
+    }
+
+    updatePacket->setNumberOfLSAs(0);
+
+    updatePacket->setPacketLength(0); // TODO: Calculate correct length
+    updatePacket->setChecksum(0); // TODO: Calculate correct cheksum(16-bit one's complement of the entire packet)
+
+    if ((lsa != NULL) && !AddToUpdatePacket(updatePacket, lsa)) {
+        delete updatePacket;
+        return NULL;
+    }
+    return updatePacket;
+}
+
+/**
+ * Appends a copy of lsa to the Link State Update packet. The LS age of the copy is
+ * incremented by the interface's transmission delay plus ageIncrement.
+ * @return False if lsa has an unknown type(it is not added then), true otherwise.
+ */
+bool OSPF::Interface::AddToUpdatePacket(OSPFLinkStateUpdatePacket* updatePacket, const OSPFLSA* lsa, unsigned short ageIncrement /*= 0*/)
+{
+    LSAType                  lsaType       = static_cast<LSAType> (lsa->getHeader().getLsType());
+    const OSPFRouterLSA*     routerLSA     = (lsaType == RouterLSAType) ? dynamic_cast<const OSPFRouterLSA*> (lsa) : NULL;
+    const OSPFNetworkLSA*    networkLSA    = (lsaType == NetworkLSAType) ? dynamic_cast<const OSPFNetworkLSA*> (lsa) : NULL;
+    const OSPFSummaryLSA*    summaryLSA    = ((lsaType == SummaryLSA_NetworksType) ||
+                                              (lsaType == SummaryLSA_ASBoundaryRoutersType)) ? dynamic_cast<const OSPFSummaryLSA*> (lsa) : NULL;
+    const OSPFASExternalLSA* asExternalLSA = (lsaType == ASExternalLSAType) ? dynamic_cast<const OSPFASExternalLSA*> (lsa) : NULL;
+    OSPFLSAHeader*           lsaHeader     = NULL;
+
+    switch (lsaType) {
+        case RouterLSAType:
+            if (routerLSA != NULL) {
+                unsigned int routerLSACount = updatePacket->getRouterLSAsArraySize();
+
+                updatePacket->setRouterLSAsArraySize(routerLSACount + 1);
+                updatePacket->setRouterLSAs(routerLSACount, *routerLSA);
+                lsaHeader = &(updatePacket->getRouterLSAs(routerLSACount).getHeader());
+            }
+            break;
+        case NetworkLSAType:
+            if (networkLSA != NULL) {
+                unsigned int networkLSACount = updatePacket->getNetworkLSAsArraySize();
+
+                updatePacket->setNetworkLSAsArraySize(networkLSACount + 1);
+                updatePacket->setNetworkLSAs(networkLSACount, *networkLSA);
+                lsaHeader = &(updatePacket->getNetworkLSAs(networkLSACount).getHeader());
+            }
+            break;
+        case SummaryLSA_NetworksType:
+        case SummaryLSA_ASBoundaryRoutersType:
+            if (summaryLSA != NULL) {
+                unsigned int summaryLSACount = updatePacket->getSummaryLSAsArraySize();
+
+                updatePacket->setSummaryLSAsArraySize(summaryLSACount + 1);
+                updatePacket->setSummaryLSAs(summaryLSACount, *summaryLSA);
+                lsaHeader = &(updatePacket->getSummaryLSAs(summaryLSACount).getHeader());
+            }
+            break;
+        case ASExternalLSAType:
+            if (asExternalLSA != NULL) {
+                unsigned int asExternalLSACount = updatePacket->getAsExternalLSAsArraySize();
+
+                updatePacket->setAsExternalLSAsArraySize(asExternalLSACount + 1);
+                updatePacket->setAsExternalLSAs(asExternalLSACount, *asExternalLSA);
+                lsaHeader = &(updatePacket->getAsExternalLSAs(asExternalLSACount).getHeader());
+            }
+            break;
+        default: break;
+    }
+
+    if (lsaHeader == NULL) {
+        return false;
+    }
+
+    unsigned long lsAge = lsaHeader->getLsAge() + interfaceTransmissionDelay + ageIncrement;
+    lsaHeader->setLsAge((lsAge < MAX_AGE) ? lsAge : MAX_AGE);
+
+    updatePacket->setNumberOfLSAs(updatePacket->getNumberOfLSAs() + 1);
+
+    return true;
+}
+
+/**
+ * Sends lsa in a Link State Update packet to destination. If flood pacing is
+ * enabled, a copy of the LSA is queued instead, and all LSAs queued until the
+ * flood timer fires are sent packed into as few packets as the MTU allows. A
+ * queued instance of the same LSA is replaced.
+ * @param lsa         [in] The LSA to send.
+ * @param destination [in] The destination address of the update.
+ */
+void OSPF::Interface::SendUpdate(OSPFLSA* lsa, IPv4Address destination)
+{
+    OSPF::MessageHandler* messageHandler = parentArea->GetRouter()->GetMessageHandler();
+    simtime_t             pacingInterval = parentArea->GetRouter()->GetFloodPacingInterval();
+
+    if (pacingInterval <= 0) {
+        OSPFLinkStateUpdatePacket* updatePacket = CreateUpdatePacket(lsa);
+
+        if (updatePacket != NULL) {
+            int ttl = (interfaceType == OSPF::Interface::Virtual) ? VIRTUAL_LINK_TTL : 1;
+            messageHandler->SendPacket(updatePacket, destination, ifIndex, ttl);
         }
+        return;
+    }
 
-        updatePacket->setNumberOfLSAs(1);
+    PendingUpdateList& pendingList = pendingUpdates[destination];
+    PendingUpdate      update;
+    OSPF::LSAKeyType   lsaKey;
 
-        switch (lsaType) {
-            case RouterLSAType:
-                {
-                    updatePacket->setRouterLSAsArraySize(1);
-                    updatePacket->setRouterLSAs(0, *routerLSA);
-                    unsigned short lsAge = updatePacket->getRouterLSAs(0).getHeader().getLsAge();
-                    if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
-                        updatePacket->getRouterLSAs(0).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
-                    } else {
-                        updatePacket->getRouterLSAs(0).getHeader().setLsAge(MAX_AGE);
-                    }
-                }
-                break;
-            case NetworkLSAType:
-                {
-                    updatePacket->setNetworkLSAsArraySize(1);
-                    updatePacket->setNetworkLSAs(0, *networkLSA);
-                    unsigned short lsAge = updatePacket->getNetworkLSAs(0).getHeader().getLsAge();
-                    if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
-                        updatePacket->getNetworkLSAs(0).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
-                    } else {
-                        updatePacket->getNetworkLSAs(0).getHeader().setLsAge(MAX_AGE);
-                    }
-                }
-                break;
-            case SummaryLSA_NetworksType:
-            case SummaryLSA_ASBoundaryRoutersType:
-                {
-                    updatePacket->setSummaryLSAsArraySize(1);
-                    updatePacket->setSummaryLSAs(0, *summaryLSA);
-                    unsigned short lsAge = updatePacket->getSummaryLSAs(0).getHeader().getLsAge();
-                    if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
-                        updatePacket->getSummaryLSAs(0).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
-                    } else {
-                        updatePacket->getSummaryLSAs(0).getHeader().setLsAge(MAX_AGE);
-                    }
-                }
-                break;
-            case ASExternalLSAType:
-                {
-                    updatePacket->setAsExternalLSAsArraySize(1);
-                    updatePacket->setAsExternalLSAs(0, *asExternalLSA);
-                    unsigned short lsAge = updatePacket->getAsExternalLSAs(0).getHeader().getLsAge();
-                    if (lsAge < MAX_AGE - interfaceTransmissionDelay) {
-                        updatePacket->getAsExternalLSAs(0).getHeader().setLsAge(lsAge + interfaceTransmissionDelay);
-                    } else {
-                        updatePacket->getAsExternalLSAs(0).getHeader().setLsAge(MAX_AGE);
-                    }
-                }
-                break;
-            default: break;
+    lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
+    lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
+
+    update.lsa = CopyLSA(lsa);
+    update.queueTime = simTime();
+
+    std::map<OSPF::LSAKeyType, unsigned long, OSPF::LSAKeyType_Less>::iterator positionIt = pendingList.positions.find(lsaKey);
+    if (positionIt != pendingList.positions.end()) {
+        delete pendingList.updates[positionIt->second].lsa;
+        pendingList.updates[positionIt->second] = update;
+    } else {
+        pendingList.positions[lsaKey] = pendingList.updates.size();
+        pendingList.updates.push_back(update);
+    }
+
+    if (!floodTimer->isScheduled()) {
+        messageHandler->StartTimer(floodTimer, pacingInterval);
+    }
+}
+
+/**
+ * Sends the LSAs queued by SendUpdate(), packing as many of them into each Link
+ * State Update packet as the interface MTU allows. The LS age of each LSA is
+ * increased by the whole seconds it spent in the queue.
+ */
+void OSPF::Interface::SendPendingUpdates(void)
+{
+    OSPF::MessageHandler* messageHandler = parentArea->GetRouter()->GetMessageHandler();
+    unsigned long         maxPacketSize  = ((IPV4_HEADER_LENGTH + OSPF_HEADER_LENGTH + OSPF_LSA_HEADER_LENGTH) > mtu) ? IPV4_DATAGRAM_LENGTH : mtu;
+    int                   ttl            = (interfaceType == OSPF::Interface::Virtual) ? VIRTUAL_LINK_TTL : 1;
+
+    for (std::map<IPv4Address, PendingUpdateList, OSPF::IPv4Address_Less>::iterator pendingIt = pendingUpdates.begin();
+         pendingIt != pendingUpdates.end();
+         pendingIt++)
+    {
+        std::vector<PendingUpdate>& updates      = pendingIt->second.updates;
+        OSPFLinkStateUpdatePacket*  updatePacket = NULL;
+        unsigned long               packetLength = 0;
+        unsigned long               updateCount  = updates.size();
+
+        for (unsigned long i = 0; i < updateCount; i++) {
+            OSPFLSA*      lsa     = updates[i].lsa;
+            unsigned long lsaSize = CalculateLSASize(lsa);
+
+            if ((updatePacket != NULL) && (packetLength + lsaSize > maxPacketSize)) {
+                messageHandler->SendPacket(updatePacket, pendingIt->first, ifIndex, ttl);
+                updatePacket = NULL;
+            }
+            if (updatePacket == NULL) {
+                updatePacket = CreateUpdatePacket();
+                packetLength = IPV4_HEADER_LENGTH + OSPF_HEADER_LENGTH;
+            }
+
+            unsigned long queueingDelay = static_cast<unsigned long> (floor(SIMTIME_DBL(simTime() - updates[i].queueTime)));
+            AddToUpdatePacket(updatePacket, lsa, (queueingDelay < MAX_AGE) ? queueingDelay : MAX_AGE);
+            packetLength += lsaSize;
+
+            delete lsa;
+        }
+        if (updatePacket != NULL) {
+            messageHandler->SendPacket(updatePacket, pendingIt->first, ifIndex, ttl);
         }
+    }
+    pendingUpdates.clear();
+}
 
-        updatePacket->setPacketLength(0); // TODO: Calculate correct length
-        updatePacket->setChecksum(0); // TODO: Calculate correct cheksum(16-bit one's complement of the entire packet)
+/**
+ * Drops the LSAs queued by SendUpdate() and stops the flood timer.
+ */
+void OSPF::Interface::ClearPendingUpdates(void)
+{
+    for (std::map<IPv4Address, PendingUpdateList, OSPF::IPv4Address_Less>::iterator pendingIt = pendingUpdates.begin();
+         pendingIt != pendingUpdates.end();
+         pendingIt++)
+    {
+        std::vector<PendingUpdate>& updates     = pendingIt->second.updates;
+        unsigned long               updateCount = updates.size();
 
-        return updatePacket;
+        for (unsigned long i = 0; i < updateCount; i++) {
+            delete updates[i].lsa;
+        }
     }
-    return NULL;
+    pendingUpdates.clear();
+    parentArea->GetRouter()->GetMessageHandler()->ClearTimer(floodTimer);
 }
 
 void OSPF::Interface::AddDelayedAcknowledgement(OSPFLSAHeader& lsaHeader)
@@ -570,11 +693,3 @@ void OSPF::Interface::SendDelayedAcknowledgements(void)
     }
     messageHandler->StartTimer(acknowledgementTimer, acknowledgementDelay);
 }
-
-void OSPF::Interface::AgeTransmittedLSALists(void)
-{
-    long neighborCount = neighboringRouters.size();
-    for (long i = 0; i < neighborCount; i++) {
-        neighboringRouters[i]->AgeTransmittedLSAList();
-    }
-}
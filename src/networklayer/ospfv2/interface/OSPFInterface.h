@@ -64,6 +64,17 @@ public:
         DesignatedRouterState    = 6
     };
 
+private:
+    struct PendingUpdate {
+        OSPFLSA*    lsa;
+        simtime_t   queueTime;
+    };
+
+    struct PendingUpdateList {
+        std::vector<PendingUpdate>                              updates;
+        std::map<LSAKeyType, unsigned long, LSAKeyType_Less>    positions;     ///< LSA key -> index in updates.
+    };
+
 private:
     OSPFInterfaceType                                                   interfaceType;
     InterfaceState*                                                     state;
@@ -81,10 +92,12 @@ private:
     OSPFTimer*                                                          helloTimer;
     OSPFTimer*                                                          waitTimer;
     OSPFTimer*                                                          acknowledgementTimer;
+    OSPFTimer*                                                          floodTimer;
     std::map<RouterID, Neighbor*>                                       neighboringRoutersByID;
     std::map<IPv4Address, Neighbor*, IPv4Address_Less>                  neighboringRoutersByAddress;
     std::vector<Neighbor*>                                              neighboringRouters;
     std::map<IPv4Address, std::list<OSPFLSAHeader>, IPv4Address_Less>   delayedAcknowledgements;
+    std::map<IPv4Address, PendingUpdateList, IPv4Address_Less>          pendingUpdates;         ///< LSAs waiting for the flood timer, by destination.
     DesignatedRouterID                                                  designatedRouter;
     DesignatedRouterID                                                  backupDesignatedRouter;
     Metric                                                              interfaceOutputCost;
@@ -117,9 +130,12 @@ public:
     bool                FloodLSA                            (OSPFLSA* lsa, Interface* intf = NULL, Neighbor* neighbor = NULL);
     void                AddDelayedAcknowledgement           (OSPFLSAHeader& lsaHeader);
     void                SendDelayedAcknowledgements         (void);
-    void                AgeTransmittedLSALists              (void);
+    void                SendUpdate                          (OSPFLSA* lsa, IPv4Address destination);
+    void                SendPendingUpdates                  (void);
+    void                ClearPendingUpdates                 (void);
 
-    OSPFLinkStateUpdatePacket*  CreateUpdatePacket          (OSPFLSA* lsa);
+    OSPFLinkStateUpdatePacket*  CreateUpdatePacket          (OSPFLSA* lsa = NULL);
+    bool                        AddToUpdatePacket           (OSPFLinkStateUpdatePacket* updatePacket, const OSPFLSA* lsa, unsigned short ageIncrement = 0);
 
     void                    SetType                         (OSPFInterfaceType ifType)  { interfaceType = ifType; }
     OSPFInterfaceType       GetType                         (void) const                { return interfaceType; }
@@ -157,6 +173,7 @@ public:
     OSPFTimer*              GetHelloTimer                   (void)                      { return helloTimer; }
     OSPFTimer*              GetWaitTimer                    (void)                      { return waitTimer; }
     OSPFTimer*              GetAcknowledgementTimer         (void)                      { return acknowledgementTimer; }
+    OSPFTimer*              GetFloodTimer                   (void)                      { return floodTimer; }
     DesignatedRouterID      GetDesignatedRouter             (void) const                { return designatedRouter; }
     DesignatedRouterID      GetBackupDesignatedRouter       (void) const                { return backupDesignatedRouter; }
     unsigned long           GetNeighborCount                (void) const                { return neighboringRouters.size(); }
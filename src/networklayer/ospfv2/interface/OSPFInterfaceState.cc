@@ -54,7 +54,6 @@ void OSPF::InterfaceState::ChangeState(OSPF::Interface* intf, OSPF::InterfaceSta
             if (sequenceNumber == MAX_SEQUENCE_NUMBER) {
                 routerLSA->getHeader().setLsAge(MAX_AGE);
                 intf->GetArea()->FloodLSA(routerLSA);
-                routerLSA->IncrementInstallTime();
             } else {
                 OSPF::RouterLSA* newLSA = intf->GetArea()->OriginateRouterLSA();
 
@@ -91,7 +90,6 @@ void OSPF::InterfaceState::ChangeState(OSPF::Interface* intf, OSPF::InterfaceSta
             if (oldLSA != NULL) {
                 oldLSA->getHeader().setLsAge(MAX_AGE);
                 intf->GetArea()->FloodLSA(oldLSA);
-                oldLSA->IncrementInstallTime();
             }
         }
     }
@@ -102,12 +100,11 @@ void OSPF::InterfaceState::ChangeState(OSPF::Interface* intf, OSPF::InterfaceSta
         if (networkLSA != NULL) {
             networkLSA->getHeader().setLsAge(MAX_AGE);
             intf->GetArea()->FloodLSA(networkLSA);
-            networkLSA->IncrementInstallTime();
         }
     }
 
     if (rebuildRoutingTable) {
-        intf->GetArea()->GetRouter()->RebuildRoutingTable();
+        intf->GetArea()->GetRouter()->ScheduleRoutingTableRebuild();
     }
 }
 
@@ -306,7 +306,6 @@ void OSPF::HelloHandler::ProcessPacket(OSPFPacket* packet, OSPF::Interface* intf
                             if (sequenceNumber == MAX_SEQUENCE_NUMBER) {
                                 routerLSA->getHeader().setLsAge(MAX_AGE);
                                 intf->GetArea()->FloodLSA(routerLSA);
-                                routerLSA->IncrementInstallTime();
                             } else {
                                 OSPF::RouterLSA* newLSA = intf->GetArea()->OriginateRouterLSA();
 
@@ -329,6 +328,6 @@ void OSPF::HelloHandler::ProcessPacket(OSPFPacket* packet, OSPF::Interface* intf
     }
 
     if (rebuildRoutingTable) {
-        router->RebuildRoutingTable();
+        router->ScheduleRoutingTableRebuild();
     }
 }
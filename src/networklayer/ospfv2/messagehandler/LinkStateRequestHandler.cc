@@ -71,31 +71,49 @@ void OSPF::LinkStateRequestHandler::ProcessPacket(OSPFPacket* packet, OSPF::Inte
         }
 
         if (!error) {
-            int                   updatesCount   = lsas.size();
-            int                   ttl            = (intf->GetType() == OSPF::Interface::Virtual) ? VIRTUAL_LINK_TTL : 1;
-            OSPF::MessageHandler* messageHandler = router->GetMessageHandler();
+            int                        updatesCount   = lsas.size();
+            int                        ttl            = (intf->GetType() == OSPF::Interface::Virtual) ? VIRTUAL_LINK_TTL : 1;
+            unsigned long              maxPacketSize  = ((IPV4_HEADER_LENGTH + OSPF_HEADER_LENGTH + OSPF_LSA_HEADER_LENGTH) > intf->GetMTU()) ? IPV4_DATAGRAM_LENGTH : intf->GetMTU();
+            OSPF::MessageHandler*      messageHandler = router->GetMessageHandler();
+            OSPFLinkStateUpdatePacket* updatePacket   = NULL;
+            unsigned long              packetLength   = 0;
+            IPv4Address                destination;
 
+            if (intf->GetType() == OSPF::Interface::Broadcast) {
+                if ((intf->GetState() == OSPF::Interface::DesignatedRouterState) ||
+                    (intf->GetState() == OSPF::Interface::BackupState) ||
+                    (intf->GetDesignatedRouter() == OSPF::NullDesignatedRouterID))
+                {
+                    destination = OSPF::AllSPFRouters;
+                } else {
+                    destination = OSPF::AllDRouters;
+                }
+            } else {
+                if (intf->GetType() == OSPF::Interface::PointToPoint) {
+                    destination = OSPF::AllSPFRouters;
+                } else {
+                    destination = neighbor->GetAddress();
+                }
+            }
+
+            // pack the requested LSAs into as few update packets as the MTU allows
             for (int j = 0; j < updatesCount; j++) {
-                OSPFLinkStateUpdatePacket* updatePacket = intf->CreateUpdatePacket(lsas[j]);
-                if (updatePacket != NULL) {
-                    if (intf->GetType() == OSPF::Interface::Broadcast) {
-                        if ((intf->GetState() == OSPF::Interface::DesignatedRouterState) ||
-                            (intf->GetState() == OSPF::Interface::BackupState) ||
-                            (intf->GetDesignatedRouter() == OSPF::NullDesignatedRouterID))
-                        {
-                            messageHandler->SendPacket(updatePacket, OSPF::AllSPFRouters, intf->GetIfIndex(), ttl);
-                        } else {
-                            messageHandler->SendPacket(updatePacket, OSPF::AllDRouters, intf->GetIfIndex(), ttl);
-                        }
-                    } else {
-                        if (intf->GetType() == OSPF::Interface::PointToPoint) {
-                            messageHandler->SendPacket(updatePacket, OSPF::AllSPFRouters, intf->GetIfIndex(), ttl);
-                        } else {
-                            messageHandler->SendPacket(updatePacket, neighbor->GetAddress(), intf->GetIfIndex(), ttl);
-                        }
-                    }
+                unsigned long lsaSize = CalculateLSASize(lsas[j]);
 
+                if ((updatePacket != NULL) && (packetLength + lsaSize > maxPacketSize)) {
+                    messageHandler->SendPacket(updatePacket, destination, intf->GetIfIndex(), ttl);
+                    updatePacket = NULL;
+                }
+                if (updatePacket == NULL) {
+                    updatePacket = intf->CreateUpdatePacket();
+                    packetLength = IPV4_HEADER_LENGTH + OSPF_HEADER_LENGTH;
                 }
+                if (intf->AddToUpdatePacket(updatePacket, lsas[j])) {
+                    packetLength += lsaSize;
+                }
+            }
+            if (updatePacket != NULL) {
+                messageHandler->SendPacket(updatePacket, destination, intf->GetIfIndex(), ttl);
             }
             // These update packets should not be placed on retransmission lists
         }
@@ -253,7 +253,7 @@ void OSPF::LinkStateUpdateHandler::ProcessPacket(OSPFPacket* packet, OSPF::Inter
     }
 
     if (rebuildRoutingTable) {
-        router->RebuildRoutingTable();
+        router->ScheduleRoutingTableRebuild();
     }
 }
 
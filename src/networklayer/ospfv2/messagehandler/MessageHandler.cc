@@ -87,6 +87,19 @@ void OSPF::MessageHandler::HandleTimer(OSPFTimer* timer)
                 }
             }
             break;
+        case InterfaceFloodTimer:
+            {
+                OSPF::Interface* intf;
+                if (! (intf = reinterpret_cast <OSPF::Interface*> (timer->getContextPointer()))) {
+                    // should not reach this point
+                    EV << "Discarding invalid InterfaceFloodTimer.\n";
+                    delete timer;
+                } else {
+                    PrintEvent("Flood Timer expired", intf);
+                    intf->SendPendingUpdates();
+                }
+            }
+            break;
         case NeighborInactivityTimer:
             {
                 OSPF::Neighbor* neighbor;
@@ -158,6 +171,12 @@ void OSPF::MessageHandler::HandleTimer(OSPFTimer* timer)
                 router->AgeDatabase();
             }
             break;
+        case DatabaseSPFTimer:
+            {
+                PrintEvent("SPF Timer expired");
+                router->RebuildRoutingTable();
+            }
+            break;
         default: break;
     }
 }
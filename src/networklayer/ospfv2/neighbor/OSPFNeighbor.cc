@@ -108,6 +108,7 @@ void OSPF::Neighbor::Reset(void)
         delete(*retIt);
     }
     linkStateRetransmissionList.clear();
+    linkStateRetransmissionIndex.clear();
 
     std::list<OSPFLSAHeader*>::iterator it;
     for (it = databaseSummaryList.begin(); it != databaseSummaryList.end(); it++) {
@@ -392,81 +393,41 @@ bool OSPF::Neighbor::NeedAdjacency(void)
  */
 void OSPF::Neighbor::AddToRetransmissionList(OSPFLSA* lsa)
 {
-    std::list<OSPFLSA*>::iterator it;
-    for (it = linkStateRetransmissionList.begin(); it != linkStateRetransmissionList.end(); it++) {
-        if (((*it)->getHeader().getLinkStateID() == lsa->getHeader().getLinkStateID()) &&
-            ((*it)->getHeader().getAdvertisingRouter().getInt() == lsa->getHeader().getAdvertisingRouter().getInt()))
-        {
-            break;
-        }
-    }
+    OSPF::LSAKeyType lsaKey;
 
-    OSPFLSA* lsaCopy = NULL;
-    switch (lsa->getHeader().getLsType()) {
-        case RouterLSAType:
-            lsaCopy = new OSPFRouterLSA(*(check_and_cast<OSPFRouterLSA*> (lsa)));
-            break;
-        case NetworkLSAType:
-            lsaCopy = new OSPFNetworkLSA(*(check_and_cast<OSPFNetworkLSA*> (lsa)));
-            break;
-        case SummaryLSA_NetworksType:
-        case SummaryLSA_ASBoundaryRoutersType:
-            lsaCopy = new OSPFSummaryLSA(*(check_and_cast<OSPFSummaryLSA*> (lsa)));
-            break;
-        case ASExternalLSAType:
-            lsaCopy = new OSPFASExternalLSA(*(check_and_cast<OSPFASExternalLSA*> (lsa)));
-            break;
-        default:
-            ASSERT(false); // error
-            break;
-    }
+    lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
+    lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
 
-    if (it != linkStateRetransmissionList.end()) {
-        delete(*it);
-        *it = static_cast<OSPFLSA*> (lsaCopy);
+    OSPFLSA* lsaCopy = CopyLSA(lsa);
+
+    std::map<OSPF::LSAKeyType, std::list<OSPFLSA*>::iterator, OSPF::LSAKeyType_Less>::iterator indexIt = linkStateRetransmissionIndex.find(lsaKey);
+    if (indexIt != linkStateRetransmissionIndex.end()) {
+        delete(*(indexIt->second));
+        *(indexIt->second) = lsaCopy;
     } else {
-        linkStateRetransmissionList.push_back(static_cast<OSPFLSA*> (lsaCopy));
+        linkStateRetransmissionIndex[lsaKey] = linkStateRetransmissionList.insert(linkStateRetransmissionList.end(), lsaCopy);
     }
 }
 
 void OSPF::Neighbor::RemoveFromRetransmissionList(OSPF::LSAKeyType lsaKey)
 {
-    std::list<OSPFLSA*>::iterator it = linkStateRetransmissionList.begin();
-    while (it != linkStateRetransmissionList.end()) {
-        if (((*it)->getHeader().getLinkStateID() == lsaKey.linkStateID) &&
-            ((*it)->getHeader().getAdvertisingRouter().getInt() == lsaKey.advertisingRouter))
-        {
-            delete(*it);
-            it = linkStateRetransmissionList.erase(it);
-        } else {
-            it++;
-        }
+    std::map<OSPF::LSAKeyType, std::list<OSPFLSA*>::iterator, OSPF::LSAKeyType_Less>::iterator indexIt = linkStateRetransmissionIndex.find(lsaKey);
+    if (indexIt != linkStateRetransmissionIndex.end()) {
+        delete(*(indexIt->second));
+        linkStateRetransmissionList.erase(indexIt->second);
+        linkStateRetransmissionIndex.erase(indexIt);
     }
 }
 
 bool OSPF::Neighbor::IsLSAOnRetransmissionList(OSPF::LSAKeyType lsaKey) const
 {
-    for (std::list<OSPFLSA*>::const_iterator it = linkStateRetransmissionList.begin(); it != linkStateRetransmissionList.end(); it++) {
-        const OSPFLSA* lsa = *it;
-        if ((lsa->getHeader().getLinkStateID() == lsaKey.linkStateID) &&
-            (lsa->getHeader().getAdvertisingRouter().getInt() == lsaKey.advertisingRouter))
-        {
-            return true;
-        }
-    }
-    return false;
+    return (linkStateRetransmissionIndex.find(lsaKey) != linkStateRetransmissionIndex.end());
 }
 
 OSPFLSA* OSPF::Neighbor::FindOnRetransmissionList(OSPF::LSAKeyType lsaKey)
 {
-    for (std::list<OSPFLSA*>::iterator it = linkStateRetransmissionList.begin(); it != linkStateRetransmissionList.end(); it++) {
-        if (((*it)->getHeader().getLinkStateID() == lsaKey.linkStateID) &&
-            ((*it)->getHeader().getAdvertisingRouter().getInt() == lsaKey.advertisingRouter))
-        {
-            return (*it);
-        }
-    }
-    return NULL;
+    std::map<OSPF::LSAKeyType, std::list<OSPFLSA*>::iterator, OSPF::LSAKeyType_Less>::iterator indexIt = linkStateRetransmissionIndex.find(lsaKey);
+    return (indexIt != linkStateRetransmissionIndex.end()) ? *(indexIt->second) : NULL;
 }
 
 void OSPF::Neighbor::StartUpdateRetransmissionTimer(void)
@@ -549,17 +510,25 @@ void OSPF::Neighbor::ClearRequestRetransmissionTimer(void)
 
 void OSPF::Neighbor::AddToTransmittedLSAList(OSPF::LSAKeyType lsaKey)
 {
+    // the list is ordered by transmission time: drop the entries older than MIN_LS_ARRIVAL
+    while (!transmittedLSAs.empty() && (simTime() - transmittedLSAs.front().transmissionTime >= MIN_LS_ARRIVAL)) {
+        transmittedLSAs.pop_front();
+    }
+
     TransmittedLSA transmit;
 
     transmit.lsaKey = lsaKey;
-    transmit.age = 0;
+    transmit.transmissionTime = simTime();
 
     transmittedLSAs.push_back(transmit);
 }
 
 bool OSPF::Neighbor::IsOnTransmittedLSAList(OSPF::LSAKeyType lsaKey) const
 {
-    for (std::list<TransmittedLSA>::const_iterator it = transmittedLSAs.begin(); it != transmittedLSAs.end(); it++) {
+    for (std::list<TransmittedLSA>::const_reverse_iterator it = transmittedLSAs.rbegin(); it != transmittedLSAs.rend(); it++) {
+        if (simTime() - it->transmissionTime >= MIN_LS_ARRIVAL) {
+            break;
+        }
         if ((it->lsaKey.linkStateID == lsaKey.linkStateID) &&
             (it->lsaKey.advertisingRouter == lsaKey.advertisingRouter))
         {
@@ -569,155 +538,36 @@ bool OSPF::Neighbor::IsOnTransmittedLSAList(OSPF::LSAKeyType lsaKey) const
     return false;
 }
 
-void OSPF::Neighbor::AgeTransmittedLSAList(void)
-{
-    std::list<TransmittedLSA>::iterator it = transmittedLSAs.begin();
-    while ((it != transmittedLSAs.end()) && (it->age == MIN_LS_ARRIVAL)) {
-        transmittedLSAs.pop_front();
-        it = transmittedLSAs.begin();
-    }
-    for (it = transmittedLSAs.begin(); it != transmittedLSAs.end(); it++) {
-        it->age++;
-    }
-}
-
 void OSPF::Neighbor::RetransmitUpdatePacket(void)
 {
-    OSPFLinkStateUpdatePacket* updatePacket = new OSPFLinkStateUpdatePacket;
-
-    updatePacket->setType(LinkStateUpdatePacket);
-    updatePacket->setRouterID(parentInterface->GetArea()->GetRouter()->GetRouterID());
-    updatePacket->setAreaID(parentInterface->GetArea()->GetAreaID());
-    updatePacket->setAuthenticationType(parentInterface->GetAuthenticationType());
-    OSPF::AuthenticationKeyType authKey = parentInterface->GetAuthenticationKey();
-    for (int i = 0; i < 8; i++) {
-        updatePacket->setAuthentication(i, authKey.bytes[i]);
-    }
+    OSPFLinkStateUpdatePacket* updatePacket = parentInterface->CreateUpdatePacket();
 
     bool                          packetFull   = false;
     unsigned short                lsaCount     = 0;
-    unsigned long                 packetLength = IPV4_HEADER_LENGTH + OSPF_LSA_HEADER_LENGTH;
+    unsigned long                 packetLength = IPV4_HEADER_LENGTH + OSPF_HEADER_LENGTH;
     std::list<OSPFLSA*>::iterator it           = linkStateRetransmissionList.begin();
 
     while (!packetFull && (it != linkStateRetransmissionList.end())) {
-        LSAType            lsaType       = static_cast<LSAType> ((*it)->getHeader().getLsType());
-        OSPFRouterLSA*     routerLSA     = (lsaType == RouterLSAType) ? dynamic_cast<OSPFRouterLSA*> (*it) : NULL;
-        OSPFNetworkLSA*    networkLSA    = (lsaType == NetworkLSAType) ? dynamic_cast<OSPFNetworkLSA*> (*it) : NULL;
-        OSPFSummaryLSA*    summaryLSA    = ((lsaType == SummaryLSA_NetworksType) ||
-                                            (lsaType == SummaryLSA_ASBoundaryRoutersType)) ? dynamic_cast<OSPFSummaryLSA*> (*it) : NULL;
-        OSPFASExternalLSA* asExternalLSA = (lsaType == ASExternalLSAType) ? dynamic_cast<OSPFASExternalLSA*> (*it) : NULL;
-        long               lsaSize       = 0;
-        bool               includeLSA    = false;
-
-        switch (lsaType) {
-            case RouterLSAType:
-                if (routerLSA != NULL) {
-                    lsaSize = CalculateLSASize(routerLSA);
-                }
-                break;
-            case NetworkLSAType:
-                if (networkLSA != NULL) {
-                    lsaSize = CalculateLSASize(networkLSA);
-                }
-                break;
-            case SummaryLSA_NetworksType:
-            case SummaryLSA_ASBoundaryRoutersType:
-                if (summaryLSA != NULL) {
-                    lsaSize = CalculateLSASize(summaryLSA);
-                }
-                break;
-            case ASExternalLSAType:
-                if (asExternalLSA != NULL) {
-                    lsaSize = CalculateLSASize(asExternalLSA);
-                }
-                break;
-            default: break;
-        }
+        unsigned long lsaSize    = CalculateLSASize(*it);
+        bool          includeLSA = false;
 
         if (packetLength + lsaSize < parentInterface->GetMTU()) {
             includeLSA = true;
-            lsaCount++;
         } else {
             if ((lsaCount == 0) && (packetLength + lsaSize < IPV4_DATAGRAM_LENGTH)) {
                 includeLSA = true;
-                lsaCount++;
                 packetFull = true;
             }
         }
 
-        if (includeLSA) {
-            switch (lsaType) {
-                case RouterLSAType:
-                    if (routerLSA != NULL) {
-                        unsigned int routerLSACount = updatePacket->getRouterLSAsArraySize();
-
-                        updatePacket->setRouterLSAsArraySize(routerLSACount + 1);
-                        updatePacket->setRouterLSAs(routerLSACount, *routerLSA);
-
-                        unsigned short lsAge = updatePacket->getRouterLSAs(routerLSACount).getHeader().getLsAge();
-                        if (lsAge < MAX_AGE - parentInterface->GetTransmissionDelay()) {
-                            updatePacket->getRouterLSAs(routerLSACount).getHeader().setLsAge(lsAge + parentInterface->GetTransmissionDelay());
-                        } else {
-                            updatePacket->getRouterLSAs(routerLSACount).getHeader().setLsAge(MAX_AGE);
-                        }
-                    }
-                    break;
-                case NetworkLSAType:
-                    if (networkLSA != NULL) {
-                        unsigned int networkLSACount = updatePacket->getNetworkLSAsArraySize();
-
-                        updatePacket->setNetworkLSAsArraySize(networkLSACount + 1);
-                        updatePacket->setNetworkLSAs(networkLSACount, *networkLSA);
-
-                        unsigned short lsAge = updatePacket->getNetworkLSAs(networkLSACount).getHeader().getLsAge();
-                        if (lsAge < MAX_AGE - parentInterface->GetTransmissionDelay()) {
-                            updatePacket->getNetworkLSAs(networkLSACount).getHeader().setLsAge(lsAge + parentInterface->GetTransmissionDelay());
-                        } else {
-                            updatePacket->getNetworkLSAs(networkLSACount).getHeader().setLsAge(MAX_AGE);
-                        }
-                    }
-                    break;
-                case SummaryLSA_NetworksType:
-                case SummaryLSA_ASBoundaryRoutersType:
-                    if (summaryLSA != NULL) {
-                        unsigned int summaryLSACount = updatePacket->getSummaryLSAsArraySize();
-
-                        updatePacket->setSummaryLSAsArraySize(summaryLSACount + 1);
-                        updatePacket->setSummaryLSAs(summaryLSACount, *summaryLSA);
-
-                        unsigned short lsAge = updatePacket->getSummaryLSAs(summaryLSACount).getHeader().getLsAge();
-                        if (lsAge < MAX_AGE - parentInterface->GetTransmissionDelay()) {
-                            updatePacket->getSummaryLSAs(summaryLSACount).getHeader().setLsAge(lsAge + parentInterface->GetTransmissionDelay());
-                        } else {
-                            updatePacket->getSummaryLSAs(summaryLSACount).getHeader().setLsAge(MAX_AGE);
-                        }
-                    }
-                    break;
-                case ASExternalLSAType:
-                    if (asExternalLSA != NULL) {
-                        unsigned int asExternalLSACount = updatePacket->getAsExternalLSAsArraySize();
-
-                        updatePacket->setAsExternalLSAsArraySize(asExternalLSACount + 1);
-                        updatePacket->setAsExternalLSAs(asExternalLSACount, *asExternalLSA);
-
-                        unsigned short lsAge = updatePacket->getAsExternalLSAs(asExternalLSACount).getHeader().getLsAge();
-                        if (lsAge < MAX_AGE - parentInterface->GetTransmissionDelay()) {
-                            updatePacket->getAsExternalLSAs(asExternalLSACount).getHeader().setLsAge(lsAge + parentInterface->GetTransmissionDelay());
-                        } else {
-                            updatePacket->getAsExternalLSAs(asExternalLSACount).getHeader().setLsAge(MAX_AGE);
-                        }
-                    }
-                    break;
-                default: break;
-            }
+        if (includeLSA && parentInterface->AddToUpdatePacket(updatePacket, *it)) {
+            packetLength += lsaSize;
+            lsaCount++;
         }
 
         it++;
     }
 
-    updatePacket->setPacketLength(0); // TODO: Calculate correct length
-    updatePacket->setChecksum(0); // TODO: Calculate correct cheksum(16-bit one's complement of the entire packet)
-
     OSPF::MessageHandler* messageHandler = parentInterface->GetArea()->GetRouter()->GetMessageHandler();
     int ttl = (parentInterface->GetType() == OSPF::Interface::Virtual) ? VIRTUAL_LINK_TTL : 1;
     messageHandler->SendPacket(updatePacket, neighborIPAddress, parentInterface->GetIfIndex(), ttl);
@@ -23,6 +23,7 @@
 #include "OSPFcommon.h"
 #include "LSA.h"
 #include <list>
+#include <map>
 
 namespace OSPF {
 
@@ -79,7 +80,7 @@ public:
 private:
     struct TransmittedLSA {
         LSAKeyType      lsaKey;
-        unsigned short  age;
+        simtime_t       transmissionTime;
     };
 
 private:
@@ -105,6 +106,8 @@ private:
     bool                                designatedRoutersSetUp;
     short                               neighborsRouterDeadInterval;
     std::list<OSPFLSA*>                 linkStateRetransmissionList;
+    std::map<LSAKeyType, std::list<OSPFLSA*>::iterator, LSAKeyType_Less>
+                                        linkStateRetransmissionIndex;   ///< LSA key -> position in linkStateRetransmissionList.
     std::list<OSPFLSAHeader*>           databaseSummaryList;
     std::list<OSPFLSAHeader*>           linkStateRequestList;
     std::list<TransmittedLSA>           transmittedLSAs;
@@ -147,7 +150,6 @@ public:
     void                ClearRequestRetransmissionTimer     (void);
     void                AddToTransmittedLSAList             (LSAKeyType lsaKey);
     bool                IsOnTransmittedLSAList              (LSAKeyType lsaKey) const;
-    void                AgeTransmittedLSAList               (void);
     unsigned long       GetUniqueULong                      (void);
     void                DeleteLastSentDDPacket              (void);
 
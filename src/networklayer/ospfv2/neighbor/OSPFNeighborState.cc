@@ -38,7 +38,6 @@ void OSPF::NeighborState::ChangeState(OSPF::Neighbor* neighbor, OSPF::NeighborSt
             if (sequenceNumber == MAX_SEQUENCE_NUMBER) {
                 routerLSA->getHeader().setLsAge(MAX_AGE);
                 neighbor->GetInterface()->GetArea()->FloodLSA(routerLSA);
-                routerLSA->IncrementInstallTime();
             } else {
                 OSPF::RouterLSA* newLSA = neighbor->GetInterface()->GetArea()->OriginateRouterLSA();
 
@@ -59,7 +58,6 @@ void OSPF::NeighborState::ChangeState(OSPF::Neighbor* neighbor, OSPF::NeighborSt
                 if (sequenceNumber == MAX_SEQUENCE_NUMBER) {
                     networkLSA->getHeader().setLsAge(MAX_AGE);
                     neighbor->GetInterface()->GetArea()->FloodLSA(networkLSA);
-                    networkLSA->IncrementInstallTime();
                 } else {
                     OSPF::NetworkLSA* newLSA = neighbor->GetInterface()->GetArea()->OriginateNetworkLSA(neighbor->GetInterface());
 
@@ -70,7 +68,6 @@ void OSPF::NeighborState::ChangeState(OSPF::Neighbor* neighbor, OSPF::NeighborSt
                         delete newLSA;
                     } else {    // no neighbors on the network -> old NetworkLSA must be flushed
                         networkLSA->getHeader().setLsAge(MAX_AGE);
-                        networkLSA->IncrementInstallTime();
                     }
 
                     neighbor->GetInterface()->GetArea()->FloodLSA(networkLSA);
@@ -80,6 +77,6 @@ void OSPF::NeighborState::ChangeState(OSPF::Neighbor* neighbor, OSPF::NeighborSt
     }
 
     if (rebuildRoutingTable) {
-        neighbor->GetInterface()->GetArea()->GetRouter()->RebuildRoutingTable();
+        neighbor->GetInterface()->GetArea()->GetRouter()->ScheduleRoutingTableRebuild();
     }
 }
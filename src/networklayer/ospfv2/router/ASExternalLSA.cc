@@ -22,6 +22,7 @@ bool OSPF::ASExternalLSA::Update(const OSPFASExternalLSA* lsa)
     bool different = DiffersFrom(lsa);
     (*this) = (*lsa);
     ResetInstallTime();
+    ResetAge(header_var);
     if (different) {
         ClearNextHops();
         return true;
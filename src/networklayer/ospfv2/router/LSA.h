@@ -55,6 +55,15 @@ public:
     OSPFLSA*        GetParent           (void) const                { return parent; }
 };
 
+/**
+ * Bookkeeping attached to the LSAs in the link state database.
+ *
+ * LS ages are not incremented by a periodic sweep: the age written into the
+ * header is remembered together with the time it was set, and UpdateAge()
+ * brings the header up to date from the elapsed simulation time whenever the
+ * LSA is looked up. Explicit writes to the header's LS age (e.g. flushing with
+ * MAX_AGE) are detected by UpdateAge() and aging restarts from the new value.
+ */
 class LSATrackingInfo
 {
 public:
@@ -64,20 +73,53 @@ public:
     };
 
 private:
+    enum { AGE_NOT_SYNCED = 0xFFFF };
+
     InstallSource   source;
-    unsigned long   installTime;
+    simtime_t       installTime;
+    simtime_t       ageBaseTime;    ///< The simulation time the LS age was last set.
+    unsigned short  ageBase;        ///< The LS age at ageBaseTime.
+    unsigned short  syncedAge;      ///< The LS age last seen in/written to the header by UpdateAge().
+    simtime_t       agingDeadline;  ///< Time of this LSA's entry on the Router's aging queue, negative if not queued.
 
 public:
-        LSATrackingInfo(void) : source(Flooded), installTime(0) {}
-        LSATrackingInfo(const LSATrackingInfo& info) : source(info.source), installTime(info.installTime) {}
+        LSATrackingInfo(void) : source(Flooded), installTime(simTime()), ageBaseTime(simTime()), ageBase(0), syncedAge(AGE_NOT_SYNCED), agingDeadline(-1) {}
+        LSATrackingInfo(const LSATrackingInfo& info) : source(info.source), installTime(info.installTime), ageBaseTime(info.ageBaseTime), ageBase(info.ageBase),
+                                                       syncedAge(info.syncedAge), agingDeadline(info.agingDeadline) {}
 
     void            SetSource               (InstallSource installSource)   { source = installSource; }
     InstallSource   GetSource               (void) const                    { return source; }
-    void            IncrementInstallTime    (void)                          { installTime++; }
-    void            ResetInstallTime        (void)                          { installTime = 0; }
-    unsigned long   GetInstallTime          (void) const                    { return installTime; }
+    void            ResetInstallTime        (void)                          { installTime = simTime(); }
+    /** Returns the number of whole seconds elapsed since the LSA was installed. */
+    unsigned long   GetInstallTime          (void) const                    { return (unsigned long) floor(SIMTIME_DBL(simTime() - installTime)); }
+
+    /** Restarts aging from the LS age currently in the header. */
+    void            ResetAge                (const OSPFLSAHeader& header)   { ageBase = syncedAge = header.getLsAge(); ageBaseTime = simTime(); }
+    inline void     UpdateAge               (OSPFLSAHeader& header);
+    /** Returns the simulation time the LS age reaches the input age. The header must be up to date(see UpdateAge()). */
+    simtime_t       GetAgeDeadline          (unsigned short age) const      { return (syncedAge >= age) ? simTime() : ageBaseTime + (age - ageBase); }
+    /** Returns true if the LSA got to MAX_AGE by aging, instead of being flushed explicitly. */
+    bool            HasAgedToMaxAge         (void) const                    { return ((syncedAge == MAX_AGE) && (ageBase < MAX_AGE)); }
+
+    void            SetAgingDeadline        (simtime_t deadline)            { agingDeadline = deadline; }
+    simtime_t       GetAgingDeadline        (void) const                    { return agingDeadline; }
 };
 
+inline void LSATrackingInfo::UpdateAge(OSPFLSAHeader& header)
+{
+    unsigned short lsAge = header.getLsAge();
+
+    if (lsAge != syncedAge) {
+        ResetAge(header);
+    } else if (lsAge < MAX_AGE) {
+        double elapsed = floor(SIMTIME_DBL(simTime() - ageBaseTime));
+
+        lsAge = (ageBase + elapsed >= MAX_AGE) ? MAX_AGE : (ageBase + (unsigned short) elapsed);
+        header.setLsAge(lsAge);
+        syncedAge = lsAge;
+    }
+}
+
 class RouterLSA : public OSPFRouterLSA,
                   public RoutingInfo,
                   public LSATrackingInfo
@@ -269,6 +311,33 @@ inline unsigned int CalculateLSASize(const OSPFASExternalLSA* asExternalLSA)
             (asExternalLSA->getContents().getExternalTOSInfoArraySize() * OSPF_ASEXTERNALLSA_TOS_INFO_LENGTH));
 }
 
+inline unsigned int CalculateLSASize(const OSPFLSA* lsa)
+{
+    switch (lsa->getHeader().getLsType()) {
+        case RouterLSAType:                     return CalculateLSASize(check_and_cast<const OSPFRouterLSA*> (lsa));
+        case NetworkLSAType:                    return CalculateLSASize(check_and_cast<const OSPFNetworkLSA*> (lsa));
+        case SummaryLSA_NetworksType:
+        case SummaryLSA_ASBoundaryRoutersType:  return CalculateLSASize(check_and_cast<const OSPFSummaryLSA*> (lsa));
+        case ASExternalLSAType:                 return CalculateLSASize(check_and_cast<const OSPFASExternalLSA*> (lsa));
+        default:                                return OSPF_LSA_HEADER_LENGTH;
+    }
+}
+
+/**
+ * Returns a heap allocated copy of the input LSA, with the dynamic type selected by the LS type.
+ */
+inline OSPFLSA* CopyLSA(const OSPFLSA* lsa)
+{
+    switch (lsa->getHeader().getLsType()) {
+        case RouterLSAType:                     return new OSPFRouterLSA(*(check_and_cast<const OSPFRouterLSA*> (lsa)));
+        case NetworkLSAType:                    return new OSPFNetworkLSA(*(check_and_cast<const OSPFNetworkLSA*> (lsa)));
+        case SummaryLSA_NetworksType:
+        case SummaryLSA_ASBoundaryRoutersType:  return new OSPFSummaryLSA(*(check_and_cast<const OSPFSummaryLSA*> (lsa)));
+        case ASExternalLSAType:                 return new OSPFASExternalLSA(*(check_and_cast<const OSPFASExternalLSA*> (lsa)));
+        default:                                ASSERT(false); return NULL;
+    }
+}
+
 inline void PrintLSAHeader(const OSPFLSAHeader& lsaHeader, std::ostream& output) {
     char addressString[16];
     output << "LSAHeader: age="
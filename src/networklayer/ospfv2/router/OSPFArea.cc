@@ -18,6 +18,7 @@
 #include "OSPFArea.h"
 #include "OSPFRouter.h"
 #include <memory.h>
+#include <algorithm>
 
 OSPF::Area::Area(OSPF::AreaID id) :
     areaID(id),
@@ -225,11 +226,14 @@ bool OSPF::Area::InstallRouterLSA(OSPFRouterLSA* lsa)
         lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
 
         RemoveFromAllRetransmissionLists(lsaKey);
-        return lsaIt->second->Update(lsa);
+        bool rebuildRoutingTable = lsaIt->second->Update(lsa);
+        parentRouter->ScheduleLSAAging(lsaIt->second, areaID);
+        return rebuildRoutingTable;
     } else {
         OSPF::RouterLSA* lsaCopy = new OSPF::RouterLSA(*lsa);
         routerLSAsByID[linkStateID] = lsaCopy;
         routerLSAs.push_back(lsaCopy);
+        parentRouter->ScheduleLSAAging(lsaCopy, areaID);
         return true;
     }
 }
@@ -245,11 +249,14 @@ bool OSPF::Area::InstallNetworkLSA(OSPFNetworkLSA* lsa)
         lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
 
         RemoveFromAllRetransmissionLists(lsaKey);
-        return lsaIt->second->Update(lsa);
+        bool rebuildRoutingTable = lsaIt->second->Update(lsa);
+        parentRouter->ScheduleLSAAging(lsaIt->second, areaID);
+        return rebuildRoutingTable;
     } else {
         OSPF::NetworkLSA* lsaCopy = new OSPF::NetworkLSA(*lsa);
         networkLSAsByID[linkStateID] = lsaCopy;
         networkLSAs.push_back(lsaCopy);
+        parentRouter->ScheduleLSAAging(lsaCopy, areaID);
         return true;
     }
 }
@@ -269,11 +276,14 @@ bool OSPF::Area::InstallSummaryLSA(OSPFSummaryLSA* lsa)
         lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
 
         RemoveFromAllRetransmissionLists(lsaKey);
-        return lsaIt->second->Update(lsa);
+        bool rebuildRoutingTable = lsaIt->second->Update(lsa);
+        parentRouter->ScheduleLSAAging(lsaIt->second, areaID);
+        return rebuildRoutingTable;
     } else {
         OSPF::SummaryLSA* lsaCopy = new OSPF::SummaryLSA(*lsa);
         summaryLSAsByID[lsaKey] = lsaCopy;
         summaryLSAs.push_back(lsaCopy);
+        parentRouter->ScheduleLSAAging(lsaCopy, areaID);
         return true;
     }
 }
@@ -282,6 +292,7 @@ OSPF::RouterLSA* OSPF::Area::FindRouterLSA(OSPF::LinkStateID linkStateID)
 {
     std::map<OSPF::LinkStateID, OSPF::RouterLSA*>::iterator lsaIt = routerLSAsByID.find(linkStateID);
     if (lsaIt != routerLSAsByID.end()) {
+        lsaIt->second->UpdateAge(lsaIt->second->getHeader());
         return lsaIt->second;
     } else {
         return NULL;
@@ -302,6 +313,7 @@ OSPF::NetworkLSA* OSPF::Area::FindNetworkLSA(OSPF::LinkStateID linkStateID)
 {
     std::map<OSPF::LinkStateID, OSPF::NetworkLSA*>::iterator lsaIt = networkLSAsByID.find(linkStateID);
     if (lsaIt != networkLSAsByID.end()) {
+        lsaIt->second->UpdateAge(lsaIt->second->getHeader());
         return lsaIt->second;
     } else {
         return NULL;
@@ -322,6 +334,7 @@ OSPF::SummaryLSA* OSPF::Area::FindSummaryLSA(OSPF::LSAKeyType lsaKey)
 {
     std::map<OSPF::LSAKeyType, OSPF::SummaryLSA*, OSPF::LSAKeyType_Less>::iterator lsaIt = summaryLSAsByID.find(lsaKey);
     if (lsaIt != summaryLSAsByID.end()) {
+        lsaIt->second->UpdateAge(lsaIt->second->getHeader());
         return lsaIt->second;
     } else {
         return NULL;
@@ -338,296 +351,220 @@ const OSPF::SummaryLSA* OSPF::Area::FindSummaryLSA(OSPF::LSAKeyType lsaKey) cons
     }
 }
 
-void OSPF::Area::AgeDatabase(void)
+/**
+ * Handles an aging deadline of one of the Area's LSAs: re-originates self-originated
+ * LSAs when they reach LS_REFRESH_TIME, floods out LSAs which reached MAX_AGE and
+ * removes MaxAge LSAs from the database once no neighbor needs them anymore.
+ * The input lsa's age must be up to date(see OSPF::LSATrackingInfo::UpdateAge()).
+ * @param lsa [in] The database LSA to age. It may be deleted by this method.
+ * @return True if the routing table needs to be updated, false otherwise.
+ * @sa RFC2328 Section 14.
+ */
+bool OSPF::Area::AgeLSA(OSPFLSA* lsa)
 {
-    long            lsaCount            = routerLSAs.size();
-    bool            rebuildRoutingTable = false;
-    long            i;
-
-    for (i = 0; i < lsaCount; i++) {
-        unsigned short   lsAge          = routerLSAs[i]->getHeader().getLsAge();
-        bool             selfOriginated = (routerLSAs[i]->getHeader().getAdvertisingRouter().getInt() == parentRouter->GetRouterID());
-        bool             unreachable    = parentRouter->IsDestinationUnreachable(routerLSAs[i]);
-        OSPF::RouterLSA* lsa            = routerLSAs[i];
-
-        if ((selfOriginated && (lsAge < (LS_REFRESH_TIME - 1))) || (!selfOriginated && (lsAge < (MAX_AGE - 1)))) {
-            lsa->getHeader().setLsAge(lsAge + 1);
-            if ((lsAge + 1) % CHECK_AGE == 0) {
-                if (!lsa->ValidateLSChecksum()) {
-                    EV << "Invalid LS checksum. Memory error detected!\n";
-                }
-            }
-            lsa->IncrementInstallTime();
-        }
-        if (selfOriginated && (lsAge == (LS_REFRESH_TIME - 1))) {
-            if (unreachable) {
-                lsa->getHeader().setLsAge(MAX_AGE);
-                FloodLSA(lsa);
-                lsa->IncrementInstallTime();
-            } else {
-                long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
-                if (sequenceNumber == MAX_SEQUENCE_NUMBER) {
-                    lsa->getHeader().setLsAge(MAX_AGE);
-                    FloodLSA(lsa);
-                    lsa->IncrementInstallTime();
-                } else {
-                    OSPF::RouterLSA* newLSA = OriginateRouterLSA();
-
-                    newLSA->getHeader().setLsSequenceNumber(sequenceNumber + 1);
-                    newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
-                    rebuildRoutingTable |= lsa->Update(newLSA);
-                    delete newLSA;
+    switch (lsa->getHeader().getLsType()) {
+        case RouterLSAType:
+            return AgeRouterLSA(check_and_cast<OSPF::RouterLSA*> (lsa));
+        case NetworkLSAType:
+            return AgeNetworkLSA(check_and_cast<OSPF::NetworkLSA*> (lsa));
+        case SummaryLSA_NetworksType:
+        case SummaryLSA_ASBoundaryRoutersType:
+            return AgeSummaryLSA(check_and_cast<OSPF::SummaryLSA*> (lsa));
+        default:
+            ASSERT(false);
+            break;
+    }
+    return false;
+}
 
-                    FloodLSA(lsa);
-                }
-            }
-        }
-        if (!selfOriginated && (lsAge == MAX_AGE - 1)) {
+bool OSPF::Area::AgeRouterLSA(OSPF::RouterLSA* lsa)
+{
+    unsigned short lsAge               = lsa->getHeader().getLsAge();
+    bool           selfOriginated      = (lsa->getHeader().getAdvertisingRouter().getInt() == parentRouter->GetRouterID());
+    bool           unreachable         = parentRouter->IsDestinationUnreachable(lsa);
+    bool           rebuildRoutingTable = false;
+
+    if (selfOriginated && (lsAge >= LS_REFRESH_TIME) && (lsAge < MAX_AGE)) {
+        long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
+        if (unreachable || (sequenceNumber == MAX_SEQUENCE_NUMBER)) {
             lsa->getHeader().setLsAge(MAX_AGE);
             FloodLSA(lsa);
-            lsa->IncrementInstallTime();
-        }
-        if (lsAge == MAX_AGE) {
-            OSPF::LSAKeyType lsaKey;
-
-            lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
-            lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
-
-            if (!IsOnAnyRetransmissionList(lsaKey) &&
-                !HasAnyNeighborInStates(OSPF::Neighbor::ExchangeState | OSPF::Neighbor::LoadingState))
-            {
-                if (!selfOriginated || unreachable) {
-                    routerLSAsByID.erase(lsa->getHeader().getLinkStateID());
-                    delete lsa;
-                    routerLSAs[i] = NULL;
-                    rebuildRoutingTable = true;
-                } else {
-                    OSPF::RouterLSA* newLSA              = OriginateRouterLSA();
-                    long             sequenceNumber      = lsa->getHeader().getLsSequenceNumber();
+        } else {
+            OSPF::RouterLSA* newLSA = OriginateRouterLSA();
 
-                    newLSA->getHeader().setLsSequenceNumber((sequenceNumber == MAX_SEQUENCE_NUMBER) ? INITIAL_SEQUENCE_NUMBER : sequenceNumber + 1);
-                    newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
-                    rebuildRoutingTable |= lsa->Update(newLSA);
-                    delete newLSA;
+            newLSA->getHeader().setLsSequenceNumber(sequenceNumber + 1);
+            newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
+            rebuildRoutingTable |= lsa->Update(newLSA);
+            delete newLSA;
 
-                    FloodLSA(lsa);
-                }
-            }
+            FloodLSA(lsa);
         }
+        return rebuildRoutingTable;
     }
-
-    std::vector<RouterLSA*>::iterator routerIt = routerLSAs.begin();
-    while (routerIt != routerLSAs.end()) {
-        if ((*routerIt) == NULL) {
-            routerIt = routerLSAs.erase(routerIt);
-        } else {
-            routerIt++;
-        }
+    if (lsa->HasAgedToMaxAge()) {
+        lsa->ResetAge(lsa->getHeader());
+        FloodLSA(lsa);
+        return false;
     }
+    if (lsAge == MAX_AGE) {
+        OSPF::LSAKeyType lsaKey;
 
-    lsaCount = networkLSAs.size();
-    for (i = 0; i < lsaCount; i++) {
-        unsigned short    lsAge          = networkLSAs[i]->getHeader().getLsAge();
-        bool              unreachable    = parentRouter->IsDestinationUnreachable(networkLSAs[i]);
-        OSPF::NetworkLSA* lsa            = networkLSAs[i];
-        OSPF::Interface*  localIntf      = GetInterface(IPv4AddressFromULong(lsa->getHeader().getLinkStateID()));
-        bool              selfOriginated = false;
-
-        if ((localIntf != NULL) &&
-            (localIntf->GetState() == OSPF::Interface::DesignatedRouterState) &&
-            (localIntf->GetNeighborCount() > 0) &&
-            (localIntf->HasAnyNeighborInStates(OSPF::Neighbor::FullState)))
-        {
-            selfOriginated = true;
-        }
+        lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
+        lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
 
-        if ((selfOriginated && (lsAge < (LS_REFRESH_TIME - 1))) || (!selfOriginated && (lsAge < (MAX_AGE - 1)))) {
-            lsa->getHeader().setLsAge(lsAge + 1);
-            if ((lsAge + 1) % CHECK_AGE == 0) {
-                if (!lsa->ValidateLSChecksum()) {
-                    EV << "Invalid LS checksum. Memory error detected!\n";
-                }
-            }
-            lsa->IncrementInstallTime();
-        }
-        if (selfOriginated && (lsAge == (LS_REFRESH_TIME - 1))) {
-            if (unreachable) {
-                lsa->getHeader().setLsAge(MAX_AGE);
-                FloodLSA(lsa);
-                lsa->IncrementInstallTime();
+        if (!IsOnAnyRetransmissionList(lsaKey) &&
+            !HasAnyNeighborInStates(OSPF::Neighbor::ExchangeState | OSPF::Neighbor::LoadingState))
+        {
+            if (!selfOriginated || unreachable) {
+                routerLSAsByID.erase(lsa->getHeader().getLinkStateID());
+                routerLSAs.erase(std::find(routerLSAs.begin(), routerLSAs.end(), lsa));
+                delete lsa;
+                rebuildRoutingTable = true;
             } else {
-                long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
-                if (sequenceNumber == MAX_SEQUENCE_NUMBER) {
-                    lsa->getHeader().setLsAge(MAX_AGE);
-                    FloodLSA(lsa);
-                    lsa->IncrementInstallTime();
-                } else {
-                    OSPF::NetworkLSA* newLSA = OriginateNetworkLSA(localIntf);
-
-                    if (newLSA != NULL) {
-                        newLSA->getHeader().setLsSequenceNumber(sequenceNumber + 1);
-                        newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
-                        rebuildRoutingTable |= lsa->Update(newLSA);
-                        delete newLSA;
-                    } else {    // no neighbors on the network -> old NetworkLSA must be flushed
-                        lsa->getHeader().setLsAge(MAX_AGE);
-                        lsa->IncrementInstallTime();
-                    }
-
-                    FloodLSA(lsa);
-                }
-            }
-        }
-        if (!selfOriginated && (lsAge == MAX_AGE - 1)) {
-            lsa->getHeader().setLsAge(MAX_AGE);
-            FloodLSA(lsa);
-            lsa->IncrementInstallTime();
-        }
-        if (lsAge == MAX_AGE) {
-            OSPF::LSAKeyType lsaKey;
+                OSPF::RouterLSA* newLSA              = OriginateRouterLSA();
+                long             sequenceNumber      = lsa->getHeader().getLsSequenceNumber();
 
-            lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
-            lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
+                newLSA->getHeader().setLsSequenceNumber((sequenceNumber == MAX_SEQUENCE_NUMBER) ? INITIAL_SEQUENCE_NUMBER : sequenceNumber + 1);
+                newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
+                rebuildRoutingTable |= lsa->Update(newLSA);
+                delete newLSA;
 
-            if (!IsOnAnyRetransmissionList(lsaKey) &&
-                !HasAnyNeighborInStates(OSPF::Neighbor::ExchangeState | OSPF::Neighbor::LoadingState))
-            {
-                if (!selfOriginated || unreachable) {
-                    networkLSAsByID.erase(lsa->getHeader().getLinkStateID());
-                    delete lsa;
-                    networkLSAs[i] = NULL;
-                    rebuildRoutingTable = true;
-                } else {
-                    OSPF::NetworkLSA* newLSA              = OriginateNetworkLSA(localIntf);
-                    long              sequenceNumber      = lsa->getHeader().getLsSequenceNumber();
-
-                    if (newLSA != NULL) {
-                        newLSA->getHeader().setLsSequenceNumber((sequenceNumber == MAX_SEQUENCE_NUMBER) ? INITIAL_SEQUENCE_NUMBER : sequenceNumber + 1);
-                        newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
-                        rebuildRoutingTable |= lsa->Update(newLSA);
-                        delete newLSA;
-
-                        FloodLSA(lsa);
-                    } else {    // no neighbors on the network -> old NetworkLSA must be deleted
-                        delete networkLSAs[i];
-                    }
-                }
+                FloodLSA(lsa);
             }
         }
     }
+    return rebuildRoutingTable;
+}
 
-    std::vector<NetworkLSA*>::iterator networkIt = networkLSAs.begin();
-    while (networkIt != networkLSAs.end()) {
-        if ((*networkIt) == NULL) {
-            networkIt = networkLSAs.erase(networkIt);
-        } else {
-            networkIt++;
-        }
+bool OSPF::Area::AgeNetworkLSA(OSPF::NetworkLSA* lsa)
+{
+    unsigned short   lsAge               = lsa->getHeader().getLsAge();
+    bool             unreachable         = parentRouter->IsDestinationUnreachable(lsa);
+    OSPF::Interface* localIntf           = GetInterface(IPv4AddressFromULong(lsa->getHeader().getLinkStateID()));
+    bool             selfOriginated      = false;
+    bool             rebuildRoutingTable = false;
+
+    if ((localIntf != NULL) &&
+        (localIntf->GetState() == OSPF::Interface::DesignatedRouterState) &&
+        (localIntf->GetNeighborCount() > 0) &&
+        (localIntf->HasAnyNeighborInStates(OSPF::Neighbor::FullState)))
+    {
+        selfOriginated = true;
     }
 
-    lsaCount = summaryLSAs.size();
-    for (i = 0; i < lsaCount; i++) {
-        unsigned short    lsAge          = summaryLSAs[i]->getHeader().getLsAge();
-        bool              selfOriginated = (summaryLSAs[i]->getHeader().getAdvertisingRouter().getInt() == parentRouter->GetRouterID());
-        bool              unreachable    = parentRouter->IsDestinationUnreachable(summaryLSAs[i]);
-        OSPF::SummaryLSA* lsa            = summaryLSAs[i];
-
-        if ((selfOriginated && (lsAge < (LS_REFRESH_TIME - 1))) || (!selfOriginated && (lsAge < (MAX_AGE - 1)))) {
-            lsa->getHeader().setLsAge(lsAge + 1);
-            if ((lsAge + 1) % CHECK_AGE == 0) {
-                if (!lsa->ValidateLSChecksum()) {
-                    EV << "Invalid LS checksum. Memory error detected!\n";
-                }
-            }
-            lsa->IncrementInstallTime();
-        }
-        if (selfOriginated && (lsAge == (LS_REFRESH_TIME - 1))) {
-            if (unreachable) {
+    if (selfOriginated && (lsAge >= LS_REFRESH_TIME) && (lsAge < MAX_AGE)) {
+        long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
+        if (unreachable || (sequenceNumber == MAX_SEQUENCE_NUMBER)) {
+            lsa->getHeader().setLsAge(MAX_AGE);
+            FloodLSA(lsa);
+        } else {
+            OSPF::NetworkLSA* newLSA = OriginateNetworkLSA(localIntf);
+
+            if (newLSA != NULL) {
+                newLSA->getHeader().setLsSequenceNumber(sequenceNumber + 1);
+                newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
+                rebuildRoutingTable |= lsa->Update(newLSA);
+                delete newLSA;
+            } else {    // no neighbors on the network -> old NetworkLSA must be flushed
                 lsa->getHeader().setLsAge(MAX_AGE);
-                FloodLSA(lsa);
-                lsa->IncrementInstallTime();
-            } else {
-                long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
-                if (sequenceNumber == MAX_SEQUENCE_NUMBER) {
-                    lsa->getHeader().setLsAge(MAX_AGE);
-                    FloodLSA(lsa);
-                    lsa->IncrementInstallTime();
-                } else {
-                    OSPF::SummaryLSA* newLSA = OriginateSummaryLSA(lsa);
-
-                    if (newLSA != NULL) {
-                        newLSA->getHeader().setLsSequenceNumber(sequenceNumber + 1);
-                        newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
-                        rebuildRoutingTable |= lsa->Update(newLSA);
-                        delete newLSA;
-
-                        FloodLSA(lsa);
-                    } else {
-                        lsa->getHeader().setLsAge(MAX_AGE);
-                        FloodLSA(lsa);
-                        lsa->IncrementInstallTime();
-                    }
-                }
             }
-        }
-        if (!selfOriginated && (lsAge == MAX_AGE - 1)) {
-            lsa->getHeader().setLsAge(MAX_AGE);
+
             FloodLSA(lsa);
-            lsa->IncrementInstallTime();
         }
-        if (lsAge == MAX_AGE) {
-            OSPF::LSAKeyType lsaKey;
+        return rebuildRoutingTable;
+    }
+    if (lsa->HasAgedToMaxAge()) {
+        lsa->ResetAge(lsa->getHeader());
+        FloodLSA(lsa);
+        return false;
+    }
+    if (lsAge == MAX_AGE) {
+        OSPF::LSAKeyType lsaKey;
 
-            lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
-            lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
+        lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
+        lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
 
-            if (!IsOnAnyRetransmissionList(lsaKey) &&
-                !HasAnyNeighborInStates(OSPF::Neighbor::ExchangeState | OSPF::Neighbor::LoadingState))
-            {
-                if (!selfOriginated || unreachable) {
-                    summaryLSAsByID.erase(lsaKey);
-                    delete lsa;
-                    summaryLSAs[i] = NULL;
-                    rebuildRoutingTable = true;
-                } else {
-                    OSPF::SummaryLSA* newLSA = OriginateSummaryLSA(lsa);
-                    if (newLSA != NULL) {
-                        long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
+        if (!IsOnAnyRetransmissionList(lsaKey) &&
+            !HasAnyNeighborInStates(OSPF::Neighbor::ExchangeState | OSPF::Neighbor::LoadingState))
+        {
+            OSPF::NetworkLSA* newLSA = (!selfOriginated || unreachable) ? NULL : OriginateNetworkLSA(localIntf);
 
-                        newLSA->getHeader().setLsSequenceNumber((sequenceNumber == MAX_SEQUENCE_NUMBER) ? INITIAL_SEQUENCE_NUMBER : sequenceNumber + 1);
-                        newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
-                        rebuildRoutingTable |= lsa->Update(newLSA);
-                        delete newLSA;
+            if (newLSA != NULL) {
+                long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
 
-                        FloodLSA(lsa);
-                    } else {
-                        summaryLSAsByID.erase(lsaKey);
-                        delete lsa;
-                        summaryLSAs[i] = NULL;
-                        rebuildRoutingTable = true;
-                    }
-                }
+                newLSA->getHeader().setLsSequenceNumber((sequenceNumber == MAX_SEQUENCE_NUMBER) ? INITIAL_SEQUENCE_NUMBER : sequenceNumber + 1);
+                newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
+                rebuildRoutingTable |= lsa->Update(newLSA);
+                delete newLSA;
+
+                FloodLSA(lsa);
+            } else {    // not ours or no neighbors on the network -> old NetworkLSA must be deleted
+                networkLSAsByID.erase(lsa->getHeader().getLinkStateID());
+                networkLSAs.erase(std::find(networkLSAs.begin(), networkLSAs.end(), lsa));
+                delete lsa;
+                rebuildRoutingTable = true;
             }
         }
     }
+    return rebuildRoutingTable;
+}
 
-    std::vector<SummaryLSA*>::iterator summaryIt = summaryLSAs.begin();
-    while (summaryIt != summaryLSAs.end()) {
-        if ((*summaryIt) == NULL) {
-            summaryIt = summaryLSAs.erase(summaryIt);
+bool OSPF::Area::AgeSummaryLSA(OSPF::SummaryLSA* lsa)
+{
+    unsigned short lsAge               = lsa->getHeader().getLsAge();
+    bool           selfOriginated      = (lsa->getHeader().getAdvertisingRouter().getInt() == parentRouter->GetRouterID());
+    bool           unreachable         = parentRouter->IsDestinationUnreachable(lsa);
+    bool           rebuildRoutingTable = false;
+
+    if (selfOriginated && (lsAge >= LS_REFRESH_TIME) && (lsAge < MAX_AGE)) {
+        long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
+        OSPF::SummaryLSA* newLSA = (unreachable || (sequenceNumber == MAX_SEQUENCE_NUMBER)) ? NULL : OriginateSummaryLSA(lsa);
+
+        if (newLSA != NULL) {
+            newLSA->getHeader().setLsSequenceNumber(sequenceNumber + 1);
+            newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
+            rebuildRoutingTable |= lsa->Update(newLSA);
+            delete newLSA;
         } else {
-            summaryIt++;
+            lsa->getHeader().setLsAge(MAX_AGE);
         }
+        FloodLSA(lsa);
+        return rebuildRoutingTable;
     }
-
-    long interfaceCount = associatedInterfaces.size();
-    for (long m = 0; m < interfaceCount; m++) {
-        associatedInterfaces[m]->AgeTransmittedLSALists();
+    if (lsa->HasAgedToMaxAge()) {
+        lsa->ResetAge(lsa->getHeader());
+        FloodLSA(lsa);
+        return false;
     }
+    if (lsAge == MAX_AGE) {
+        OSPF::LSAKeyType lsaKey;
+
+        lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
+        lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
+
+        if (!IsOnAnyRetransmissionList(lsaKey) &&
+            !HasAnyNeighborInStates(OSPF::Neighbor::ExchangeState | OSPF::Neighbor::LoadingState))
+        {
+            OSPF::SummaryLSA* newLSA = (!selfOriginated || unreachable) ? NULL : OriginateSummaryLSA(lsa);
+
+            if (newLSA != NULL) {
+                long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
+
+                newLSA->getHeader().setLsSequenceNumber((sequenceNumber == MAX_SEQUENCE_NUMBER) ? INITIAL_SEQUENCE_NUMBER : sequenceNumber + 1);
+                newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
+                rebuildRoutingTable |= lsa->Update(newLSA);
+                delete newLSA;
 
-    if (rebuildRoutingTable) {
-        parentRouter->RebuildRoutingTable();
+                FloodLSA(lsa);
+            } else {
+                summaryLSAsByID.erase(lsaKey);
+                summaryLSAs.erase(std::find(summaryLSAs.begin(), summaryLSAs.end(), lsa));
+                delete lsa;
+                rebuildRoutingTable = true;
+            }
+        }
     }
+    return rebuildRoutingTable;
 }
 
 bool OSPF::Area::HasAnyNeighborInStates(int states) const
@@ -665,6 +602,9 @@ bool OSPF::Area::FloodLSA(OSPFLSA* lsa, OSPF::Interface* intf, OSPF::Neighbor* n
     bool floodedBackOut  = false;
     long interfaceCount = associatedInterfaces.size();
 
+    // flooding means the database instance was (re)originated or flushed: its aging deadline may have moved
+    parentRouter->ScheduleLSAAging(lsa, areaID);
+
     for (long i = 0; i < interfaceCount; i++) {
         if (associatedInterfaces[i]->FloodLSA(lsa, intf, neighbor)) {
             floodedBackOut = true;
@@ -2097,11 +2037,11 @@ bool OSPF::Area::HasLink(OSPFLSA* fromLSA, OSPFLSA* toLSA) const
 }
 
 /**
- * Browse through the newRoutingTable looking for entries describing the same destination
+ * Look up the entries of the new routing table describing the same destination
  * as the currentLSA. If a cheaper route is found then skip this LSA(return true), else
  * note those which are of equal or worse cost than the currentCost.
  */
-bool OSPF::Area::FindSameOrWorseCostRoute(const std::vector<OSPF::RoutingTableEntry*>& newRoutingTable,
+bool OSPF::Area::FindSameOrWorseCostRoute(const OSPF::RoutingTableIndex&               newTableIndex,
                                            const OSPF::SummaryLSA&                      summaryLSA,
                                            unsigned short                               currentCost,
                                            bool&                                        destinationInRoutingTable,
@@ -2110,51 +2050,39 @@ bool OSPF::Area::FindSameOrWorseCostRoute(const std::vector<OSPF::RoutingTableEn
     destinationInRoutingTable = false;
     sameOrWorseCost.clear();
 
-    long                   routeCount = newRoutingTable.size();
-    OSPF::IPv4AddressRange destination;
+    OSPF::IPv4AddressRange                  destination;
+    OSPF::RoutingTableIndex::EntryRange     matchingEntries;
 
     destination.address = IPv4AddressFromULong(summaryLSA.getHeader().getLinkStateID());
     destination.mask    = IPv4AddressFromULong(summaryLSA.getNetworkMask().getInt());
 
-    for (long j = 0; j < routeCount; j++) {
-        OSPF::RoutingTableEntry* routingEntry  = newRoutingTable[j];
-        bool                     foundMatching = false;
+    if (summaryLSA.getHeader().getLsType() == SummaryLSA_NetworksType) {
+        matchingEntries = newTableIndex.GetNetworkEntries(ULongFromIPv4Address(destination.address & destination.mask));
+    } else {
+        matchingEntries = newTableIndex.GetRouterEntries(ULongFromIPv4Address(destination.address));
+    }
 
-        if (summaryLSA.getHeader().getLsType() == SummaryLSA_NetworksType) {
-            if ((routingEntry->GetDestinationType() == OSPF::RoutingTableEntry::NetworkDestination) &&
-                (ULongFromIPv4Address(destination.address & destination.mask) == routingEntry->GetDestinationID().getInt()))
-            {
-                foundMatching = true;
-            }
-        } else {
-            if ((((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::AreaBorderRouterDestination) != 0) ||
-                 ((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0)) &&
-                (ULongFromIPv4Address(destination.address) == routingEntry->GetDestinationID().getInt()))
-            {
-                foundMatching = true;
-            }
-        }
+    for (OSPF::RoutingTableIndex::EntryIterator it = matchingEntries.first; it != matchingEntries.second; it++) {
+        OSPF::RoutingTableEntry* routingEntry = it->second;
 
-        if (foundMatching) {
-            destinationInRoutingTable = true;
+        destinationInRoutingTable = true;
 
-            /* If the matching entry is an IntraArea getRoute(intra-area paths are
-                * always preferred to other paths of any cost), or it's a cheaper InterArea
-                * route, then skip this LSA.
-                */
-            if ((routingEntry->GetPathType() == OSPF::RoutingTableEntry::IntraArea) ||
-                ((routingEntry->GetPathType() == OSPF::RoutingTableEntry::InterArea) &&
-                 (routingEntry->GetCost() < currentCost)))
+        /* If the matching entry is an IntraArea getRoute(intra-area paths are
+            * always preferred to other paths of any cost), or it's a cheaper InterArea
+            * route, then skip this LSA.
+            */
+        if ((routingEntry->GetPathType() == OSPF::RoutingTableEntry::IntraArea) ||
+            ((routingEntry->GetPathType() == OSPF::RoutingTableEntry::InterArea) &&
+             (routingEntry->GetCost() < currentCost)))
+        {
+            return true;
+        } else {
+            // if it's an other InterArea path
+            if ((routingEntry->GetPathType() == OSPF::RoutingTableEntry::InterArea) &&
+                (routingEntry->GetCost() >= currentCost))
             {
-                return true;
-            } else {
-                // if it's an other InterArea path
-                if ((routingEntry->GetPathType() == OSPF::RoutingTableEntry::InterArea) &&
-                    (routingEntry->GetCost() >= currentCost))
-                {
-                    sameOrWorseCost.push_back(routingEntry);
-                }   // else it's external -> same as if not in the table
-            }
+                sameOrWorseCost.push_back(routingEntry);
+            }   // else it's external -> same as if not in the table
         }
     }
     return false;
@@ -2198,16 +2126,30 @@ OSPF::RoutingTableEntry* OSPF::Area::CreateRoutingTableEntryFromSummaryLSA(const
     return newEntry;
 }
 
+/**
+ * Returns the first area border or AS boundary router entry of this area in the
+ * new routing table describing the router identified by routerID, or NULL if there's none.
+ */
+OSPF::RoutingTableEntry* OSPF::Area::FindBorderRouterEntry(const OSPF::RoutingTableIndex& newTableIndex, OSPF::RouterID routerID) const
+{
+    OSPF::RoutingTableIndex::EntryRange routerEntries = newTableIndex.GetRouterEntries(routerID);
+
+    for (OSPF::RoutingTableIndex::EntryIterator it = routerEntries.first; it != routerEntries.second; it++) {
+        if (it->second->GetArea() == areaID) {
+            return it->second;
+        }
+    }
+    return NULL;
+}
+
 /**
  * @see RFC 2328 Section 16.2.
- * @todo This function does a lot of lookup in the input newRoutingTable.
- *       Restructuring the input vector into some kind of hash would quite
- *       probably speed up execution.
+ * The lookups in the new routing table go through newTableIndex, which is kept
+ * up to date with the entries added to and removed from newRoutingTable.
  */
-void OSPF::Area::CalculateInterAreaRoutes(std::vector<OSPF::RoutingTableEntry*>& newRoutingTable)
+void OSPF::Area::CalculateInterAreaRoutes(std::vector<OSPF::RoutingTableEntry*>& newRoutingTable, OSPF::RoutingTableIndex& newTableIndex)
 {
     unsigned long i = 0;
-    unsigned long j = 0;
     unsigned long lsaCount = summaryLSAs.size();
 
     for (i = 0; i < lsaCount; i++) {
@@ -2224,50 +2166,21 @@ void OSPF::Area::CalculateInterAreaRoutes(std::vector<OSPF::RoutingTableEntry*>&
         }
 
         char                   lsType     = currentHeader.getLsType();
-        unsigned long          routeCount = newRoutingTable.size();
         OSPF::IPv4AddressRange destination;
 
         destination.address = IPv4AddressFromULong(currentHeader.getLinkStateID());
         destination.mask    = IPv4AddressFromULong(currentLSA->getNetworkMask().getInt());
 
         if ((lsType == SummaryLSA_NetworksType) && (parentRouter->HasAddressRange(destination))) { // (3)
-            bool foundIntraAreaRoute = false;
-
             // look for an "Active" IntraArea route
-            for (j = 0; j < routeCount; j++) {
-                OSPF::RoutingTableEntry* routingEntry = newRoutingTable[j];
-
-                if ((routingEntry->GetDestinationType() == OSPF::RoutingTableEntry::NetworkDestination) &&
-                    (routingEntry->GetPathType() == OSPF::RoutingTableEntry::IntraArea) &&
-                    ((routingEntry->GetDestinationID().getInt() &
-                      routingEntry->GetAddressMask().getInt()   &
-                      ULongFromIPv4Address(destination.mask)       ) == ULongFromIPv4Address(destination.address &
-                                                                                               destination.mask)))
-                {
-                    foundIntraAreaRoute = true;
-                    break;
-                }
-            }
-            if (foundIntraAreaRoute) {
+            if (newTableIndex.HasIntraAreaNetworkWithin(destination)) {
                 continue;
             }
         }
 
-        OSPF::RoutingTableEntry* borderRouterEntry = NULL;
-
         // The routingEntry describes a route to an other area -> look for the border router originating it
-        for (j = 0; j < routeCount; j++) {     // (4) N == destination, BR == borderRouterEntry
-            OSPF::RoutingTableEntry* routingEntry = newRoutingTable[j];
+        OSPF::RoutingTableEntry* borderRouterEntry = FindBorderRouterEntry(newTableIndex, originatingRouter);  // (4) N == destination, BR == borderRouterEntry
 
-            if ((routingEntry->GetArea() == areaID) &&
-                (((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::AreaBorderRouterDestination) != 0) ||
-                 ((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0)) &&
-                (routingEntry->GetDestinationID().getInt() == originatingRouter))
-            {
-                borderRouterEntry = routingEntry;
-                break;
-            }
-        }
         if (borderRouterEntry == NULL) {
             continue;
         } else {    // (5)
@@ -2279,7 +2192,7 @@ void OSPF::Area::CalculateInterAreaRoutes(std::vector<OSPF::RoutingTableEntry*>&
             unsigned short                      currentCost               = routeCost + borderRouterEntry->GetCost();
             std::list<OSPF::RoutingTableEntry*> sameOrWorseCost;
 
-            if (FindSameOrWorseCostRoute(newRoutingTable,
+            if (FindSameOrWorseCostRoute(newTableIndex,
                                           *currentLSA,
                                           currentCost,
                                           destinationInRoutingTable,
@@ -2300,6 +2213,7 @@ void OSPF::Area::CalculateInterAreaRoutes(std::vector<OSPF::RoutingTableEntry*>&
                     if (checkedEntry->GetCost() > currentCost) {
                         for (std::vector<OSPF::RoutingTableEntry*>::iterator entryIt = newRoutingTable.begin(); entryIt != newRoutingTable.end(); entryIt++) {
                             if (checkedEntry == (*entryIt)) {
+                                newTableIndex.RemoveEntry(checkedEntry);
                                 newRoutingTable.erase(entryIt);
                                 break;
                             }
@@ -2322,17 +2236,19 @@ void OSPF::Area::CalculateInterAreaRoutes(std::vector<OSPF::RoutingTableEntry*>&
                     OSPF::RoutingTableEntry* newEntry = CreateRoutingTableEntryFromSummaryLSA(*currentLSA, currentCost, *borderRouterEntry);
                     ASSERT(newEntry != NULL);
                     newRoutingTable.push_back(newEntry);
+                    newTableIndex.AddEntry(newEntry);
                 }
             } else {
                 OSPF::RoutingTableEntry* newEntry = CreateRoutingTableEntryFromSummaryLSA(*currentLSA, currentCost, *borderRouterEntry);
                 ASSERT(newEntry != NULL);
                 newRoutingTable.push_back(newEntry);
+                newTableIndex.AddEntry(newEntry);
             }
         }
     }
 }
 
-void OSPF::Area::ReCheckSummaryLSAs(std::vector<OSPF::RoutingTableEntry*>& newRoutingTable)
+void OSPF::Area::ReCheckSummaryLSAs(std::vector<OSPF::RoutingTableEntry*>& newRoutingTable, OSPF::RoutingTableIndex& newTableIndex)
 {
     unsigned long i = 0;
     unsigned long j = 0;
@@ -2351,70 +2267,43 @@ void OSPF::Area::ReCheckSummaryLSAs(std::vector<OSPF::RoutingTableEntry*>& newRo
             continue;
         }
 
-        unsigned long            routeCount       = newRoutingTable.size();
-        char                     lsType           = currentHeader.getLsType();
-        OSPF::RoutingTableEntry* destinationEntry = NULL;
-        OSPF::IPv4AddressRange   destination;
+        char                                lsType           = currentHeader.getLsType();
+        OSPF::RoutingTableEntry*            destinationEntry = NULL;
+        OSPF::IPv4AddressRange              destination;
+        OSPF::RoutingTableIndex::EntryRange matchingEntries;
 
         destination.address = IPv4AddressFromULong(currentHeader.getLinkStateID());
         destination.mask    = IPv4AddressFromULong(currentLSA->getNetworkMask().getInt());
 
-        for (j = 0; j < routeCount; j++) {  // (3)
-            OSPF::RoutingTableEntry* routingEntry  = newRoutingTable[j];
-            bool                     foundMatching = false;
-
-            if (lsType == SummaryLSA_NetworksType) {
-                if ((routingEntry->GetDestinationType() == OSPF::RoutingTableEntry::NetworkDestination) &&
-                    (ULongFromIPv4Address(destination.address & destination.mask) == routingEntry->GetDestinationID().getInt()))
-                {
-                    foundMatching = true;
-                }
-            } else {
-                if ((((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::AreaBorderRouterDestination) != 0) ||
-                     ((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0)) &&
-                    (ULongFromIPv4Address(destination.address) == routingEntry->GetDestinationID().getInt()))
-                {
-                    foundMatching = true;
-                }
-            }
+        if (lsType == SummaryLSA_NetworksType) {   // (3)
+            matchingEntries = newTableIndex.GetNetworkEntries(ULongFromIPv4Address(destination.address & destination.mask));
+        } else {
+            matchingEntries = newTableIndex.GetRouterEntries(ULongFromIPv4Address(destination.address));
+        }
 
-            if (foundMatching) {
-                OSPF::RoutingTableEntry::RoutingPathType pathType = routingEntry->GetPathType();
+        if (matchingEntries.first != matchingEntries.second) {
+            OSPF::RoutingTableEntry*                 routingEntry = matchingEntries.first->second;
+            OSPF::RoutingTableEntry::RoutingPathType pathType     = routingEntry->GetPathType();
 
-                if ((pathType == OSPF::RoutingTableEntry::Type1External) ||
-                    (pathType == OSPF::RoutingTableEntry::Type2External) ||
-                    (routingEntry->GetArea() != OSPF::BackboneAreaID))
-                {
-                    break;
-                } else {
-                    destinationEntry = routingEntry;
-                    break;
-                }
+            if ((pathType != OSPF::RoutingTableEntry::Type1External) &&
+                (pathType != OSPF::RoutingTableEntry::Type2External) &&
+                (routingEntry->GetArea() == OSPF::BackboneAreaID))
+            {
+                destinationEntry = routingEntry;
             }
         }
         if (destinationEntry == NULL) {
             continue;
         }
 
-        OSPF::RoutingTableEntry* borderRouterEntry = NULL;
+        OSPF::RoutingTableEntry* borderRouterEntry = FindBorderRouterEntry(newTableIndex, originatingRouter);   // (4) BR == borderRouterEntry
         unsigned short           currentCost       = routeCost;
 
-        for (j = 0; j < routeCount; j++) {     // (4) BR == borderRouterEntry
-            OSPF::RoutingTableEntry* routingEntry = newRoutingTable[j];
-
-            if ((routingEntry->GetArea() == areaID) &&
-                (((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::AreaBorderRouterDestination) != 0) ||
-                 ((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0)) &&
-                (routingEntry->GetDestinationID().getInt() == originatingRouter))
-            {
-                borderRouterEntry = routingEntry;
-                currentCost += borderRouterEntry->GetCost();
-                break;
-            }
-        }
         if (borderRouterEntry == NULL) {
             continue;
         } else {    // (5)
+            currentCost += borderRouterEntry->GetCost();
+
             if (currentCost <= destinationEntry->GetCost()) {
                 if (currentCost < destinationEntry->GetCost()) {
                     destinationEntry->ClearNextHops();
@@ -24,6 +24,7 @@
 #include "OSPFInterface.h"
 #include "LSA.h"
 #include "OSPFRoutingTableEntry.h"
+#include "OSPFRoutingTableIndex.h"
 
 namespace OSPF {
 
@@ -73,13 +74,13 @@ public:
     const Router*       GetRouter                       (void) const                                    { return parentRouter; }
 
     unsigned long       GetRouterLSACount               (void) const                                    { return routerLSAs.size(); }
-    RouterLSA*          GetRouterLSA                    (unsigned long i)                               { return routerLSAs[i]; }
+    RouterLSA*          GetRouterLSA                    (unsigned long i)                               { routerLSAs[i]->UpdateAge(routerLSAs[i]->getHeader()); return routerLSAs[i]; }
     const RouterLSA*    GetRouterLSA                    (unsigned long i) const                         { return routerLSAs[i]; }
     unsigned long       GetNetworkLSACount              (void) const                                    { return networkLSAs.size(); }
-    NetworkLSA*         GetNetworkLSA                   (unsigned long i)                               { return networkLSAs[i]; }
+    NetworkLSA*         GetNetworkLSA                   (unsigned long i)                               { networkLSAs[i]->UpdateAge(networkLSAs[i]->getHeader()); return networkLSAs[i]; }
     const NetworkLSA*   GetNetworkLSA                   (unsigned long i) const                         { return networkLSAs[i]; }
     unsigned long       GetSummaryLSACount              (void) const                                    { return summaryLSAs.size(); }
-    SummaryLSA*         GetSummaryLSA                   (unsigned long i)                               { return summaryLSAs[i]; }
+    SummaryLSA*         GetSummaryLSA                   (unsigned long i)                               { summaryLSAs[i]->UpdateAge(summaryLSAs[i]->getHeader()); return summaryLSAs[i]; }
     const SummaryLSA*   GetSummaryLSA                   (unsigned long i) const                         { return summaryLSAs[i]; }
 
     bool                ContainsAddress                     (IPv4Address address) const;
@@ -100,7 +101,7 @@ public:
     const NetworkLSA*   FindNetworkLSA                      (LinkStateID linkStateID) const;
     SummaryLSA*         FindSummaryLSA                      (LSAKeyType lsaKey);
     const SummaryLSA*   FindSummaryLSA                      (LSAKeyType lsaKey) const;
-    void                AgeDatabase                         (void);
+    bool                AgeLSA                              (OSPFLSA* lsa);
     bool                HasAnyNeighborInStates              (int states) const;
     void                RemoveFromAllRetransmissionLists    (LSAKeyType lsaKey);
     bool                IsOnAnyRetransmissionList           (LSAKeyType lsaKey) const;
@@ -112,13 +113,16 @@ public:
                                                              const std::map<LSAKeyType, bool, LSAKeyType_Less>& originatedLSAs,
                                                              SummaryLSA*& lsaToReoriginate);
     void                CalculateShortestPathTree           (std::vector<RoutingTableEntry*>& newRoutingTable);
-    void                CalculateInterAreaRoutes            (std::vector<RoutingTableEntry*>& newRoutingTable);
-    void                ReCheckSummaryLSAs                  (std::vector<RoutingTableEntry*>& newRoutingTable);
+    void                CalculateInterAreaRoutes            (std::vector<RoutingTableEntry*>& newRoutingTable, RoutingTableIndex& newTableIndex);
+    void                ReCheckSummaryLSAs                  (std::vector<RoutingTableEntry*>& newRoutingTable, RoutingTableIndex& newTableIndex);
 
     void        info(char* buffer);
     std::string detailedInfo(void) const;
 
 private:
+    bool                    AgeRouterLSA                            (RouterLSA* lsa);
+    bool                    AgeNetworkLSA                           (NetworkLSA* lsa);
+    bool                    AgeSummaryLSA                           (SummaryLSA* lsa);
     SummaryLSA*             OriginateSummaryLSA                     (const OSPF::SummaryLSA* summaryLSA);
     bool                    HasLink                                 (OSPFLSA* fromLSA, OSPFLSA* toLSA) const;
     std::vector<NextHop>*   CalculateNextHops                       (OSPFLSA* destination, OSPFLSA* parent) const;
@@ -128,12 +132,14 @@ private:
                                                                      Metric destinationCost,
                                                                      SummaryLSA*& lsaToReoriginate) const;
 
-    bool                    FindSameOrWorseCostRoute                (const std::vector<OSPF::RoutingTableEntry*>& newRoutingTable,
+    bool                    FindSameOrWorseCostRoute                (const OSPF::RoutingTableIndex&               newTableIndex,
                                                                      const OSPF::SummaryLSA&                      currentLSA,
                                                                      unsigned short                               currentCost,
                                                                      bool&                                        destinationInRoutingTable,
                                                                      std::list<OSPF::RoutingTableEntry*>&         sameOrWorseCost) const;
 
+    RoutingTableEntry*      FindBorderRouterEntry                   (const OSPF::RoutingTableIndex& newTableIndex, RouterID routerID) const;
+
     RoutingTableEntry*      CreateRoutingTableEntryFromSummaryLSA   (const OSPF::SummaryLSA&        summaryLSA,
                                                                      unsigned short                 entryCost,
                                                                      const OSPF::RoutingTableEntry& borderRouterEntry) const;
@@ -17,21 +17,32 @@
 
 #include "OSPFRouter.h"
 #include "RoutingTableAccess.h"
+#include <algorithm>
 
 /**
  * Constructor.
- * Initializes internal variables, adds a MessageHandler and starts the Database Age timer.
+ * Initializes internal variables and adds a MessageHandler. The Database Age timer is started
+ * when the first LSA is put on the aging queue.
  */
 OSPF::Router::Router(OSPF::RouterID id, cSimpleModule* containingModule) :
     routerID(id),
-    rfc1583Compatibility(false)
+    rfc1583Compatibility(false),
+    floodPacingInterval(0),
+    spfInitialDelay(0),
+    spfHoldTime(0),
+    spfMaxHoldTime(0),
+    spfCurrentHoldTime(0),
+    lastSPFTime(-1)
 {
     messageHandler = new OSPF::MessageHandler(this, containingModule);
     ageTimer = new OSPFTimer;
     ageTimer->setTimerKind(DatabaseAgeTimer);
     ageTimer->setContextPointer(this);
     ageTimer->setName("OSPF::Router::DatabaseAgeTimer");
-    messageHandler->StartTimer(ageTimer, 1.0);
+    spfTimer = new OSPFTimer;
+    spfTimer->setTimerKind(DatabaseSPFTimer);
+    spfTimer->setContextPointer(this);
+    spfTimer->setName("OSPF::Router::DatabaseSPFTimer");
 }
 
 
@@ -55,6 +66,8 @@ OSPF::Router::~Router(void)
     }
     messageHandler->ClearTimer(ageTimer);
     delete ageTimer;
+    messageHandler->ClearTimer(spfTimer);
+    delete spfTimer;
     delete messageHandler;
 }
 
@@ -216,19 +229,9 @@ bool OSPF::Router::InstallASExternalLSA(OSPFASExternalLSA* lsa)
      */
      // TODO: how to solve this problem?
 
-    OSPF::RouterID advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
-    bool           reachable         = false;
-    unsigned int   routeCount        = routingTable.size();
-
-    for (unsigned int i = 0; i < routeCount; i++) {
-        if ((((routingTable[i]->GetDestinationType() & OSPF::RoutingTableEntry::AreaBorderRouterDestination) != 0) ||
-             ((routingTable[i]->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0)) &&
-            (routingTable[i]->GetDestinationID().getInt() == advertisingRouter))
-        {
-            reachable = true;
-            break;
-        }
-    }
+    OSPF::RouterID                      advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
+    OSPF::RoutingTableIndex::EntryRange routerEntries     = routingTableIndex.GetRouterEntries(advertisingRouter);
+    bool                                reachable         = (routerEntries.first != routerEntries.second);
 
     bool             ownLSAFloodedOut = false;
     OSPF::LSAKeyType lsaKey;
@@ -249,7 +252,6 @@ bool OSPF::Router::InstallASExternalLSA(OSPFASExternalLSA* lsa)
         } else {
             lsaIt->second->getHeader().setLsAge(MAX_AGE);
             FloodLSA(lsaIt->second, OSPF::BackboneAreaID);
-            lsaIt->second->IncrementInstallTime();
             ownLSAFloodedOut = true;
         }
     }
@@ -262,11 +264,14 @@ bool OSPF::Router::InstallASExternalLSA(OSPFASExternalLSA* lsa)
         for (unsigned long i = 0; i < areaCount; i++) {
             areas[i]->RemoveFromAllRetransmissionLists(lsaKey);
         }
-        return ((lsaIt->second->Update(lsa)) | ownLSAFloodedOut);
+        bool rebuildRoutingTable = lsaIt->second->Update(lsa);
+        ScheduleLSAAging(lsaIt->second, OSPF::BackboneAreaID);
+        return (rebuildRoutingTable | ownLSAFloodedOut);
     } else {
         OSPF::ASExternalLSA* lsaCopy = new OSPF::ASExternalLSA(*lsa);
         asExternalLSAsByID[lsaKey] = lsaCopy;
         asExternalLSAs.push_back(lsaCopy);
+        ScheduleLSAAging(lsaCopy, OSPF::BackboneAreaID);
         return true;
     }
 }
@@ -330,6 +335,7 @@ OSPF::ASExternalLSA* OSPF::Router::FindASExternalLSA(OSPF::LSAKeyType lsaKey)
 {
     std::map<OSPF::LSAKeyType, OSPF::ASExternalLSA*, OSPF::LSAKeyType_Less>::iterator lsaIt = asExternalLSAsByID.find(lsaKey);
     if (lsaIt != asExternalLSAsByID.end()) {
+        lsaIt->second->UpdateAge(lsaIt->second->getHeader());
         return lsaIt->second;
     } else {
         return NULL;
@@ -354,112 +360,174 @@ const OSPF::ASExternalLSA* OSPF::Router::FindASExternalLSA(OSPF::LSAKeyType lsaK
 
 
 /**
- * Ages the LSAs in the Router's database.
- * This method is called on every firing of the DatabaseAgeTimer(every second).
+ * Puts the database instance of the input LSA on the aging queue, for the next
+ * moment its age has to be acted upon: reaching LS_REFRESH_TIME(re-origination of
+ * self-originated LSAs) or MAX_AGE(flushing). MaxAge LSAs are rechecked every second
+ * until they can be removed from the database.
+ * Does nothing if the LSA is not in the database or is already queued for an earlier time.
+ * @param lsa    [in] The LSA whose database instance should be queued.
+ * @param areaID [in] The Area of the input Router, Network and Summary LSA.
+ */
+void OSPF::Router::ScheduleLSAAging(OSPFLSA* lsa, OSPF::AreaID areaID)
+{
+    LSAType          lsaType = static_cast<LSAType> (lsa->getHeader().getLsType());
+    OSPF::LSAKeyType lsaKey;
+
+    lsaKey.linkStateID = lsa->getHeader().getLinkStateID();
+    lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
+
+    OSPFLSA*               lsaInDatabase = FindLSA(lsaType, lsaKey, areaID);    // also brings its age up to date
+    OSPF::LSATrackingInfo* info          = (lsaInDatabase != NULL) ? dynamic_cast<OSPF::LSATrackingInfo*> (lsaInDatabase) : NULL;
+
+    if (info == NULL) {
+        return;
+    }
+
+    unsigned short lsAge = lsaInDatabase->getHeader().getLsAge();
+    simtime_t      deadline;
+
+    if (lsAge < LS_REFRESH_TIME) {
+        deadline = info->GetAgeDeadline(LS_REFRESH_TIME);
+    } else if (lsAge < MAX_AGE) {
+        deadline = info->GetAgeDeadline(MAX_AGE);
+    } else {
+        deadline = simTime() + 1.0;
+    }
+
+    simtime_t queuedDeadline = info->GetAgingDeadline();
+    if ((queuedDeadline >= 0) && (queuedDeadline <= deadline)) {
+        return;     // the earlier entry will reschedule the LSA when it's processed
+    }
+
+    AgingQueueEntry entry;
+
+    entry.lsaType = lsaType;
+    entry.lsaKey = lsaKey;
+    entry.areaID = areaID;
+    agingQueue.insert(std::make_pair(deadline, entry));
+    info->SetAgingDeadline(deadline);
+
+    if (!ageTimer->isScheduled() || (ageTimer->getArrivalTime() > deadline)) {
+        messageHandler->ClearTimer(ageTimer);
+        messageHandler->StartTimer(ageTimer, deadline - simTime());
+    }
+}
+
+
+/**
+ * Ages the LSAs in the Router's database whose aging deadline has passed.
+ * This method is called on every firing of the DatabaseAgeTimer, which is always
+ * scheduled for the earliest deadline on the aging queue. Queue entries superseded by an
+ * earlier one, or belonging to LSAs removed from the database since, are skipped.
  * @sa RFC2328 Section 14.
  */
 void OSPF::Router::AgeDatabase(void)
 {
-    long lsaCount            = asExternalLSAs.size();
     bool rebuildRoutingTable = false;
 
-    for (long i = 0; i < lsaCount; i++) {
-        unsigned short       lsAge          = asExternalLSAs[i]->getHeader().getLsAge();
-        bool                 selfOriginated = (asExternalLSAs[i]->getHeader().getAdvertisingRouter().getInt() == routerID);
-        bool                 unreachable    = IsDestinationUnreachable(asExternalLSAs[i]);
-        OSPF::ASExternalLSA* lsa            = asExternalLSAs[i];
-
-        if ((selfOriginated && (lsAge < (LS_REFRESH_TIME - 1))) || (!selfOriginated && (lsAge < (MAX_AGE - 1)))) {
-            lsa->getHeader().setLsAge(lsAge + 1);
-            if ((lsAge + 1) % CHECK_AGE == 0) {
-                if (!lsa->ValidateLSChecksum()) {
-                    EV << "Invalid LS checksum. Memory error detected!\n";
-                }
-            }
-            lsa->IncrementInstallTime();
-        }
-        if (selfOriginated && (lsAge == (LS_REFRESH_TIME - 1))) {
-            if (unreachable) {
-                lsa->getHeader().setLsAge(MAX_AGE);
-                FloodLSA(lsa, OSPF::BackboneAreaID);
-                lsa->IncrementInstallTime();
-            } else {
-                long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
-                if (sequenceNumber == MAX_SEQUENCE_NUMBER) {
-                    lsa->getHeader().setLsAge(MAX_AGE);
-                    FloodLSA(lsa, OSPF::BackboneAreaID);
-                    lsa->IncrementInstallTime();
-                } else {
-                    OSPF::ASExternalLSA* newLSA = OriginateASExternalLSA(lsa);
+    while (!agingQueue.empty() && (agingQueue.begin()->first <= simTime())) {
+        simtime_t       deadline = agingQueue.begin()->first;
+        AgingQueueEntry entry    = agingQueue.begin()->second;
 
-                    newLSA->getHeader().setLsSequenceNumber(sequenceNumber + 1);
-                    newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
-                    rebuildRoutingTable |= lsa->Update(newLSA);
-                    delete newLSA;
+        agingQueue.erase(agingQueue.begin());
 
-                    FloodLSA(lsa, OSPF::BackboneAreaID);
-                }
-            }
-        }
-        if (!selfOriginated && (lsAge == MAX_AGE - 1)) {
-            lsa->getHeader().setLsAge(MAX_AGE);
-            FloodLSA(lsa, OSPF::BackboneAreaID);
-            lsa->IncrementInstallTime();
+        OSPFLSA*               lsa  = FindLSA(entry.lsaType, entry.lsaKey, entry.areaID);
+        OSPF::LSATrackingInfo* info = (lsa != NULL) ? dynamic_cast<OSPF::LSATrackingInfo*> (lsa) : NULL;
+
+        if ((info == NULL) || (info->GetAgingDeadline() != deadline)) {
+            continue;
         }
-        if (lsAge == MAX_AGE) {
-            OSPF::LSAKeyType lsaKey;
+        info->SetAgingDeadline(-1);
 
-            lsaKey.linkStateID       = lsa->getHeader().getLinkStateID();
-            lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
+        if (entry.lsaType == ASExternalLSAType) {
+            rebuildRoutingTable |= AgeASExternalLSA(check_and_cast<OSPF::ASExternalLSA*> (lsa));
+        } else {
+            OSPF::Area* area = GetArea(entry.areaID);
+            if (area != NULL) {
+                rebuildRoutingTable |= area->AgeLSA(lsa);
+            }
+        }
 
-            if (!IsOnAnyRetransmissionList(lsaKey) &&
-                !HasAnyNeighborInStates(OSPF::Neighbor::ExchangeState | OSPF::Neighbor::LoadingState))
-            {
-                if (!selfOriginated || unreachable) {
-                    asExternalLSAsByID.erase(lsaKey);
-                    delete lsa;
-                    asExternalLSAs[i] = NULL;
-                    rebuildRoutingTable = true;
-                } else {
-                    if (lsa->GetPurgeable()) {
-                        asExternalLSAsByID.erase(lsaKey);
-                        delete lsa;
-                        asExternalLSAs[i] = NULL;
-                        rebuildRoutingTable = true;
-                    } else {
-                        OSPF::ASExternalLSA* newLSA              = OriginateASExternalLSA(lsa);
-                        long                 sequenceNumber      = lsa->getHeader().getLsSequenceNumber();
+        lsa = FindLSA(entry.lsaType, entry.lsaKey, entry.areaID);
+        if (lsa != NULL) {
+            ScheduleLSAAging(lsa, entry.areaID);
+        }
+    }
 
-                        newLSA->getHeader().setLsSequenceNumber((sequenceNumber == MAX_SEQUENCE_NUMBER) ? INITIAL_SEQUENCE_NUMBER : sequenceNumber + 1);
-                        newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
-                        rebuildRoutingTable |= lsa->Update(newLSA);
-                        delete newLSA;
+    messageHandler->ClearTimer(ageTimer);
+    if (!agingQueue.empty()) {
+        messageHandler->StartTimer(ageTimer, agingQueue.begin()->first - simTime());
+    }
 
-                        FloodLSA(lsa, OSPF::BackboneAreaID);
-                    }
-                }
-            }
-        }
+    if (rebuildRoutingTable) {
+        ScheduleRoutingTableRebuild();
     }
+}
 
-    std::vector<ASExternalLSA*>::iterator it = asExternalLSAs.begin();
-    while (it != asExternalLSAs.end()) {
-        if ((*it) == NULL) {
-            it = asExternalLSAs.erase(it);
+
+/**
+ * Handles an aging deadline of an AS External LSA.
+ * @param lsa [in] The database LSA to age. It may be deleted by this method.
+ * @return True if the routing table needs to be updated, false otherwise.
+ * @sa OSPF::Area::AgeLSA
+ */
+bool OSPF::Router::AgeASExternalLSA(OSPF::ASExternalLSA* lsa)
+{
+    unsigned short lsAge               = lsa->getHeader().getLsAge();
+    bool           selfOriginated      = (lsa->getHeader().getAdvertisingRouter().getInt() == routerID);
+    bool           unreachable         = IsDestinationUnreachable(lsa);
+    bool           rebuildRoutingTable = false;
+
+    if (selfOriginated && (lsAge >= LS_REFRESH_TIME) && (lsAge < MAX_AGE)) {
+        long sequenceNumber = lsa->getHeader().getLsSequenceNumber();
+        if (unreachable || (sequenceNumber == MAX_SEQUENCE_NUMBER)) {
+            lsa->getHeader().setLsAge(MAX_AGE);
+            FloodLSA(lsa, OSPF::BackboneAreaID);
         } else {
-            it++;
+            OSPF::ASExternalLSA* newLSA = OriginateASExternalLSA(lsa);
+
+            newLSA->getHeader().setLsSequenceNumber(sequenceNumber + 1);
+            newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
+            rebuildRoutingTable |= lsa->Update(newLSA);
+            delete newLSA;
+
+            FloodLSA(lsa, OSPF::BackboneAreaID);
         }
+        return rebuildRoutingTable;
     }
-
-    long areaCount = areas.size();
-    for (long j = 0; j < areaCount; j++) {
-        areas[j]->AgeDatabase();
+    if (lsa->HasAgedToMaxAge()) {
+        lsa->ResetAge(lsa->getHeader());
+        FloodLSA(lsa, OSPF::BackboneAreaID);
+        return false;
     }
-    messageHandler->StartTimer(ageTimer, 1.0);
+    if (lsAge == MAX_AGE) {
+        OSPF::LSAKeyType lsaKey;
 
-    if (rebuildRoutingTable) {
-        RebuildRoutingTable();
+        lsaKey.linkStateID       = lsa->getHeader().getLinkStateID();
+        lsaKey.advertisingRouter = lsa->getHeader().getAdvertisingRouter().getInt();
+
+        if (!IsOnAnyRetransmissionList(lsaKey) &&
+            !HasAnyNeighborInStates(OSPF::Neighbor::ExchangeState | OSPF::Neighbor::LoadingState))
+        {
+            if (!selfOriginated || unreachable || lsa->GetPurgeable()) {
+                asExternalLSAsByID.erase(lsaKey);
+                asExternalLSAs.erase(std::find(asExternalLSAs.begin(), asExternalLSAs.end(), lsa));
+                delete lsa;
+                rebuildRoutingTable = true;
+            } else {
+                OSPF::ASExternalLSA* newLSA              = OriginateASExternalLSA(lsa);
+                long                 sequenceNumber      = lsa->getHeader().getLsSequenceNumber();
+
+                newLSA->getHeader().setLsSequenceNumber((sequenceNumber == MAX_SEQUENCE_NUMBER) ? INITIAL_SEQUENCE_NUMBER : sequenceNumber + 1);
+                newLSA->getHeader().setLsChecksum(0);    // TODO: calculate correct LS checksum
+                rebuildRoutingTable |= lsa->Update(newLSA);
+                delete newLSA;
+
+                FloodLSA(lsa, OSPF::BackboneAreaID);
+            }
+        }
     }
+    return rebuildRoutingTable;
 }
 
 
@@ -526,6 +594,8 @@ bool OSPF::Router::FloodLSA(OSPFLSA* lsa, OSPF::AreaID areaID /*= BackboneAreaID
 
     if (lsa != NULL) {
         if (lsa->getHeader().getLsType() == ASExternalLSAType) {
+            ScheduleLSAAging(lsa, OSPF::BackboneAreaID);
+
             long areaCount = areas.size();
             for (long i = 0; i < areaCount; i++) {
                 if (areas[i]->GetExternalRoutingCapability()) {
@@ -721,95 +791,90 @@ bool OSPF::Router::IsDestinationUnreachable(OSPFLSA* lsa) const
 
 
 /**
- * Do a lookup in either the input OSPF routing table, or if it's NULL then in the Router's own routing table.
+ * Do a lookup in either the input OSPF routing table index, or if it's NULL then in the Router's own routing table.
  * @sa RFC2328 Section 11.1.
  * @param destination [in] The destination to look up in the routing table.
- * @param table       [in] The routing table to do the lookup in.
+ * @param tableIndex  [in] The index of the routing table to do the lookup in.
  * @return The RoutingTableEntry describing the input destination if there's one, false otherwise.
  */
-OSPF::RoutingTableEntry* OSPF::Router::Lookup(IPAddress destination, std::vector<OSPF::RoutingTableEntry*>* table /*= NULL*/) const
+OSPF::RoutingTableEntry* OSPF::Router::Lookup(IPAddress destination, const OSPF::RoutingTableIndex* tableIndex /*= NULL*/) const
+{
+    const OSPF::RoutingTableIndex& index = (tableIndex == NULL) ? routingTableIndex : (*tableIndex);
+
+    return index.Lookup(destination.getInt());
+}
+
+
+/**
+ * Indexes the input routing table and adds the discard entries of the areas'
+ * active address ranges to the index.
+ * @param table      [in] The routing table to index.
+ * @param tableIndex [out] The index to (re)build.
+ * @sa RFC2328 Section 11.1.
+ */
+void OSPF::Router::BuildRoutingTableIndex(const std::vector<OSPF::RoutingTableEntry*>& table, OSPF::RoutingTableIndex& tableIndex) const
 {
-    const std::vector<OSPF::RoutingTableEntry*>& rTable           = (table == NULL) ? routingTable : (*table);
-    unsigned long                                dest             = destination.getInt();
-    unsigned long                                routingTableSize = rTable.size();
-    bool                                         unreachable      = false;
-    std::vector<OSPF::RoutingTableEntry*>        discard;
-    unsigned long                                i;
+    tableIndex.Build(table);
 
     unsigned long areaCount = areas.size();
-    for (i = 0; i < areaCount; i++) {
+    for (unsigned long i = 0; i < areaCount; i++) {
         unsigned int addressRangeCount = areas[i]->GetAddressRangeCount();
         for (unsigned int j = 0; j < addressRangeCount; j++) {
             OSPF::IPv4AddressRange range = areas[i]->GetAddressRange(j);
 
-            for (unsigned int k = 0; k < routingTableSize; k++) {
-                OSPF::RoutingTableEntry* entry = rTable[k];
-
-                if (entry->GetDestinationType() != OSPF::RoutingTableEntry::NetworkDestination) {
-                    continue;
-                }
-                if (((entry->GetDestinationID().getInt() & entry->GetAddressMask().getInt() & ULongFromIPv4Address(range.mask)) == ULongFromIPv4Address(range.address & range.mask)) &&
-                    (entry->GetPathType() == OSPF::RoutingTableEntry::IntraArea))
-                {
-                    // active area address range
-                    OSPF::RoutingTableEntry* discardEntry = new OSPF::RoutingTableEntry;
-                    discardEntry->SetDestinationID(ULongFromIPv4Address(range.address));
-                    discardEntry->SetAddressMask(ULongFromIPv4Address(range.mask));
-                    discardEntry->SetDestinationType(OSPF::RoutingTableEntry::NetworkDestination);
-                    discardEntry->SetPathType(OSPF::RoutingTableEntry::InterArea);
-                    discardEntry->SetArea(areas[i]->GetAreaID());
-                    discard.push_back(discardEntry);
-                    break;
-                }
+            if (tableIndex.HasIntraAreaNetworkWithin(range)) {
+                tableIndex.AddDiscardRange(range);
             }
         }
     }
+}
 
-    OSPF::RoutingTableEntry* bestMatch = NULL;
-    unsigned long            longestMatch = 0;
 
-    for (i = 0; i < routingTableSize; i++) {
-        if (rTable[i]->GetDestinationType() == OSPF::RoutingTableEntry::NetworkDestination) {
-            OSPF::RoutingTableEntry* entry        = rTable[i];
-            unsigned long            entryAddress = entry->GetDestinationID().getInt();
-            unsigned long            entryMask    = entry->GetAddressMask().getInt();
+/**
+ * Sets the parameters of the routing table calculation throttle. After a quiet
+ * period the calculation runs initialDelay after the first change. Changes within
+ * the hold time of the previous calculation are deferred until the hold time
+ * expires, and each such deferral doubles the hold time up to maxHoldTime.
+ * If both initialDelay and holdTime are 0, the routing table is rebuilt at once
+ * on every change.
+ */
+void OSPF::Router::SetSPFThrottle(simtime_t initialDelay, simtime_t holdTime, simtime_t maxHoldTime)
+{
+    spfInitialDelay = initialDelay;
+    spfHoldTime = holdTime;
+    spfMaxHoldTime = (maxHoldTime > holdTime) ? maxHoldTime : holdTime;
+    spfCurrentHoldTime = holdTime;
+}
 
-            if ((entryAddress & entryMask) == (dest & entryMask)) {
-                if ((dest & entryMask) > longestMatch) {
-                    longestMatch = (dest & entryMask);
-                    bestMatch    = entry;
-                }
-            }
-        }
-    }
 
-    unsigned int discardCount = discard.size();
-    if (bestMatch == NULL) {
-        unreachable = true;
-    } else {
-        for (i = 0; i < discardCount; i++) {
-            OSPF::RoutingTableEntry* entry        = discard[i];
-            unsigned long            entryAddress = entry->GetDestinationID().getInt();
-            unsigned long            entryMask    = entry->GetAddressMask().getInt();
-
-            if ((entryAddress & entryMask) == (dest & entryMask)) {
-                if ((dest & entryMask) > longestMatch) {
-                    unreachable = true;
-                    break;
-                }
-            }
-        }
+/**
+ * Requests a routing table rebuild after a change in the LSA database. The
+ * requests are coalesced and throttled as set by SetSPFThrottle().
+ */
+void OSPF::Router::ScheduleRoutingTableRebuild(void)
+{
+    if ((spfInitialDelay <= 0) && (spfHoldTime <= 0)) {
+        RebuildRoutingTable();
+        return;
     }
-
-    for (i = 0; i < discardCount; i++) {
-        delete discard[i];
+    if (spfTimer->isScheduled()) {  // the pending calculation will take this change into account as well
+        return;
     }
 
-    if (unreachable) {
-        return NULL;
+    simtime_t now   = simTime();
+    simtime_t delay = spfInitialDelay;
+
+    if ((lastSPFTime < 0) || (now - lastSPFTime > spfCurrentHoldTime)) {
+        spfCurrentHoldTime = spfHoldTime;
     } else {
-        return bestMatch;
+        simtime_t holdRemaining = lastSPFTime + spfCurrentHoldTime - now;
+        if (holdRemaining > delay) {
+            delay = holdRemaining;
+        }
+        spfCurrentHoldTime = (spfCurrentHoldTime * 2 < spfMaxHoldTime) ? spfCurrentHoldTime * 2 : spfMaxHoldTime;
     }
+
+    messageHandler->StartTimer(spfTimer, delay);
 }
 
 
@@ -824,6 +889,9 @@ void OSPF::Router::RebuildRoutingTable(void)
     std::vector<OSPF::RoutingTableEntry*> newTable;
     unsigned long                         i;
 
+    messageHandler->ClearTimer(spfTimer);
+    lastSPFTime = simTime();
+
     EV << "Rebuilding routing table:\n";
 
     for (i = 0; i < areaCount; i++) {
@@ -832,24 +900,29 @@ void OSPF::Router::RebuildRoutingTable(void)
             hasTransitAreas = true;
         }
     }
+
+    // the intra-area routes are final from here on, so are the discard entries
+    OSPF::RoutingTableIndex newTableIndex;
+    BuildRoutingTableIndex(newTable, newTableIndex);
+
     if (areaCount > 1) {
         OSPF::Area* backbone = GetArea(OSPF::BackboneAreaID);
         if (backbone != NULL) {
-            backbone->CalculateInterAreaRoutes(newTable);
+            backbone->CalculateInterAreaRoutes(newTable, newTableIndex);
         }
     } else {
         if (areaCount == 1) {
-            areas[0]->CalculateInterAreaRoutes(newTable);
+            areas[0]->CalculateInterAreaRoutes(newTable, newTableIndex);
         }
     }
     if (hasTransitAreas) {
         for (i = 0; i < areaCount; i++) {
             if (areas[i]->GetTransitCapability()) {
-                areas[i]->ReCheckSummaryLSAs(newTable);
+                areas[i]->ReCheckSummaryLSAs(newTable, newTableIndex);
             }
         }
     }
-    CalculateASExternalRoutes(newTable);
+    CalculateASExternalRoutes(newTable, newTableIndex);
 
     // backup the routing table
     unsigned long                         routeCount = routingTable.size();
@@ -858,6 +931,7 @@ void OSPF::Router::RebuildRoutingTable(void)
     oldTable.assign(routingTable.begin(), routingTable.end());
     routingTable.clear();
     routingTable.assign(newTable.begin(), newTable.end());
+    routingTableIndex = newTableIndex;
 
     RoutingTableAccess         routingTableAccess;
     std::vector<const IPRoute*> eraseEntries;
@@ -905,18 +979,15 @@ void OSPF::Router::RebuildRoutingTable(void)
 
 /**
  * Returns true if there is a route to the AS Boundary Router identified by
- * asbrRouterID in the input inRoutingTable, false otherwise.
- * @param inRoutingTable [in] The routing table to look in.
- * @param asbrRouterID   [in] The ID of the AS Boundary Router to look for.
+ * asbrRouterID in the routing table indexed by inTableIndex, false otherwise.
+ * @param inTableIndex [in] The index of the routing table to look in.
+ * @param asbrRouterID [in] The ID of the AS Boundary Router to look for.
  */
-bool OSPF::Router::HasRouteToASBoundaryRouter(const std::vector<OSPF::RoutingTableEntry*>& inRoutingTable, OSPF::RouterID asbrRouterID) const
+bool OSPF::Router::HasRouteToASBoundaryRouter(const OSPF::RoutingTableIndex& inTableIndex, OSPF::RouterID asbrRouterID) const
 {
-    long routeCount = inRoutingTable.size();
-    for (long i = 0; i < routeCount; i++) {
-        OSPF::RoutingTableEntry* routingEntry = inRoutingTable[i];
-        if (((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0) &&
-            (routingEntry->GetDestinationID().getInt() == asbrRouterID))
-        {
+    OSPF::RoutingTableIndex::EntryRange routerEntries = inTableIndex.GetRouterEntries(asbrRouterID);
+    for (OSPF::RoutingTableIndex::EntryIterator it = routerEntries.first; it != routerEntries.second; it++) {
+        if ((it->second->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0) {
             return true;
         }
     }
@@ -926,22 +997,20 @@ bool OSPF::Router::HasRouteToASBoundaryRouter(const std::vector<OSPF::RoutingTab
 
 /**
  * Returns an std::vector of routes leading to the AS Boundary Router
- * identified by asbrRouterID from the input fromRoutingTable. If there are no
- * routes leading to the AS Boundary Router, the returned std::vector is empty.
- * @param fromRoutingTable [in] The routing table to look in.
- * @param asbrRouterID     [in] The ID of the AS Boundary Router to look for.
+ * identified by asbrRouterID from the routing table indexed by fromTableIndex.
+ * If there are no routes leading to the AS Boundary Router, the returned
+ * std::vector is empty.
+ * @param fromTableIndex [in] The index of the routing table to look in.
+ * @param asbrRouterID   [in] The ID of the AS Boundary Router to look for.
  */
-std::vector<OSPF::RoutingTableEntry*> OSPF::Router::GetRoutesToASBoundaryRouter(const std::vector<OSPF::RoutingTableEntry*>& fromRoutingTable, OSPF::RouterID asbrRouterID) const
+std::vector<OSPF::RoutingTableEntry*> OSPF::Router::GetRoutesToASBoundaryRouter(const OSPF::RoutingTableIndex& fromTableIndex, OSPF::RouterID asbrRouterID) const
 {
     std::vector<OSPF::RoutingTableEntry*> results;
-    long                                  routeCount = fromRoutingTable.size();
+    OSPF::RoutingTableIndex::EntryRange   routerEntries = fromTableIndex.GetRouterEntries(asbrRouterID);
 
-    for (long i = 0; i < routeCount; i++) {
-        OSPF::RoutingTableEntry* routingEntry = fromRoutingTable[i];
-        if (((routingEntry->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0) &&
-            (routingEntry->GetDestinationID().getInt() == asbrRouterID))
-        {
-            results.push_back(routingEntry);
+    for (OSPF::RoutingTableIndex::EntryIterator it = routerEntries.first; it != routerEntries.second; it++) {
+        if ((it->second->GetDestinationType() & OSPF::RoutingTableEntry::ASBoundaryRouterDestination) != 0) {
+            results.push_back(it->second);
         }
     }
     return results;
@@ -1022,18 +1091,18 @@ OSPF::RoutingTableEntry* OSPF::Router::SelectLeastCostRoutingEntry(std::vector<O
  *                                the preferred Routing Entry is sought for.
  * @param skipSelfOriginated [in] Whether to disregard this LSA if it was
  *                                self-originated.
- * @param fromRoutingTable   [in] The Routing Table from which to select the
- *                                preferred RoutingTableEntry. If it is NULL
- *                                then the router's current routing table is
- *                                used instead.
+ * @param fromTableIndex     [in] The index of the Routing Table from which to
+ *                                select the preferred RoutingTableEntry. If it
+ *                                is NULL then the router's current routing
+ *                                table is used instead.
  * @return The preferred RoutingTableEntry, or NULL if no such entry exists.
  * @sa RFC2328 Section 16.4. points(1) through(3)
  * @sa OSPF::Area::OriginateSummaryLSA
  */
-OSPF::RoutingTableEntry* OSPF::Router::GetPreferredEntry(const OSPFLSA& lsa, bool skipSelfOriginated, std::vector<OSPF::RoutingTableEntry*>* fromRoutingTable /*= NULL*/)
+OSPF::RoutingTableEntry* OSPF::Router::GetPreferredEntry(const OSPFLSA& lsa, bool skipSelfOriginated, const OSPF::RoutingTableIndex* fromTableIndex /*= NULL*/)
 {
-    if (fromRoutingTable == NULL) {
-        fromRoutingTable = &routingTable;
+    if (fromTableIndex == NULL) {
+        fromTableIndex = &routingTableIndex;
     }
 
     const OSPFLSAHeader&     lsaHeader         = lsa.getHeader();
@@ -1052,18 +1121,18 @@ OSPF::RoutingTableEntry* OSPF::Router::GetPreferredEntry(const OSPFLSA& lsa, boo
         return NULL;
     }
 
-    if (!HasRouteToASBoundaryRouter(*fromRoutingTable, originatingRouter)) { // (3)
+    if (!HasRouteToASBoundaryRouter(*fromTableIndex, originatingRouter)) { // (3)
         return NULL;
     }
 
     if (forwardingAddress.isUnspecified()) {   // (3)
-        std::vector<OSPF::RoutingTableEntry*> asbrEntries = GetRoutesToASBoundaryRouter(*fromRoutingTable, originatingRouter);
+        std::vector<OSPF::RoutingTableEntry*> asbrEntries = GetRoutesToASBoundaryRouter(*fromTableIndex, originatingRouter);
         if (!rfc1583Compatibility) {
             PruneASBoundaryRouterEntries(asbrEntries);
         }
         return SelectLeastCostRoutingEntry(asbrEntries);
     } else {
-        OSPF::RoutingTableEntry* forwardEntry = Lookup(forwardingAddress, fromRoutingTable);
+        OSPF::RoutingTableEntry* forwardEntry = Lookup(forwardingAddress, fromTableIndex);
 
         if (forwardEntry == NULL) {
             return NULL;
@@ -1087,9 +1156,10 @@ OSPF::RoutingTableEntry* OSPF::Router::GetPreferredEntry(const OSPFLSA& lsa, boo
  * @param newRoutingTable [in/out] Push the new RoutingTableEntries into this
  *                                 routing table, and also use this for path
  *                                 calculations.
+ * @param newTableIndex   [in/out] The index of newRoutingTable, kept up to date.
  * @sa RFC2328 Section 16.4.
  */
-void OSPF::Router::CalculateASExternalRoutes(std::vector<OSPF::RoutingTableEntry*>& newRoutingTable)
+void OSPF::Router::CalculateASExternalRoutes(std::vector<OSPF::RoutingTableEntry*>& newRoutingTable, OSPF::RoutingTableIndex& newTableIndex)
 {
     unsigned long lsaCount = asExternalLSAs.size();
     unsigned long i;
@@ -1100,7 +1170,7 @@ void OSPF::Router::CalculateASExternalRoutes(std::vector<OSPF::RoutingTableEntry
         unsigned short       externalCost      = currentLSA->getContents().getRouteCost();
         OSPF::RouterID       originatingRouter = currentHeader.getAdvertisingRouter().getInt();
 
-        OSPF::RoutingTableEntry* preferredEntry = GetPreferredEntry(*currentLSA, true, &newRoutingTable);
+        OSPF::RoutingTableEntry* preferredEntry = GetPreferredEntry(*currentLSA, true, &newTableIndex);
         if (preferredEntry == NULL) {
             continue;
         }
@@ -1108,7 +1178,7 @@ void OSPF::Router::CalculateASExternalRoutes(std::vector<OSPF::RoutingTableEntry
         IPAddress destination = currentHeader.getLinkStateID() & currentLSA->getContents().getNetworkMask().getInt();
 
         Metric                   preferredCost    = preferredEntry->GetCost();
-        OSPF::RoutingTableEntry* destinationEntry = Lookup(destination, &newRoutingTable);   // (5)
+        OSPF::RoutingTableEntry* destinationEntry = Lookup(destination, &newTableIndex);   // (5)
         if (destinationEntry == NULL) {
             bool                     type2ExternalMetric = currentLSA->getContents().getE_ExternalMetricType();
             unsigned int             nextHopCount        = preferredEntry->GetNextHopCount();
@@ -1136,6 +1206,7 @@ void OSPF::Router::CalculateASExternalRoutes(std::vector<OSPF::RoutingTableEntry
             }
 
             newRoutingTable.push_back(newEntry);
+            newTableIndex.AddEntry(newEntry);
         } else {
             OSPF::RoutingTableEntry::RoutingPathType destinationPathType = destinationEntry->GetPathType();
             bool                                     type2ExternalMetric = currentLSA->getContents().getE_ExternalMetricType();
@@ -1156,7 +1227,7 @@ void OSPF::Router::CalculateASExternalRoutes(std::vector<OSPF::RoutingTableEntry
                 continue;
             }
 
-            OSPF::RoutingTableEntry* destinationPreferredEntry = GetPreferredEntry(*(destinationEntry->GetLinkStateOrigin()), false, &newRoutingTable);
+            OSPF::RoutingTableEntry* destinationPreferredEntry = GetPreferredEntry(*(destinationEntry->GetLinkStateOrigin()), false, &newTableIndex);
             if ((!rfc1583Compatibility) &&
                 (destinationPreferredEntry->GetPathType() == OSPF::RoutingTableEntry::IntraArea) &&
                 (destinationPreferredEntry->GetArea() != OSPF::BackboneAreaID) &&
@@ -1581,7 +1652,7 @@ void OSPF::Router::UpdateExternalRoute(OSPF::IPv4Address networkAddress, const O
     delete asExternalLSA;
 
     if (rebuild) {
-        RebuildRoutingTable();
+        ScheduleRoutingTableRebuild();
     }
 }
 
@@ -24,6 +24,7 @@
 #include "OSPFInterface.h"
 #include "LSA.h"
 #include "OSPFRoutingTableEntry.h"
+#include "OSPFRoutingTableIndex.h"
 #include <map>
 
 /**
@@ -35,6 +36,14 @@ namespace OSPF {
  * Represents the full OSPF datastructure as laid out in RFC2328.
  */
 class Router {
+private:
+    struct AgingQueueEntry {
+        LSAType     lsaType;
+        LSAKeyType  lsaKey;
+        AreaID      areaID;
+    };
+    typedef std::multimap<simtime_t, AgingQueueEntry> AgingQueue;
+
 private:
     RouterID                                                           routerID;                ///< The router ID assigned by the IP layer.
     std::map<AreaID, Area*>                                            areasByID;               ///< A map of the contained areas with the AreaID as key.
@@ -42,9 +51,18 @@ private:
     std::map<LSAKeyType, ASExternalLSA*, LSAKeyType_Less>              asExternalLSAsByID;      ///< A map of the ASExternalLSAs advertised by this router.
     std::vector<ASExternalLSA*>                                        asExternalLSAs;          ///< A list of the ASExternalLSAs advertised by this router.
     std::map<IPv4Address, OSPFASExternalLSAContents, IPv4Address_Less> externalRoutes;          ///< A map of the external route advertised by this router.
-    OSPFTimer*                                                         ageTimer;                ///< Database age timer - fires every second.
+    OSPFTimer*                                                         ageTimer;                ///< Database age timer - fires at the earliest deadline on the agingQueue.
+    AgingQueue                                                         agingQueue;              ///< LS refresh and MaxAge deadlines of the database LSAs, ordered by time.
     std::vector<RoutingTableEntry*>                                    routingTable;            ///< The OSPF routing table - contains more information than the one in the IP layer.
+    RoutingTableIndex                                                  routingTableIndex;       ///< Lookup index of the routingTable.
     MessageHandler*                                                    messageHandler;          ///< The message dispatcher class.
+    simtime_t                                                          floodPacingInterval;     ///< LSAs flooded within this interval are packed into common LS Update packets(0: no pacing).
+    OSPFTimer*                                                         spfTimer;                ///< Routing table calculation timer - fires when a throttled calculation is due.
+    simtime_t                                                          spfInitialDelay;         ///< Delay of the routing table calculation after a quiet period.
+    simtime_t                                                          spfHoldTime;             ///< Initial minimum time between two routing table calculations.
+    simtime_t                                                          spfMaxHoldTime;          ///< Upper limit of the doubling hold time.
+    simtime_t                                                          spfCurrentHoldTime;      ///< Current minimum time between two routing table calculations.
+    simtime_t                                                          lastSPFTime;             ///< Time of the last routing table calculation(-1: none yet).
     bool                                                               rfc1583Compatibility;    ///< Decides whether to handle the preferred routing table entry to an AS boundary router as defined in RFC1583 or not.
 
 public:
@@ -55,19 +73,22 @@ public:
     RouterID                 GetRouterID               (void) const               { return routerID; }
     void                     SetRFC1583Compatibility   (bool compatibility)       { rfc1583Compatibility = compatibility; }
     bool                     GetRFC1583Compatibility   (void) const               { return rfc1583Compatibility; }
+    void                     SetFloodPacingInterval    (simtime_t interval)       { floodPacingInterval = interval; }
+    simtime_t                GetFloodPacingInterval    (void) const               { return floodPacingInterval; }
+    void                     SetSPFThrottle            (simtime_t initialDelay, simtime_t holdTime, simtime_t maxHoldTime);
     unsigned long            GetAreaCount              (void) const               { return areas.size(); }
 
     MessageHandler*          GetMessageHandler         (void)                     { return messageHandler; }
 
     unsigned long            GetASExternalLSACount     (void) const               { return asExternalLSAs.size(); }
-    ASExternalLSA*           GetASExternalLSA          (unsigned long i)          { return asExternalLSAs[i]; }
+    ASExternalLSA*           GetASExternalLSA          (unsigned long i)          { asExternalLSAs[i]->UpdateAge(asExternalLSAs[i]->getHeader()); return asExternalLSAs[i]; }
     const ASExternalLSA*     GetASExternalLSA          (unsigned long i) const    { return asExternalLSAs[i]; }
     bool                     GetASBoundaryRouter       (void) const               { return (externalRoutes.size() > 0); }
 
     unsigned long            GetRoutingTableEntryCount(void) const               { return routingTable.size(); }
     RoutingTableEntry*       GetRoutingTableEntry      (unsigned long i)          { return routingTable[i]; }
     const RoutingTableEntry* GetRoutingTableEntry      (unsigned long i) const    { return routingTable[i]; }
-    void                     AddRoutingTableEntry      (RoutingTableEntry* entry) { routingTable.push_back(entry); }
+    void                     AddRoutingTableEntry      (RoutingTableEntry* entry) { routingTable.push_back(entry); routingTableIndex.AddEntry(entry); }
 
     void                 AddWatches                           (void);
 
@@ -79,6 +100,7 @@ public:
     bool                 InstallLSA                           (OSPFLSA* lsa, AreaID areaID = BackboneAreaID);
     OSPFLSA*             FindLSA                              (LSAType lsaType, LSAKeyType lsaKey, AreaID areaID);
     void                 AgeDatabase                          (void);
+    void                 ScheduleLSAAging                     (OSPFLSA* lsa, AreaID areaID);
     bool                 HasAnyNeighborInStates               (int states) const;
     void                 RemoveFromAllRetransmissionLists     (LSAKeyType lsaKey);
     bool                 IsOnAnyRetransmissionList            (LSAKeyType lsaKey) const;
@@ -86,27 +108,30 @@ public:
     bool                 IsLocalAddress                       (IPv4Address address) const;
     bool                 HasAddressRange                      (IPv4AddressRange addressRange) const;
     bool                 IsDestinationUnreachable             (OSPFLSA* lsa) const;
-    RoutingTableEntry*   Lookup                               (IPAddress destination, std::vector<RoutingTableEntry*>* table = NULL) const;
+    RoutingTableEntry*   Lookup                               (IPAddress destination, const RoutingTableIndex* tableIndex = NULL) const;
     void                 RebuildRoutingTable                  (void);
+    void                 ScheduleRoutingTableRebuild          (void);
     IPv4AddressRange     GetContainingAddressRange            (IPv4AddressRange addressRange, bool* advertise = NULL) const;
     void                 UpdateExternalRoute                  (IPv4Address networkAddress, const OSPFASExternalLSAContents& externalRouteContents, int ifIndex);
     void                 RemoveExternalRoute                  (IPv4Address networkAddress);
-    RoutingTableEntry*   GetPreferredEntry                    (const OSPFLSA& lsa, bool skipSelfOriginated, std::vector<RoutingTableEntry*>* fromRoutingTable = NULL);
+    RoutingTableEntry*   GetPreferredEntry                    (const OSPFLSA& lsa, bool skipSelfOriginated, const RoutingTableIndex* fromTableIndex = NULL);
 
 private:
     bool                 InstallASExternalLSA                 (OSPFASExternalLSA* lsa);
     ASExternalLSA*       FindASExternalLSA                    (LSAKeyType lsaKey);
     const ASExternalLSA* FindASExternalLSA                    (LSAKeyType lsaKey) const;
+    bool                 AgeASExternalLSA                     (ASExternalLSA* lsa);
     ASExternalLSA*       OriginateASExternalLSA               (ASExternalLSA* lsa);
     LinkStateID          GetUniqueLinkStateID                 (IPv4AddressRange destination,
                                                                Metric destinationCost,
                                                                OSPF::ASExternalLSA*& lsaToReoriginate,
                                                                bool externalMetricIsType2 = false) const;
-    void                 CalculateASExternalRoutes            (std::vector<RoutingTableEntry*>& newRoutingTable);
+    void                 BuildRoutingTableIndex               (const std::vector<RoutingTableEntry*>& table, RoutingTableIndex& tableIndex) const;
+    void                 CalculateASExternalRoutes            (std::vector<RoutingTableEntry*>& newRoutingTable, RoutingTableIndex& newTableIndex);
     void                 NotifyAboutRoutingTableChanges       (std::vector<RoutingTableEntry*>& oldRoutingTable);
-    bool                 HasRouteToASBoundaryRouter           (const std::vector<RoutingTableEntry*>& inRoutingTable, OSPF::RouterID routerID) const;
+    bool                 HasRouteToASBoundaryRouter           (const RoutingTableIndex& inTableIndex, OSPF::RouterID routerID) const;
     std::vector<RoutingTableEntry*>
-                         GetRoutesToASBoundaryRouter          (const std::vector<RoutingTableEntry*>& fromRoutingTable, OSPF::RouterID routerID) const;
+                         GetRoutesToASBoundaryRouter          (const RoutingTableIndex& fromTableIndex, OSPF::RouterID routerID) const;
     void                 PruneASBoundaryRouterEntries         (std::vector<RoutingTableEntry*>& asbrEntries) const;
     RoutingTableEntry*   SelectLeastCostRoutingEntry          (std::vector<RoutingTableEntry*>& entries) const;
 };
@@ -0,0 +1,147 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "OSPFRoutingTableIndex.h"
+
+void OSPF::RoutingTableIndex::Clear(void)
+{
+    networksByMask.clear();
+    networksByID.clear();
+    routersByID.clear();
+    discardRanges.clear();
+}
+
+/**
+ * Indexes all entries of the input table. Discard ranges are left empty.
+ */
+void OSPF::RoutingTableIndex::Build(const std::vector<OSPF::RoutingTableEntry*>& table)
+{
+    Clear();
+
+    unsigned long routeCount = table.size();
+    for (unsigned long i = 0; i < routeCount; i++) {
+        AddEntry(table[i]);
+    }
+}
+
+void OSPF::RoutingTableIndex::AddEntry(OSPF::RoutingTableEntry* entry)
+{
+    unsigned long destinationID = entry->GetDestinationID().getInt();
+
+    if (entry->GetDestinationType() == OSPF::RoutingTableEntry::NetworkDestination) {
+        unsigned long mask = entry->GetAddressMask().getInt();
+
+        networksByMask[mask].insert(std::make_pair(destinationID & mask, entry));
+        networksByID.insert(std::make_pair(destinationID, entry));
+    }
+    if ((entry->GetDestinationType() & (OSPF::RoutingTableEntry::AreaBorderRouterDestination | OSPF::RoutingTableEntry::ASBoundaryRouterDestination)) != 0) {
+        routersByID.insert(std::make_pair(destinationID, entry));
+    }
+}
+
+void OSPF::RoutingTableIndex::RemoveEntry(OSPF::RoutingTableEntry* entry)
+{
+    unsigned long destinationID = entry->GetDestinationID().getInt();
+
+    if (entry->GetDestinationType() == OSPF::RoutingTableEntry::NetworkDestination) {
+        unsigned long              mask   = entry->GetAddressMask().getInt();
+        MaskedNetworkMap::iterator maskIt = networksByMask.find(mask);
+
+        if (maskIt != networksByMask.end()) {
+            RemoveFromMap(maskIt->second, destinationID & mask, entry);
+            if (maskIt->second.empty()) {
+                networksByMask.erase(maskIt);
+            }
+        }
+        RemoveFromMap(networksByID, destinationID, entry);
+    }
+    if ((entry->GetDestinationType() & (OSPF::RoutingTableEntry::AreaBorderRouterDestination | OSPF::RoutingTableEntry::ASBoundaryRouterDestination)) != 0) {
+        RemoveFromMap(routersByID, destinationID, entry);
+    }
+}
+
+void OSPF::RoutingTableIndex::RemoveFromMap(EntryMap& entryMap, unsigned long key, OSPF::RoutingTableEntry* entry)
+{
+    std::pair<EntryMap::iterator, EntryMap::iterator> range = entryMap.equal_range(key);
+    for (EntryMap::iterator it = range.first; it != range.second; it++) {
+        if (it->second == entry) {
+            entryMap.erase(it);
+            return;
+        }
+    }
+}
+
+/**
+ * Adds an active area address range: destinations falling into it, but matched only
+ * by a less specific route, are unreachable.
+ * @sa RFC2328 Section 11.1.
+ */
+void OSPF::RoutingTableIndex::AddDiscardRange(OSPF::IPv4AddressRange addressRange)
+{
+    DiscardRange discard;
+
+    discard.mask    = ULongFromIPv4Address(addressRange.mask);
+    discard.address = ULongFromIPv4Address(addressRange.address) & discard.mask;
+    discardRanges.push_back(discard);
+}
+
+/**
+ * Returns the network entry with the longest mask matching the input destination,
+ * or NULL if there's no such entry or if a more specific discard range covers the destination.
+ * @sa RFC2328 Section 11.1.
+ */
+OSPF::RoutingTableEntry* OSPF::RoutingTableIndex::Lookup(unsigned long destination) const
+{
+    for (MaskedNetworkMap::const_iterator maskIt = networksByMask.begin(); maskIt != networksByMask.end(); maskIt++) {
+        unsigned long       mask    = maskIt->first;
+        EntryMap::const_iterator it = maskIt->second.find(destination & mask);
+
+        if (it != maskIt->second.end()) {
+            unsigned int discardCount = discardRanges.size();
+            for (unsigned int i = 0; i < discardCount; i++) {
+                if ((discardRanges[i].mask > mask) &&
+                    ((destination & discardRanges[i].mask) == discardRanges[i].address))
+                {
+                    return NULL;
+                }
+            }
+            return it->second;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Returns true if there's an intra-area network entry for a destination inside the
+ * input address range(i.e. the address range is active).
+ */
+bool OSPF::RoutingTableIndex::HasIntraAreaNetworkWithin(OSPF::IPv4AddressRange addressRange) const
+{
+    unsigned long rangeMask  = ULongFromIPv4Address(addressRange.mask);
+    unsigned long rangeFirst = ULongFromIPv4Address(addressRange.address) & rangeMask;
+    unsigned long rangeLast  = rangeFirst | (~rangeMask & 0xFFFFFFFF);
+
+    for (MaskedNetworkMap::const_iterator maskIt = networksByMask.begin(); maskIt != networksByMask.end(); maskIt++) {
+        EntryMap::const_iterator it  = maskIt->second.lower_bound(rangeFirst);
+        EntryMap::const_iterator end = maskIt->second.upper_bound(rangeLast);
+
+        for (; it != end; it++) {
+            if (it->second->GetPathType() == OSPF::RoutingTableEntry::IntraArea) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_OSPFROUTINGTABLEINDEX_H
+#define __INET_OSPFROUTINGTABLEINDEX_H
+
+#include <map>
+#include <vector>
+#include <functional>
+#include "OSPFcommon.h"
+#include "OSPFRoutingTableEntry.h"
+
+namespace OSPF {
+
+/**
+ * Lookup structure over an OSPF routing table(a std::vector of RoutingTableEntries).
+ *
+ * Network destinations are kept in one map per address mask, keyed by the masked
+ * destination; longest-prefix matches probe these maps from the longest mask down.
+ * Area border and AS boundary router entries are indexed by their router ID.
+ * Entries with equal keys stay in insertion order, so the queries return entries in
+ * the same order as a linear scan of the indexed table would.
+ *
+ * The index does not own the entries. It has to be updated together with the table
+ * it describes, and the destination ID, mask and type of an indexed entry must not change.
+ */
+class RoutingTableIndex
+{
+public:
+    typedef std::multimap<unsigned long, RoutingTableEntry*>    EntryMap;
+    typedef EntryMap::const_iterator                            EntryIterator;
+    typedef std::pair<EntryIterator, EntryIterator>             EntryRange;
+
+private:
+    typedef std::map<unsigned long, EntryMap, std::greater<unsigned long> > MaskedNetworkMap;
+
+    struct DiscardRange {
+        unsigned long address;
+        unsigned long mask;
+    };
+
+    MaskedNetworkMap            networksByMask;     ///< Address mask -> masked destination -> network entries, longest mask first.
+    EntryMap                    networksByID;       ///< Destination ID -> network entries.
+    EntryMap                    routersByID;        ///< Router ID -> area border and AS boundary router entries.
+    std::vector<DiscardRange>   discardRanges;      ///< The active area address ranges(discard entries).
+
+public:
+    void                Clear                       (void);
+    void                Build                       (const std::vector<RoutingTableEntry*>& table);
+    void                AddEntry                    (RoutingTableEntry* entry);
+    void                RemoveEntry                 (RoutingTableEntry* entry);
+    void                AddDiscardRange             (IPv4AddressRange addressRange);
+
+    RoutingTableEntry*  Lookup                      (unsigned long destination) const;
+    bool                HasIntraAreaNetworkWithin   (IPv4AddressRange addressRange) const;
+    /** Returns the network entries whose destination ID equals destinationID. */
+    EntryRange          GetNetworkEntries           (unsigned long destinationID) const { return networksByID.equal_range(destinationID); }
+    /** Returns the area border and AS boundary router entries of routerID. */
+    EntryRange          GetRouterEntries            (RouterID routerID) const           { return routersByID.equal_range(routerID); }
+
+private:
+    void                RemoveFromMap               (EntryMap& entryMap, unsigned long key, RoutingTableEntry* entry);
+};
+
+} // namespace OSPF
+
+#endif // __INET_OSPFROUTINGTABLEINDEX_H
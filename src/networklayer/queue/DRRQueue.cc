@@ -0,0 +1,162 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <omnetpp.h>
+#include "DRRQueue.h"
+
+
+Define_Module(DRRQueue);
+
+DRRQueue::DRRQueue()
+{
+    queues = NULL;
+    numQueues = 0;
+    classifier = NULL;
+}
+
+DRRQueue::~DRRQueue()
+{
+    for (int i=0; i<numQueues; i++)
+        delete queues[i];
+    delete [] queues;
+    delete classifier;
+}
+
+void DRRQueue::initialize()
+{
+    PassiveQueueBase::initialize();
+
+    // configuration
+    frameCapacity = par("frameCapacity");
+    byteCapacity = par("byteCapacity");
+
+    const char *classifierClass = par("classifierClass");
+    classifier = check_and_cast<IQoSClassifier *>(createOne(classifierClass));
+
+    outGate = gate("out");
+
+    numQueues = classifier->getNumQueues();
+    queues = new cQueue *[numQueues];
+    for (int i=0; i<numQueues; i++)
+    {
+        char buf[32];
+        sprintf(buf, "queue-%d", i);
+        queues[i] = new cQueue(buf);
+    }
+
+    // per-class quanta: weight times the base quantum
+    long quantum = par("quantum");
+    if (quantum <= 0)
+        error("quantum must be positive");
+    cStringTokenizer tokenizer(par("weights"));
+    const char *token;
+    while ((token = tokenizer.nextToken())!=NULL)
+    {
+        double weight = atof(token);
+        if (weight <= 0)
+            error("invalid weight '%s': weights must be positive", token);
+        if (weight * quantum < 1)
+            error("weight '%s' is too small: weight times quantum must be at least 1 byte, "
+                  "otherwise the subqueue would never be credited", token);
+        quanta.push_back((long)(weight * quantum + 0.5));
+    }
+    if (quanta.size() > (unsigned int)numQueues)
+        error("%d weights given but classifier only has %d queues", (int)quanta.size(), numQueues);
+    quanta.resize(numQueues, quantum);
+
+    queueBytes.assign(numQueues, 0);
+    deficits.assign(numQueues, 0);
+    numDropped.assign(numQueues, 0);
+    headCredited = false;
+}
+
+bool DRRQueue::enqueue(cMessage *msg)
+{
+    int queueIndex = classifier->classifyPacket(msg);
+    cQueue *queue = queues[queueIndex];
+    long bytes = PK(msg)->getByteLength();
+
+    if ((frameCapacity && queue->length() >= frameCapacity) ||
+        (byteCapacity && queueBytes[queueIndex] + bytes > byteCapacity))
+    {
+        EV << "Queue " << queueIndex << " full, dropping packet.\n";
+        numDropped[queueIndex]++;
+        delete msg;
+        return true;
+    }
+
+    if (queue->empty())
+        activeList.push_back(queueIndex);
+    queue->insert(msg);
+    queueBytes[queueIndex] += bytes;
+    return false;
+}
+
+cMessage *DRRQueue::dequeue()
+{
+    // Each pass either returns a packet or moves the head queue to the back
+    // after crediting it; with quanta at least one MTU this is O(1) amortized.
+    while (!activeList.empty())
+    {
+        int queueIndex = activeList.front();
+        if (!headCredited)
+        {
+            deficits[queueIndex] += quanta[queueIndex];
+            headCredited = true;
+        }
+
+        cQueue *queue = queues[queueIndex];
+        long bytes = PK(queue->front())->getByteLength();
+        if (bytes <= deficits[queueIndex])
+        {
+            cMessage *msg = (cMessage *)queue->pop();
+            deficits[queueIndex] -= bytes;
+            queueBytes[queueIndex] -= bytes;
+            if (queue->empty())
+            {
+                // an idle queue does not accumulate credit
+                deficits[queueIndex] = 0;
+                activeList.pop_front();
+                headCredited = false;
+            }
+            return msg;
+        }
+
+        // not enough credit left: next queue's turn
+        activeList.pop_front();
+        activeList.push_back(queueIndex);
+        headCredited = false;
+    }
+    return NULL;
+}
+
+void DRRQueue::sendOut(cMessage *msg)
+{
+    send(msg, outGate);
+}
+
+void DRRQueue::finish()
+{
+    PassiveQueueBase::finish();
+
+    for (int i=0; i<numQueues; i++)
+    {
+        char buf[64];
+        sprintf(buf, "packets dropped by queue-%d", i);
+        recordScalar(buf, numDropped[i]);
+    }
+}
+
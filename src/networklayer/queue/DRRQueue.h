@@ -0,0 +1,77 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_DRRQUEUE_H
+#define __INET_DRRQUEUE_H
+
+#include <list>
+#include <vector>
+#include <omnetpp.h>
+#include "PassiveQueueBase.h"
+#include "IQoSClassifier.h"
+
+/**
+ * Deficit round robin scheduler over per-class subqueues. See NED for more info.
+ */
+class INET_API DRRQueue : public PassiveQueueBase
+{
+  protected:
+    // configuration
+    int frameCapacity;
+    long byteCapacity;
+    std::vector<long> quanta;   // bytes added to a subqueue's deficit per round
+
+    // state
+    int numQueues;
+    cQueue **queues;
+    std::vector<long> queueBytes;
+    std::vector<long> deficits;
+    std::list<int> activeList;  // non-empty subqueues, in round robin order
+    bool headCredited;          // whether the head of activeList got its quantum this round
+    IQoSClassifier *classifier;
+
+    cGate *outGate;
+
+    // statistics
+    std::vector<long> numDropped;
+
+  public:
+    DRRQueue();
+    virtual ~DRRQueue();
+
+  protected:
+    virtual void initialize();
+    virtual void finish();
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual bool enqueue(cMessage *msg);
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual cMessage *dequeue();
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual void sendOut(cMessage *msg);
+
+};
+
+#endif
+
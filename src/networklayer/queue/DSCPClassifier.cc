@@ -0,0 +1,77 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <omnetpp.h>
+#include "DSCPClassifier.h"
+#include "IPDatagram.h"
+#ifndef WITHOUT_IPv6
+#include "IPv6Datagram.h"
+#endif
+
+Register_Class(DSCPClassifier);
+
+#define NUM_QUEUES          7
+#define NETWORK_CONTROL     0
+#define EXPEDITED           1
+#define BEST_EFFORT         6
+
+DSCPClassifier::DSCPClassifier()
+{
+    for (int dscp=0; dscp<64; dscp++)
+        dscpToQueue[dscp] = BEST_EFFORT;
+
+    // class selectors CSn = n<<3; AFxy = (x<<3)|(y<<1)
+    for (int afClass=1; afClass<=4; afClass++)
+    {
+        int queue = 6 - afClass;   // AF4x -> 2 ... AF1x -> 5
+        dscpToQueue[afClass<<3] = queue;
+        for (int dropPrec=1; dropPrec<=3; dropPrec++)
+            dscpToQueue[(afClass<<3) | (dropPrec<<1)] = queue;
+    }
+    dscpToQueue[5<<3] = EXPEDITED;  // CS5
+    dscpToQueue[44] = EXPEDITED;    // VOICE-ADMIT (RFC 5865)
+    dscpToQueue[46] = EXPEDITED;    // EF
+    dscpToQueue[6<<3] = NETWORK_CONTROL;
+    dscpToQueue[7<<3] = NETWORK_CONTROL;
+}
+
+int DSCPClassifier::getNumQueues()
+{
+    return NUM_QUEUES;
+}
+
+int DSCPClassifier::classifyPacket(cMessage *msg)
+{
+    if (dynamic_cast<IPDatagram *>(msg))
+    {
+        IPDatagram *datagram = (IPDatagram *)msg;
+        return classifyByDSCP(datagram->getDiffServCodePoint());
+    }
+#ifndef WITHOUT_IPv6
+    else if (dynamic_cast<IPv6Datagram *>(msg))
+    {
+        // the DSCP is the upper 6 bits of the Traffic Class
+        IPv6Datagram *datagram = (IPv6Datagram *)msg;
+        return classifyByDSCP(datagram->getTrafficClass() >> 2);
+    }
+#endif
+    else
+    {
+        // same as the default PHB, so that subclasses only need to change dscpToQueue
+        return classifyByDSCP(0);
+    }
+}
+
@@ -0,0 +1,66 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_DSCPCLASSIFIER_H
+#define __INET_DSCPCLASSIFIER_H
+
+#include "IQoSClassifier.h"
+
+/**
+ * Maps all 64 DiffServ code points to seven subqueues, following the
+ * per-hop behaviours of RFC 2474, 2597 and 3246 (the class selector
+ * code points share the queue of the AF class with the same precedence):
+ *
+ *  - 0: network control (CS6, CS7)
+ *  - 1: expedited forwarding (EF, VOICE-ADMIT, CS5)
+ *  - 2: AF4x, CS4
+ *  - 3: AF3x, CS3
+ *  - 4: AF2x, CS2
+ *  - 5: AF1x, CS1
+ *  - 6: best effort: default PHB and all other code points
+ *
+ * Packets other than IPv4/IPv6 datagrams go into the best effort queue
+ * (the queue of DSCP 0).
+ * Queue 0 is the highest priority for DropTailQoSQueue; with DRRQueue and
+ * WFQQueue the queue index selects the weight.
+ */
+class INET_API DSCPClassifier : public IQoSClassifier
+{
+  protected:
+    int dscpToQueue[64];
+
+  public:
+    DSCPClassifier();
+
+    /**
+     * Returns the largest value plus one classifyPacket() returns.
+     */
+    virtual int getNumQueues();
+
+    /**
+     * Returns the subqueue index for the packet's DSCP (IPv4) or
+     * Traffic Class (IPv6).
+     */
+    virtual int classifyPacket(cMessage *msg);
+
+    /**
+     * Returns the subqueue index for the given DSCP value.
+     */
+    virtual int classifyByDSCP(int dscp) {return dscpToQueue[dscp & 0x3f];}
+};
+
+#endif
+
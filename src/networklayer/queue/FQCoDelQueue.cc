@@ -0,0 +1,327 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <math.h>
+#include <omnetpp.h>
+#include "FQCoDelQueue.h"
+#include "IPDatagram.h"
+#include "UDPPacket.h"
+#include "TCPSegment.h"
+#ifndef WITHOUT_IPv6
+#include "IPv6Datagram.h"
+#endif
+
+
+Define_Module(FQCoDelQueue);
+
+// Bob Jenkins' one-at-a-time style mixing of a 32-bit word into the hash
+static inline uint32 hashWord(uint32 h, uint32 word)
+{
+    for (int i=0; i<4; i++, word >>= 8)
+    {
+        h += word & 0xff;
+        h += (h << 10);
+        h ^= (h >> 6);
+    }
+    return h;
+}
+
+FQCoDelQueue::FQCoDelQueue()
+{
+    numPackets = 0;
+}
+
+FQCoDelQueue::~FQCoDelQueue()
+{
+    for (unsigned int i=0; i<flows.size(); i++)
+        for (unsigned int j=0; j<flows[i].packets.size(); j++)
+            delete flows[i].packets[j].pk;
+}
+
+void FQCoDelQueue::initialize()
+{
+    PassiveQueueBase::initialize();
+
+    sojournTimeVec.setName("sojourn time");
+    qlenVec.setName("queue length");
+
+    // configuration
+    frameCapacity = par("frameCapacity");
+    quantum = par("quantum");
+    target = par("target");
+    interval = par("interval");
+    maxPacketBytes = par("mtu");
+    int numFlows = par("flows");
+    if (numFlows <= 0)
+        error("flows must be positive");
+    if (quantum <= 0)
+        error("quantum must be positive");
+    perturbation = intrand(0x7fffffff);
+
+    outGate = gate("out");
+
+    // state
+    Flow idle;
+    idle.bytes = 0;
+    idle.deficit = 0;
+    idle.listState = FLOW_IDLE;
+    idle.firstAboveTime = 0;
+    idle.dropNext = 0;
+    idle.count = 0;
+    idle.lastCount = 0;
+    idle.dropping = false;
+    flows.assign(numFlows, idle);
+    numPackets = 0;
+
+    numCodelDrops = 0;
+    numOverflowDrops = 0;
+    WATCH(numPackets);
+    WATCH(numCodelDrops);
+    WATCH(numOverflowDrops);
+}
+
+int FQCoDelQueue::classifyFlow(cPacket *pk)
+{
+    // look through link layer encapsulation, if any
+    cPacket *netwPk = pk;
+    for (int depth=0; netwPk && depth<2; depth++)
+    {
+        if (dynamic_cast<IPDatagram *>(netwPk))
+            break;
+#ifndef WITHOUT_IPv6
+        if (dynamic_cast<IPv6Datagram *>(netwPk))
+            break;
+#endif
+        netwPk = netwPk->getEncapsulatedMsg();
+    }
+
+    uint32 h = perturbation;
+    int protocol = -1;
+    if (IPDatagram *dgram = dynamic_cast<IPDatagram *>(netwPk))
+    {
+        h = hashWord(h, dgram->getSrcAddress().getInt());
+        h = hashWord(h, dgram->getDestAddress().getInt());
+        protocol = dgram->getTransportProtocol();
+    }
+#ifndef WITHOUT_IPv6
+    else if (IPv6Datagram *dgram = dynamic_cast<IPv6Datagram *>(netwPk))
+    {
+        const uint32 *src = dgram->getSrcAddress().words();
+        const uint32 *dest = dgram->getDestAddress().words();
+        for (int i=0; i<4; i++)
+            h = hashWord(h, src[i] ^ dest[i]*31);
+        protocol = dgram->getTransportProtocol();
+    }
+#endif
+    else
+    {
+        return 0; // not IP: everything shares one flow
+    }
+    h = hashWord(h, protocol);
+
+    cPacket *transportPk = netwPk->getEncapsulatedMsg();
+    if (UDPPacket *udp = dynamic_cast<UDPPacket *>(transportPk))
+        h = hashWord(h, (udp->getSourcePort() << 16) | udp->getDestinationPort());
+    else if (TCPSegment *tcp = dynamic_cast<TCPSegment *>(transportPk))
+        h = hashWord(h, (tcp->getSrcPort() << 16) | tcp->getDestPort());
+
+    h += (h << 3);
+    h ^= (h >> 11);
+    h += (h << 15);
+    return h % flows.size();
+}
+
+bool FQCoDelQueue::enqueue(cMessage *msg)
+{
+    cPacket *pk = PK(msg);
+    Flow& flow = flows[classifyFlow(pk)];
+
+    Packet entry;
+    entry.pk = pk;
+    entry.arrivalTime = simTime();
+    flow.packets.push_back(entry);
+    flow.bytes += pk->getByteLength();
+    numPackets++;
+
+    if (flow.listState == FLOW_IDLE)
+    {
+        flow.listState = FLOW_NEW;
+        flow.deficit = quantum;
+        newFlows.push_back(&flow);
+    }
+
+    if (frameCapacity && numPackets > frameCapacity)
+    {
+        dropFromFattestFlow();
+        qlenVec.record(numPackets);
+        return true;
+    }
+    qlenVec.record(numPackets);
+    return false;
+}
+
+void FQCoDelQueue::dropFromFattestFlow()
+{
+    Flow *fattest = NULL;
+    for (unsigned int i=0; i<flows.size(); i++)
+        if (!fattest || flows[i].bytes > fattest->bytes)
+            fattest = &flows[i];
+
+    Packet entry = fattest->packets.front();
+    fattest->packets.pop_front();
+    fattest->bytes -= entry.pk->getByteLength();
+    numPackets--;
+    numOverflowDrops++;
+    EV << "Queue full, dropping packet from the head of the fattest flow.\n";
+    delete entry.pk;
+}
+
+cPacket *FQCoDelQueue::codelDoDequeue(Flow& flow, bool& okToDrop)
+{
+    okToDrop = false;
+    if (flow.packets.empty())
+    {
+        flow.firstAboveTime = 0;
+        return NULL;
+    }
+
+    Packet entry = flow.packets.front();
+    flow.packets.pop_front();
+    flow.bytes -= entry.pk->getByteLength();
+    numPackets--;
+
+    simtime_t now = simTime();
+    simtime_t sojournTime = now - entry.arrivalTime;
+    if (sojournTime < target || flow.bytes <= maxPacketBytes)
+    {
+        // went below target: stay below for at least one interval before dropping
+        flow.firstAboveTime = 0;
+    }
+    else if (flow.firstAboveTime == 0)
+    {
+        flow.firstAboveTime = now + interval;
+    }
+    else if (now >= flow.firstAboveTime)
+    {
+        okToDrop = true;
+    }
+    return entry.pk;
+}
+
+cPacket *FQCoDelQueue::codelDequeue(Flow& flow)
+{
+    simtime_t now = simTime();
+    bool okToDrop;
+    cPacket *pk = codelDoDequeue(flow, okToDrop);
+    if (!pk)
+    {
+        flow.dropping = false;
+        return NULL;
+    }
+
+    if (flow.dropping)
+    {
+        if (!okToDrop)
+        {
+            flow.dropping = false;
+        }
+        // drop as long as the next drop time has been reached; the drop
+        // rate grows with the square root of the drop count (control law)
+        while (flow.dropping && now >= flow.dropNext)
+        {
+            delete pk;
+            numCodelDrops++;
+            flow.count++;
+            pk = codelDoDequeue(flow, okToDrop);
+            if (!pk || !okToDrop)
+                flow.dropping = false;
+            else
+                flow.dropNext = flow.dropNext + interval / sqrt((double)flow.count);
+        }
+    }
+    else if (okToDrop)
+    {
+        delete pk;
+        numCodelDrops++;
+        pk = codelDoDequeue(flow, okToDrop);
+        flow.dropping = true;
+        // restart from the previous drop rate if we were dropping recently
+        int delta = flow.count - flow.lastCount;
+        if (delta > 1 && now - flow.dropNext < 16 * interval)
+            flow.count = delta;
+        else
+            flow.count = 1;
+        flow.dropNext = now + interval / sqrt((double)flow.count);
+        flow.lastCount = flow.count;
+    }
+    return pk;
+}
+
+cMessage *FQCoDelQueue::dequeue()
+{
+    while (!newFlows.empty() || !oldFlows.empty())
+    {
+        std::list<Flow *>& list = !newFlows.empty() ? newFlows : oldFlows;
+        Flow *flow = list.front();
+
+        if (flow->deficit <= 0)
+        {
+            // used up its quantum: to the end of the old flows
+            flow->deficit += quantum;
+            list.pop_front();
+            oldFlows.push_back(flow);
+            flow->listState = FLOW_OLD;
+            continue;
+        }
+
+        cPacket *pk = codelDequeue(*flow);
+        if (!pk)
+        {
+            list.pop_front();
+            if (&list == &newFlows)
+            {
+                // an emptied new flow gets one more round among the old
+                // flows, so that it cannot regain priority immediately
+                oldFlows.push_back(flow);
+                flow->listState = FLOW_OLD;
+            }
+            else
+            {
+                flow->listState = FLOW_IDLE;
+            }
+            continue;
+        }
+
+        flow->deficit -= pk->getByteLength();
+        sojournTimeVec.record(simTime() - pk->getArrivalTime());
+        qlenVec.record(numPackets);
+        return pk;
+    }
+    return NULL;
+}
+
+void FQCoDelQueue::sendOut(cMessage *msg)
+{
+    send(msg, outGate);
+}
+
+void FQCoDelQueue::finish()
+{
+    PassiveQueueBase::finish();
+    recordScalar("packets dropped by CoDel", numCodelDrops);
+    recordScalar("packets dropped on overflow", numOverflowDrops);
+}
+
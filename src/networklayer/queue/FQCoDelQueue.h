@@ -0,0 +1,114 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_FQCODELQUEUE_H
+#define __INET_FQCODELQUEUE_H
+
+#include <deque>
+#include <list>
+#include <vector>
+#include <omnetpp.h>
+#include "PassiveQueueBase.h"
+
+/**
+ * FQ-CoDel queue (RFC 8290). See NED for more info.
+ */
+class INET_API FQCoDelQueue : public PassiveQueueBase
+{
+  protected:
+    struct Packet
+    {
+        cPacket *pk;
+        simtime_t arrivalTime;
+    };
+
+    enum FlowListState { FLOW_IDLE, FLOW_NEW, FLOW_OLD };
+
+    struct Flow
+    {
+        std::deque<Packet> packets;
+        long bytes;
+        long deficit;
+        FlowListState listState;
+
+        // CoDel state
+        simtime_t firstAboveTime;
+        simtime_t dropNext;
+        int count;
+        int lastCount;
+        bool dropping;
+    };
+
+    // configuration
+    int frameCapacity;   // total number of packets over all flows
+    long quantum;
+    simtime_t target;
+    simtime_t interval;
+    long maxPacketBytes;
+    uint32 perturbation; // hash seed
+
+    // state
+    std::vector<Flow> flows;
+    std::list<Flow *> newFlows;
+    std::list<Flow *> oldFlows;
+    int numPackets;
+
+    cGate *outGate;
+
+    // statistics
+    long numCodelDrops;
+    long numOverflowDrops;
+    cOutVector sojournTimeVec;
+    cOutVector qlenVec;
+
+  public:
+    FQCoDelQueue();
+    virtual ~FQCoDelQueue();
+
+  protected:
+    virtual void initialize();
+    virtual void finish();
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual bool enqueue(cMessage *msg);
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual cMessage *dequeue();
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual void sendOut(cMessage *msg);
+
+    /** Maps the packet's 5-tuple (IPv4 or IPv6) to a flow index */
+    virtual int classifyFlow(cPacket *pk);
+
+    /** Removes the head packet of the flow; okToDrop tells whether CoDel may drop it */
+    virtual cPacket *codelDoDequeue(Flow& flow, bool& okToDrop);
+
+    /** Runs the CoDel control law on the flow and returns the packet to send, or NULL */
+    virtual cPacket *codelDequeue(Flow& flow);
+
+    /** Drops the head packet of the flow with the largest backlog */
+    virtual void dropFromFattestFlow();
+};
+
+#endif
+
@@ -0,0 +1,151 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#include <algorithm>
+#include <omnetpp.h>
+#include "WFQQueue.h"
+
+
+Define_Module(WFQQueue);
+
+WFQQueue::WFQQueue()
+{
+    queues = NULL;
+    numQueues = 0;
+    classifier = NULL;
+}
+
+WFQQueue::~WFQQueue()
+{
+    for (int i=0; i<numQueues; i++)
+        delete queues[i];
+    delete [] queues;
+    delete classifier;
+}
+
+void WFQQueue::initialize()
+{
+    PassiveQueueBase::initialize();
+
+    // configuration
+    frameCapacity = par("frameCapacity");
+    byteCapacity = par("byteCapacity");
+
+    const char *classifierClass = par("classifierClass");
+    classifier = check_and_cast<IQoSClassifier *>(createOne(classifierClass));
+
+    outGate = gate("out");
+
+    numQueues = classifier->getNumQueues();
+    queues = new cQueue *[numQueues];
+    for (int i=0; i<numQueues; i++)
+    {
+        char buf[32];
+        sprintf(buf, "queue-%d", i);
+        queues[i] = new cQueue(buf);
+    }
+
+    cStringTokenizer tokenizer(par("weights"));
+    const char *token;
+    while ((token = tokenizer.nextToken())!=NULL)
+    {
+        double weight = atof(token);
+        if (weight <= 0)
+            error("invalid weight '%s': weights must be positive", token);
+        weights.push_back(weight);
+    }
+    if (weights.size() > (unsigned int)numQueues)
+        error("%d weights given but classifier only has %d queues", (int)weights.size(), numQueues);
+    weights.resize(numQueues, 1.0);
+
+    finishTags.resize(numQueues);
+    lastFinishTags.assign(numQueues, 0.0);
+    queueBytes.assign(numQueues, 0);
+    numDropped.assign(numQueues, 0);
+    virtualTime = 0;
+    WATCH(virtualTime);
+}
+
+bool WFQQueue::enqueue(cMessage *msg)
+{
+    int queueIndex = classifier->classifyPacket(msg);
+    cQueue *queue = queues[queueIndex];
+    long bytes = PK(msg)->getByteLength();
+
+    if ((frameCapacity && queue->length() >= frameCapacity) ||
+        (byteCapacity && queueBytes[queueIndex] + bytes > byteCapacity))
+    {
+        EV << "Queue " << queueIndex << " full, dropping packet.\n";
+        numDropped[queueIndex]++;
+        delete msg;
+        return true;
+    }
+
+    // SCFQ: F = max(F_prev, V) + L/w, with V the finish tag in service
+    double start = std::max(lastFinishTags[queueIndex], virtualTime);
+    double finishTag = start + bytes / weights[queueIndex];
+    lastFinishTags[queueIndex] = finishTag;
+
+    if (queue->empty())
+        heads.insert(std::make_pair(finishTag, queueIndex));
+    queue->insert(msg);
+    finishTags[queueIndex].push_back(finishTag);
+    queueBytes[queueIndex] += bytes;
+    return false;
+}
+
+cMessage *WFQQueue::dequeue()
+{
+    if (heads.empty())
+    {
+        // system idle: restart virtual time so that tags stay small
+        virtualTime = 0;
+        lastFinishTags.assign(numQueues, 0.0);
+        return NULL;
+    }
+
+    // the subqueue whose head packet has the smallest finish tag: O(log n)
+    HeadSet::iterator first = heads.begin();
+    int queueIndex = first->second;
+    virtualTime = first->first;
+    heads.erase(first);
+
+    cQueue *queue = queues[queueIndex];
+    cMessage *msg = (cMessage *)queue->pop();
+    finishTags[queueIndex].pop_front();
+    queueBytes[queueIndex] -= PK(msg)->getByteLength();
+    if (!queue->empty())
+        heads.insert(std::make_pair(finishTags[queueIndex].front(), queueIndex));
+    return msg;
+}
+
+void WFQQueue::sendOut(cMessage *msg)
+{
+    send(msg, outGate);
+}
+
+void WFQQueue::finish()
+{
+    PassiveQueueBase::finish();
+
+    for (int i=0; i<numQueues; i++)
+    {
+        char buf[64];
+        sprintf(buf, "packets dropped by queue-%d", i);
+        recordScalar(buf, numDropped[i]);
+    }
+}
+
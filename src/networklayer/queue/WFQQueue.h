@@ -0,0 +1,83 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef __INET_WFQQUEUE_H
+#define __INET_WFQQUEUE_H
+
+#include <deque>
+#include <set>
+#include <vector>
+#include <omnetpp.h>
+#include "PassiveQueueBase.h"
+#include "IQoSClassifier.h"
+
+/**
+ * Weighted fair queueing (self-clocked variant) over per-class subqueues.
+ * See NED for more info.
+ */
+class INET_API WFQQueue : public PassiveQueueBase
+{
+  protected:
+    // (finish tag, subqueue index) of the head packet of each non-empty subqueue
+    typedef std::set<std::pair<double,int> > HeadSet;
+
+    // configuration
+    int frameCapacity;
+    long byteCapacity;
+    std::vector<double> weights;
+
+    // state
+    int numQueues;
+    cQueue **queues;
+    std::vector<std::deque<double> > finishTags;  // parallel to queues[i]
+    std::vector<double> lastFinishTags;
+    std::vector<long> queueBytes;
+    HeadSet heads;
+    double virtualTime;  // finish tag of the packet last sent
+    IQoSClassifier *classifier;
+
+    cGate *outGate;
+
+    // statistics
+    std::vector<long> numDropped;
+
+  public:
+    WFQQueue();
+    virtual ~WFQQueue();
+
+  protected:
+    virtual void initialize();
+    virtual void finish();
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual bool enqueue(cMessage *msg);
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual cMessage *dequeue();
+
+    /**
+     * Redefined from PassiveQueueBase.
+     */
+    virtual void sendOut(cMessage *msg);
+
+};
+
+#endif
+
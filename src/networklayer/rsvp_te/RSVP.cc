@@ -40,11 +40,14 @@ Define_Module(RSVP);
 
 RSVP::RSVP()
 {
+    stateTimerMsg = NULL;
 }
 
 RSVP::~RSVP()
 {
-    // TODO cancelAndDelete timers in all data structures
+    cancelAndDelete(stateTimerMsg);
+
+    // TODO cancelAndDelete hello timers
 }
 
 void RSVP::initialize(int stage)
@@ -69,6 +72,16 @@ void RSVP::initialize(int stage)
 
         retryInterval = 1.0;
 
+        refreshQuantum = par("refreshQuantum").doubleValue();
+        bundleRefreshes = par("bundleRefreshes").boolValue();
+
+        stateTimerMsg = new cMessage("state timers");
+        processingStateTimers = false;
+
+        numStateTimerEvents = 0;
+        numStateTimersFired = 0;
+        numBundlesSent = 0;
+
         // setup hello
         setupHello();
 
@@ -77,6 +90,13 @@ void RSVP::initialize(int stage)
     }
 }
 
+void RSVP::finish()
+{
+    recordScalar("state timer events", numStateTimerEvents);
+    recordScalar("state timers fired", numStateTimersFired);
+    recordScalar("bundles sent", numBundlesSent);
+}
+
 int RSVP::getInLabel(const SessionObj_t& session, const SenderTemplateObj_t& sender)
 {
     unsigned int index;
@@ -467,18 +487,16 @@ void RSVP::processHELLO_TIMER(HelloTimerMsg* msg)
     scheduleAt(simTime() + helloInterval, msg);
 }
 
-void RSVP::processPSB_TIMER(PsbTimerMsg *msg)
+void RSVP::processPSB_TIMER(PathStateBlock_t *psb)
 {
-    PathStateBlock_t *psb = findPsbById(msg->getId());
     ASSERT(psb);
 
     refreshPath(psb);
     scheduleRefreshTimer(psb, PSB_REFRESH_INTERVAL);
 }
 
-void RSVP::processPSB_TIMEOUT(PsbTimeoutMsg* msg)
+void RSVP::processPSB_TIMEOUT(PathStateBlock_t *psb)
 {
-    PathStateBlock_t *psb = findPsbById(msg->getId());
     ASSERT(psb);
 
     if (tedmod->isLocalAddress(psb->OutInterface))
@@ -493,10 +511,11 @@ void RSVP::processPSB_TIMEOUT(PsbTimeoutMsg* msg)
 }
 
 
-void RSVP::processRSB_REFRESH_TIMER(RsbRefreshTimerMsg *msg)
+void RSVP::processRSB_REFRESH_TIMER(ResvStateBlock_t *rsb)
 {
-    ResvStateBlock_t *rsb = findRsbById(msg->getId());
-    if (rsb->commitTimerMsg->isScheduled())
+    ASSERT(rsb);
+
+    if (isStateTimerScheduled(rsb->commitTimer))
     {
         // reschedule after commit
         scheduleRefreshTimer(rsb, 0.0);
@@ -509,19 +528,19 @@ void RSVP::processRSB_REFRESH_TIMER(RsbRefreshTimerMsg *msg)
     }
 }
 
-void RSVP::processRSB_COMMIT_TIMER(RsbCommitTimerMsg *msg)
+void RSVP::processRSB_COMMIT_TIMER(ResvStateBlock_t *rsb)
 {
-    ResvStateBlock_t *rsb = findRsbById(msg->getId());
+    ASSERT(rsb);
+
     commitResv(rsb);
 }
 
-void RSVP::processRSB_TIMEOUT(RsbTimeoutMsg* msg)
+void RSVP::processRSB_TIMEOUT(ResvStateBlock_t *rsb)
 {
-    EV << "RSB TIMEOUT RSB " << msg->getId() << endl;
+    ASSERT(rsb);
 
-    ResvStateBlock_t *rsb = findRsbById(msg->getId());
+    EV << "RSB TIMEOUT RSB " << rsb->id << endl;
 
-    ASSERT(rsb);
     ASSERT(tedmod->isLocalAddress(rsb->OI));
 
     for (unsigned int i = 0; i < rsb->FlowDescriptor.size(); i++)
@@ -539,15 +558,13 @@ bool RSVP::doCACCheck(const SessionObj_t& session, const SenderTspecObj_t& tspec
 
     double sharedBW = 0.0;
 
-    for (RSBVector::iterator it = RSBList.begin(); it != RSBList.end(); it++)
+    std::pair<RSBSessionIndex::iterator, RSBSessionIndex::iterator> range = rsbBySession.equal_range(SessionKey_t(session));
+    for (RSBSessionIndex::iterator it = range.first; it != range.second; it++)
     {
-        if (it->Session_Object != session)
-            continue;
-
-        if (it->Flowspec_Object.req_bandwidth <= sharedBW)
+        if (it->second->Flowspec_Object.req_bandwidth <= sharedBW)
             continue;
 
-        sharedBW = it->Flowspec_Object.req_bandwidth;
+        sharedBW = it->second->Flowspec_Object.req_bandwidth;
     }
 
     EV << "CACCheck: link=" << OI <<
@@ -591,7 +608,7 @@ void RSVP::refreshPath(PathStateBlock_t *psbEle)
 
     ASSERT(ERO.size() == 0 ||ERO[0].node.equals(nextHop) || ERO[0].L);
 
-    sendToIP(pm, nextHop);
+    sendRefresh(pm, nextHop);
 }
 
 void RSVP::refreshResv(ResvStateBlock_t *rsbEle)
@@ -600,26 +617,24 @@ void RSVP::refreshResv(ResvStateBlock_t *rsbEle)
 
     IPAddressVector phops;
 
-    for (PSBVector::iterator it = PSBList.begin(); it != PSBList.end(); it++)
+    for (unsigned int i = 0; i < rsbEle->FlowDescriptor.size(); i++)
     {
-        if (it->OutInterface != rsbEle->OI)
+        PathStateBlock_t *psb = findPSB(rsbEle->Session_Object, (SenderTemplateObj_t&)rsbEle->FlowDescriptor[i].Filter_Spec_Object);
+        if (!psb)
             continue;
 
-        for (int i = 0; i < (int)rsbEle->FlowDescriptor.size(); i++)
-        {
-            if ((FilterSpecObj_t&)it->Sender_Template_Object != rsbEle->FlowDescriptor[i].Filter_Spec_Object)
-                continue;
-
-            if (tedmod->isLocalAddress(it->Previous_Hop_Address))
-                continue; // IR nothing to refresh
+        if (psb->OutInterface != rsbEle->OI)
+            continue;
 
-            if (!find(phops, it->Previous_Hop_Address))
-                phops.push_back(it->Previous_Hop_Address);
-        }
+        if (tedmod->isLocalAddress(psb->Previous_Hop_Address))
+            continue; // IR nothing to refresh
 
-        for (IPAddressVector::iterator it = phops.begin(); it != phops.end(); it++)
-            refreshResv(rsbEle, *it);
+        if (!find(phops, psb->Previous_Hop_Address))
+            phops.push_back(psb->Previous_Hop_Address);
     }
+
+    for (IPAddressVector::iterator it = phops.begin(); it != phops.end(); it++)
+        refreshResv(rsbEle, *it);
 }
 
 void RSVP::refreshResv(ResvStateBlock_t *rsbEle, IPAddress PHOP)
@@ -637,34 +652,27 @@ void RSVP::refreshResv(ResvStateBlock_t *rsbEle, IPAddress PHOP)
     hop.Next_Hop_Address = PHOP;
     msg->setHop(hop);
 
-    for (PSBVector::iterator it = PSBList.begin(); it != PSBList.end(); it++)
+    ASSERT(rsbEle->inLabelVector.size() == rsbEle->FlowDescriptor.size());
+
+    for (unsigned int c = 0; c < rsbEle->FlowDescriptor.size(); c++)
     {
-        if (it->Previous_Hop_Address != PHOP)
+        PathStateBlock_t *psb = findPSB(rsbEle->Session_Object, (SenderTemplateObj_t&)rsbEle->FlowDescriptor[c].Filter_Spec_Object);
+        if (!psb)
             continue;
 
-        //if (it->LIH != LIH)
-        //  continue;
-
-        if (it->Session_Object != rsbEle->Session_Object)
+        if (psb->Previous_Hop_Address != PHOP)
             continue;
 
-        for (unsigned int c = 0; c < rsbEle->FlowDescriptor.size(); c++)
-        {
-            if ((FilterSpecObj_t&)it->Sender_Template_Object != rsbEle->FlowDescriptor[c].Filter_Spec_Object)
-                continue;
-
-            ASSERT(rsbEle->inLabelVector.size() == rsbEle->FlowDescriptor.size());
-
-            FlowDescriptor_t flow;
-            flow.Filter_Spec_Object = (FilterSpecObj_t&)it->Sender_Template_Object;
-            flow.Flowspec_Object = (FlowSpecObj_t&)it->Sender_Tspec_Object;
-            flow.RRO = rsbEle->FlowDescriptor[c].RRO;
-            flow.RRO.push_back(routerId);
-            flow.label = rsbEle->inLabelVector[c];
-            flows.push_back(flow);
+        //if (psb->LIH != LIH)
+        //  continue;
 
-            break;
-        }
+        FlowDescriptor_t flow;
+        flow.Filter_Spec_Object = (FilterSpecObj_t&)psb->Sender_Template_Object;
+        flow.Flowspec_Object = (FlowSpecObj_t&)psb->Sender_Tspec_Object;
+        flow.RRO = rsbEle->FlowDescriptor[c].RRO;
+        flow.RRO.push_back(routerId);
+        flow.label = rsbEle->inLabelVector[c];
+        flows.push_back(flow);
     }
 
     msg->setFlowDescriptor(flows);
@@ -680,7 +688,7 @@ void RSVP::refreshResv(ResvStateBlock_t *rsbEle, IPAddress PHOP)
 
     msg->setByteLength(length);
 
-    sendToIP(msg, PHOP);
+    sendRefresh(msg, PHOP);
 }
 
 void RSVP::preempt(IPAddress OI, int priority, double bandwidth)
@@ -928,12 +936,12 @@ void RSVP::commitResv(ResvStateBlock_t *rsb)
         }
 
         // schedule commit of merging backups too...
-        for (unsigned int j = 0; j < RSBList.size(); j++)
+        for (RSBVector::iterator it = RSBList.begin(); it != RSBList.end(); it++)
         {
-            if (RSBList[j].OI != lspid)
+            if (it->OI != lspid)
                 continue;
 
-            scheduleCommitTimer(&RSBList[j]);
+            scheduleCommitTimer(&(*it));
         }
     }
 }
@@ -944,14 +952,9 @@ RSVP::ResvStateBlock_t* RSVP::createRSB(RSVPResvMsg *msg)
 
     rsbEle.id = ++maxRsbId;
 
-    rsbEle.timeoutMsg = new RsbTimeoutMsg("rsb timeout");
-    rsbEle.timeoutMsg->setId(rsbEle.id);
-
-    rsbEle.refreshTimerMsg = new RsbRefreshTimerMsg("rsb timer");
-    rsbEle.refreshTimerMsg->setId(rsbEle.id);
-
-    rsbEle.commitTimerMsg = new RsbCommitTimerMsg("rsb commit");
-    rsbEle.commitTimerMsg->setId(rsbEle.id);
+    rsbEle.refreshTimer = stateTimers.end();
+    rsbEle.commitTimer = stateTimers.end();
+    rsbEle.timeoutTimer = stateTimers.end();
 
     rsbEle.Session_Object = msg->getSession();
     rsbEle.Next_Hop_Address = msg->getNHOP();
@@ -967,7 +970,10 @@ RSVP::ResvStateBlock_t* RSVP::createRSB(RSVPResvMsg *msg)
     }
 
     RSBList.push_back(rsbEle);
-    ResvStateBlock_t *rsb = &(*(RSBList.end() - 1));
+    ResvStateBlock_t *rsb = &RSBList.back();
+
+    rsbById[rsb->id] = --RSBList.end();
+    rsbBySession.insert(std::make_pair(SessionKey_t(rsb->Session_Object), rsb));
 
     EV << "created new RSB " << rsb->id << endl;
 
@@ -1047,13 +1053,11 @@ void RSVP::removeRSB(ResvStateBlock_t *rsb)
 
     EV << "removing empty RSB " << rsb->id << endl;
 
-    cancelEvent(rsb->refreshTimerMsg);
-    cancelEvent(rsb->commitTimerMsg);
-    cancelEvent(rsb->timeoutMsg);
+    cancelStateTimer(rsb->refreshTimer);
+    cancelStateTimer(rsb->commitTimer);
+    cancelStateTimer(rsb->timeoutTimer);
 
-    delete rsb->refreshTimerMsg;
-    delete rsb->commitTimerMsg;
-    delete rsb->timeoutMsg;
+    dropPendingRefreshes(rsb->Session_Object, NULL);
 
     if (rsb->Flowspec_Object.req_bandwidth > 0)
     {
@@ -1061,15 +1065,20 @@ void RSVP::removeRSB(ResvStateBlock_t *rsb)
         allocateResource(rsb->OI, rsb->Session_Object, -rsb->Flowspec_Object.req_bandwidth);
     }
 
-    for (RSBVector::iterator it = RSBList.begin(); it != RSBList.end(); it++)
+    std::pair<RSBSessionIndex::iterator, RSBSessionIndex::iterator> range = rsbBySession.equal_range(SessionKey_t(rsb->Session_Object));
+    for (RSBSessionIndex::iterator it = range.first; it != range.second; it++)
     {
-        if (it->id != rsb->id)
+        if (it->second != rsb)
             continue;
 
-        RSBList.erase(it);
-        return;
+        rsbBySession.erase(it);
+        break;
     }
-    ASSERT(false);
+
+    RSBIdIndex::iterator it = rsbById.find(rsb->id);
+    ASSERT(it != rsbById.end());
+    RSBList.erase(it->second);
+    rsbById.erase(it);
 }
 
 void RSVP::removePSB(PathStateBlock_t *psb)
@@ -1093,21 +1102,17 @@ void RSVP::removePSB(PathStateBlock_t *psb)
 
     // proceed with actual removal *********************************************
 
-    cancelEvent(psb->timerMsg);
-    cancelEvent(psb->timeoutMsg);
+    cancelStateTimer(psb->refreshTimer);
+    cancelStateTimer(psb->timeoutTimer);
 
-    delete psb->timerMsg;
-    delete psb->timeoutMsg;
+    dropPendingRefreshes(psb->Session_Object, &psb->Sender_Template_Object);
 
-    for (PSBVector::iterator it = PSBList.begin(); it != PSBList.end(); it++)
-    {
-        if (it->id != psb->id)
-            continue;
+    psbBySender.erase(SenderKey_t(psb->Session_Object, psb->Sender_Template_Object));
 
-        PSBList.erase(it);
-        return;
-    }
-    ASSERT(false);
+    PSBIdIndex::iterator it = psbById.find(psb->id);
+    ASSERT(it != psbById.end());
+    PSBList.erase(it->second);
+    psbById.erase(it);
 }
 
 bool RSVP::evalNextHopInterface(IPAddress destAddr, const EroVector& ERO, IPAddress& OI)
@@ -1205,11 +1210,8 @@ RSVP::PathStateBlock_t* RSVP::createPSB(RSVPPathMsg *msg)
 
     psbEle.id = ++maxPsbId;
 
-    psbEle.timeoutMsg = new PsbTimeoutMsg("psb timeout");
-    psbEle.timeoutMsg->setId(psbEle.id);
-
-    psbEle.timerMsg = new PsbTimerMsg("psb timer");
-    psbEle.timerMsg->setId(psbEle.id);
+    psbEle.refreshTimer = stateTimers.end();
+    psbEle.timeoutTimer = stateTimers.end();
 
     psbEle.Session_Object = msg->getSession();
     psbEle.Sender_Template_Object = msg->getSenderTemplate();
@@ -1225,7 +1227,10 @@ RSVP::PathStateBlock_t* RSVP::createPSB(RSVPPathMsg *msg)
     psbEle.handler = -1;
 
     PSBList.push_back(psbEle);
-    PathStateBlock_t *cPSB = &(*(PSBList.end() - 1));
+    PathStateBlock_t *cPSB = &PSBList.back();
+
+    psbById[cPSB->id] = --PSBList.end();
+    psbBySender[SenderKey_t(cPSB->Session_Object, cPSB->Sender_Template_Object)] = cPSB;
 
     EV << "created new PSB " << cPSB->id << endl;
 
@@ -1255,11 +1260,8 @@ RSVP::PathStateBlock_t* RSVP::createIngressPSB(const traffic_session_t& session,
     PathStateBlock_t psbEle;
     psbEle.id = ++maxPsbId;
 
-    psbEle.timeoutMsg = new PsbTimeoutMsg("psb timeout");
-    psbEle.timeoutMsg->setId(psbEle.id);
-
-    psbEle.timerMsg = new PsbTimerMsg("psb timer");
-    psbEle.timerMsg->setId(psbEle.id);
+    psbEle.refreshTimer = stateTimers.end();
+    psbEle.timeoutTimer = stateTimers.end();
 
     psbEle.Session_Object = session.sobj;
     psbEle.Sender_Template_Object = path.sender;
@@ -1274,7 +1276,10 @@ RSVP::PathStateBlock_t* RSVP::createIngressPSB(const traffic_session_t& session,
     psbEle.handler = path.owner;
 
     PSBList.push_back(psbEle);
-    PathStateBlock_t *cPSB = &(*(PSBList.end() - 1));
+    PathStateBlock_t *cPSB = &PSBList.back();
+
+    psbById[cPSB->id] = --PSBList.end();
+    psbBySender[SenderKey_t(cPSB->Session_Object, cPSB->Sender_Template_Object)] = cPSB;
 
     return cPSB;
 }
@@ -1286,14 +1291,9 @@ RSVP::ResvStateBlock_t* RSVP::createEgressRSB(PathStateBlock_t *psb)
 
     rsbEle.id = ++maxRsbId;
 
-    rsbEle.timeoutMsg = new RsbTimeoutMsg("rsb timeout");
-    rsbEle.timeoutMsg->setId(rsbEle.id);
-
-    rsbEle.refreshTimerMsg = new RsbRefreshTimerMsg("rsb timer");
-    rsbEle.refreshTimerMsg->setId(rsbEle.id);
-
-    rsbEle.commitTimerMsg = new RsbCommitTimerMsg("rsb commit");
-    rsbEle.commitTimerMsg->setId(rsbEle.id);
+    rsbEle.refreshTimer = stateTimers.end();
+    rsbEle.commitTimer = stateTimers.end();
+    rsbEle.timeoutTimer = stateTimers.end();
 
     rsbEle.Session_Object = psb->Session_Object;
     rsbEle.Next_Hop_Address = psb->Previous_Hop_Address;
@@ -1309,7 +1309,10 @@ RSVP::ResvStateBlock_t* RSVP::createEgressRSB(PathStateBlock_t *psb)
     rsbEle.inLabelVector.push_back(-1);
 
     RSBList.push_back(rsbEle);
-    ResvStateBlock_t *rsb = &(*(RSBList.end() - 1));
+    ResvStateBlock_t *rsb = &RSBList.back();
+
+    rsbById[rsb->id] = --RSBList.end();
+    rsbBySession.insert(std::make_pair(SessionKey_t(rsb->Session_Object), rsb));
 
     EV << "created new (egress) RSB " << rsb->id << endl;
 
@@ -1318,6 +1321,12 @@ RSVP::ResvStateBlock_t* RSVP::createEgressRSB(PathStateBlock_t *psb)
 
 void RSVP::handleMessage(cMessage *msg)
 {
+    if (msg == stateTimerMsg)
+    {
+        processStateTimers();
+        return;
+    }
+
     SignallingMsg *sMsg = dynamic_cast<SignallingMsg*>(msg);
     RSVPMessage *rMsg = dynamic_cast<RSVPMessage*>(msg);
 
@@ -1360,11 +1369,26 @@ void RSVP::processRSVPMessage(RSVPMessage *msg)
             processPathErrMsg(check_and_cast<RSVPPathError*>(msg));
             break;
 
+        case BUNDLE_MESSAGE:
+            processBundleMsg(check_and_cast<RSVPBundleMsg*>(msg));
+            break;
+
         default:
             ASSERT(false);
     }
 }
 
+void RSVP::processBundleMsg(RSVPBundleMsg* msg)
+{
+    EV << "Received BUNDLE_MESSAGE with " << msg->getNumSubMessages() << " messages" << endl;
+
+    RSVPMessage *subMsg;
+    while ((subMsg = msg->removeFirstSubMessage()) != NULL)
+        processRSVPMessage(subMsg);
+
+    delete msg;
+}
+
 void RSVP::processHelloMsg(RSVPHelloMsg* msg)
 {
     EV << "Received RSVP_HELLO" << endl;
@@ -1526,10 +1550,13 @@ void RSVP::processPathTearMsg(RSVPPathTear *msg)
 
     bool modified = false;
 
-    for (PSBVector::iterator it = PSBList.begin(); it != PSBList.end(); it++)
+    for (PSBVector::iterator it = PSBList.begin(); it != PSBList.end(); )
     {
         if (it->OutInterface.getInt() != lspid)
+        {
+            it++;
             continue;
+        }
 
         // merging backup exists
 
@@ -1542,8 +1569,7 @@ void RSVP::processPathTearMsg(RSVPPathTear *msg)
 
         EV << "merging backup must be removed too" << endl;
 
-        removePSB(&(*it));
-        --it;
+        removePSB(&(*it++));
 
         modified = true;
     }
@@ -1666,18 +1692,16 @@ void RSVP::processResvMsg(RSVPResvMsg *msg)
     // find matching RSB *******************************************************
 
     ResvStateBlock_t *rsb = NULL;
-    for (RSBVector::iterator it = RSBList.begin(); it != RSBList.end(); it++)
+    std::pair<RSBSessionIndex::iterator, RSBSessionIndex::iterator> range = rsbBySession.equal_range(SessionKey_t(msg->getSession()));
+    for (RSBSessionIndex::iterator it = range.first; it != range.second; it++)
     {
-        if (!(msg->isInSession(&it->Session_Object)))
-            continue;
-
-        if (it->Next_Hop_Address != msg->getNHOP())
+        if (it->second->Next_Hop_Address != msg->getNHOP())
             continue;
 
-        if (it->OI != msg->getLIH())
+        if (it->second->OI != msg->getLIH())
             continue;
 
-        rsb = &(*it);
+        rsb = it->second;
         break;
     }
 
@@ -1726,26 +1750,6 @@ void RSVP::processSignallingMessage(SignallingMsg *msg)
     int command = msg->getCommand();
     switch(command)
     {
-        case MSG_PSB_TIMER:
-            processPSB_TIMER(check_and_cast<PsbTimerMsg*>(msg));
-            break;
-
-        case MSG_PSB_TIMEOUT:
-            processPSB_TIMEOUT(check_and_cast<PsbTimeoutMsg*>(msg));
-            break;
-
-        case MSG_RSB_REFRESH_TIMER:
-            processRSB_REFRESH_TIMER(check_and_cast<RsbRefreshTimerMsg*>(msg));
-            break;
-
-        case MSG_RSB_COMMIT_TIMER:
-            processRSB_COMMIT_TIMER(check_and_cast<RsbCommitTimerMsg*>(msg));
-            break;
-
-        case MSG_RSB_TIMEOUT:
-            processRSB_TIMEOUT(check_and_cast<RsbTimeoutMsg*>(msg));
-            break;
-
         case MSG_HELLO_TIMER:
             processHELLO_TIMER(check_and_cast<HelloTimerMsg*>(msg));
             break;
@@ -1763,6 +1767,70 @@ void RSVP::processSignallingMessage(SignallingMsg *msg)
     }
 }
 
+void RSVP::processStateTimers()
+{
+    numStateTimerEvents++;
+
+    processingStateTimers = true;
+
+    // timers scheduled with zero delay by the handlers below are due as well;
+    // they are appended to the queue and processed within this same event
+    while (!stateTimers.empty() && stateTimers.begin()->first <= simTime())
+    {
+        StateTimer_t timer = stateTimers.begin()->second;
+
+        numStateTimersFired++;
+
+        switch(timer.kind)
+        {
+            case PSB_REFRESH_TIMER: {
+                PathStateBlock_t *psb = findPsbById(timer.id);
+                cancelStateTimer(psb->refreshTimer);
+                processPSB_TIMER(psb);
+                break;
+            }
+
+            case PSB_TIMEOUT_TIMER: {
+                PathStateBlock_t *psb = findPsbById(timer.id);
+                cancelStateTimer(psb->timeoutTimer);
+                processPSB_TIMEOUT(psb);
+                break;
+            }
+
+            case RSB_REFRESH_TIMER: {
+                ResvStateBlock_t *rsb = findRsbById(timer.id);
+                cancelStateTimer(rsb->refreshTimer);
+                processRSB_REFRESH_TIMER(rsb);
+                break;
+            }
+
+            case RSB_COMMIT_TIMER: {
+                ResvStateBlock_t *rsb = findRsbById(timer.id);
+                cancelStateTimer(rsb->commitTimer);
+                processRSB_COMMIT_TIMER(rsb);
+                break;
+            }
+
+            case RSB_TIMEOUT_TIMER: {
+                ResvStateBlock_t *rsb = findRsbById(timer.id);
+                cancelStateTimer(rsb->timeoutTimer);
+                processRSB_TIMEOUT(rsb);
+                break;
+            }
+
+            default:
+                ASSERT(false);
+        }
+    }
+
+    processingStateTimers = false;
+
+    flushBundles();
+
+    if (!stateTimers.empty())
+        scheduleAt(stateTimers.begin()->first, stateTimerMsg);
+}
+
 void RSVP::pathProblem(PathStateBlock_t *psb)
 {
     ASSERT(psb);
@@ -1950,6 +2018,9 @@ void RSVP::processCommand(const cXMLElement& node)
 
 void RSVP::sendPathTearMessage(IPAddress peerIP, const SessionObj_t& session, const SenderTemplateObj_t& sender, IPAddress LIH, IPAddress NHOP, bool force)
 {
+    // a bundled refresh would only go out after the tear and recreate the state
+    dropPendingRefreshes(session, &sender);
+
     RSVPPathTear *msg = new RSVPPathTear("PathTear");
     msg->setSenderTemplate(sender);
     msg->setSession(session);
@@ -2003,14 +2074,143 @@ void RSVP::sendToIP(cMessage *msg, IPAddress destAddr)
     send(msg, "ipOut");
 }
 
+void RSVP::sendRefresh(RSVPMessage *msg, IPAddress destAddr)
+{
+    if (!bundleRefreshes || !processingStateTimers)
+    {
+        sendToIP(msg, destAddr);
+        return;
+    }
+
+    // collect refreshes that become due in the same event; they are sent
+    // in flushBundles() once all due state timers have been processed
+    RSVPBundleMsg *&bundle = pendingBundles[destAddr];
+    if (!bundle)
+        bundle = new RSVPBundleMsg("Bundle");
+    bundle->addSubMessage(msg);
+}
+
+void RSVP::flushBundles()
+{
+    for (BundleMap::iterator it = pendingBundles.begin(); it != pendingBundles.end(); it++)
+    {
+        RSVPBundleMsg *bundle = it->second;
+
+        if (bundle->getNumSubMessages() == 1)
+        {
+            // nothing to bundle with, send the message on its own
+            RSVPMessage *msg = bundle->removeFirstSubMessage();
+            delete bundle;
+            sendToIP(msg, it->first);
+        }
+        else
+        {
+            EV << "sending bundle of " << bundle->getNumSubMessages() << " messages to " << it->first << endl;
+
+            numBundlesSent++;
+            sendToIP(bundle, it->first);
+        }
+    }
+    pendingBundles.clear();
+}
+
+void RSVP::dropPendingRefreshes(const SessionObj_t& session, const SenderTemplateObj_t *sender)
+{
+    // with a sender, drop the Path refreshes of that sender; without one,
+    // the Resv refreshes of the session
+    for (BundleMap::iterator it = pendingBundles.begin(); it != pendingBundles.end(); )
+    {
+        RSVPBundleMsg *bundle = it->second;
+
+        unsigned int n = bundle->getNumSubMessages();
+        for (unsigned int i = 0; i < n; i++)
+        {
+            RSVPMessage *msg = bundle->removeFirstSubMessage();
+
+            bool match;
+            if (sender)
+            {
+                RSVPPathMsg *pm = dynamic_cast<RSVPPathMsg*>(msg);
+                match = pm && pm->getSession() == session && pm->getSenderTemplate() == *sender;
+            }
+            else
+            {
+                RSVPResvMsg *rm = dynamic_cast<RSVPResvMsg*>(msg);
+                match = rm && rm->getSession() == session;
+            }
+
+            if (match)
+            {
+                EV << "dropping pending refresh " << msg->getName() << " to " << it->first << endl;
+                delete msg;
+            }
+            else
+                bundle->addSubMessage(msg);
+        }
+
+        if (bundle->getNumSubMessages() == 0)
+        {
+            delete bundle;
+            pendingBundles.erase(it++);
+        }
+        else
+            it++;
+    }
+}
+
+void RSVP::scheduleStateTimer(StateTimerRef& ref, StateTimerKind kind, int id, simtime_t delay)
+{
+    cancelStateTimer(ref);
+
+    simtime_t t = simTime() + delay;
+
+    // round up to the next multiple of the quantum, so that the timers of
+    // many blocks fall into the same event and their refreshes can be
+    // bundled; zero delay timers (commits, triggered refreshes) stay exact
+    if (delay > 0 && refreshQuantum > 0)
+    {
+        int64 q = refreshQuantum.raw();
+        int64 r = t.raw() % q;
+        if (r != 0)
+            t.setRaw(t.raw() + q - r);
+    }
+
+    StateTimer_t timer;
+    timer.kind = kind;
+    timer.id = id;
+
+    ref = stateTimers.insert(std::make_pair(t, timer));
+
+    // while processing, stateTimerMsg is rescheduled when done
+    if (processingStateTimers)
+        return;
+
+    if (stateTimerMsg->isScheduled())
+    {
+        if (stateTimerMsg->getArrivalTime() <= t)
+            return;
+
+        cancelEvent(stateTimerMsg);
+    }
+    scheduleAt(t, stateTimerMsg);
+}
+
+void RSVP::cancelStateTimer(StateTimerRef& ref)
+{
+    if (!isStateTimerScheduled(ref))
+        return;
+
+    // stateTimerMsg is left alone; if it fires with nothing due, it is
+    // simply rescheduled for the next timer
+    stateTimers.erase(ref);
+    ref = stateTimers.end();
+}
+
 void RSVP::scheduleTimeout(PathStateBlock_t *psbEle)
 {
     ASSERT(psbEle);
 
-    if (psbEle->timeoutMsg->isScheduled())
-        cancelEvent(psbEle->timeoutMsg);
-
-    scheduleAt(simTime() + PSB_TIMEOUT_INTERVAL, psbEle->timeoutMsg);
+    scheduleStateTimer(psbEle->timeoutTimer, PSB_TIMEOUT_TIMER, psbEle->id, PSB_TIMEOUT_INTERVAL);
 }
 
 void RSVP::scheduleRefreshTimer(PathStateBlock_t *psbEle, simtime_t delay)
@@ -2023,56 +2223,43 @@ void RSVP::scheduleRefreshTimer(PathStateBlock_t *psbEle, simtime_t delay)
     if (!tedmod->isLocalAddress(psbEle->OutInterface))
         return;
 
-    if (psbEle->timerMsg->isScheduled())
-        cancelEvent(psbEle->timerMsg);
-
     EV << "scheduling PSB " << psbEle->id << " refresh " << (simTime() + delay) << endl;
 
-    scheduleAt(simTime() + delay, psbEle->timerMsg);
+    scheduleStateTimer(psbEle->refreshTimer, PSB_REFRESH_TIMER, psbEle->id, delay);
 }
 
 void RSVP::scheduleTimeout(ResvStateBlock_t *rsbEle)
 {
     ASSERT(rsbEle);
 
-    if (rsbEle->timeoutMsg->isScheduled())
-        cancelEvent(rsbEle->timeoutMsg);
-
-    scheduleAt(simTime() + RSB_TIMEOUT_INTERVAL, rsbEle->timeoutMsg);
+    scheduleStateTimer(rsbEle->timeoutTimer, RSB_TIMEOUT_TIMER, rsbEle->id, RSB_TIMEOUT_INTERVAL);
 }
 
 void RSVP::scheduleRefreshTimer(ResvStateBlock_t *rsbEle, simtime_t delay)
 {
     ASSERT(rsbEle);
 
-    if (rsbEle->refreshTimerMsg->isScheduled())
-        cancelEvent(rsbEle->refreshTimerMsg);
-
-    scheduleAt(simTime() + delay, rsbEle->refreshTimerMsg);
+    scheduleStateTimer(rsbEle->refreshTimer, RSB_REFRESH_TIMER, rsbEle->id, delay);
 }
 
 void RSVP::scheduleCommitTimer(ResvStateBlock_t *rsbEle)
 {
     ASSERT(rsbEle);
 
-    if (rsbEle->commitTimerMsg->isScheduled())
-        cancelEvent(rsbEle->commitTimerMsg);
-
-    scheduleAt(simTime(), rsbEle->commitTimerMsg);
+    scheduleStateTimer(rsbEle->commitTimer, RSB_COMMIT_TIMER, rsbEle->id, 0.0);
 }
 
 RSVP::ResvStateBlock_t* RSVP::findRSB(const SessionObj_t& session, const SenderTemplateObj_t& sender, unsigned int& index)
 {
-    RSBVector::iterator it;
+    std::pair<RSBSessionIndex::iterator, RSBSessionIndex::iterator> range = rsbBySession.equal_range(SessionKey_t(session));
 
-    for (it = RSBList.begin(); it != RSBList.end(); it++)
+    for (RSBSessionIndex::iterator it = range.first; it != range.second; it++)
     {
-        if (it->Session_Object != session)
-            continue;
+        ResvStateBlock_t *rsb = it->second;
 
         FlowDescriptorVector::iterator fit;
         index = 0;
-        for (fit = it->FlowDescriptor.begin(); fit != it->FlowDescriptor.end(); fit++)
+        for (fit = rsb->FlowDescriptor.begin(); fit != rsb->FlowDescriptor.end(); fit++)
         {
             if ((SenderTemplateObj_t&)fit->Filter_Spec_Object != sender)
             {
@@ -2080,7 +2267,7 @@ RSVP::ResvStateBlock_t* RSVP::findRSB(const SessionObj_t& session, const SenderT
                 continue;
             }
 
-            return &(*it);
+            return rsb;
         }
 
         // don't break here, may be in different (if outInterface is different)
@@ -2090,46 +2277,28 @@ RSVP::ResvStateBlock_t* RSVP::findRSB(const SessionObj_t& session, const SenderT
 
 RSVP::PathStateBlock_t* RSVP::findPSB(const SessionObj_t& session, const SenderTemplateObj_t& sender)
 {
-    PSBVector::iterator it;
-    for (it = PSBList.begin(); it != PSBList.end(); it++)
-    {
-        if (it->Session_Object != session)
-            continue;
-
-        if (it->Sender_Template_Object != sender)
-            continue;
-
-        return &(*it);
-    }
+    PSBSenderIndex::iterator it = psbBySender.find(SenderKey_t(session, sender));
+    if (it == psbBySender.end())
+        return NULL;
 
-    return NULL;
+    return it->second;
 }
 
 RSVP::PathStateBlock_t* RSVP::findPsbById(int id)
 {
-    for (unsigned int i = 0; i < PSBList.size(); i++)
-    {
-        if (PSBList[i].id != id)
-            continue;
+    PSBIdIndex::iterator it = psbById.find(id);
+    ASSERT(it != psbById.end());
 
-        return &PSBList[i];
-    }
-    ASSERT(false);
-    return NULL; // prevent warning
+    return &(*it->second);
 }
 
 
 RSVP::ResvStateBlock_t* RSVP::findRsbById(int id)
 {
-    for (unsigned int i = 0; i < RSBList.size(); i++)
-    {
-        if (RSBList[i].id != id)
-            continue;
+    RSBIdIndex::iterator it = rsbById.find(id);
+    ASSERT(it != rsbById.end());
 
-        return &RSBList[i];
-    }
-    ASSERT(false);
-    return NULL; // prevent warning
+    return &(*it->second);
 }
 
 RSVP::HelloState_t* RSVP::findHello(IPAddress peer)
@@ -16,6 +16,8 @@
 #define __INET_RSVP_H
 
 #include <vector>
+#include <list>
+#include <map>
 #include <omnetpp.h>
 
 #include "IScriptable.h"
@@ -23,6 +25,7 @@
 #include "RSVPPathMsg.h"
 #include "RSVPResvMsg.h"
 #include "RSVPHelloMsg.h"
+#include "RSVPBundleMsg.h"
 #include "SignallingMsg_m.h"
 #include "IRSVPClassifier.h"
 #include "NotificationBoard.h"
@@ -63,6 +66,63 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
 
     std::vector<traffic_session_t> traffic;
 
+    /**
+     * Soft-state timers of PSBs and RSBs. All of them are kept in a single
+     * time-ordered table per node and driven by one self-message
+     * (see scheduleStateTimer() and processStateTimers()).
+     */
+    enum StateTimerKind
+    {
+        PSB_REFRESH_TIMER,
+        PSB_TIMEOUT_TIMER,
+        RSB_REFRESH_TIMER,
+        RSB_COMMIT_TIMER,
+        RSB_TIMEOUT_TIMER
+    };
+
+    struct StateTimer_t
+    {
+        StateTimerKind kind;
+        int id; // PSB or RSB id
+    };
+
+    typedef std::multimap<simtime_t, StateTimer_t> StateTimerQueue;
+    typedef StateTimerQueue::iterator StateTimerRef;
+
+    /**
+     * Lookup keys of the PSB and RSB indices
+     */
+    struct SessionKey_t
+    {
+        uint32 destAddr;
+        int tunnelId;
+        int extTunnelId;
+
+        SessionKey_t(const SessionObj_t& s) :
+            destAddr(s.DestAddress.getInt()), tunnelId(s.Tunnel_Id), extTunnelId(s.Extended_Tunnel_Id) {}
+        bool operator<(const SessionKey_t& other) const {
+            if (destAddr != other.destAddr) return destAddr < other.destAddr;
+            if (tunnelId != other.tunnelId) return tunnelId < other.tunnelId;
+            return extTunnelId < other.extTunnelId;
+        }
+    };
+
+    struct SenderKey_t
+    {
+        SessionKey_t session;
+        uint32 srcAddr;
+        int lspId;
+
+        SenderKey_t(const SessionObj_t& s, const SenderTemplateObj_t& t) :
+            session(s), srcAddr(t.SrcAddress.getInt()), lspId(t.Lsp_Id) {}
+        bool operator<(const SenderKey_t& other) const {
+            if (session < other.session) return true;
+            if (other.session < session) return false;
+            if (srcAddr != other.srcAddr) return srcAddr < other.srcAddr;
+            return lspId < other.lspId;
+        }
+    };
+
     /**
      * Path State Block (PSB) structure
      */
@@ -95,15 +155,18 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
         // XXX nam colors
         int color;
 
-        // timer/timeout routines
-        PsbTimerMsg *timerMsg;
-        PsbTimeoutMsg *timeoutMsg;
+        // timer/timeout routines (entries in stateTimers)
+        StateTimerRef refreshTimer;
+        StateTimerRef timeoutTimer;
 
         // handler module
         int handler;
     };
 
-    typedef std::vector<PathStateBlock_t> PSBVector;
+    // a list, so that PSB pointers remain valid while other blocks come and go
+    typedef std::list<PathStateBlock_t> PSBVector;
+    typedef std::map<SenderKey_t, PathStateBlock_t*> PSBSenderIndex;
+    typedef std::map<int, PSBVector::iterator> PSBIdIndex;
 
     /**
      * Reservation State Block (RSB) structure
@@ -134,13 +197,16 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
         // RSB unique identifier
         int id;
 
-        // timer/timeout routines
-        RsbRefreshTimerMsg *refreshTimerMsg;
-        RsbCommitTimerMsg *commitTimerMsg;
-        RsbTimeoutMsg *timeoutMsg;
+        // timer/timeout routines (entries in stateTimers)
+        StateTimerRef refreshTimer;
+        StateTimerRef commitTimer;
+        StateTimerRef timeoutTimer;
     };
 
-    typedef std::vector<ResvStateBlock_t> RSBVector;
+    // a list, so that RSB pointers remain valid while other blocks come and go
+    typedef std::list<ResvStateBlock_t> RSBVector;
+    typedef std::multimap<SessionKey_t, ResvStateBlock_t*> RSBSessionIndex;
+    typedef std::map<int, RSBVector::iterator> RSBIdIndex;
 
     /**
      * RSVP Hello State structure
@@ -169,6 +235,9 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
     simtime_t helloTimeout;
     simtime_t retryInterval;
 
+    simtime_t refreshQuantum;   // refresh and timeout times are rounded up to a multiple of this
+    bool bundleRefreshes;       // send refreshes to the same neighbour in one Bundle message
+
   protected:
     TED *tedmod;
     IRoutingTable *rt;
@@ -189,13 +258,31 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
     RSBVector RSBList;
     HelloVector HelloList;
 
+    PSBSenderIndex psbBySender;
+    PSBIdIndex psbById;
+    RSBSessionIndex rsbBySession;
+    RSBIdIndex rsbById;
+
+    StateTimerQueue stateTimers;
+    cMessage *stateTimerMsg;
+    bool processingStateTimers;
+
+    // refreshes collected while processing state timers, one bundle per neighbour
+    typedef std::map<IPAddress, RSVPBundleMsg*> BundleMap;
+    BundleMap pendingBundles;
+
+    long numStateTimerEvents;
+    long numStateTimersFired;
+    long numBundlesSent;
+
   protected:
     virtual void processSignallingMessage(SignallingMsg *msg);
-    virtual void processPSB_TIMER(PsbTimerMsg *msg);
-    virtual void processPSB_TIMEOUT(PsbTimeoutMsg* msg);
-    virtual void processRSB_REFRESH_TIMER(RsbRefreshTimerMsg *msg);
-    virtual void processRSB_COMMIT_TIMER(RsbCommitTimerMsg *msg);
-    virtual void processRSB_TIMEOUT(RsbTimeoutMsg* msg);
+    virtual void processStateTimers();
+    virtual void processPSB_TIMER(PathStateBlock_t *psb);
+    virtual void processPSB_TIMEOUT(PathStateBlock_t *psb);
+    virtual void processRSB_REFRESH_TIMER(ResvStateBlock_t *rsb);
+    virtual void processRSB_COMMIT_TIMER(ResvStateBlock_t *rsb);
+    virtual void processRSB_TIMEOUT(ResvStateBlock_t *rsb);
     virtual void processHELLO_TIMER(HelloTimerMsg* msg);
     virtual void processHELLO_TIMEOUT(HelloTimeoutMsg* msg);
     virtual void processPATH_NOTIFY(PathNotifyMsg* msg);
@@ -205,6 +292,7 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
     virtual void processResvMsg(RSVPResvMsg* msg);
     virtual void processPathTearMsg(RSVPPathTear* msg);
     virtual void processPathErrMsg(RSVPPathError* msg);
+    virtual void processBundleMsg(RSVPBundleMsg* msg);
 
     virtual PathStateBlock_t* createPSB(RSVPPathMsg *msg);
     virtual PathStateBlock_t* createIngressPSB(const traffic_session_t& session, const traffic_path_t& path);
@@ -226,6 +314,10 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
     virtual void scheduleCommitTimer(ResvStateBlock_t *rsbEle);
     virtual void scheduleTimeout(ResvStateBlock_t *rsbEle);
 
+    virtual void scheduleStateTimer(StateTimerRef& ref, StateTimerKind kind, int id, simtime_t delay);
+    virtual void cancelStateTimer(StateTimerRef& ref);
+    bool isStateTimerScheduled(const StateTimerRef& ref) const {return ref != stateTimers.end();}
+
     virtual void sendPathErrorMessage(PathStateBlock_t *psb, int errCode);
     virtual void sendPathErrorMessage(SessionObj_t session, SenderTemplateObj_t sender, SenderTspecObj_t tspec, IPAddress nextHop, int errCode);
     virtual void sendPathTearMessage(IPAddress peerIP, const SessionObj_t& session, const SenderTemplateObj_t& sender, IPAddress LIH, IPAddress NHOP, bool force);
@@ -242,6 +334,9 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
     virtual void announceLinkChange(int tedlinkindex);
 
     virtual void sendToIP(cMessage *msg, IPAddress destAddr);
+    virtual void sendRefresh(RSVPMessage *msg, IPAddress destAddr);
+    virtual void flushBundles();
+    virtual void dropPendingRefreshes(const SessionObj_t& session, const SenderTemplateObj_t *sender);
 
     virtual bool evalNextHopInterface(IPAddress destAddr, const EroVector& ERO, IPAddress& OI);
 
@@ -284,6 +379,7 @@ class INET_API RSVP : public cSimpleModule, public IScriptable
     virtual int numInitStages() const  {return 5;}
     virtual void initialize(int stage);
     virtual void handleMessage(cMessage *msg);
+    virtual void finish();
 
     // IScriptable implementation
     virtual void processCommand(const cXMLElement& node);
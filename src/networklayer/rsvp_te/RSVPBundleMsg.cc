@@ -0,0 +1,70 @@
+//
+// This library is free software, you can redistribute it
+// and/or modify
+// it under  the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation;
+// either version 2 of the License, or any later version.
+// The library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+
+
+#include "RSVPBundleMsg.h"
+
+Register_Class(RSVPBundleMsg);
+
+
+RSVPBundleMsg& RSVPBundleMsg::operator=(const RSVPBundleMsg& other)
+{
+    if (this == &other)
+        return *this;
+
+    while (!subMessages.empty())
+    {
+        RSVPMessage *msg = subMessages.front();
+        subMessages.pop_front();
+        dropAndDelete(msg);
+    }
+
+    RSVPBundleMsg_Base::operator=(other);
+
+    for (std::list<RSVPMessage*>::const_iterator i=other.subMessages.begin(); i!=other.subMessages.end(); ++i)
+    {
+        RSVPMessage *msg = (*i)->dup();
+        take(msg);
+        subMessages.push_back(msg);
+    }
+
+    return *this;
+}
+
+RSVPBundleMsg::~RSVPBundleMsg()
+{
+    while (!subMessages.empty())
+    {
+        RSVPMessage *msg = subMessages.front();
+        subMessages.pop_front();
+        dropAndDelete(msg);
+    }
+}
+
+void RSVPBundleMsg::addSubMessage(RSVPMessage *msg)
+{
+    take(msg);
+    subMessages.push_back(msg);
+    addByteLength(msg->getByteLength());
+}
+
+RSVPMessage *RSVPBundleMsg::removeFirstSubMessage()
+{
+    if (subMessages.empty())
+        return NULL;
+
+    RSVPMessage *msg = subMessages.front();
+    subMessages.pop_front();
+    drop(msg);
+    addByteLength(-msg->getByteLength());
+    return msg;
+}
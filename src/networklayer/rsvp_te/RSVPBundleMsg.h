@@ -0,0 +1,60 @@
+//
+// This library is free software, you can redistribute it
+// and/or modify
+// it under  the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation;
+// either version 2 of the License, or any later version.
+// The library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+
+#ifndef __INET_RSVPBUNDLEMSG_H
+#define __INET_RSVPBUNDLEMSG_H
+
+#include <list>
+
+#include "RSVPBundle_m.h"
+
+/**
+ * Length of the \RSVP common header that precedes the bundled messages
+ */
+#define RSVP_BUNDLE_HEADER_LENGTH   8
+
+/**
+ * RSVP Bundle message (RFC 2961)
+ *
+ * The bundled messages are owned by the bundle; its byte length is the
+ * header plus the lengths of the sub-messages.
+ */
+class RSVPBundleMsg : public RSVPBundleMsg_Base
+{
+  protected:
+    std::list<RSVPMessage*> subMessages;
+
+  public:
+    RSVPBundleMsg(const char *name=NULL, int kind=RSVP_TRAFFIC) : RSVPBundleMsg_Base(name,kind) {setByteLength(RSVP_BUNDLE_HEADER_LENGTH);}
+    RSVPBundleMsg(const RSVPBundleMsg& other) : RSVPBundleMsg_Base(other.getName()) {operator=(other);}
+    virtual ~RSVPBundleMsg();
+    RSVPBundleMsg& operator=(const RSVPBundleMsg& other);
+    virtual RSVPBundleMsg *dup() const {return new RSVPBundleMsg(*this);}
+
+    /**
+     * Returns the number of messages in this bundle
+     */
+    virtual unsigned int getNumSubMessages() const {return subMessages.size();}
+
+    /**
+     * Appends a message to the bundle and takes ownership of it
+     */
+    virtual void addSubMessage(RSVPMessage *msg);
+
+    /**
+     * Removes and returns the first message of the bundle, or NULL if the
+     * bundle is empty. Ownership passes to the caller.
+     */
+    virtual RSVPMessage *removeFirstSubMessage();
+};
+
+#endif
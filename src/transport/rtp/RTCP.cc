@@ -34,7 +34,6 @@ Define_Module(RTCP);
 
 RTCP::RTCP()
 {
-    _participantInfos = NULL;
 }
 
 void RTCP::initialize()
@@ -48,13 +47,12 @@ void RTCP::initialize()
 
     _packetsCalculated = 0;
     _averagePacketSize = 0.0;
-
-    _participantInfos = new cArray("ParticipantInfos");
 }
 
 RTCP::~RTCP()
 {
-    delete _participantInfos;
+    for (ParticipantInfoMap::iterator it = _participantInfos.begin(); it != _participantInfos.end(); it++)
+        delete it->second;
 }
 
 void RTCP::handleMessage(cMessage *msg)
@@ -227,7 +225,7 @@ void RTCP::createSocket()
 
 void RTCP::scheduleInterval(){
 
-    simtime_t intervalLength = _averagePacketSize * (simtime_t)(_participantInfos->size()) / (simtime_t)(_bandwidth * _rtcpPercentage * (_senderInfo->isSender() ? 1.0 : 0.75) / 100.0);
+    simtime_t intervalLength = _averagePacketSize * (simtime_t)(_participantInfos.size()) / (simtime_t)(_bandwidth * _rtcpPercentage * (_senderInfo->isSender() ? 1.0 : 0.75) / 100.0);
 
     // interval length must be at least 5 seconds
     if (intervalLength < 5.0)
@@ -254,7 +252,7 @@ void RTCP::chooseSSRC(){
     } while (ssrcConflict);
     ev << "chooseSSRC" << ssrc;
     _senderInfo->setSSRC(ssrc);
-    _participantInfos->add(_senderInfo);
+    _participantInfos[ssrc] = _senderInfo;
     _ssrcChosen = true;
 }
 
@@ -277,24 +275,25 @@ void RTCP::createPacket()
     reportPacket->setSSRC(_senderInfo->getSSRC());
 
 
-    // insert receiver reports for packets from other sources
-    for (int i = 0; i < _participantInfos->size(); i++) {
-
-        if (_participantInfos->exist(i)) {
-            RTPParticipantInfo *participantInfo = (RTPParticipantInfo *)(_participantInfos->get(i));
-            if (participantInfo->getSSRC() != _senderInfo->getSSRC()) {
-                ReceptionReport *report = ((RTPReceiverInfo *)participantInfo)->receptionReport(simTime());
-                if (report != NULL) {
-                    reportPacket->addReceptionReport(report);
-                }
+    // insert receiver reports for packets from other sources, and
+    // drop participants that timed out, in the same pass
+    for (ParticipantInfoMap::iterator it = _participantInfos.begin(); it != _participantInfos.end(); ) {
+        RTPParticipantInfo *participantInfo = it->second;
+        if (participantInfo->getSSRC() != _senderInfo->getSSRC()) {
+            ReceptionReport *report = ((RTPReceiverInfo *)participantInfo)->receptionReport(simTime());
+            if (report != NULL) {
+                reportPacket->addReceptionReport(report);
             }
-            participantInfo->nextInterval(simTime());
+        }
+        participantInfo->nextInterval(simTime());
 
-            if (participantInfo->toBeDeleted(simTime())) {
-                _participantInfos->remove(participantInfo);
-                delete participantInfo;
-                // perhaps inform the profile
-            }
+        if (participantInfo->toBeDeleted(simTime())) {
+            _participantInfos.erase(it++);
+            delete participantInfo;
+            // perhaps inform the profile
+        }
+        else {
+            it++;
         }
     }
     // insert source description items (at least common name)
@@ -350,7 +349,7 @@ void RTCP::processIncomingRTPPacket(RTPPacket *packet, IPAddress address, int po
         participantInfo = new RTPParticipantInfo(ssrc);
         participantInfo->setAddress(address);
         participantInfo->setRTPPort(port);
-        _participantInfos->add(participantInfo);
+        _participantInfos[ssrc] = participantInfo;
     }
     else {
         // check for ssrc conflict
@@ -389,7 +388,7 @@ void RTCP::processIncomingRTCPPacket(RTCPCompoundPacket *packet, IPAddress addre
                     participantInfo = new RTPReceiverInfo(ssrc);
                     participantInfo->setAddress(address);
                     participantInfo->setRTCPPort(port);
-                    _participantInfos->add(participantInfo);
+                    _participantInfos[ssrc] = participantInfo;
                 }
                 else {
                     if (participantInfo->getAddress() == address) {
@@ -431,7 +430,7 @@ void RTCP::processIncomingRTCPPacket(RTCPCompoundPacket *packet, IPAddress addre
                     participantInfo = new RTPReceiverInfo(ssrc);
                     participantInfo->setAddress(address);
                     participantInfo->setRTCPPort(port);
-                    _participantInfos->add(participantInfo);
+                    _participantInfos[ssrc] = participantInfo;
                 }
                 else {
                     if (participantInfo->getAddress() == address) {
@@ -481,7 +480,7 @@ void RTCP::processIncomingRTCPPacket(RTCPCompoundPacket *packet, IPAddress addre
                             participantInfo = new RTPReceiverInfo(ssrc);
                             participantInfo->setAddress(address);
                             participantInfo->setRTCPPort(port);
-                            _participantInfos->add(participantInfo);
+                            _participantInfos[ssrc] = participantInfo;
                         }
                         else {
                             // check for ssrc conflict
@@ -498,7 +497,7 @@ void RTCP::processIncomingRTCPPacket(RTCPCompoundPacket *packet, IPAddress addre
                 RTPParticipantInfo *participantInfo = findParticipantInfo(ssrc);
 
                 if (participantInfo != NULL && participantInfo != _senderInfo) {
-                    _participantInfos->remove(participantInfo);
+                    _participantInfos.erase(ssrc);
 
                     delete participantInfo;
                     // perhaps it would be useful to inform
@@ -518,14 +517,8 @@ void RTCP::processIncomingRTCPPacket(RTCPCompoundPacket *packet, IPAddress addre
 
 RTPParticipantInfo *RTCP::findParticipantInfo(uint32 ssrc)
 {
-    char *ssrcString = RTPParticipantInfo::ssrcToName(ssrc);
-    int participantIndex = _participantInfos->find(ssrcString);
-    if (participantIndex != -1) {
-        return (RTPParticipantInfo *)(_participantInfos->get(participantIndex));
-    }
-    else {
-        return NULL;
-    }
+    ParticipantInfoMap::iterator it = _participantInfos.find(ssrc);
+    return it != _participantInfos.end() ? it->second : NULL;
 }
 
 
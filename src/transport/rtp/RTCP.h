@@ -22,6 +22,7 @@
 #ifndef __INET_RTCPENDSYSTEMMODULE_H
 #define __INET_RTCPENDSYSTEMMODULE_H
 
+#include <map>
 #include "INETDefs.h"
 #include "IPAddress.h"
 #include "RTPInnerPacket.h"
@@ -149,9 +150,10 @@ class INET_API RTCP : public cSimpleModule
 
         /**
          * Information about all known rtp end system participating in
-         * this rtp session.
+         * this rtp session, keyed by ssrc.
          */
-        cArray *_participantInfos;
+        typedef std::map<uint32, RTPParticipantInfo *> ParticipantInfoMap;
+        ParticipantInfoMap _participantInfos;
 
         /**
          * The server socket for receiving rtcp packets.
@@ -31,7 +31,6 @@ Define_Module(RTPProfile);
 
 RTPProfile::RTPProfile()
 {
-    _ssrcGates = NULL;
 }
 
 void RTPProfile::initialize()
@@ -43,14 +42,14 @@ void RTPProfile::initialize()
 
     // how many gates to payload receivers do we have
     _maxReceivers = gateSize("payloadReceiverOut");
-    _ssrcGates = new cArray("SSRCGates");
     _autoOutputFileNames = par("autoOutputFileNames").boolValue();
     ev << "initialize() Exit"<<endl;
 }
 
 RTPProfile::~RTPProfile()
 {
-    delete _ssrcGates;
+    for (SSRCGateMap::iterator it = _ssrcGates.begin(); it != _ssrcGates.end(); it++)
+        delete it->second;
 }
 
 
@@ -278,15 +277,8 @@ void RTPProfile::processOutgoingPacket(RTPInnerPacket *rinp)
 
 RTPProfile::SSRCGate *RTPProfile::findSSRCGate(uint32 ssrc)
 {
-    const char *name = RTPParticipantInfo::ssrcToName(ssrc);
-    int objectIndex = _ssrcGates->find(name);
-    if (objectIndex == -1) {
-        return NULL;
-    }
-    else {
-        cObject *co = (_ssrcGates->get(objectIndex));
-        return (SSRCGate *)co;
-    }
+    SSRCGateMap::iterator it = _ssrcGates.find(ssrc);
+    return it != _ssrcGates.end() ? it->second : NULL;
 }
 
 
@@ -302,10 +294,12 @@ RTPProfile::SSRCGate *RTPProfile::newSSRCGate(uint32 ssrc)
         }
     }
 
-    if (!assigned)
+    if (!assigned) {
+        delete ssrcGate;
         opp_error("Can't manage more senders");
+    }
 
-    _ssrcGates->add(ssrcGate);
+    _ssrcGates[ssrc] = ssrcGate;
     return ssrcGate;
 }
 
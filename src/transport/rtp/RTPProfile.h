@@ -22,6 +22,7 @@
 #ifndef __INET_RTPPROFILE_H
 #define __INET_RTPPROFILE_H
 
+#include <map>
 #include "INETDefs.h"
 #include "RTPInnerPacket.h"
 
@@ -44,7 +45,7 @@ class INET_API RTPProfile : public cSimpleModule
         // and the gate which leads to the RTPPayloadReceiver module.
         // Note: in the original, this used to be a hundred lines, as RTPSSRCGate.cc/h,
         // but even this class is an overkill --Andras
-        class SSRCGate : public cNamedObject  //FIXME why is it a namedObject?
+        class SSRCGate
         {
           protected:
             uint32 ssrc;
@@ -187,7 +188,8 @@ class INET_API RTPProfile : public cSimpleModule
          * Stores information to which gate rtp data packets
          * from a ssrc must be forwarded.
          */
-        cArray *_ssrcGates;
+        typedef std::map<uint32, SSRCGate *> SSRCGateMap;
+        SSRCGateMap _ssrcGates;
 
         /**
          * The percentage of the available bandwidth to be used for rtcp.
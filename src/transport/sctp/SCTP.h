@@ -25,6 +25,7 @@
 
 #include <omnetpp.h>
 #include <map>
+#include "INETDefs.h"
 #include "IPvXAddress.h"
 #include "UDPSocket.h"
 
@@ -33,7 +34,8 @@ class SCTPAssociation;
 class SCTPMessage;
 
 
-#define sctpEV3 (!SCTP::testing==true)?std::cerr:std::cerr
+// verbose debug output; always goes to stderr (compile out with INET_LOGLEVEL < INET_LOGLEVEL_DEBUG)
+#define sctpEV3 INET_LOG_IF(INET_LOGLEVEL_DEBUG, std::cerr, true)
 
 
 
@@ -30,6 +30,7 @@
 #include "SCTPQueue.h"
 #include "SCTPSendStream.h"
 #include "SCTPReceiveStream.h"
+#include "SCTPGapList.h"
 #include "SCTPMessage.h"
 #include "IPControlInfo.h"
 #include <list>
@@ -181,7 +182,6 @@ enum SCTPStreamSchedulers
 
 #define SCTP_MAX_PAYLOAD                1488 // 12 bytes for common header
 
-#define MAX_GAP_COUNT                   500
 #define MAX_GAP_REPORTS                 4
 #define ADD_PADDING(x)                  ((((x) + 3) >> 2) << 2)
 
@@ -427,9 +427,7 @@ class INET_API SCTPStateVariables : public cPolymorphic
         uint32                      lastTsnReceived;          // SACK
         uint32                      lastTSN;                  // my very last TSN to be sent
         uint32                      ackState;                 // number of packets to be acknowledged
-        uint32                      numGaps;
-        uint32                      gapStartList[MAX_GAP_COUNT];
-        uint32                      gapStopList[MAX_GAP_COUNT];
+        SCTPGapList                 gapList;                  // TSN blocks received above cTsnAck
         uint64                      outstandingBytes;     // Number of bytes outstanding
         uint64                      queuedReceivedBytes;  // Number of bytes in receiver queue
         uint32                      lastStreamScheduled;
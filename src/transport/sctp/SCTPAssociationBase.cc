@@ -239,7 +239,6 @@ SCTPStateVariables::SCTPStateVariables()
     outstandingBytes          = 0;
     messagesToPush            = 0;
     pushMessagesLeft          = 0;
-    numGaps                   = 0;
     msgNum                    = 0;
     bytesRcvd                 = 0;
     sendBuffer                = 0;
@@ -253,10 +252,6 @@ SCTPStateVariables::SCTPStateVariables()
     for (unsigned int i = 0; i < 65536; i++) {
         numMsgsReq[i] = 0;
     }
-    for (unsigned int i = 0; i < MAX_GAP_COUNT; i++) {
-        gapStartList[i] = 0;
-        gapStopList[i]   = 0;
-    }
     for (unsigned int i = 0; i < 32; i++) {
         localTieTag[i] = 0;
         peerTieTag[i]   = 0;
@@ -407,7 +402,7 @@ bool SCTPAssociation::processTimer(cMessage *msg)
     }
     else if (msg==SackTimer)
     {
-    sctpEV3<<simulation.getSimTime()<<" delayed Sack: cTsnAck="<<state->cTsnAck<<" highestTsnReceived="<<state->highestTsnReceived<<" lastTsnReceived="<<state->lastTsnReceived<<" ackState="<<state->ackState<<" numGaps="<<state->numGaps<<"\n";
+    sctpEV3<<simulation.getSimTime()<<" delayed Sack: cTsnAck="<<state->cTsnAck<<" highestTsnReceived="<<state->highestTsnReceived<<" lastTsnReceived="<<state->lastTsnReceived<<" ackState="<<state->ackState<<" numGaps="<<state->gapList.getNumGaps()<<"\n";
         sendSack();
     }
     else if (msg==T2_ShutdownTimer)
@@ -1262,11 +1262,11 @@ SCTPEventCode SCTPAssociation::processDataArrived(SCTPDataChunk* dataChunk)
     SCTP::AssocStatMap::iterator iter=sctpMain->assocStatMap.find(assocId);
     iter->second.rcvdBytes+=dataChunk->getBitLength()/8-SCTP_DATA_CHUNK_LENGTH;
 
-    if (state->numGaps == 0) {
+    if (state->gapList.empty()) {
         state->highestTsnReceived = state->cTsnAck;
     }
     else {
-        state->highestTsnReceived = state->gapStopList[state->numGaps-1];
+        state->highestTsnReceived = state->gapList.getHighestTsn();
     }
     if (state->stopReceiving) {
         return SCTP_E_IGNORE;
@@ -174,7 +174,7 @@ SCTPPathVariables* SCTPAssociation::choosePathForRetransmission()
 void SCTPAssociation::timeForSack(bool& sackOnly, bool& sackWithData)
 {
     sackOnly = sackWithData = false;
-        if (((state->numGaps > 0) || (state->dupList.size() > 0)) &&
+        if (((!state->gapList.empty()) || (state->dupList.size() > 0)) &&
              (state->sackAllowed)) {
         // Schedule sending of SACKs at once, when we have fragments to report
         state->ackState = sackFrequency;
@@ -908,7 +908,7 @@ SCTPSackChunk* SCTPAssociation::createSack()
     sackChunk->setChunkType(SACK);
     sackChunk->setCumTsnAck(state->cTsnAck);
     sackChunk->setA_rwnd(arwnd);
-    uint32 numGaps=state->numGaps;
+    uint32 numGaps=state->gapList.getNumGaps();
     uint32 numDups=state->dupList.size();
     uint16 sackLength=SCTP_SACK_CHUNK_LENGTH + numGaps*4 + numDups*4;
     uint32 mtu = getPath(remoteAddr)->pmtu;
@@ -938,15 +938,16 @@ SCTPSackChunk* SCTPAssociation::createSack()
         sackChunk->setGapStopArraySize(numGaps);
 
         uint32 last = state->cTsnAck;
-        for (key=0; key<numGaps; key++)
+        SCTPGapList::const_iterator gap = state->gapList.begin();
+        for (key=0; key<numGaps; key++, gap++)
         {
             // ====== Validity check ===========================================
-            assert(tsnGt(state->gapStartList[key], last + 1));
-            assert(tsnGe(state->gapStopList[key], state->gapStartList[key]));
-            last = state->gapStopList[key];
+            assert(tsnGt(gap->first, last + 1));
+            assert(tsnGe(gap->second, gap->first));
+            last = gap->second;
 
-            sackChunk->setGapStart(key, state->gapStartList[key]);
-            sackChunk->setGapStop(key, state->gapStopList[key]);
+            sackChunk->setGapStart(key, gap->first);
+            sackChunk->setGapStop(key, gap->second);
         }
     }
     if (numDups > 0)
@@ -1281,83 +1282,33 @@ bool SCTPAssociation::tsnIsDuplicate(const uint32 tsn) const
         if ((*iterator) == tsn)
             return true;
     }
-    for (uint32 i=0; i < state->numGaps; i++) {
-        if (tsnBetween(state->gapStartList[i], tsn, state->gapStopList[i])) {
-            return true;
-        }
-    }
-    return false;
+    return state->gapList.contains(tsn);
 }
 
 void SCTPAssociation::removeFromGapList(uint32 removedTsn)
 {
-    int32 gapsize, numgaps;
-
-    numgaps = state->numGaps;
-    sctpEV3<<"remove TSN "<<removedTsn<<" from GapList. "<<numgaps<<" gaps present, cumTsnAck="<<state->cTsnAck<<"\n";
-    for (int32 j=0; j<numgaps; j++)
-        sctpEV3<<state->gapStartList[j]<<" - "<<state->gapStopList[j]<<"\n";
-    for (int32 i=numgaps-1; i>=0; i--)
+    sctpEV3<<"remove TSN "<<removedTsn<<" from GapList. "<<state->gapList.getNumGaps()<<" gaps present, cumTsnAck="<<state->cTsnAck<<"\n";
+    const bool hadGaps = !state->gapList.empty();
+    state->gapList.remove(removedTsn);
+    if (state->gapList.empty())
     {
-        sctpEV3<<"gapStartList["<<i<<"]="<<state->gapStartList[i]<<", state->gapStopList["<<i<<"]="<<state->gapStopList[i]<<"\n";
-        if (tsnBetween(state->gapStartList[i], removedTsn, state->gapStopList[i]))
+        if (hadGaps && removedTsn == state->lastTsnAck+1)
         {
-            gapsize = (int32)(state->gapStopList[i] - state->gapStartList[i]+1);
-            if (gapsize>1)
-            {
-                if (state->gapStopList[i]==removedTsn)
-                {
-                    state->gapStopList[i]--;
-                }
-                else if (state->gapStartList[i]==removedTsn)
-                {
-                    state->gapStartList[i]++;
-                }
-                else //gap is split in two
-                {
-                    for (int32 j=numgaps-1; j>=i; j--)
-                    {
-                        state->gapStopList[j+1] = state->gapStopList[j];
-                        state->gapStartList[j+1] = state->gapStartList[j];
-                    }
-                    state->gapStopList[i] = removedTsn-1;
-                    state->gapStartList[i+1] = removedTsn+1;
-                    state->numGaps = min(state->numGaps + 1, MAX_GAP_COUNT);      // T.D. 18.12.09: Enforce upper limit!
-                }
-            }
-            else
-            {
-                for (int32 j=i; j<=numgaps-1; j++)
-                {
-                    state->gapStopList[j] = state->gapStopList[j+1];
-                    state->gapStartList[j] = state->gapStartList[j+1];
-                }
-                state->gapStartList[numgaps-1]=0;
-                state->gapStopList[numgaps-1]=0;
-                state->numGaps--;
-                if (state->numGaps == 0)
-                {
-                    if (removedTsn == state->lastTsnAck+1)
-                    {
-                        state->lastTsnAck = removedTsn;
-                    }
-                }
-            }
+            state->lastTsnAck = removedTsn;
         }
+        state->highestTsnReceived = state->cTsnAck;
     }
-    if (state->numGaps>0)
-        state->highestTsnReceived = state->gapStopList[state->numGaps-1];
     else
-        state->highestTsnReceived = state->cTsnAck;
+        state->highestTsnReceived = state->gapList.getHighestTsn();
 }
 
 bool SCTPAssociation::updateGapList(const uint32 receivedTsn)
 {
     sctpEV3 << "Entering updateGapList (tsn=" << receivedTsn
               << " cTsnAck=" <<state->cTsnAck << " Number of Gaps="
-              << state->numGaps << endl;
+              << state->gapList.getNumGaps() << endl;
 
-    uint32 lo = state->cTsnAck + 1;
+    const uint32 lo = state->cTsnAck + 1;
     if ((int32)(state->localRwnd-state->queuedReceivedBytes) <= 0)
     {
         sctpEV3 << "Window full" << endl;
@@ -1373,152 +1324,20 @@ bool SCTPAssociation::updateGapList(const uint32 receivedTsn)
         state->highestTsnStored = receivedTsn;
     }
 
-    for (uint32 i = 0; i<state->numGaps; i++) {
-        if (state->gapStartList[i] > 0) {
-            const uint32 hi = state->gapStartList[i] - 1;
-            if (tsnBetween(lo, receivedTsn, hi)) {
-                const uint32 gapsize = hi - lo + 1;
-                if (gapsize > 1) {
-                    /**
-                    * TSN either sits at the end of one gap, and thus changes gap
-                    * boundaries, or it is in between two gaps, and becomes a new gap
-                    */
-                    if (receivedTsn == hi) {
-                        state->gapStartList[i] = receivedTsn;
-                        state->newChunkReceived = true;
-                        return true;
-                    }
-                    else if (receivedTsn == lo) {
-                        if (receivedTsn == (state->cTsnAck + 1)) {
-                            state->cTsnAck++;
-                            state->newChunkReceived = true;
-                            return true;
-                        }
-                        /* some gap must increase its upper bound */
-                        state->gapStopList[i-1] = receivedTsn;
-                        state->newChunkReceived = true;
-                        return true;
-                    }
-                    else {  /* a gap in between */
-                        state->numGaps = min(state->numGaps + 1, MAX_GAP_COUNT);      // T.D. 18.12.09: Enforce upper limit!
-
-                        for (uint32 j = state->numGaps - 1; j > i; j--) {    // T.D. 18.12.09: Fixed invalid start value.
-                            state->gapStartList[j] = state->gapStartList[j-1];
-                            state->gapStopList[j] = state->gapStopList[j-1];
-                        }
-                        state->gapStartList[i]=receivedTsn;
-                        state->gapStopList[i]=receivedTsn;
-                        state->newChunkReceived = true;
-                        return true;
-                    }
-                }
-                else {  /* alright: gapsize is 1: our received tsn may close gap between fragments */
-                    if (lo == state->cTsnAck + 1) {
-                        state->cTsnAck = state->gapStopList[i];
-                        if (i == state->numGaps-1) {
-                            state->gapStartList[i] = 0;
-                            state->gapStopList[i] = 0;
-                        }
-                        else {
-                            for (uint32 j = i; j < state->numGaps - 1; j++) {        // T.D. 18.12.09: Fixed invalid end value.
-                                state->gapStartList[j] = state->gapStartList[j + 1];
-                                state->gapStopList[j]  = state->gapStopList[j + 1];
-                            }
-                        }
-                        state->numGaps--;
-                        state->newChunkReceived = true;
-                        return true;
-                    }
-                    else {
-                        state->gapStopList[i-1] = state->gapStopList[i];
-                        if (i == state->numGaps-1) {
-                            state->gapStartList[i] = 0;
-                            state->gapStopList[i] = 0;
-                        }
-                        else {
-                            for (uint32 j = i; j < state->numGaps - 1; j++) {        // T.D. 18.12.09: Fixed invalid end value.
-                                state->gapStartList[j] = state->gapStartList[j + 1];
-                                state->gapStopList[j]  = state->gapStopList[j + 1];
-                            }
-                        }
-                        state->numGaps--;
-                        state->newChunkReceived = true;
-                        return true;
-                    }
-                }
-            }
-            else {  /* receivedTsn is not in the gap between these fragments... */
-                lo = state->gapStopList[i] + 1;
-            }
-        } /* end: for */
-    }/* end: for */
-
-    /* (NULL LIST)   OR  (End of Gap List passed) */
-    if (receivedTsn == lo) {    // just increase ctsna, handle further update of ctsna later
-        if (receivedTsn == state->cTsnAck + 1) {
-            state->cTsnAck              = receivedTsn;
-            state->newChunkReceived = true;
-            return true;
-        }
-        /* Update last fragment....increase stop_tsn by one */
-        state->gapStopList[state->numGaps-1]++;
-
+    if (state->gapList.insert(receivedTsn, state->cTsnAck)) {
         state->newChunkReceived = true;
-        return true;
-
     }
-    else {  // A new fragment altogether, past the end of the list
-        if(state->numGaps + 1 <= MAX_GAP_COUNT) {     // T.D. 18.12.09: Enforce upper limit!
-            state->gapStartList[state->numGaps] = receivedTsn;
-            state->gapStopList[state->numGaps]  = receivedTsn;
-            state->numGaps++;
-            state->newChunkReceived = true;
-        }
-        return true;
-    }
-
-    return false;
+    return true;
 }
 
 bool SCTPAssociation::advanceCtsna()
 {
-    int32 listLength, counter;
-
-    ev<<"Entering advanceCtsna(ctsna now =="<< state->cTsnAck<<"\n";;
-
-    listLength = state->numGaps;
+    ev<<"Entering advanceCtsna(ctsna now =="<< state->cTsnAck<<"\n";
 
-    /* if there are no fragments, we cannot advance the ctsna */
-    if (listLength == 0) return false;
-    counter = 0;
-
-    while(counter < listLength)
-    {
-        /* if we take out a fragment here, we need to modify either counter or list_length */
-
-        if (state->cTsnAck + 1 == state->gapStartList[0])
-        {
-            /* BINGO ! */
-            state->cTsnAck = state->gapStopList[0];
-            /* we can take out a maximum of list_length fragments */
-            counter++;
-            for (uint32 i=1; i<state->numGaps; i++)
-            {
-                state->gapStartList[i-1] = state->gapStartList[i];
-                state->gapStopList[i-1] = state->gapStopList[i];
-            }
-
-        }
-        else
-        {
-            ev<<"Entering advanceCtsna(when leaving: ctsna=="<<state->cTsnAck<<"\n";
-            return false;
-        }
-
-    }    /* end while */
+    const bool advanced = state->gapList.advance(state->cTsnAck);
 
     ev<<"Entering advanceCtsna(when leaving: ctsna=="<< state->cTsnAck<<"\n";
-    return true;
+    return advanced;
 }
 
 SCTPDataVariables* SCTPAssociation::makeVarFromMsg(SCTPDataChunk* dataChunk)
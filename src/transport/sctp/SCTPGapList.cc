@@ -0,0 +1,115 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "SCTPGapList.h"
+
+
+bool SCTPGapList::contains(const uint32 tsn) const
+{
+    // first block starting above tsn; the candidate is the one before it
+    BlockMap::const_iterator it = blocks.upper_bound(tsn);
+    if (it == blocks.begin())
+        return false;
+    --it;
+    return ((int32)(tsn - it->second) <= 0);
+}
+
+bool SCTPGapList::insert(const uint32 tsn, uint32& cumTsnAck)
+{
+    if ((int32)(tsn - cumTsnAck) <= 0)
+        return false;
+
+    if (tsn == cumTsnAck + 1) {
+        cumTsnAck = tsn;
+        advance(cumTsnAck);
+        return true;
+    }
+
+    BlockMap::iterator next = blocks.upper_bound(tsn);
+    BlockMap::iterator prev = blocks.end();
+    if (next != blocks.begin()) {
+        prev = next;
+        --prev;
+        if ((int32)(tsn - prev->second) <= 0)
+            return false;   // already covered
+    }
+
+    const bool joinPrev = (prev != blocks.end() && prev->second + 1 == tsn);
+    const bool joinNext = (next != blocks.end() && next->first == tsn + 1);
+
+    if (joinPrev && joinNext) {
+        prev->second = next->second;
+        blocks.erase(next);
+    }
+    else if (joinPrev) {
+        prev->second = tsn;
+    }
+    else if (joinNext) {
+        const uint32 stop = next->second;
+        blocks.erase(next++);
+        blocks.insert(next, std::make_pair(tsn, stop));
+    }
+    else {
+        blocks.insert(next, std::make_pair(tsn, tsn));
+    }
+    return true;
+}
+
+void SCTPGapList::remove(const uint32 tsn)
+{
+    BlockMap::iterator it = blocks.upper_bound(tsn);
+    if (it == blocks.begin())
+        return;
+    --it;
+    const uint32 start = it->first;
+    const uint32 stop = it->second;
+    if ((int32)(tsn - stop) > 0)
+        return;
+
+    if (start == stop) {
+        blocks.erase(it);
+    }
+    else if (tsn == stop) {
+        it->second = stop - 1;
+    }
+    else if (tsn == start) {
+        BlockMap::iterator next = it;
+        ++next;
+        blocks.erase(it);
+        blocks.insert(next, std::make_pair(start + 1, stop));
+    }
+    else {  // block is split in two
+        it->second = tsn - 1;
+        BlockMap::iterator next = it;
+        ++next;
+        blocks.insert(next, std::make_pair(tsn + 1, stop));
+    }
+}
+
+bool SCTPGapList::advance(uint32& cumTsnAck)
+{
+    bool changed = false;
+    // blocks are non-adjacent, so at most one of them can start at cumTsnAck+1;
+    // stale blocks at or below cumTsnAck are dropped on the way
+    while (!blocks.empty() && (int32)(blocks.begin()->first - (cumTsnAck + 1)) <= 0) {
+        BlockMap::iterator first = blocks.begin();
+        if ((int32)(first->second - cumTsnAck) > 0) {
+            cumTsnAck = first->second;
+            changed = true;
+        }
+        blocks.erase(first);
+    }
+    return changed;
+}
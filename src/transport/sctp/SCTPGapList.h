@@ -0,0 +1,84 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __SCTPGAPLIST_H
+#define __SCTPGAPLIST_H
+
+#include <map>
+#include <omnetpp.h>
+#include "INETDefs.h"
+
+
+/**
+ * Set of TSN intervals received above the cumulative TSN ack, i.e. the
+ * gap ack blocks reported in a SACK. Blocks are kept disjoint and
+ * non-adjacent in a map ordered by serial number arithmetic (RFC 1982),
+ * so inserting or removing a TSN costs O(log n) and there is no upper
+ * limit on the number of blocks.
+ */
+class INET_API SCTPGapList
+{
+  protected:
+    struct TsnLess
+    {
+        bool operator()(const uint32 tsn1, const uint32 tsn2) const {
+            return ((int32)(tsn1 - tsn2) < 0);
+        }
+    };
+
+  public:
+    /** Start TSN -> stop TSN (both inclusive) */
+    typedef std::map<uint32, uint32, TsnLess> BlockMap;
+    typedef BlockMap::const_iterator const_iterator;
+
+  protected:
+    BlockMap blocks;
+
+  public:
+    SCTPGapList() {}
+
+    /** Number of gap ack blocks */
+    inline uint32 getNumGaps() const {return blocks.size();}
+    inline bool empty() const {return blocks.empty();}
+    inline void clear() {blocks.clear();}
+
+    /** Blocks in ascending TSN order, e.g. for filling a SACK chunk */
+    inline const_iterator begin() const {return blocks.begin();}
+    inline const_iterator end() const {return blocks.end();}
+
+    /** Highest TSN covered by a block; only valid if the list is not empty */
+    inline uint32 getHighestTsn() const {return blocks.rbegin()->second;}
+
+    /** Returns true if the TSN is covered by one of the blocks */
+    bool contains(const uint32 tsn) const;
+
+    /**
+     * Adds a TSN above cumTsnAck. If it (or a block it merges into) becomes
+     * contiguous with cumTsnAck, cumTsnAck is advanced and the block dropped.
+     * Returns false if the TSN was already present.
+     */
+    bool insert(const uint32 tsn, uint32& cumTsnAck);
+
+    /** Removes a TSN, shrinking or splitting its block (used when reneging) */
+    void remove(const uint32 tsn);
+
+    /**
+     * Advances cumTsnAck over a block starting at cumTsnAck+1, if any.
+     * Returns true if cumTsnAck was changed.
+     */
+    bool advance(uint32& cumTsnAck);
+};
+
+#endif
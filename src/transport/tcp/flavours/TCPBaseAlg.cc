@@ -96,6 +96,8 @@ TCPBaseAlg::TCPBaseAlg() : TCPAlgorithm(),
   state((TCPBaseAlgStateVariables *&)TCPAlgorithm::state)
 {
     rexmitTimer = persistTimer = delayedAckTimer = keepAliveTimer = NULL;
+    lazyTimers = false;
+    rexmitDeadline = persistDeadline = delayedAckDeadline = -1;
     cwndVector = ssthreshVector = rttVector = srttVector = rttvarVector = rtoVector = numRtosVector = NULL;
 }
 
@@ -133,6 +135,8 @@ void TCPBaseAlg::initialize()
     delayedAckTimer->setContextPointer(conn);
     keepAliveTimer->setContextPointer(conn);
 
+    lazyTimers = conn->getTcpMain()->par("lazyTimers");
+
     if (conn->getTcpMain()->recordStatistics)
     {
         cwndVector = new cOutVector("cwnd");
@@ -208,16 +212,68 @@ void TCPBaseAlg::connectionClosed()
     cancelEvent(persistTimer);
     cancelEvent(delayedAckTimer);
     cancelEvent(keepAliveTimer);
+    rexmitDeadline = persistDeadline = delayedAckDeadline = -1;
+}
+
+void TCPBaseAlg::startTimer(cMessage *timer, simtime_t& deadline, simtime_t timeout)
+{
+    deadline = simTime() + timeout;
+
+    if (timer->isScheduled())
+    {
+        // in lazy mode, a message that arrives early is simply re-armed
+        if (lazyTimers && timer->getArrivalTime() <= deadline)
+            return;
+        cancelEvent(timer);
+    }
+    conn->getTcpMain()->scheduleAt(deadline, timer);
+}
+
+void TCPBaseAlg::stopTimer(cMessage *timer, simtime_t& deadline)
+{
+    deadline = -1;
+
+    // in lazy mode, the message stays in the FES and is ignored when it arrives
+    if (!lazyTimers)
+        cancelEvent(timer);
+}
+
+bool TCPBaseAlg::timerExpired(cMessage *timer, simtime_t& deadline)
+{
+    if (!isTimerRunning(deadline))
+    {
+        tcpEV << timer->getName() << " timer was stopped, ignoring\n";
+        return false;
+    }
+
+    if (deadline > simTime())
+    {
+        tcpEV << timer->getName() << " timer was restarted, rescheduling to " << deadline << "\n";
+        conn->getTcpMain()->scheduleAt(deadline, timer);
+        return false;
+    }
+
+    deadline = -1;
+    return true;
 }
 
 void TCPBaseAlg::processTimer(cMessage *timer, TCPEventCode& event)
 {
     if (timer==rexmitTimer)
-        processRexmitTimer(event);
+    {
+        if (timerExpired(timer, rexmitDeadline))
+            processRexmitTimer(event);
+    }
     else if (timer==persistTimer)
-        processPersistTimer(event);
+    {
+        if (timerExpired(timer, persistDeadline))
+            processPersistTimer(event);
+    }
     else if (timer==delayedAckTimer)
-        processDelayedAckTimer(event);
+    {
+        if (timerExpired(timer, delayedAckDeadline))
+            processDelayedAckTimer(event);
+    }
     else if (timer==keepAliveTimer)
         processKeepAliveTimer(event);
     else
@@ -260,7 +316,7 @@ void TCPBaseAlg::processRexmitTimer(TCPEventCode& event)
     state->rexmit_timeout += state->rexmit_timeout;
     if (state->rexmit_timeout > MAX_REXMIT_TIMEOUT)
         state->rexmit_timeout = MAX_REXMIT_TIMEOUT;
-    conn->scheduleTimeout(rexmitTimer, state->rexmit_timeout);
+    startTimer(rexmitTimer, rexmitDeadline, state->rexmit_timeout);
 
     tcpEV << " to " << state->rexmit_timeout << "s, and cancelling RTT measurement\n";
 
@@ -322,7 +378,7 @@ void TCPBaseAlg::processPersistTimer(TCPEventCode& event)
         state->rexmit_timeout = MIN_PERSIST_TIMEOUT;
     if (state->persist_timeout > MAX_PERSIST_TIMEOUT)
         state->rexmit_timeout = MAX_PERSIST_TIMEOUT;
-    conn->scheduleTimeout(persistTimer, state->persist_timeout);
+    startTimer(persistTimer, persistDeadline, state->persist_timeout);
 
     // sending persist probe
     conn->sendProbe();
@@ -357,7 +413,7 @@ void TCPBaseAlg::startRexmitTimer()
     state->rexmit_count = 0;
 
     // schedule timer
-    conn->scheduleTimeout(rexmitTimer, state->rexmit_timeout);
+    startTimer(rexmitTimer, rexmitDeadline, state->rexmit_timeout);
 }
 
 void TCPBaseAlg::rttMeasurementComplete(simtime_t tSent, simtime_t tAcked)
@@ -474,7 +530,7 @@ void TCPBaseAlg::receivedOutOfOrderSegment()
 void TCPBaseAlg::receiveSeqChanged()
 {
     // If we send a data segment already (with the updated seqNo) there is no need to send an additional ACK
-    if (state->full_sized_segment_counter == 0 && !state->ack_now && state->last_ack_sent == state->rcv_nxt && !delayedAckTimer->isScheduled()) // ackSent?
+    if (state->full_sized_segment_counter == 0 && !state->ack_now && state->last_ack_sent == state->rcv_nxt && !isTimerRunning(delayedAckDeadline)) // ackSent?
     {
         // tcpEV << "ACK has already been sent (possibly piggybacked on data)\n";
     }
@@ -510,8 +566,8 @@ void TCPBaseAlg::receiveSeqChanged()
             else
             {
                 tcpEV << "rcv_nxt changed to " << state->rcv_nxt << ", (delayed ACK enabled and full_sized_segment_counter=" << state->full_sized_segment_counter << ") scheduling ACK\n";
-                if (!delayedAckTimer->isScheduled()) // schedule delayed ACK timer if not already running
-                    conn->scheduleTimeout(delayedAckTimer, DELAYED_ACK_TIMEOUT);
+                if (!isTimerRunning(delayedAckDeadline)) // schedule delayed ACK timer if not already running
+                    startTimer(delayedAckTimer, delayedAckDeadline, DELAYED_ACK_TIMEOUT);
             }
         }
     }
@@ -542,10 +598,10 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     //
     if (state->snd_una==state->snd_max)
     {
-        if (rexmitTimer->isScheduled())
+        if (isTimerRunning(rexmitDeadline))
         {
             tcpEV << "ACK acks all outstanding segments, cancel REXMIT timer\n";
-            cancelEvent(rexmitTimer);
+            stopTimer(rexmitTimer, rexmitDeadline);
         }
         else
             tcpEV << "There were no outstanding segments, nothing new in this ACK.\n";
@@ -555,7 +611,6 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
         tcpEV << "ACK acks some but not all outstanding segments ("
               << (state->snd_max - state->snd_una) << " bytes outstanding), "
               << "restarting REXMIT timer\n";
-        cancelEvent(rexmitTimer);
         startRexmitTimer();
     }
 
@@ -570,12 +625,12 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     //
     if (state->snd_wnd==0) // received zero-sized window?
     {
-        if (rexmitTimer->isScheduled())
+        if (isTimerRunning(rexmitDeadline))
         {
-            if (persistTimer->isScheduled())
+            if (isTimerRunning(persistDeadline))
             {
                 tcpEV << "Received zero-sized window and REXMIT timer is running therefore PERSIST timer is canceled.\n";
-                cancelEvent(persistTimer);
+                stopTimer(persistTimer, persistDeadline);
                 state->persist_factor = 0;
             }
             else
@@ -583,10 +638,10 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
         }
         else
         {
-            if (!persistTimer->isScheduled())
+            if (!isTimerRunning(persistDeadline))
             {
                 tcpEV << "Received zero-sized window therefore PERSIST timer is started.\n";
-                conn->scheduleTimeout(persistTimer, state->persist_timeout);
+                startTimer(persistTimer, persistDeadline, state->persist_timeout);
             }
             else
                 tcpEV << "Received zero-sized window and PERSIST timer is already running.\n";
@@ -594,10 +649,10 @@ void TCPBaseAlg::receivedDataAck(uint32 firstSeqAcked)
     }
     else // received non zero-sized window?
     {
-        if (persistTimer->isScheduled())
+        if (isTimerRunning(persistDeadline))
         {
             tcpEV << "Received non zero-sized window therefore PERSIST timer is canceled.\n";
-            cancelEvent(persistTimer);
+            stopTimer(persistTimer, persistDeadline);
             state->persist_factor = 0;
         }
     }
@@ -645,14 +700,14 @@ void TCPBaseAlg::ackSent()
     state->ack_now = false; // reset flag
     state->last_ack_sent = state->rcv_nxt; // update last_ack_sent, needed for TS option
     // if delayed ACK timer is running, cancel it
-    if (delayedAckTimer->isScheduled())
-        cancelEvent(delayedAckTimer);
+    if (isTimerRunning(delayedAckDeadline))
+        stopTimer(delayedAckTimer, delayedAckDeadline);
 }
 
 void TCPBaseAlg::dataSent(uint32 fromseq)
 {
     // if retransmission timer not running, schedule it
-    if (!rexmitTimer->isScheduled())
+    if (!isTimerRunning(rexmitDeadline))
     {
         tcpEV << "Starting REXMIT timer\n";
         startRexmitTimer();
@@ -675,7 +730,5 @@ void TCPBaseAlg::dataSent(uint32 fromseq)
 
 void TCPBaseAlg::restartRexmitTimer()
 {
-    if (rexmitTimer->isScheduled())
-        cancelEvent(rexmitTimer);
     startRexmitTimer();
 }
@@ -90,6 +90,14 @@ class INET_API TCPBaseAlgStateVariables : public TCPStateVariables
  * To be done:
  *   - KEEP-ALIVE timer
  *
+ * With the lazyTimers parameter of the TCP module, the REXMIT, PERSIST and
+ * DELAYEDACK timers are kept as deadlines: restarting or stopping a timer
+ * only updates the deadline, and the timer message is moved only when the
+ * deadline becomes earlier. A firing before the deadline re-arms the message,
+ * a firing of a stopped timer is ignored. This saves most of the cancel and
+ * schedule operations on the future event set (which happen on nearly every
+ * ACK) without changing protocol behaviour.
+ *
  * Note: currently the timers and time calculations are done in double
  * and NOT in Unix (200ms or 500ms) ticks. It's possible to write another
  * TCPAlgorithm which uses ticks (or rather, factor out timer handling to
@@ -109,6 +117,11 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
     cMessage *delayedAckTimer;
     cMessage *keepAliveTimer;
 
+    bool lazyTimers;              // see class documentation
+    simtime_t rexmitDeadline;     // expiry of the REXMIT timer, or -1 if it's not running
+    simtime_t persistDeadline;    // expiry of the PERSIST timer, or -1 if it's not running
+    simtime_t delayedAckDeadline; // expiry of the DELAYEDACK timer, or -1 if it's not running
+
     cOutVector *cwndVector;  // will record changes to snd_cwnd
     cOutVector *ssthreshVector; // will record changes to ssthresh
     cOutVector *rttVector;   // will record measured RTT
@@ -126,6 +139,20 @@ class INET_API TCPBaseAlg : public TCPAlgorithm
     virtual void processKeepAliveTimer(TCPEventCode& event);
     //@}
 
+    /** @name Start, stop and query REXMIT, PERSIST and DELAYEDACK timers (see lazyTimers) */
+    //@{
+    virtual void startTimer(cMessage *timer, simtime_t& deadline, simtime_t timeout);
+    virtual void stopTimer(cMessage *timer, simtime_t& deadline);
+    bool isTimerRunning(const simtime_t& deadline) const {return deadline >= 0;}
+
+    /**
+     * Called when the timer message arrives. Returns true if the timer has
+     * really expired; otherwise the message is re-armed for a later deadline
+     * or, if the timer has been stopped, just dropped from the FES.
+     */
+    virtual bool timerExpired(cMessage *timer, simtime_t& deadline);
+    //@}
+
     /**
      * Start REXMIT timer and initialize retransmission variables
      */
@@ -21,6 +21,7 @@
 #include <map>
 #include <set>
 #include <omnetpp.h>
+#include "INETDefs.h"
 #include "IPvXAddress.h"
 
 class TCPSegment;
@@ -30,10 +31,10 @@ namespace tcp_old {
 class TCPConnection;
 
 // macro for normal ev<< logging (note: deliberately no parens in macro def)
-#define tcpEV (ev.disable_tracing||TCP::testing)?ev:ev
+#define tcpEV INET_LOG_IF(INET_LOGLEVEL_INFO, ev, !ev.disable_tracing && !TCP::testing)
 
 // macro for more verbose ev<< logging (note: deliberately no parens in macro def)
-#define tcpEV2 (ev.disable_tracing||TCP::testing||!TCP::logverbose)?ev:ev
+#define tcpEV2 INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.disable_tracing && !TCP::testing && TCP::logverbose)
 
 // testingEV writes log that automated test cases can check (*.test files)
 #define testingEV (ev.disable_tracing||!TCP::testing)?ev:ev
@@ -501,6 +501,7 @@ void UDP::processMsgFromApp(cPacket *appData)
         ipControlInfo->setSrcAddr(udpCtrl->getSrcAddr().get4());
         ipControlInfo->setDestAddr(udpCtrl->getDestAddr().get4());
         ipControlInfo->setInterfaceId(udpCtrl->getInterfaceId());
+        ipControlInfo->setDiffServCodePoint(udpCtrl->getDiffServCodePoint());
         udpPacket->setControlInfo(ipControlInfo);
         delete udpCtrl;
 
@@ -0,0 +1,369 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <errno.h>
+#include <sstream>
+#include "PcapWriter.h"
+
+#define PCAP_MAGIC           0xa1b2c3d4
+#define PCAPNG_SHB           0x0a0d0d0a
+#define PCAPNG_IDB           0x00000001
+#define PCAPNG_EPB           0x00000006
+#define PCAPNG_BYTE_ORDER    0x1a2b3c4d
+
+#define PCAP_RECORD_HEADER   16
+#define PCAPNG_EPB_HEADER    28
+#define PCAPNG_EPB_TRAILER   (3 + 8 + 4 + 4)  // padding, epb_flags, end of options, block length
+
+#define MIN_BLOCK_SIZE       (128*1024)
+
+
+PcapWriter::PcapWriter()
+{
+    format = PCAP;
+    snaplen = 65535;
+    blockSize = 0;
+    maxFileSize = 0;
+    ringFiles = 0;
+    file = NULL;
+    fileIndex = 0;
+    fileBytes = 0;
+    fileEmpty = true;
+    block = spareBlock = NULL;
+    used = 0;
+    numPackets = numFlushes = 0;
+    threaded = false;
+#ifdef PCAPWRITER_THREADS
+    pendingBlock = NULL;
+    pendingLength = 0;
+    stopThread = writeError = false;
+#endif
+}
+
+PcapWriter::~PcapWriter()
+{
+    close();
+}
+
+void PcapWriter::open(const char *name, Format fmt, uint32 snapLength, size_t blkSize,
+                      bool useThread, uint64 maxSize, int numRingFiles)
+{
+    fileName = name;
+    format = fmt;
+    snaplen = snapLength;
+    blockSize = std::max(blkSize, (size_t)MIN_BLOCK_SIZE);
+    maxFileSize = maxSize;
+    ringFiles = numRingFiles;
+    block = new unsigned char[blockSize];
+    used = 0;
+    fileIndex = 0;
+    numPackets = numFlushes = 0;
+
+#ifdef PCAPWRITER_THREADS
+    threaded = useThread;
+    if (threaded)
+    {
+        spareBlock = new unsigned char[blockSize];
+        pendingBlock = NULL;
+        stopThread = writeError = false;
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&cond, NULL);
+        if (pthread_create(&thread, NULL, threadMain, this) != 0)
+            opp_error("PcapWriter: cannot start writer thread");
+    }
+#else
+    threaded = false;  // no background writing on this platform
+#endif
+
+    openFile();
+}
+
+int PcapWriter::addInterface(const char *name, int linkType)
+{
+    Interface iface;
+    iface.name = name;
+    iface.linkType = linkType;
+    interfaces.push_back(iface);
+    if (file && format==PCAPNG)
+        writeInterfaceDescription(iface);
+    return interfaces.size()-1;
+}
+
+void PcapWriter::close()
+{
+    if (file)
+        closeFile();
+#ifdef PCAPWRITER_THREADS
+    if (threaded)
+    {
+        pthread_mutex_lock(&mutex);
+        stopThread = true;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+        pthread_join(thread, NULL);
+        pthread_cond_destroy(&cond);
+        pthread_mutex_destroy(&mutex);
+        threaded = false;
+    }
+#endif
+    delete [] block;
+    delete [] spareBlock;
+    block = spareBlock = NULL;
+}
+
+std::string PcapWriter::insertSuffix(const std::string& fileName, const std::string& suffix)
+{
+    // "dump.pcap" -> "dump_<suffix>.pcap"
+    std::string::size_type dot = fileName.rfind('.');
+    std::string::size_type slash = fileName.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        dot = fileName.size();
+    return fileName.substr(0, dot) + "_" + suffix + fileName.substr(dot);
+}
+
+std::string PcapWriter::getFileName(int index) const
+{
+    if (maxFileSize == 0)
+        return fileName;
+    if (ringFiles > 0)
+        index %= ringFiles;
+    std::stringstream os;
+    os << index;
+    return insertSuffix(fileName, os.str());
+}
+
+void PcapWriter::openFile()
+{
+    std::string name = getFileName(fileIndex);
+    file = fopen(name.c_str(), "wb");
+    if (!file)
+        opp_error("Cannot open file '%s' for writing: %s", name.c_str(), strerror(errno));
+    setvbuf(file, NULL, _IONBF, 0);  // we write whole blocks
+    fileBytes = 0;
+    fileEmpty = true;
+    writeFileHeader();
+}
+
+void PcapWriter::closeFile()
+{
+    flush();
+    waitForWriter();
+    fclose(file);
+    file = NULL;
+}
+
+void PcapWriter::writeFileHeader()
+{
+    if (format == PCAP)
+    {
+        put32(PCAP_MAGIC);
+        put16(2);
+        put16(4);
+        put32(0);   // thiszone
+        put32(0);   // sigfigs
+        put32(snaplen);
+        put32(interfaces.empty() ? LINKTYPE_RAW : interfaces[0].linkType);
+        return;
+    }
+
+    // Section Header Block, section length unknown
+    put32(PCAPNG_SHB);
+    put32(28);
+    put32(PCAPNG_BYTE_ORDER);
+    put16(1);
+    put16(0);
+    put32(0xffffffff);
+    put32(0xffffffff);
+    put32(28);
+    for (unsigned int i=0; i<interfaces.size(); i++)
+        writeInterfaceDescription(interfaces[i]);
+}
+
+void PcapWriter::writeInterfaceDescription(const Interface& iface)
+{
+    uint32 nameLength = iface.name.size();
+    uint32 length = 20 + 4 + ((nameLength+3) & ~3) + 8 + 4;
+    if (used + length > blockSize)
+        flush();
+
+    put32(PCAPNG_IDB);
+    put32(length);
+    put16(iface.linkType);
+    put16(0);
+    put32(snaplen);
+    // if_name
+    put16(2);
+    put16(nameLength);
+    memcpy(block+used, iface.name.data(), nameLength);
+    used += nameLength;
+    while (used % 4)
+        block[used++] = 0;
+    // if_tsresol: nanoseconds
+    put16(9);
+    put16(1);
+    put32(0);
+    block[used-4] = 9;
+    // opt_endofopt
+    put32(0);
+    put32(length);
+}
+
+unsigned char *PcapWriter::beginPacket(uint32 maxLength)
+{
+    const uint32 headerLength = (format == PCAP) ? PCAP_RECORD_HEADER : PCAPNG_EPB_HEADER;
+    const uint32 need = headerLength + maxLength + PCAPNG_EPB_TRAILER;
+    if (need > blockSize)
+        opp_error("PcapWriter: packet of %u bytes does not fit into the write buffer", maxLength);
+
+    const uint32 maxRecordLength = headerLength + std::min(maxLength, snaplen) + (format == PCAP ? 0 : PCAPNG_EPB_TRAILER);
+    if (maxFileSize > 0 && !fileEmpty && fileBytes + used + maxRecordLength > maxFileSize)
+    {
+        // start the next file (of the ring)
+        closeFile();
+        fileIndex++;
+        openFile();
+    }
+    if (used + need > blockSize)
+        flush();
+    return block + used + headerLength;
+}
+
+void PcapWriter::endPacket(simtime_t timestamp, int interfaceId, uint32 length, Direction direction)
+{
+    // exact conversion of the simulation time to nanoseconds
+    int64 ns = timestamp.raw();
+    int scaleExp = SimTime::getScaleExp();
+    for (; scaleExp > -9; scaleExp--)
+        ns *= 10;
+    for (; scaleExp < -9; scaleExp++)
+        ns /= 10;
+
+    uint32 capLength = std::min(length, snaplen);
+    size_t start = used;
+    if (format == PCAP)
+    {
+        put32((uint32)(ns / 1000000000));
+        put32((uint32)((ns % 1000000000) / 1000));
+        put32(capLength);
+        put32(length);
+        used += capLength;
+    }
+    else
+    {
+        put32(PCAPNG_EPB);
+        put32(0);   // block length, filled in below
+        put32(interfaceId);
+        put32((uint32)((uint64)ns >> 32));
+        put32((uint32)ns);
+        put32(capLength);
+        put32(length);
+        used += capLength;
+        while (used % 4)
+            block[used++] = 0;
+        if (direction != UNKNOWN)
+        {
+            // epb_flags: inbound/outbound in the lowest two bits
+            put16(2);
+            put16(4);
+            put32(direction);
+            put32(0);
+        }
+        uint32 blockLength = used + 4 - start;
+        put32(blockLength);
+        memcpy(block+start+4, &blockLength, 4);
+    }
+    numPackets++;
+    fileEmpty = false;
+}
+
+void PcapWriter::flush()
+{
+    if (used == 0)
+        return;
+    fileBytes += used;
+    numFlushes++;
+#ifdef PCAPWRITER_THREADS
+    if (threaded)
+    {
+        // hand the block over to the writer thread and continue in the other one
+        waitForWriter();
+        pthread_mutex_lock(&mutex);
+        pendingBlock = block;
+        pendingLength = used;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+        std::swap(block, spareBlock);
+        used = 0;
+        return;
+    }
+#endif
+    writeBlock(block, used);
+    used = 0;
+}
+
+void PcapWriter::writeBlock(const unsigned char *data, size_t length)
+{
+    if (fwrite(data, 1, length, file) != length)
+        opp_error("PcapWriter: cannot write '%s': %s", getFileName(fileIndex).c_str(), strerror(errno));
+}
+
+void PcapWriter::waitForWriter()
+{
+#ifdef PCAPWRITER_THREADS
+    if (!threaded)
+        return;
+    pthread_mutex_lock(&mutex);
+    while (pendingBlock)
+        pthread_cond_wait(&cond, &mutex);
+    bool error = writeError;
+    pthread_mutex_unlock(&mutex);
+    if (error)
+        opp_error("PcapWriter: cannot write '%s'", getFileName(fileIndex).c_str());
+#endif
+}
+
+#ifdef PCAPWRITER_THREADS
+void *PcapWriter::threadMain(void *arg)
+{
+    ((PcapWriter *)arg)->writerLoop();
+    return NULL;
+}
+
+void PcapWriter::writerLoop()
+{
+    // only fwrite() runs here; everything else stays in the simulation thread
+    pthread_mutex_lock(&mutex);
+    while (true)
+    {
+        while (!pendingBlock && !stopThread)
+            pthread_cond_wait(&cond, &mutex);
+        if (!pendingBlock)
+            break;
+        const unsigned char *data = pendingBlock;
+        size_t length = pendingLength;
+        pthread_mutex_unlock(&mutex);
+
+        bool ok = fwrite(data, 1, length, file) == length;
+
+        pthread_mutex_lock(&mutex);
+        if (!ok)
+            writeError = true;
+        pendingBlock = NULL;
+        pthread_cond_broadcast(&cond);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+#endif
@@ -0,0 +1,148 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __PCAPWRITER_H
+#define __PCAPWRITER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <omnetpp.h>
+#include "INETDefs.h"
+
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32) && !defined(__CYGWIN__) && !defined(_WIN64)
+#include <pthread.h>
+#define PCAPWRITER_THREADS
+#endif
+
+#define LINKTYPE_NULL   0      // 4-byte address family header (BSD loopback)
+#define LINKTYPE_RAW    101    // raw IPv4/IPv6
+
+
+/**
+ * Writes packets into pcap or pcapng files through a large in-memory
+ * block. Packet data is serialized straight into the block: the caller
+ * gets a pointer with beginPacket(), fills in the data and completes the
+ * record with endPacket(), which truncates it to the snapshot length.
+ * Full blocks are written out with a single fwrite(); with a background
+ * thread (POSIX only), writing overlaps with the simulation, using two
+ * blocks alternately.
+ *
+ * pcapng files get one Interface Description Block per interface added
+ * with addInterface(). When a maximum file size is set, the output is
+ * split into files named <base>_<n><ext>; with a ring of N files, the
+ * oldest one is overwritten.
+ */
+class INET_API PcapWriter
+{
+  public:
+    enum Format { PCAP, PCAPNG };
+    enum Direction { UNKNOWN = 0, INBOUND = 1, OUTBOUND = 2 };
+
+  protected:
+    struct Interface
+    {
+        std::string name;
+        int linkType;
+    };
+
+    std::string fileName;
+    Format format;
+    uint32 snaplen;
+    size_t blockSize;
+    uint64 maxFileSize;         // 0: unlimited
+    int ringFiles;              // 0: no ring, files are numbered on
+    std::vector<Interface> interfaces;
+
+    FILE *file;
+    int fileIndex;
+    uint64 fileBytes;           // bytes handed over for the current file
+    bool fileEmpty;             // no packets in the current file yet
+
+    unsigned char *block;       // block being filled
+    size_t used;
+    unsigned char *spareBlock;  // block being written by the thread
+
+    // statistics
+    unsigned long numPackets;
+    unsigned long numFlushes;
+
+    bool threaded;
+#ifdef PCAPWRITER_THREADS
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned char *pendingBlock;  // handed over to the thread, NULL if none
+    size_t pendingLength;
+    bool stopThread;
+    bool writeError;
+
+    static void *threadMain(void *arg);
+    void writerLoop();
+#endif
+
+  protected:
+    std::string getFileName(int index) const;
+    void openFile();
+    void closeFile();
+    void writeFileHeader();
+    void writeInterfaceDescription(const Interface& iface);
+    void flush();
+    void waitForWriter();
+    void writeBlock(const unsigned char *data, size_t length);
+    void put16(uint16 v) {memcpy(block+used, &v, 2); used += 2;}
+    void put32(uint32 v) {memcpy(block+used, &v, 4); used += 4;}
+
+  public:
+    PcapWriter();
+    ~PcapWriter();
+
+    /**
+     * Opens the (first) output file. For pcap files, the link type of
+     * the first interface added is used for all packets, so interfaces
+     * must be added before the first packet.
+     */
+    void open(const char *fileName, Format format, uint32 snaplen, size_t blockSize,
+              bool threaded, uint64 maxFileSize=0, int ringFiles=0);
+
+    /** Registers an interface; returns its id for endPacket(). */
+    int addInterface(const char *name, int linkType);
+
+    /** Flushes and closes the file, and stops the writer thread. */
+    void close();
+
+    bool isOpen() const {return file!=NULL;}
+    int getLinkType(int interfaceId) const {return interfaces[interfaceId].linkType;}
+    unsigned long getNumPackets() const {return numPackets;}
+    unsigned long getNumFlushes() const {return numFlushes;}
+
+    /** Inserts "_" and the suffix before the extension of the file name */
+    static std::string insertSuffix(const std::string& fileName, const std::string& suffix);
+
+    /**
+     * Returns a buffer for the data (link header included) of the next
+     * packet, which can hold at least maxLength bytes.
+     */
+    unsigned char *beginPacket(uint32 maxLength);
+
+    /**
+     * Completes the packet started with beginPacket(); length is the
+     * number of bytes filled in, of which at most snaplen are kept.
+     */
+    void endPacket(simtime_t timestamp, int interfaceId, uint32 length, Direction direction=UNKNOWN);
+};
+
+#endif
@@ -19,11 +19,13 @@
 //
 
 
+#include <algorithm>
 #include "TCPDump.h"
 #include "IPControlInfo_m.h"
 #include "SCTPMessage.h"
 #include "SCTPAssociation.h"
 #include "IPSerializer.h"
+#include "IPv6Serializer.h"
 #include "ICMPMessage.h"
 #include "UDPPacket_m.h"
 
@@ -317,6 +319,8 @@ void TCPDumper::sctpDump(const char *label, SCTPMessage *sctpmsg, const std::str
 
 TCPDump::~TCPDump()
 {
+    for (unsigned int i=0; i<writers.size(); i++)
+        delete writers[i];
 }
 
 const char *TCPDumper::intToChunk(int32 type)
@@ -358,8 +362,7 @@ Define_Module(TCPDump);
 
 TCPDump::TCPDump() : cSimpleModule(), tcpdump(ev.getOStream())
 {
-
-
+    perInterfaceFiles = false;
 }
 
 void TCPDumper::udpDump(bool l2r, const char *label, IPDatagram *dgram, const char *comment)
@@ -519,32 +522,95 @@ void TCPDumper::tcpDump(bool l2r, const char *label, TCPSegment *tcpseg, const s
 
 void TCPDump::initialize()
 {
-    struct pcap_hdr fh;
     const char* file = this->par("dumpFile");
     snaplen = this->par("snaplen");
     tcpdump.setVerbosity(par("verbosity"));
 
-
     if (strcmp(file,"")!=0)
+        openWriters(file);
+}
+
+std::string TCPDump::getInterfaceName(int index)
+{
+    // name of the interface module (ppp0, eth1, ...), as Wireshark shows it
+    cGate *g = gate("ifOut", index)->getNextGate();
+    if (g)
+        return g->getOwnerModule()->getFullName();
+    char buf[16];
+    sprintf(buf, "if%d", index);
+    return buf;
+}
+
+void TCPDump::openWriters(const char *file)
+{
+    PcapWriter::Format format;
+    const char *formatName = par("format");
+    if (!strcmp(formatName, "pcap"))
+        format = PcapWriter::PCAP;
+    else if (!strcmp(formatName, "pcapng"))
+        format = PcapWriter::PCAPNG;
+    else
+        error("Unknown dump file format '%s', must be \"pcap\" or \"pcapng\"", formatName);
+
+    // pcap: keep the BSD loopback header of earlier versions; pcapng: raw IP
+    int linkType = (format == PcapWriter::PCAP) ? LINKTYPE_NULL : LINKTYPE_RAW;
+    size_t bufferSize = (long)par("bufferSize");
+    uint64 maxFileSize = (long)par("maxFileSize");
+    int ringFiles = par("ringFiles");
+    bool threaded = par("threadEnable");
+    perInterfaceFiles = par("perInterfaceFiles");
+
+    int numInterfaces = gateSize("ifIn");
+    if (perInterfaceFiles)
     {
-        tcpdump.dumpfile = fopen(file, "wb");
-        if (!tcpdump.dumpfile)
+        for (int i=0; i<numInterfaces; i++)
         {
-            fprintf(stderr, "Cannot open file [%s] for writing: %s\n", file, strerror(errno));
-            exit(-1);
+            std::string name = getInterfaceName(i);
+            PcapWriter *writer = new PcapWriter();
+            writer->addInterface(name.c_str(), linkType);
+            writer->open(PcapWriter::insertSuffix(file, name).c_str(), format, snaplen, bufferSize, threaded, maxFileSize, ringFiles);
+            writers.push_back(writer);
         }
-
-        fh.magic = PCAP_MAGIC;
-        fh.version_major = 2;
-        fh.version_minor = 4;
-        fh.thiszone = 0;
-        fh.sigfigs = 0;
-        fh.snaplen = snaplen;
-        fh.network = 0;
-        fwrite(&fh, sizeof(fh), 1, tcpdump.dumpfile);
     }
     else
-        tcpdump.dumpfile = NULL;
+    {
+        PcapWriter *writer = new PcapWriter();
+        for (int i=0; i<numInterfaces; i++)
+            writer->addInterface(getInterfaceName(i).c_str(), linkType);
+        if (numInterfaces == 0)
+            writer->addInterface("if0", linkType);
+        writer->open(file, format, snaplen, bufferSize, threaded, maxFileSize, ringFiles);
+        writers.push_back(writer);
+    }
+}
+
+void TCPDump::writePacket(cMessage *msg)
+{
+    IPDatagram *ipPacket = dynamic_cast<IPDatagram *>(msg);
+    IPv6Datagram *ipv6Packet = ipPacket ? NULL : dynamic_cast<IPv6Datagram *>(msg);
+    if (!ipPacket && !ipv6Packet)
+        return;
+
+    int index = msg->getArrivalGate()->getIndex();
+    PcapWriter *writer = writers[perInterfaceFiles ? index : 0];
+    int interfaceId = perInterfaceFiles ? 0 : index;
+
+    // serialize straight into the writer's buffer
+    uint32 linkHeaderLength = (writer->getLinkType(interfaceId) == LINKTYPE_NULL) ? 4 : 0;
+    uint8 *buf = writer->beginPacket(linkHeaderLength + MAXBUFLENGTH);
+    if (linkHeaderLength)
+    {
+        uint32 family = ipPacket ? 2 : 24;  // AF_INET, or AF_INET6 of the BSDs
+        memcpy(buf, &family, sizeof(family));
+    }
+    uint8 *ipBuf = buf + linkHeaderLength;
+    // the serializers leave payload bytes untouched; clear just the datagram
+    memset(ipBuf, 0, std::min((uint32)PK(msg)->getByteLength(), (uint32)MAXBUFLENGTH));
+    int32 serialized = ipPacket ? IPSerializer().serialize(ipPacket, ipBuf, MAXBUFLENGTH)
+                                : IPv6Serializer().serialize(ipv6Packet, ipBuf, MAXBUFLENGTH);
+
+    PcapWriter::Direction direction = msg->arrivedOn("ifIn") ? PcapWriter::INBOUND : PcapWriter::OUTBOUND;
+    writer->endPacket(simulation.getSimTime(), interfaceId, linkHeaderLength + serialized, direction);
 }
 
 void TCPDump::handleMessage(cMessage *msg)
@@ -626,32 +692,8 @@ void TCPDump::handleMessage(cMessage *msg)
     }
 
 
-    if (tcpdump.dumpfile!=NULL && dynamic_cast<IPDatagram *>(msg))
-    {
-        uint8 buf[MAXBUFLENGTH];
-        memset((void*)&buf, 0, sizeof(buf));
-
-        const simtime_t stime = simulation.getSimTime();
-        // Write PCap header
-
-        struct pcaprec_hdr ph;
-        ph.ts_sec = (int32)stime.dbl();
-        ph.ts_usec = (uint32)((stime.dbl() - ph.ts_sec)*1000000);
-         // Write Ethernet header
-        uint32 hdr = 2; //AF_INET
-                     //We do not want this to end in an error if EtherAutoconf messages
-        IPDatagram *ipPacket = check_and_cast<IPDatagram *>(msg);
-        // IP header:
-        //struct sockaddr_in *to = (struct sockaddr_in*) malloc(sizeof(struct sockaddr_in));
-        //int32 tosize = sizeof(struct sockaddr_in);
-        int32 serialized_ip = IPSerializer().serialize(ipPacket, buf, sizeof(buf));
-        ph.incl_len = serialized_ip + sizeof(uint32);
-
-        ph.orig_len = ph.incl_len;
-        fwrite(&ph, sizeof(ph), 1, tcpdump.dumpfile);
-        fwrite(&hdr, sizeof(uint32), 1, tcpdump.dumpfile);
-        fwrite(buf, serialized_ip, 1, tcpdump.dumpfile);
-    }
+    if (!writers.empty())
+        writePacket(msg);
 
 
     // forward
@@ -668,7 +710,12 @@ void TCPDump::handleMessage(cMessage *msg)
 void TCPDump::finish()
 {
      tcpdump.dump("", "tcpdump finished");
-     if (strcmp(this->par("dumpFile"),"")!=0)
-          fclose(tcpdump.dumpfile);
+     for (unsigned int i=0; i<writers.size(); i++)
+     {
+          EV << "pcap writer " << i << ": " << writers[i]->getNumPackets() << " packets in "
+             << writers[i]->getNumFlushes() << " writes\n";
+          writers[i]->close();
+          delete writers[i];
+     }
+     writers.clear();
 }
-
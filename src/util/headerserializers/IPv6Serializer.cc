@@ -0,0 +1,76 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+#include <string.h>
+#include <platdep/sockets.h>
+#include "IPv6Serializer.h"
+#include "TCPSerializer.h"
+#include "UDPSerializer.h"
+#include "ICMPv6Message_m.h"
+
+#if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32) && !defined(__CYGWIN__) && !defined(_WIN64)
+#include <netinet/in.h>  // htonl, ntohl, ...
+#endif
+
+#define IPv6_HEADER_BYTES 40
+
+
+int IPv6Serializer::serialize(const IPv6Datagram *dgram, unsigned char *buf, unsigned int bufsize)
+{
+    if (bufsize < IPv6_HEADER_BYTES)
+        opp_error("IPv6Serializer: buffer too small");
+
+    // version, traffic class, flow label
+    uint32 vtf = htonl((6u << 28) | ((dgram->getTrafficClass() & 0xff) << 20) | (dgram->getFlowLabel() & 0xfffff));
+    memcpy(buf, &vtf, 4);
+    buf[6] = dgram->getTransportProtocol();
+    buf[7] = dgram->getHopLimit();
+    for (int i=0; i<4; i++)
+    {
+        uint32 w = htonl(dgram->getSrcAddress().words()[i]);
+        memcpy(buf + 8 + 4*i, &w, 4);
+        w = htonl(dgram->getDestAddress().words()[i]);
+        memcpy(buf + 24 + 4*i, &w, 4);
+    }
+
+    unsigned char *payload = buf + IPv6_HEADER_BYTES;
+    unsigned int room = bufsize - IPv6_HEADER_BYTES;
+    cPacket *encapPacket = dgram->getEncapsulatedMsg();
+    unsigned int payloadLength = 0;
+    if (encapPacket)
+    {
+        switch (dgram->getTransportProtocol())
+        {
+          case IP_PROT_TCP:
+            payloadLength = TCPSerializer().serialize(check_and_cast<TCPSegment *>(encapPacket), payload, room,
+                                                      dgram->getSrcAddress(), dgram->getDestAddress());
+            break;
+          case IP_PROT_UDP:
+            payloadLength = UDPSerializer().serialize(check_and_cast<UDPPacket *>(encapPacket), payload, room);
+            break;
+          default:
+            payloadLength = std::min((unsigned int)encapPacket->getByteLength(), room);
+            memset(payload, 0, payloadLength);
+            if (dgram->getTransportProtocol() == IP_PROT_IPv6_ICMP && payloadLength >= 4)
+                payload[0] = check_and_cast<ICMPv6Message *>(encapPacket)->getType();
+            break;
+        }
+    }
+
+    uint16 plen = htons(payloadLength);
+    memcpy(buf + 4, &plen, 2);
+    return IPv6_HEADER_BYTES + payloadLength;
+}
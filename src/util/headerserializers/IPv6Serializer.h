@@ -0,0 +1,41 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IPV6SERIALIZER_H
+#define __INET_IPV6SERIALIZER_H
+
+#include "IPv6Datagram.h"
+
+
+/**
+ * Converts an IPv6Datagram into binary (network byte order) form, for
+ * writing it into capture files. Extension headers are not serialized
+ * (the Next Header field holds the transport protocol); TCP and UDP
+ * payloads are serialized by their serializers, ICMPv6 messages as
+ * their type followed by zeros, anything else as zeros.
+ */
+class IPv6Serializer
+{
+    public:
+        IPv6Serializer() {}
+
+        /**
+         * Serializes an IPv6Datagram. Returns the length of data written
+         * into buffer.
+         */
+        int serialize(const IPv6Datagram *dgram, unsigned char *buf, unsigned int bufsize);
+};
+
+#endif
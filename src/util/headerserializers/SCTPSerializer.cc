@@ -504,24 +504,128 @@ int32 SCTPSerializer::serialize(const SCTPMessage *msg, unsigned char *buf, uint
     return writtenbytes;
 }
 
-uint32 SCTPSerializer::checksum(const uint8_t *buf, register uint32 len)
+// The x86 fast paths are compiled with per-function target attributes and
+// selected at run time, so the library still runs on CPUs without SSE4.2.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SCTP_CRC32C_SSE42
+#include <nmmintrin.h>
+#endif
+
+static uint32 crc32cTable[8][256];
+
+/**
+ * Builds the slicing-by-8 tables from the byte-wise table in headers/sctp.h:
+ * crc32cTable[k][b] is the CRC of byte b followed by k zero bytes.
+ */
+static void initCrc32cTables()
+{
+    for (uint32 i = 0; i < 256; i++)
+        crc32cTable[0][i] = crc_c[i];
+    for (uint32 k = 1; k < 8; k++)
+        for (uint32 i = 0; i < 256; i++)
+            crc32cTable[k][i] = (crc32cTable[k-1][i] >> 8) ^ crc32cTable[0][crc32cTable[k-1][i] & 0xFF];
+}
+
+static uint32 crc32cSlicingBy8(uint32 crc, const uint8_t *buf, uint32 len)
+{
+    // align to 8 bytes, then consume 64 bits per iteration
+    while (len > 0 && ((size_t)buf & 7) != 0)
+    {
+        CRC32C(crc, *buf++);
+        len--;
+    }
+    while (len >= 8)
+    {
+        // assemble the words byte by byte, so this is independent of host byte order
+        const uint32 lo = crc ^ (buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32)buf[3] << 24));
+        const uint32 hi = buf[4] | (buf[5] << 8) | (buf[6] << 16) | ((uint32)buf[7] << 24);
+        crc = crc32cTable[7][lo & 0xFF] ^ crc32cTable[6][(lo >> 8) & 0xFF] ^
+              crc32cTable[5][(lo >> 16) & 0xFF] ^ crc32cTable[4][lo >> 24] ^
+              crc32cTable[3][hi & 0xFF] ^ crc32cTable[2][(hi >> 8) & 0xFF] ^
+              crc32cTable[1][(hi >> 16) & 0xFF] ^ crc32cTable[0][hi >> 24];
+        buf += 8;
+        len -= 8;
+    }
+    while (len-- > 0)
+        CRC32C(crc, *buf++);
+    return crc;
+}
+
+#ifdef SCTP_CRC32C_SSE42
+__attribute__((target("sse4.2")))
+static uint32 crc32cSSE42(uint32 crc, const uint8_t *buf, uint32 len)
+{
+    while (len > 0 && ((size_t)buf & 7) != 0)
+    {
+        crc = _mm_crc32_u8(crc, *buf++);
+        len--;
+    }
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    for (; len >= 8; buf += 8, len -= 8)
+        crc64 = _mm_crc32_u64(crc64, *(const uint64_t *)buf);
+    crc = (uint32)crc64;
+#else
+    for (; len >= 4; buf += 4, len -= 4)
+        crc = _mm_crc32_u32(crc, *(const uint32 *)buf);
+#endif
+    while (len-- > 0)
+        crc = _mm_crc32_u8(crc, *buf++);
+    return crc;
+}
+#endif
+
+typedef uint32 (*Crc32cFunction)(uint32 crc, const uint8_t *buf, uint32 len);
+
+static Crc32cFunction selectCrc32c()
+{
+    initCrc32cTables();
+#ifdef SCTP_CRC32C_SSE42
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+        return crc32cSSE42;
+#endif
+    return crc32cSlicingBy8;
+}
+
+static Crc32cFunction crc32cUpdate = selectCrc32c();
+
+/**
+ * Converts the raw (reflected) CRC32c register into the value to be stored
+ * in the SCTP common header.
+ */
+static inline uint32 crc32cFinish(uint32 res)
 {
-    uint32 h;
+    uint32 h = ~res;
     unsigned char byte0, byte1, byte2, byte3;
-    uint32 crc32c;
-    register uint32 i;
-    register uint32 res = (~0L);
-    for (i = 0; i < len; i++)
-      CRC32C(res, buf[i]);
-    h      = ~res;
     byte0  = h & 0xff;
     byte1  = (h>>8) & 0xff;
     byte2  = (h>>16) & 0xff;
     byte3  = (h>>24) & 0xff;
-    crc32c = ((byte0 << 24) | (byte1 << 16) | (byte2 << 8) | byte3);
+    uint32 crc32c = ((byte0 << 24) | (byte1 << 16) | (byte2 << 8) | byte3);
     return htonl(crc32c);
 }
 
+uint32 SCTPSerializer::checksum(const uint8_t *buf, register uint32 len)
+{
+    return crc32cFinish(crc32cUpdate(~0U, buf, len));
+}
+
+uint32 SCTPSerializer::checksumBytewise(const uint8_t *buf, register uint32 len)
+{
+    register uint32 i;
+    register uint32 res = (~0L);
+    for (i = 0; i < len; i++)
+      CRC32C(res, buf[i]);
+    return crc32cFinish(res);
+}
+
+uint32 SCTPSerializer::checksumSlicingBy8(const uint8_t *buf, register uint32 len)
+{
+    return crc32cFinish(crc32cSlicingBy8(~0U, buf, len));
+}
+
 void SCTPSerializer::parse(const uint8_t *buf, uint32 bufsize, SCTPMessage *dest)
 {
     int32 size_common_header = sizeof(struct common_header);
@@ -41,7 +41,15 @@ class SCTPSerializer
          */
         void parse(const uint8 *buf, uint32 bufsize, SCTPMessage *dest);
 
+        /**
+         * Computes the CRC32c checksum of the packet. Uses the SSE4.2 crc32
+         * instruction if the CPU supports it, and slicing-by-8 otherwise.
+         */
         static uint32 checksum(const uint8 *buf, register uint32 len);
+
+        /** Portable implementations, also used for comparison in tests */
+        static uint32 checksumBytewise(const uint8 *buf, register uint32 len);
+        static uint32 checksumSlicingBy8(const uint8 *buf, register uint32 len);
 };
 
 #endif
@@ -16,13 +16,141 @@
 // along with this program; if not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <string.h>
+
 #include "TCPIPchecksum.h"
 
 #if !defined(_WIN32) && !defined(__WIN32__) && !defined(WIN32) && !defined(__CYGWIN__) && !defined(_WIN64)
 #include <netinet/in.h>  // htonl, ntohl, ...
 #endif
 
+// SIMD variants are compiled with per-function target attributes and
+// selected at run time; SSE2 is always present on x86-64.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define TCPIP_CHECKSUM_SIMD
+#include <immintrin.h>
+#endif
+
+/**
+ * Folds a 64-bit accumulator of 16-bit words into a 16-bit one's complement sum.
+ */
+static inline uint16_t fold64(uint64_t sum)
+{
+    sum = (sum & 0xFFFFFFFFULL) + (sum >> 32);
+    sum = (sum & 0xFFFFFFFFULL) + (sum >> 32);
+    uint32_t sum32 = (uint32_t)sum;
+    sum32 = (sum32 & 0xFFFF) + (sum32 >> 16);
+    sum32 = (sum32 & 0xFFFF) + (sum32 >> 16);
+    return (uint16_t)sum32;
+}
+
+/**
+ * Sums the buffer as 32-bit words into a 64-bit accumulator. Since 2^16 == 1
+ * in one's complement arithmetic, this gives the same result as adding 16-bit
+ * words, with no carry handling inside the loop.
+ */
+static uint64_t sumWords64(const uint8_t *p, unsigned int count, uint64_t sum)
+{
+    uint32_t w;
+    for (; count >= 16; p += 16, count -= 16)
+    {
+        uint32_t w0, w1, w2, w3;
+        memcpy(&w0, p, 4);
+        memcpy(&w1, p + 4, 4);
+        memcpy(&w2, p + 8, 4);
+        memcpy(&w3, p + 12, 4);
+        sum += (uint64_t)w0 + w1 + w2 + w3;
+    }
+    for (; count >= 4; p += 4, count -= 4)
+    {
+        memcpy(&w, p, 4);
+        sum += w;
+    }
+    if (count >= 2)
+    {
+        uint16_t h;
+        memcpy(&h, p, 2);
+        sum += h;
+        p += 2;
+        count -= 2;
+    }
+    if (count)
+        sum += *p;
+    return sum;
+}
+
+static uint16_t checksumScalar64(const void *addr, unsigned int count)
+{
+    return fold64(sumWords64((const uint8_t *)addr, count, 0));
+}
+
+#ifdef TCPIP_CHECKSUM_SIMD
+__attribute__((target("sse2")))
+static uint16_t checksumSSE2(const void *addr, unsigned int count)
+{
+    const uint8_t *p = (const uint8_t *)addr;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;   // two 64-bit lanes
+    for (; count >= 16; p += 16, count -= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    uint64_t sum = fold64(lanes[0]) + (uint64_t)fold64(lanes[1]);
+    return fold64(sumWords64(p, count, sum));
+}
+
+__attribute__((target("avx2")))
+static uint16_t checksumAVX2(const void *addr, unsigned int count)
+{
+    const uint8_t *p = (const uint8_t *)addr;
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc0 = zero, acc1 = zero;   // four 64-bit lanes each
+    for (; count >= 64; p += 64, count -= 64)
+    {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)p);
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(p + 32));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v1, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v1, zero));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(acc0, acc1));
+    // each loop iteration adds two 32-bit words to every lane of acc0 and of acc1;
+    // with count < 2^32 that is below 2^26 iterations, so a lane of acc0+acc1 is
+    // below 2^60 and the sum of the four lanes below 2^62: no overflow
+    uint64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return fold64(sumWords64(p, count, fold64(sum)));
+}
+#endif
+
+typedef uint16_t (*ChecksumFunction)(const void *addr, unsigned int count);
+
+static ChecksumFunction selectChecksum()
+{
+#ifdef TCPIP_CHECKSUM_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return checksumAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return checksumSSE2;
+#endif
+    return checksumScalar64;
+}
+
+static ChecksumFunction checksumImpl = selectChecksum();
+
 uint16_t TCPIPchecksum::_checksum(const void *addr, unsigned int count)
+{
+    return checksumImpl(addr, count);
+}
+
+uint16_t TCPIPchecksum::_checksum16(const void *addr, unsigned int count)
 {
     uint32_t sum = 0;
 
@@ -42,3 +170,8 @@ uint16_t TCPIPchecksum::_checksum(const void *addr, unsigned int count)
 
     return (uint16_t)sum;
 }
+
+uint16_t TCPIPchecksum::_checksum64(const void *addr, unsigned int count)
+{
+    return checksumScalar64(addr, count);
+}
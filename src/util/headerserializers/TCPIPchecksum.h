@@ -48,7 +48,15 @@ class TCPIPchecksum
             return ~ _checksum(addr, count);
         }
 
+        /**
+         * Returns the (not complemented) one's complement sum. Uses AVX2 or
+         * SSE2 if the CPU supports it, and a 64-bit scalar loop otherwise.
+         */
         static uint16_t _checksum(const void *addr, unsigned int count);
+
+        /** Portable implementations, also used for comparison in tests */
+        static uint16_t _checksum16(const void *addr, unsigned int count);
+        static uint16_t _checksum64(const void *addr, unsigned int count);
 };
 
 #endif
@@ -21,7 +21,7 @@
 #include "ChannelAccess.h"
 
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? ev : ev << logName() << "::ChannelAccess: "
+#define coreEV INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.isDisabled() && coreDebug) << logName() << "::ChannelAccess: "
 
 /**
  * Upon initialization ChannelAccess registers the nic parent module
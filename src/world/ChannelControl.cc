@@ -19,8 +19,16 @@
 #include "FWMath.h"
 #include <cassert>
 
+// the batch reception kernel has an AVX2 variant, compiled with a per-function
+// target attribute and selected at run time
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define CHANNELCONTROL_SIMD
+#include <immintrin.h>
+#endif
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? ev : ev << "ChannelControl: "
+
+#define coreEV INET_LOG_IF(INET_LOGLEVEL_DEBUG, ev, !ev.isDisabled() && coreDebug) << "ChannelControl: "
 
 Define_Module(ChannelControl);
 
@@ -39,8 +47,75 @@ std::ostream& operator<<(std::ostream& os, const ChannelControl::TransmissionLis
     return os;
 }
 
+/**
+ * Computes distance, propagation delay and received power (assuming a path
+ * loss exponent of 2) for n receivers, gathering their positions by index.
+ * The expressions are evaluated in the same order as Coord::distance() and
+ * the radios' path loss formula, so the results are identical.
+ */
+static void calculateReceptionsScalar(const double *posX, const double *posY, const int *indices, int n,
+                                      double x, double y, double pathLossNumerator,
+                                      double *distance, double *delay, double *power)
+{
+    const double pathLossDivisor = 16 * M_PI * M_PI;
+    for (int i = 0; i < n; i++)
+    {
+        double dx = x - posX[indices[i]];
+        double dy = y - posY[indices[i]];
+        double d = sqrt(dx * dx + dy * dy);
+        distance[i] = d;
+        delay[i] = d / LIGHT_SPEED;
+        power[i] = pathLossNumerator / (pathLossDivisor * (d * d));
+    }
+}
+
+#ifdef CHANNELCONTROL_SIMD
+// explicit mul/add intrinsics: no FMA contraction, so the lanes round like the scalar code
+__attribute__((target("avx2")))
+static void calculateReceptionsAVX2(const double *posX, const double *posY, const int *indices, int n,
+                                    double x, double y, double pathLossNumerator,
+                                    double *distance, double *delay, double *power)
+{
+    const __m256d vx = _mm256_set1_pd(x);
+    const __m256d vy = _mm256_set1_pd(y);
+    const __m256d vLightSpeed = _mm256_set1_pd(LIGHT_SPEED);
+    const __m256d vNumerator = _mm256_set1_pd(pathLossNumerator);
+    const __m256d vDivisor = _mm256_set1_pd(16 * M_PI * M_PI);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i idx = _mm_loadu_si128((const __m128i *)(indices + i));
+        __m256d dx = _mm256_sub_pd(vx, _mm256_i32gather_pd(posX, idx, 8));
+        __m256d dy = _mm256_sub_pd(vy, _mm256_i32gather_pd(posY, idx, 8));
+        __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+        _mm256_storeu_pd(distance + i, d);
+        _mm256_storeu_pd(delay + i, _mm256_div_pd(d, vLightSpeed));
+        _mm256_storeu_pd(power + i, _mm256_div_pd(vNumerator, _mm256_mul_pd(vDivisor, _mm256_mul_pd(d, d))));
+    }
+    calculateReceptionsScalar(posX, posY, indices + i, n - i, x, y, pathLossNumerator,
+                              distance + i, delay + i, power + i);
+}
+#endif
+
+typedef void (*ReceptionsFunction)(const double *posX, const double *posY, const int *indices, int n,
+                                   double x, double y, double pathLossNumerator,
+                                   double *distance, double *delay, double *power);
+
+static ReceptionsFunction selectReceptionsFunction()
+{
+#ifdef CHANNELCONTROL_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return calculateReceptionsAVX2;
+#endif
+    return calculateReceptionsScalar;
+}
+
+static ReceptionsFunction calculateReceptionsImpl = selectReceptionsFunction();
+
 ChannelControl::ChannelControl()
 {
+    numMovingHosts = 0;
 }
 
 ChannelControl::~ChannelControl()
@@ -81,6 +156,7 @@ void ChannelControl::initialize()
     lastOngoingTransmissionsUpdate = 0;
 
     maxInterferenceDistance = calcInterfDist();
+    waveLength = 300000000.0 / (double) par("carrierFrequency");
 
     WATCH(maxInterferenceDistance);
     WATCH_LIST(hosts);
@@ -146,12 +222,19 @@ ChannelControl::HostRef ChannelControl::registerHost(cModule *host, const Coord&
         radioInGate = host->gate("radioIn"); // throws error if gate does not exist
 
     HostEntry he;
+    he.index = hosts.size();
     he.host = host;
     he.radioInGate = radioInGate;
     he.pos = initialPos;
+    he.isMoving = false;
+    he.posTime = he.trajectoryEnd = he.curPosTime = 0;
     he.isNeighborListValid = false;
+    he.linkBudgets.isValid = false;
     he.channel = 0;  // for now
     hosts.push_back(he);
+    hostPosX.push_back(initialPos.x);
+    hostPosY.push_back(initialPos.y);
+    hostPathLossAlpha.push_back(-1);
     return &hosts.back(); // last element
 }
 
@@ -170,8 +253,12 @@ const ChannelControl::HostRefVector& ChannelControl::getNeighbors(HostRef h)
     if (!h->isNeighborListValid)
     {
         h->neighborList.clear();
+        h->neighborIndices.clear();
         for (std::set<HostRef>::const_iterator it = h->neighbors.begin(); it != h->neighbors.end(); it++)
+        {
             h->neighborList.push_back(*it);
+            h->neighborIndices.push_back((*it)->index);
+        }
         h->isNeighborListValid = true;
     }
     return h->neighborList;
@@ -179,7 +266,7 @@ const ChannelControl::HostRefVector& ChannelControl::getNeighbors(HostRef h)
 
 void ChannelControl::updateConnections(HostRef h)
 {
-    Coord& hpos = h->pos;
+    const Coord& hpos = getHostPosition(h);
     double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
     for (HostList::iterator it = hosts.begin(); it != hosts.end(); ++it)
     {
@@ -189,7 +276,7 @@ void ChannelControl::updateConnections(HostRef h)
 
         // get the distance between the two hosts.
         // (omitting the square root (calling sqrdist() instead of distance()) saves about 5% CPU)
-        bool inRange = hpos.sqrdist(hi->pos) < maxDistSquared;
+        bool inRange = hpos.sqrdist(getHostPosition(hi)) < maxDistSquared;
 
         if (inRange)
         {
@@ -198,6 +285,7 @@ void ChannelControl::updateConnections(HostRef h)
             {
                 hi->neighbors.insert(h);
                 h->isNeighborListValid = hi->isNeighborListValid = false;
+                h->linkBudgets.isValid = hi->linkBudgets.isValid = false;
             }
         }
         else
@@ -207,6 +295,7 @@ void ChannelControl::updateConnections(HostRef h)
             {
                 hi->neighbors.erase(h);
                 h->isNeighborListValid = hi->isNeighborListValid = false;
+                h->linkBudgets.isValid = hi->linkBudgets.isValid = false;
             }
         }
     }
@@ -221,15 +310,74 @@ void ChannelControl::checkChannel(const int channel)
 void ChannelControl::updateHostPosition(HostRef h, const Coord& pos)
 {
     Enter_Method_Silent();
+    // mobility models may report unchanged positions; those keep the link budgets
+    if (h->isMoving || pos.x != h->pos.x || pos.y != h->pos.y)
+        invalidateLinkBudgets(h);
+    if (h->isMoving)
+    {
+        h->isMoving = false;
+        numMovingHosts--;
+    }
     h->pos = pos;
+    storeHostPosition(h, pos);
     updateConnections(h);
 }
 
+void ChannelControl::updateHostTrajectory(HostRef h, const Coord& startPos, simtime_t startTime,
+                                          const Coord& speed, simtime_t endTime)
+{
+    Enter_Method_Silent();
+    bool moving = (speed.x!=0 || speed.y!=0) && endTime>startTime;
+    if (moving != h->isMoving)
+        numMovingHosts += moving ? 1 : -1;
+    h->isMoving = moving;
+    invalidateLinkBudgets(h);
+    h->pos = startPos;
+    h->posTime = startTime;
+    h->speed = speed;
+    h->trajectoryEnd = endTime;
+    h->curPosTime = -1;
+    storeHostPosition(h, getHostPosition(h));
+    updateConnections(h);
+}
+
+const Coord& ChannelControl::evaluateHostPosition(HostRef h)
+{
+    simtime_t t = simTime();
+    if (t > h->trajectoryEnd)
+        t = h->trajectoryEnd;
+    if (t != h->curPosTime)
+    {
+        h->curPos = h->pos + h->speed * SIMTIME_DBL(t - h->posTime);
+        h->curPosTime = t;
+        storeHostPosition(h, h->curPos);
+    }
+    return h->curPos;
+}
+
+void ChannelControl::setHostPathLoss(HostRef h, double pathLossAlpha)
+{
+    Enter_Method_Silent();
+    hostPathLossAlpha[h->index] = pathLossAlpha;
+    invalidateLinkBudgets(h);
+}
+
+void ChannelControl::invalidateLinkBudgets(HostRef h)
+{
+    // hosts that go out of range or come into range are handled in
+    // updateConnections(); this covers the ones staying in range
+    h->linkBudgets.isValid = false;
+    for (std::set<HostRef>::const_iterator it = h->neighbors.begin(); it != h->neighbors.end(); it++)
+        (*it)->linkBudgets.isValid = false;
+}
+
 void ChannelControl::updateHostChannel(HostRef h, const int channel)
 {
     Enter_Method_Silent();
     checkChannel(channel);
 
+    if (h->channel != channel)
+        invalidateLinkBudgets(h);
     h->channel = channel;
 }
 
@@ -287,31 +435,86 @@ void ChannelControl::purgeOngoingTransmissions()
     }
 }
 
+void ChannelControl::calculateReceptions(LinkBudgetCache& links, double x, double y, double pSend)
+{
+    int n = links.indices.size();
+    rcvDistance.resize(n);
+    links.delay.resize(n);
+    links.power.resize(n);
+    if (n == 0)
+        return;
+
+    double pathLossNumerator = pSend * waveLength * waveLength;
+    calculateReceptionsImpl(&hostPosX[0], &hostPosY[0], &links.indices[0], n, x, y, pathLossNumerator,
+                            &rcvDistance[0], &links.delay[0], &links.power[0]);
+
+    // the kernel assumes alpha==2 (free space); other exponents need pow()
+    for (int i = 0; i < n; i++)
+    {
+        double alpha = hostPathLossAlpha[links.indices[i]];
+        if (alpha < 0)
+            links.power[i] = -1;
+        else if (alpha != 2)
+            links.power[i] = pathLossNumerator / (16 * M_PI * M_PI * pow(rcvDistance[i], alpha));
+    }
+}
+
 void ChannelControl::sendToChannel(cSimpleModule *srcRadioMod, HostRef srcHost, AirFrame *airFrame)
 {
     // NOTE: no Enter_Method()! We pretend this method is part of ChannelAccess
 
-    // loop through all hosts in range
-    const HostRefVector& neighbors = getNeighbors(srcHost);
-    int n = neighbors.size();
+    // hosts moving along trajectories don't report their positions
+    // periodically, so the neighbor list of the sender is refreshed here
+    if (numMovingHosts > 0)
+        updateConnections(srcHost);
+
+    LinkBudgetCache& links = srcHost->linkBudgets;
     int channel = airFrame->getChannelNumber();
-    for (int i=0; i<n; i++)
+    double pSend = airFrame->getPSend();
+    if (!links.isValid || links.channel != channel || links.pSend != pSend)
     {
-        HostRef h = neighbors[i];
-        if (h->channel == channel)
+        // collect hosts in range listening on the frame's channel
+        const HostRefVector& neighbors = getNeighbors(srcHost);
+        int n = neighbors.size();
+        bool isStatic = !srcHost->isMoving;
+        links.hosts.clear();
+        links.indices.clear();
+        for (int i=0; i<n; i++)
         {
-            coreEV << "sending message to host listening on the same channel\n";
-            // account for propagation delay, based on distance in meters
-            // Over 300m, dt=1us=10 bit times @ 10Mbps
-            simtime_t delay = srcHost->pos.distance(h->pos) / LIGHT_SPEED;
-            srcRadioMod->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), h->radioInGate);
+            HostRef h = neighbors[i];
+            if (h->channel == channel)
+            {
+                if (h->isMoving)
+                {
+                    evaluateHostPosition(h);  // brings hostPosX/hostPosY up to date
+                    isStatic = false;
+                }
+                links.hosts.push_back(h);
+                links.indices.push_back(srcHost->neighborIndices[i]);
+            }
+            else
+                coreEV << "skipping host listening on a different channel\n";
         }
-        else
-            coreEV << "skipping host listening on a different channel\n";
+
+        // distances, propagation delays and received powers in one pass
+        const Coord& srcPos = getHostPosition(srcHost);
+        calculateReceptions(links, srcPos.x, srcPos.y, pSend);
+        links.channel = channel;
+        links.pSend = pSend;
+        links.isValid = isStatic;  // positions of moving hosts change with time
+    }
+
+    int numReceivers = links.hosts.size();
+    for (int i=0; i<numReceivers; i++)
+    {
+        coreEV << "sending message to host listening on the same channel\n";
+        // account for propagation delay, based on distance in meters
+        // Over 300m, dt=1us=10 bit times @ 10Mbps
+        AirFrame *frame = airFrame->dup();
+        frame->setRcvdPower(links.power[i]);
+        srcRadioMod->sendDirect(frame, links.delay[i], airFrame->getDuration(), links.hosts[i]->radioInGate);
     }
 
     // register transmission
     addOngoingTransmission(srcHost, airFrame);
 }
-
-
@@ -47,25 +47,72 @@ class INET_API ChannelControl : public cSimpleModule
     typedef std::list<AirFrame*> TransmissionList;
 
   protected:
+    /**
+     * Link budgets from a sender to the hosts in range listening on a
+     * channel: propagation delay and mean received power (before random
+     * effects such as shadowing). Kept while neither endpoint moves or
+     * changes channel or path loss, and the sender's power stays the same,
+     * so static topologies compute them only once per sender.
+     */
+    struct LinkBudgetCache {
+        bool isValid;
+        int channel;
+        double pSend;
+        HostRefVector hosts;
+        std::vector<int> indices;
+        std::vector<double> delay;
+        std::vector<double> power;  // negative for hosts without registered path loss
+    };
+
     /**
      * Keeps track of hosts/NICs, their positions and channels;
      * also caches neighbor info (which other hosts are within
      * interference distance).
      */
     struct HostEntry {
+        int index;  // into the position arrays below
         cModule *host;
         cGate *radioInGate;
         int channel;
-        Coord pos; // cached
+        Coord pos; // cached; for moving hosts, the position at posTime
         std::set<HostRef> neighbors;  // cached neighbour list
 
+        // hosts whose mobility publishes a trajectory instead of periodic
+        // position updates: the position is pos + speed*(t-posTime),
+        // up to trajectoryEnd. curPos caches it for curPosTime.
+        bool isMoving;
+        simtime_t posTime;
+        Coord speed;
+        simtime_t trajectoryEnd;
+        Coord curPos;
+        simtime_t curPosTime;
+
         // we cache neighbors set in an std::vector, because std::set iteration is slow;
         // std::vector is created and updated on demand
         bool isNeighborListValid;
         HostRefVector neighborList;
+        std::vector<int> neighborIndices;  // index of each neighborList entry
+
+        LinkBudgetCache linkBudgets;  // as a sender
     };
     HostList hosts;
 
+    /**
+     * @brief Current host positions and radio path loss exponents, as
+     * contiguous arrays indexed by HostEntry::index (structure of arrays),
+     * so that sendToChannel() can evaluate all receivers in one pass.
+     * For moving hosts, the position is the one last evaluated.
+     */
+    std::vector<double> hostPosX;
+    std::vector<double> hostPosY;
+    std::vector<double> hostPathLossAlpha;  // negative if not registered
+
+    /** @brief wave length at carrierFrequency, for the received power */
+    double waveLength;
+
+    /** @brief scratch buffer of calculateReceptions(), kept to avoid reallocation */
+    std::vector<double> rcvDistance;
+
     /** @brief keeps track of ongoing transmissions; this is needed when a host
      * switches to another channel (then it needs to know whether the target channel
      * is empty or busy)
@@ -91,9 +138,30 @@ class INET_API ChannelControl : public cSimpleModule
     /** @brief the number of controlled channels */
     int numChannels;
 
+    /** @brief the number of hosts currently moving along a trajectory */
+    int numMovingHosts;
+
   protected:
     virtual void updateConnections(HostRef h);
 
+    /** @brief Computes the current position of a host moving along a trajectory */
+    const Coord& evaluateHostPosition(HostRef h);
+
+    /** @brief Stores the host's position in the position arrays */
+    void storeHostPosition(HostRef h, const Coord& pos) {
+        hostPosX[h->index] = pos.x;
+        hostPosY[h->index] = pos.y;
+    }
+
+    /**
+     * @brief Fills the delay and power of the link budgets for the hosts
+     * already in it, as seen from the sender at (x,y) transmitting with pSend.
+     */
+    virtual void calculateReceptions(LinkBudgetCache& links, double x, double y, double pSend);
+
+    /** @brief Invalidates the link budgets from and to the given host */
+    void invalidateLinkBudgets(HostRef h);
+
     /** @brief Calculate interference distance*/
     virtual double calcInterfDist();
 
@@ -134,6 +202,24 @@ class INET_API ChannelControl : public cSimpleModule
     /** @brief To be called when the host moved; updates proximity info */
     virtual void updateHostPosition(HostRef h, const Coord& pos);
 
+    /**
+     * @brief To be called at the start of a linear movement: the host is at
+     * startPos at startTime, and moves with the given speed (m/s) until
+     * endTime. Its position is evaluated on demand, so no further updates
+     * are needed until the end of the movement.
+     */
+    virtual void updateHostTrajectory(HostRef h, const Coord& startPos, simtime_t startTime,
+                                      const Coord& speed, simtime_t endTime);
+
+    /**
+     * @brief Registers the path loss exponent of the host's radio. Radios
+     * whose received power is pSend * waveLength^2 / (16 * pi^2 * distance^alpha)
+     * (with carrierFrequency taken from ChannelControl) may call this; then
+     * sendToChannel() precomputes that power and passes it in the AirFrame
+     * (see AirFrame's rcvdPower field).
+     */
+    virtual void setHostPathLoss(HostRef h, double pathLossAlpha);
+
     /** @brief Called when host switches channel */
     virtual void updateHostChannel(HostRef h, const int channel);
 
@@ -144,7 +230,9 @@ class INET_API ChannelControl : public cSimpleModule
     virtual void addOngoingTransmission(HostRef h, AirFrame *frame);
 
     /** @brief Returns the host's position */
-    const Coord& getHostPosition(HostRef h)  {return h->pos;}
+    const Coord& getHostPosition(HostRef h)  {
+        return h->isMoving ? evaluateHostPosition(h) : h->pos;
+    }
 
     /** @brief Get the list of modules in range of the given host */
     const HostRefVector& getNeighbors(HostRef h);